@@ -9,9 +9,13 @@
  * See LICENSE and COPYING for more details.
  */
 #include <iostream>
+#include <cstring>
 #include <igraph/igraph.h>
 #include <igraph/igraph_version.h>
 
+#define IGRAPH_STR(x) #x
+#define IGRAPH_XSTR(x) IGRAPH_STR(x)
+
 using namespace std;
 int main(int argc, char* argv[]) {
   // versions of igraph 0.5 and earlier did not specify IGRAPH_VERSION
@@ -37,5 +41,15 @@ int main(int argc, char* argv[]) {
   } else {
     printf("#define IGRAPH_V IGRAPH_V_0_5\n");
   }
+  // igraph keeps its error state, its IGRAPH_FINALLY cleanup stack and its
+  // attribute table in globals unless it was configured with --enable-tls:
+  // only then may several threads call igraph at the same time
+  int thread_safe = 0;
+#if defined(IGRAPH_THREAD_SAFE)
+  thread_safe = IGRAPH_THREAD_SAFE;
+#elif defined(IGRAPH_THREAD_LOCAL)
+  thread_safe = strlen(IGRAPH_XSTR(IGRAPH_THREAD_LOCAL)) > 0;
+#endif
+  printf("#define IGRAPH_TLS %d\n", thread_safe ? 1 : 0);
   printf("#endif");
 }
@@ -21,6 +21,7 @@
 #include <vector>
 #include <blackadder.hpp>
 #include "tm_igraph.hpp"
+#include "tm_backup.hpp"
 #include <sstream>
 #include <iostream>
 #include <boost/algorithm/string.hpp>
@@ -30,6 +31,7 @@ using namespace std;
 
 Blackadder *ba = NULL;
 TMIgraph *tm_igraph = NULL;
+TMBackupPaths *backup_paths = NULL;
 pthread_t _event_listener, *event_listener = NULL;
 sig_atomic_t listening = 1;
 
@@ -52,6 +54,10 @@ std::string resl_req_prefix_id = string();
 std::string resl_req_bin_id = hex_to_chararray(resl_req_id);
 std::string resl_req_bin_prefix_id = hex_to_chararray(resl_req_prefix_id);
 
+/*Response scope of the TM, used by the RM to rebind publishers to their backup paths*/
+string resp_prefix_id = string(PURSUIT_ID_LEN*2-1, 'F') + "D"; // "FF..FFFFFFFFFFFFFD"
+string resp_bin_prefix_id = hex_to_chararray(resp_prefix_id);
+
 /*RM ICN IDs*/
 string UpdatePathId = resl_bin_id;
 string UpdateUnicastPathId = resl_bin_id + uc_resl_bin_id ;
@@ -89,6 +95,10 @@ void handleMulticastPathNotification (char *request, int request_len){
             path_v = string((const string&)request_str, path_idx , (int)path_len);
             /*print out the path vectors*/
             path_vecs.insert(path_v);
+            /*precompute the disjoint backup of the path*/
+            if (!backup_paths->protect(path_v)) {
+                cout << "RM: no disjoint backup for path " << path_v << endl;
+            }
             path_idx += (int)path_len;
         }
     } else {
@@ -155,6 +165,10 @@ void handleUnicastPathNotification (char *request, int request_len){
         path_v = string(request + path_idx, (int) path_len);
         path_idx += (int) path_len;
         publisher_path = make_pair(publisher, path_v);
+        /*precompute the disjoint backup of the path*/
+        if (!backup_paths->protect(path_v)) {
+            cout << "RM: no disjoint backup for path " << path_v << endl;
+        }
     } else {
         /*delivery finished for this publisher*/
         cout << "RM: delivery finished of : " << chararray_to_hex(icn_id) << endl;
@@ -285,6 +299,112 @@ void requestUnicastPaths(set<string>& ids, map<string, set<string> >& publishers
     delete FID_to_tm;
     //	cout << "-------------------------------- EoR --------------------------------" << endl;
 }
+/*Publish an UPDATE_FID directly to the publisher of an information item, in the format of the TM responses*/
+void publishBackupFID(const string &icn_id, string publisher, Bitvector *FID) {
+    unsigned char response_type = UPDATE_FID;
+    int response_size = sizeof (response_type) + icn_id.length() + FID_LEN;
+    char * response = (char *) malloc (response_size);
+    memcpy(response, &response_type, sizeof (response_type));
+    memcpy(response + sizeof (response_type), icn_id.c_str(), icn_id.length());
+    memcpy(response + sizeof (response_type) + icn_id.length(), FID->_data, FID_LEN);
+    string response_id = resp_bin_prefix_id + publisher;
+    Bitvector *FID_to_publisher = tm_igraph->calculateFID(tm_igraph->getRMNodeID(), publisher);
+    ba->publish_data(response_id, IMPLICIT_RENDEZVOUS, (char *) FID_to_publisher->_data, FID_LEN, response, response_size);
+    delete FID_to_publisher;
+    free(response);
+}
+/*Rebind the broken native ICN deliveries that have a precomputed backup for every broken path, the rebound ones are removed from ids*/
+void rebindMulticastTrees(set<string>& ids, const string &a, const string &b) {
+    vector<string> path_nodes;
+    string backup_path;
+    for (set<string>::iterator it = ids.begin(); it != ids.end(); ) {
+        set<string> &paths = tm_igraph->path_info[(*it)];
+        set<string> new_paths;
+        set<string> rebound_publishers;
+        map<string, Bitvector *> FIDs;
+        bool rebound = true;
+        for (set<string>::iterator path_it = paths.begin(); path_it != paths.end() && rebound; path_it++) {
+            TMIgraph::splitPathVector((*path_it), path_nodes);
+            if (!TMBackupPaths::crossesLink(path_nodes, a, b)) {
+                new_paths.insert((*path_it));
+            } else if (backup_paths->backup((*path_it), a, b, backup_path)) {
+                new_paths.insert(backup_path);
+                rebound_publishers.insert(path_nodes.front());
+            } else {
+                rebound = false;
+            }
+        }
+        /*the FID of a rebound publisher covers all of its paths in the tree*/
+        for (set<string>::iterator path_it = new_paths.begin(); path_it != new_paths.end() && rebound; path_it++) {
+            TMIgraph::splitPathVector((*path_it), path_nodes);
+            if (rebound_publishers.find(path_nodes.front()) == rebound_publishers.end()) {
+                continue;
+            }
+            Bitvector *path_FID = tm_igraph->calculatePathFID((*path_it));
+            if (path_FID == NULL) {
+                rebound = false;
+            } else if (FIDs.find(path_nodes.front()) == FIDs.end()) {
+                FIDs[path_nodes.front()] = path_FID;
+            } else {
+                *FIDs[path_nodes.front()] = *FIDs[path_nodes.front()] | *path_FID;
+                delete path_FID;
+            }
+        }
+        if (rebound) {
+            for (map<string, Bitvector *>::iterator fid_it = FIDs.begin(); fid_it != FIDs.end(); fid_it++) {
+                cout << "RM: Information " << chararray_to_hex((*it)) << " rebound to the backup paths of publisher " << (*fid_it).first << endl;
+                publishBackupFID((*it), (*fid_it).first, (*fid_it).second);
+            }
+            paths = new_paths;
+            ids.erase(it++);
+        } else {
+            it++;
+        }
+        for (map<string, Bitvector *>::iterator fid_it = FIDs.begin(); fid_it != FIDs.end(); fid_it++) {
+            delete (*fid_it).second;
+        }
+    }
+}
+/*Rebind the broken *-over-ICN deliveries that have a precomputed backup for every broken path, the rebound ones are removed from ids*/
+void rebindUnicastPaths(set<string>& ids, const string &a, const string &b) {
+    vector<string> path_nodes;
+    string backup_path;
+    for (set<string>::iterator it = ids.begin(); it != ids.end(); ) {
+        map<string, string> &paths = tm_igraph->unicast_path_info[(*it)];
+        map<string, string> new_paths = paths;
+        map<string, Bitvector *> FIDs;
+        bool rebound = true;
+        for (map<string, string>::iterator path_it = paths.begin(); path_it != paths.end() && rebound; path_it++) {
+            TMIgraph::splitPathVector((*path_it).second, path_nodes);
+            if (!TMBackupPaths::crossesLink(path_nodes, a, b)) {
+                continue;
+            }
+            Bitvector *path_FID = NULL;
+            if (backup_paths->backup((*path_it).second, a, b, backup_path)) {
+                path_FID = tm_igraph->calculatePathFID(backup_path);
+            }
+            if (path_FID == NULL) {
+                rebound = false;
+            } else {
+                new_paths[(*path_it).first] = backup_path;
+                FIDs[(*path_it).first] = path_FID;
+            }
+        }
+        if (rebound) {
+            for (map<string, Bitvector *>::iterator fid_it = FIDs.begin(); fid_it != FIDs.end(); fid_it++) {
+                cout << "RM: *-over-ICN Information " << chararray_to_hex((*it)) << " rebound to the backup path of publisher " << (*fid_it).first << endl;
+                publishBackupFID((*it), (*fid_it).first, (*fid_it).second);
+            }
+            paths = new_paths;
+            ids.erase(it++);
+        } else {
+            it++;
+        }
+        for (map<string, Bitvector *>::iterator fid_it = FIDs.begin(); fid_it != FIDs.end(); fid_it++) {
+            delete (*fid_it).second;
+        }
+    }
+}
 void handleLinkStateNotification(char * request, int request_len) {
     cout << "-------------------------------- Link State Notification --------------------------------" << endl;
     int field_offset = 0;
@@ -349,6 +469,23 @@ void handleLinkStateNotification(char * request, int request_len) {
             }
         }
     }
+    /*follow the failure in the RM topology, so that the FIDs towards the TM and the new backups avoid the failed link*/
+    tm_igraph->updateGraph(affected_node, lsn_publisher, (bool) net_type, true);
+    /*deliveries with a precomputed backup are rebound with a single publication, only the others are requested from the TM*/
+    rebindMulticastTrees(affected_ICNids, lsn_publisher, affected_node);
+    rebindUnicastPaths(affected_UnicastICNids, lsn_publisher, affected_node);
+    /*protect the current paths again on the updated topology*/
+    backup_paths->linkFailed(lsn_publisher, affected_node);
+    for (map<string, set<string> >::iterator icn_it = tm_igraph->path_info.begin(); icn_it != tm_igraph->path_info.end(); icn_it++) {
+        for (set<string>::iterator path_it = icn_it->second.begin(); path_it != icn_it->second.end(); path_it++) {
+            backup_paths->protect((*path_it));
+        }
+    }
+    for (map<string, map<string, string> >::iterator ip_it = tm_igraph->unicast_path_info.begin(); ip_it != tm_igraph->unicast_path_info.end(); ip_it++) {
+        for (map<string, string>::iterator path_it = ip_it->second.begin(); path_it != ip_it->second.end(); path_it++) {
+            backup_paths->protect((*path_it).second);
+        }
+    }
     if (!affected_ICNids.empty()) {
         requestMulticastTree(affected_ICNids, publishers, subscribers);
     } else {
@@ -362,6 +499,38 @@ void handleLinkStateNotification(char * request, int request_len) {
     cout << "-------------------------------- EoN --------------------------------" << endl;
 }
 
+void handleLinkRecoveryNotification(char * request, int request_len) {
+    cout << "-------------------------------- Link Recovery Notification --------------------------------" << endl;
+    int field_offset = 0;
+    unsigned char net_type;
+    string lsn_publisher;
+    string affected_node;
+    memcpy(&net_type, request + field_offset, sizeof (net_type));
+    field_offset += sizeof (net_type);
+    lsn_publisher = string(request, field_offset, NODEID_LEN);
+    field_offset += NODEID_LEN;
+    affected_node = string(request, field_offset, NODEID_LEN);
+    field_offset += NODEID_LEN;
+    /*follow the recovery in the RM topology, otherwise the topology only shrinks with every failure*/
+    if (tm_igraph->updateGraph(affected_node, lsn_publisher, (bool) net_type, false)) {
+        cout << "RM: Link Restored Between: " << lsn_publisher << " and " << affected_node << endl;
+        /*the known pairs are still disjoint, protect the paths which had no disjoint pair without the link*/
+        for (map<string, set<string> >::iterator icn_it = tm_igraph->path_info.begin(); icn_it != tm_igraph->path_info.end(); icn_it++) {
+            for (set<string>::iterator path_it = icn_it->second.begin(); path_it != icn_it->second.end(); path_it++) {
+                backup_paths->protect((*path_it));
+            }
+        }
+        for (map<string, map<string, string> >::iterator ip_it = tm_igraph->unicast_path_info.begin(); ip_it != tm_igraph->unicast_path_info.end(); ip_it++) {
+            for (map<string, string>::iterator path_it = ip_it->second.begin(); path_it != ip_it->second.end(); path_it++) {
+                backup_paths->protect((*path_it).second);
+            }
+        }
+    } else {
+        cout << "RM: the link between " << lsn_publisher << " and " << affected_node << " was not missing" << endl;
+    }
+    cout << "-------------------------------- EoN --------------------------------" << endl;
+}
+
 void DispathToHandler(const string &id, const char * request, int request_len){
     unsigned char request_type;
     unsigned char payload_len;
@@ -396,6 +565,9 @@ void DispathToHandler(const string &id, const char * request, int request_len){
                 case DISCOVER_FAILURE:
                 handleLinkStateNotification(payload, payload_len);
                 break;
+                case DISCOVER_RECOVERY:
+                handleLinkRecoveryNotification(payload, payload_len);
+                break;
             default:
                 cout << "RM: Unknow request: " << (int)request_type << endl;
                 break;
@@ -405,6 +577,8 @@ void DispathToHandler(const string &id, const char * request, int request_len){
 
 void *event_listener_loop(void *arg) {
     Blackadder *ba = (Blackadder *) arg;
+    /*the attribute table is thread-local in a thread-safe igraph*/
+    igraph_i_set_attribute_table(&igraph_cattribute_table);
     while (listening) {
         Event ev;
         ba->getEvent(ev);
@@ -431,6 +605,7 @@ int main(int argc, char* argv[]) {
     cout << "RM: starting - process ID: " << getpid() << endl;
     if (argc < 2) {
         cout << "RM: the topology file is missing" << endl;
+        cout << "usage: rm <topology.graphml> [node]" << endl;
         exit(0);
     }
     tm_igraph = new TMIgraph();
@@ -440,6 +615,8 @@ int main(int argc, char* argv[]) {
         exit(0);
     }
     cout << "RM Node: " << tm_igraph->RMnodeID << endl;
+    /*backup paths are link-disjoint, unless node-disjoint ones are requested*/
+    backup_paths = new TMBackupPaths(tm_igraph, (argc > 2) && (string(argv[2]) == "node"));
     /***************************************************/
     if (tm_igraph->mode.compare("kernel") == 0) {
         ba = Blackadder::Instance(false);
@@ -458,6 +635,7 @@ int main(int argc, char* argv[]) {
     cout << "RM: disconnecting" << endl;
     ba->disconnect();
     delete ba;
+    delete backup_paths;
     delete tm_igraph;
     cout << "RM: exiting" << endl;
     return 0;
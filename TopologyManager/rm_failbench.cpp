@@ -0,0 +1,181 @@
+/*
+ * This file is part of Blackadder.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+/*
+ * Failover benchmark for the RM backup paths: sets up random unicast
+ * deliveries on a topology, protects them with disjoint backups, then
+ * fails links on the delivery paths one at a time and times the two ways
+ * of getting the replacement FID: recomputing the shortest path (what the
+ * TM does when the RM requests a new path) and looking up the backup.
+ * The signalling round trip to the TM, which the lookup also saves, is
+ * not part of the figures. At the end the failed links are recovered and
+ * the topology is checked to be whole again.
+ *
+ * Usage: rm_failbench <topology.graphml> [deliveries] [failures] [node]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include <sys/time.h>
+#include "tm_backup.hpp"
+
+static double now() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+int main(int argc, char* argv[]) {
+	int no_deliveries = 1000;
+	int no_failures = 20;
+	bool node_disjoint = false;
+	vector<string> nodes;
+	vector<string> paths;
+	vector<string> path_nodes;
+	double protect_time = 0, recompute_time = 0, lookup_time = 0, reprotect_time = 0;
+	unsigned int broken = 0, rebound = 0, unprotected = 0, wrong = 0;
+	vector<pair<string, string> > failed;
+	if (argc < 2) {
+		fprintf(stderr, "usage: rm_failbench <topology.graphml> [deliveries] [failures] [node]\n");
+		exit(EXIT_FAILURE);
+	}
+	if (argc > 2) {
+		no_deliveries = atoi(argv[2]);
+	}
+	if (argc > 3) {
+		no_failures = atoi(argv[3]);
+	}
+	node_disjoint = (argc > 4) && (strcmp(argv[4], "node") == 0);
+	TMIgraph tm_igraph;
+	if (tm_igraph.readTopology(argv[1]) < 0) {
+		fprintf(stderr, "could not read %s\n", argv[1]);
+		exit(EXIT_FAILURE);
+	}
+	for (map<string, int>::iterator it = tm_igraph.reverse_node_index.begin(); it != tm_igraph.reverse_node_index.end(); it++) {
+		nodes.push_back((*it).first);
+	}
+	srand(1);
+	for (int d = 0; d < no_deliveries; d++) {
+		string publisher = nodes[rand() % nodes.size()];
+		string subscriber = nodes[rand() % nodes.size()];
+		Bitvector FID(FID_LEN * 8);
+		unsigned int hops;
+		string path;
+		if (publisher == subscriber) {
+			continue;
+		}
+		tm_igraph.calculateFID(publisher, subscriber, FID, hops, path);
+		if (hops != UINT_MAX) {
+			paths.push_back(path);
+		}
+	}
+	TMBackupPaths backup_paths(&tm_igraph, node_disjoint);
+	int no_edges = igraph_ecount(&tm_igraph.graph);
+	double start = now();
+	for (unsigned int d = 0; d < paths.size(); d++) {
+		backup_paths.protect(paths[d]);
+	}
+	protect_time = now() - start;
+	fprintf(stderr, "%s: %u deliveries, %u disjoint pairs in %.3fs\n", argv[1], (unsigned int) paths.size(), backup_paths.size(), protect_time);
+	for (int f = 0; f < no_failures && !paths.empty(); f++) {
+		/*fail a random link of a random delivery path*/
+		TMIgraph::splitPathVector(paths[rand() % paths.size()], path_nodes);
+		unsigned int hop = rand() % (path_nodes.size() - 1);
+		string a = path_nodes[hop];
+		string b = path_nodes[hop + 1];
+		if (tm_igraph.updateGraph(a, b, true, true)) {
+			failed.push_back(pair<string, string>(a, b));
+		}
+		vector<unsigned int> affected;
+		for (unsigned int d = 0; d < paths.size(); d++) {
+			TMIgraph::splitPathVector(paths[d], path_nodes);
+			if (TMBackupPaths::crossesLink(path_nodes, a, b)) {
+				affected.push_back(d);
+			}
+		}
+		broken += affected.size();
+		/*what a new path request costs the TM*/
+		vector<string> recomputed(affected.size());
+		start = now();
+		for (unsigned int i = 0; i < affected.size(); i++) {
+			TMIgraph::splitPathVector(paths[affected[i]], path_nodes);
+			Bitvector FID(FID_LEN * 8);
+			unsigned int hops;
+			tm_igraph.calculateFID(path_nodes.front(), path_nodes.back(), FID, hops, recomputed[i]);
+			if (hops == UINT_MAX) {
+				recomputed[i].clear();
+			}
+		}
+		recompute_time += now() - start;
+		/*what the backup lookup costs the RM*/
+		vector<string> backups(affected.size());
+		start = now();
+		for (unsigned int i = 0; i < affected.size(); i++) {
+			if (backup_paths.backup(paths[affected[i]], a, b, backups[i])) {
+				Bitvector *FID = tm_igraph.calculatePathFID(backups[i]);
+				if (FID == NULL) {
+					wrong++;
+					backups[i].clear();
+				}
+				delete FID;
+			} else {
+				backups[i].clear();
+			}
+		}
+		lookup_time += now() - start;
+		for (unsigned int i = 0; i < affected.size(); i++) {
+			if (!backups[i].empty()) {
+				rebound++;
+				paths[affected[i]] = backups[i];
+			} else {
+				unprotected++;
+				paths[affected[i]] = recomputed[i];
+			}
+		}
+		/*drop the deliveries that lost their subscriber*/
+		for (unsigned int d = paths.size(); d > 0; d--) {
+			if (paths[d - 1].empty()) {
+				paths.erase(paths.begin() + d - 1);
+			}
+		}
+		start = now();
+		backup_paths.linkFailed(a, b);
+		for (unsigned int d = 0; d < paths.size(); d++) {
+			backup_paths.protect(paths[d]);
+		}
+		reprotect_time += now() - start;
+	}
+	/*recover the failed links as the RM does on a DISCOVER_RECOVERY, the topology must be whole again*/
+	for (unsigned int f = failed.size(); f > 0; f--) {
+		tm_igraph.updateGraph(failed[f - 1].first, failed[f - 1].second, true, false);
+	}
+	for (unsigned int d = 0; d < paths.size(); d++) {
+		backup_paths.protect(paths[d]);
+	}
+	if (igraph_ecount(&tm_igraph.graph) != no_edges) {
+		fprintf(stderr, "%s: %d edges after the recovery of %u links, %d before the failures\n",
+				argv[1], (int) igraph_ecount(&tm_igraph.graph), (unsigned int) failed.size(), no_edges);
+		wrong++;
+	}
+	fprintf(stderr, "%s: %d failures, %u broken deliveries, %u rebound to backups, %u left to the TM, %u invalid backups\n",
+			argv[1], no_failures, broken, rebound, unprotected, wrong);
+	if (broken > 0) {
+		fprintf(stderr, "%s: time to the replacement FID: recomputation %.1fus, backup lookup %.1fus per delivery; re-protection %.3fs per failure\n",
+				argv[1], recompute_time * 1e6 / broken, lookup_time * 1e6 / broken, reprotect_time / no_failures);
+	}
+	return wrong == 0 ? 0 : 1;
+}
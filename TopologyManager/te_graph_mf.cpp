@@ -19,6 +19,7 @@
 #include <boost/foreach.hpp>
 #include <boost/lexical_cast.hpp>
 #include <stdlib.h>
+#include <unistd.h>
 #include "te_graph_mf.hpp"
 
 extern int EF_ALLOW_MALLOC_0;
@@ -30,14 +31,16 @@ TEgraphMF::TEgraphMF() {
 	igraph_i_set_attribute_table(&igraph_cattribute_table);
 	cacheValid=false;
 	e=0.1;
+	exit_e=0.01;
 	recalculationDelay=60;
 	defaultBW=1;
 	te_thread= NULL;
 }
 
-void TEgraphMF::initialise(int Delay,double eval,double dBW){
+void TEgraphMF::initialise(int Delay,double eval,double dBW,double exite){
 	recalculationDelay = Delay;
 	e=eval;
+	exit_e=exite;
 	defaultBW=dBW;
 	
 }
@@ -178,6 +181,9 @@ int TEgraphMF::readTopology(const char *file_name) {
 	}
 	
 	graphMF = Graph_mf((int)igraph_vcount(&graph),edgepairs,capacities);
+	// use all cores for the shortest path trees of the max-flow phases
+	long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	graphMF.num_threads = cores > 0 ? cores : 1;
 	
 	// now demands are set to half the maximum flow when
 	// using shortest paths assuming equal flow between
@@ -193,6 +199,8 @@ int TEgraphMF::readTopology(const char *file_name) {
 
 void* te_loop(void *arg) {
 	TEgraphMF* graph=(TEgraphMF*)arg;
+	/*the attribute table is thread-local in a thread-safe igraph*/
+	igraph_i_set_attribute_table(&igraph_cattribute_table);
 	while(true) {
 		cout<<"recalculating"<<endl;
 		//sleep(10);
@@ -275,7 +283,9 @@ void TEgraphMF::update_paths() {
 	}
 	
 	cout<<"Computing Min Congestion Flow"<<endl;
-	graphMF.min_congestion_flow(tmpdemands,e);
+	// warm-started from the previous period, only a full
+	// recalculation if the demands changed substantially
+	graphMF.min_congestion_flow_warm(tmpdemands,e,exit_e);
 	cout<<"Finished computing Min Congestion Flow"<<endl;
 	std::vector<mf_demand>::iterator di;
 	
@@ -370,13 +380,51 @@ void TEgraphMF::update_paths() {
 }
 
 
+int te_mf_demand::pick_flow() {
+	// every pick each path gains its weight and the chosen one
+	// pays back the total weight: the split is exact over time
+	// without the bursts of a random choice
+	if(current_weights.size() != probs.size()) {
+		current_weights.assign(probs.size(), 0.0);
+		picks.assign(probs.size(), 0);
+	}
+	double total = 0;
+	unsigned int best = 0;
+	for(unsigned int i=0; i<probs.size(); i++) {
+		current_weights[i] += probs[i];
+		total += probs[i];
+		if(current_weights[i] > current_weights[best]) {
+			best = i;
+		}
+	}
+	current_weights[best] -= total;
+	picks[best]++;
+	return best;
+}
+
+std::vector<double> te_mf_demandMap::get_realized_probs(int source, int sink) {
+	std::vector<double> realized;
+	if(demand_map.find(pair<int,int>(source,sink)) == demand_map.end()) {
+		return realized;
+	}
+	te_mf_demand* te_demand =
+	&(demand_map.find(pair<int,int>(source,sink))->second);
+	unsigned long total = 0;
+	for(unsigned int i=0; i<te_demand->picks.size(); i++) {
+		total += te_demand->picks[i];
+	}
+	realized.assign(te_demand->probs.size(), 0.0);
+	for(unsigned int i=0; total > 0 && i<te_demand->picks.size(); i++) {
+		realized[i] = (double)te_demand->picks[i] / total;
+	}
+	return realized;
+}
+
 Bitvector& te_mf_demandMap::get_fid(int source, int sink) {
 	
-	//select the FID probablistically from the set of paths
-	// use inverse transfrom of CDF
+	//select the FID from the set of paths with a smooth
+	//weighted round-robin over the path probabilities
 	cout<<"calculateFID for "<<source<<"->"<<sink<<endl;
-	double ran = drand48();
-	double cumul = 0;
 	if(demand_map.find(pair<int,int>(source,sink)) ==
 	   demand_map.end()) {
 		cout<<"WARNING no demand_map entry found\n";
@@ -386,13 +434,7 @@ Bitvector& te_mf_demandMap::get_fid(int source, int sink) {
 	}
 	te_mf_demand* te_demand =
 	&(demand_map.find(pair<int,int>(source,sink))->second);
-	unsigned int i=0;
-	for(; i<te_demand->flows.size() - 1; i++) {
-		cumul += te_demand->probs[i];
-		if (ran <= cumul) {
-			break;
-		}
-	}
+	unsigned int i=te_demand->pick_flow();
 	
 	cout<<"using path ";
 	const std::vector<Vertex>& path = te_demand->paths[i];
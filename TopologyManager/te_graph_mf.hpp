@@ -34,7 +34,18 @@ public:
 	std::vector<double> flows;
 	std::vector<double> probs;
 	std::vector<Bitvector> fids;
+	/** @brief picks the next path with a smooth weighted round-robin
+	 (as in nginx) over probs, so that after n picks each path was
+	 used within about one pick (always fewer picks than there are
+	 paths) of n*probs[i]
+	 */
 	int pick_flow();
+	/** @brief the smooth weighted round-robin state of each path
+	 */
+	std::vector<double> current_weights;
+	/** @brief how many times each path has been picked
+	 */
+	std::vector<unsigned long> picks;
 };
 
 /** @brief A collection of te_mf_demand objects indexed
@@ -44,6 +55,10 @@ class te_mf_demandMap {
 public:
 	std::vector< std::vector<int> > get_paths(int source, int sink);
 	std::vector<double> get_probs(int source, int sink);
+	/** @brief the fraction of the requests that used each path so
+	 far, to be compared with the probs of the demand
+	 */
+	std::vector<double> get_realized_probs(int source, int sink);
 	std::vector<double> get_flows(int source, int sink);
 	std::vector<Bitvector> get_fids(int source, int sink);
 	Bitvector& get_fid(int source, int sink);
@@ -68,8 +83,10 @@ public:
 	 @param recalctime seconds between recalculations, default 60
 	 @param e optimisation parameter, defualt 0.1 (must be 0 < e < 1)
 	 @param defbw default bandwidth in bits per second, default 10^8
+	 @param exite relative change of the demand matrix below which the
+	 previous paths are kept without recalculation, default 0.01
 	 */
-	void initialise(int recalctime,double e,double defbw);
+	void initialise(int recalctime,double e,double defbw,double exite=0.01);
 	
 	void calculateFID(string &source, string &destination,
 					  Bitvector &resultFID,
@@ -124,6 +141,12 @@ public:
   */
 	double e;
 	
+	/**@brief early exit threshold of the warm-started max-flow: if the
+	 normalised demands moved by less than this (L1 distance) since the
+	 last calculation the previous paths are kept. Default is 0.01
+	 */
+	double exit_e;
+	
 	void update_paths();
 	
 	/**@brief time between end of one max-flow calculation and
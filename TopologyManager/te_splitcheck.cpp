@@ -0,0 +1,96 @@
+/*
+ * This file is part of Blackadder.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+/*
+ * Path split check for the TE FID selection: fills a te_mf_demandMap with
+ * demands of random path sets and split probabilities (each path with its
+ * own FID), requests FIDs with get_fid and checks that after every request
+ * each path was used within fewer picks than there are paths of n * prob,
+ * and that get_realized_probs reports the split of the FIDs returned.
+ *
+ * Usage: te_splitcheck [demands] [requests]
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include "te_graph_mf.hpp"
+
+int main(int argc, char* argv[]) {
+	int no_demands = 100;
+	int no_requests = 10000;
+	unsigned int wrong_split = 0, wrong_realized = 0;
+	double worst = 0;
+	if (argc > 1) {
+		no_demands = atoi(argv[1]);
+	}
+	if (argc > 2) {
+		no_requests = atoi(argv[2]);
+	}
+	srand(1);
+	te_mf_demandMap demand_map;
+	for (int d = 0; d < no_demands; d++) {
+		te_mf_demand demand;
+		unsigned int no_paths = 1 + rand() % 8;
+		double total = 0;
+		demand.source = d;
+		demand.sink = no_demands + d;
+		for (unsigned int i = 0; i < no_paths; i++) {
+			Bitvector fid(FID_LEN * 8);
+			fid[i].operator |=(true);
+			demand.paths.push_back(std::vector<Vertex>(1, i));
+			demand.fids.push_back(fid);
+			demand.probs.push_back(0.001 + (double) rand() / RAND_MAX);
+			total += demand.probs[i];
+		}
+		for (unsigned int i = 0; i < no_paths; i++) {
+			demand.probs[i] /= total;
+		}
+		demand_map.insert_demand(demand);
+	}
+	for (int d = 0; d < no_demands; d++) {
+		te_mf_demand &demand = demand_map.demand_map.find(std::pair<int, int>(d, no_demands + d))->second;
+		unsigned int no_paths = demand.probs.size();
+		std::vector<unsigned long> used(no_paths, 0);
+		for (int n = 1; n <= no_requests; n++) {
+			Bitvector &fid = demand_map.get_fid(d, no_demands + d);
+			for (unsigned int i = 0; i < no_paths; i++) {
+				if (fid == demand.fids[i]) {
+					used[i]++;
+				}
+			}
+			for (unsigned int i = 0; i < no_paths; i++) {
+				double deviation = fabs(used[i] - n * demand.probs[i]);
+				worst = deviation > worst ? deviation : worst;
+				if (deviation >= no_paths && no_paths > 1) {
+					wrong_split++;
+				}
+			}
+		}
+		std::vector<double> realized = demand_map.get_realized_probs(d, no_demands + d);
+		if (realized.size() != no_paths) {
+			wrong_realized++;
+			continue;
+		}
+		for (unsigned int i = 0; i < no_paths; i++) {
+			if (fabs(realized[i] - (double) used[i] / no_requests) > 1e-12) {
+				wrong_realized++;
+			}
+		}
+	}
+	fprintf(stderr, "%d demands, %d requests each: worst deviation from the requested split %.3f picks, %u splits off, %u realized splits wrong\n",
+			no_demands, no_requests, worst, wrong_split, wrong_realized);
+	return (wrong_split == 0 && wrong_realized == 0) ? 0 : 1;
+}
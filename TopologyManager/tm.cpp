@@ -18,7 +18,10 @@
 #include <unistd.h>
 #include <signal.h>
 #include <arpa/inet.h>
+#include <pthread.h>
 #include <set>
+#include <queue>
+#include <vector>
 #include <blackadder.hpp>
 #include "tm_graph.hpp"
 #include "tm_igraph.hpp"
@@ -51,6 +54,24 @@ pthread_t _event_listener, *event_listener = NULL;
 pthread_t _moly_event_listener, *moly_event_listener = NULL;
 sig_atomic_t listening = 1;
 
+/**@brief a queue of path requests served by a single path computation worker
+ */
+struct PathRequestQueue {
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    std::queue<Event *> events;
+};
+/**@brief the number of path computation workers, set with -w (default: number of online CPUs).
+ * Workers call igraph concurrently, which requires an igraph built with thread-local storage (--enable-tls, see IGRAPH_TLS in igraph_version.hpp).
+ * With any other igraph a single worker is started, so that graph_lock serialises all igraph calls of the path requests and topology updates.
+ */
+unsigned int no_workers = 0;
+std::vector<PathRequestQueue *> workers;
+/**@brief path computations hold this lock for reading, topology updates (LSN/LSM) hold it for writing
+ */
+pthread_rwlock_t graph_lock = PTHREAD_RWLOCK_INITIALIZER;
+
 std::string req_id = string(PURSUIT_ID_LEN*2-1, 'F') + "E"; // "FF..FFFFFFFFFFFFFE"
 std::string req_prefix_id = string();
 std::string req_bin_id = hex_to_chararray(req_id);
@@ -194,7 +215,6 @@ void handleMulticastPathRequest(char *request, int request_len) {
             // Get the priority
             int prio = DEFAULT_QOS_PRIO;
             // Try to avoid messing with the cache while quering
-            // IT IS NOT THREAD-SAFE!
             if (!added)
             prio = metaCache.getIIQoSPrio(ids_str, ba);
             
@@ -203,7 +223,14 @@ void handleMulticastPathRequest(char *request, int request_len) {
             uint16_t netprio = tm_igraph->getWeightKeyForIIPrio(prio);
             cout<<"TM: QoS: II Priority: "<<prio;
             cout<<"Mappend on NET Priority Class: "<<netprio<<endl;
-            tm_igraph->calculateFID_weighted(publishers, subscribers, result, pathvectors, &tm_igraph->qlwm[netprio]);
+            /*find, not operator[]: requests only hold graph_lock for reading and must not insert a plane*/
+            QoSLinkWeightMap::iterator plane = tm_igraph->qlwm.find(netprio);
+            if (plane != tm_igraph->qlwm.end()) {
+                tm_igraph->calculateFID_weighted(publishers, subscribers, result, pathvectors, &plane->second);
+            } else {
+                cout << "TM: QoS: no weight plane for NET Priority Class " << netprio << ", unweighted paths" << endl;
+                tm_igraph->calculateFID(publishers, subscribers, result, pathvectors);
+            }
         }
         
         else{
@@ -508,25 +535,71 @@ void handleUnicastPathRequest (char *request, int request_len)
     }
     cout << "---------------- EoR *-over-ICN  --------------------\n" << endl;
 }
+/**@brief recomputes the TM_to_nodeFID, RVFID and TMFID of the nodes whose tree paths crossed a failed link and
+ * publishes the RVFIDs and TMFIDs that changed.
+ *
+ * updateGraph has already repaired the TM/RV shortest path trees and left these nodes in rerouted_nodes. The FIDs
+ * of all other nodes did not use the failed link and stay as they are.
+ */
+void updateReroutedFIDs() {
+    unsigned char response_type;
+    int response_size = sizeof(response_type) + FID_LEN;
+    char * response = (char *) malloc (response_size);
+    string nodeID;
+    string response_id;
+    Bitvector AllzeroFID (FID_LEN * 8);
+    Bitvector * update_FID;
+    set<string>::iterator node_it;
+    for (node_it = tm_igraph->getReroutedNodes().begin(); node_it != tm_igraph->getReroutedNodes().end(); node_it++) {
+        nodeID = *node_it;
+        update_FID = tm_igraph->calculateFID(tm_igraph->getNodeID(), nodeID);
+        tm_igraph->setTM_to_nodeFID(nodeID, update_FID);
+        delete update_FID;
+        if ((*(tm_igraph->getTM_to_nodeFID(nodeID))).zero()) {
+            /*no TM_to_nodeFID is found, so the node is disconnected and no RVFID or TMFID will be found either*/
+            cout << "TM: Node: " << nodeID << " is now isolated" << endl;
+            tm_igraph->setRVFID(nodeID, &AllzeroFID);
+            tm_igraph->setTMFID(nodeID, &AllzeroFID);
+            continue;
+        }
+        response_id = resp_bin_prefix_id + nodeID;
+        update_FID = tm_igraph->calculateFID(nodeID, tm_igraph->getRVNodeID());
+        if (!(*update_FID == *(tm_igraph->getRVFID(nodeID)))) {
+            /*RVFID is affected, send the updated RVFID*/
+            tm_igraph->setRVFID(nodeID, update_FID);
+            response_type = UPDATE_RVFID;
+            memcpy(response, &response_type, sizeof (response_type));
+            memcpy(response + sizeof (response_type), (char *)update_FID->_data, FID_LEN);
+            ba->publish_data(response_id, IMPLICIT_RENDEZVOUS, (char *) tm_igraph->getTM_to_nodeFID(nodeID)->_data, FID_LEN, response, response_size);
+        }
+        delete update_FID;
+        update_FID = tm_igraph->calculateFID(nodeID, tm_igraph->getNodeID());
+        if (!(*update_FID == *(tm_igraph->getTMFID(nodeID)))) {
+            /*TMFID is affected, send the updated TMFID*/
+            tm_igraph->setTMFID(nodeID, update_FID);
+            response_type = UPDATE_TMFID;
+            memcpy(response, &response_type, sizeof (response_type));
+            memcpy(response + sizeof (response_type), (char *)update_FID->_data, FID_LEN);
+            ba->publish_data(response_id, IMPLICIT_RENDEZVOUS, (char *) tm_igraph->getTM_to_nodeFID(nodeID)->_data, FID_LEN, response, response_size);
+        }
+        delete update_FID;
+    }
+    cout << "TM: " << tm_igraph->getReroutedNodes().size() << " nodes rerouted" << endl;
+    free(response);
+}
 void handleLinkStateNotificationPM(char *request, int request_len, const string &request_publisher) {
     cout<<"---------------- LSN REQUEST--------------------"<<endl;
     bool update = false;
     bool remove = false;
-    bool match = false;
     bool bidirectional = false;
     unsigned int no_affectedLIDs;
     unsigned int no_nodes = tm_igraph->reverse_node_index.size();
     unsigned int offset = 0;
-    unsigned char response_type;
     unsigned char lsn_type;
     unsigned char net_type;
     map<ICNEdge, Bitvector *> freedLIDs;
     map<ICNEdge, Bitvector *>::iterator lid_it;
     map<string, Bitvector *>::iterator return_fid_it;
-    Bitvector AND_CMP (FID_LEN * 8);
-    Bitvector * AllzeroFID = new Bitvector(FID_LEN * 8);
-    Bitvector * update_TM_to_nodeFID = new Bitvector(FID_LEN * 8);
-    Bitvector * update_RVTMFID = new Bitvector(FID_LEN * 8);
     Bitvector * TM_to_all_FID = new Bitvector(FID_LEN * 8);
     /*parse the control message feilds*/
     memcpy(&lsn_type, request, sizeof(lsn_type));
@@ -540,73 +613,24 @@ void handleLinkStateNotificationPM(char *request, int request_len, const string
     bidirectional = (bool)net_type;
     update = tm_igraph->updateGraph(affected_node, request_publisher, bidirectional, remove);
     if (update) {
-        string response_id;
         if(remove){
             cout << "TM: Link Failure: " << request_publisher << " - " << affected_node << endl;
-            int response_size = sizeof(response_type) + FID_LEN;
-            char * response = (char *) malloc (response_size);
             freedLIDs = tm_igraph->getFreedLIDs();
             no_affectedLIDs = freedLIDs.size();
+            /*only the nodes whose RV/TM tree paths crossed the failed link get new FIDs*/
+            updateReroutedFIDs();
             return_fid_it = tm_igraph->TM_to_nodeFID.begin();
             for (unsigned int i = 0; i < no_nodes; i++) {
-                /*check all LIDs for the TM->Node direction before checking the Node->RV/TM direction, because otherwise a break on both directions will not be correctly detected*/
-                lid_it = freedLIDs.begin();
-                for (unsigned int j = 0; j < no_affectedLIDs; j++) {
-                    nodeID = (*return_fid_it).first;
-                    AND_CMP = *(lid_it->second) & *((*return_fid_it).second);
-                    match = (AND_CMP == *(lid_it->second));
-                    if(match){
-                        /*TM-to-node FID is affected*/
-                        update_TM_to_nodeFID = tm_igraph->calculateFID(tm_igraph->getNodeID(), nodeID);
-                        /*update the TM_to_nodeFID state */
-                        tm_igraph->setTM_to_nodeFID(nodeID, update_TM_to_nodeFID);
-                    }
+                nodeID = (*return_fid_it).first;
+                if (uc_notification && !(*(*return_fid_it).second).zero()) {
                     /*publish affected LIDs in unicast mode to individual nodes instead of broadcast*/
-                    if(uc_notification){
-//                        cout << "TM: publish affected LIDs to node: " << nodeID << endl;
-                        ba->publish_data(pathMgmt_bin_full_id, IMPLICIT_RENDEZVOUS, (char *)tm_igraph->getTM_to_nodeFID(nodeID)->_data, FID_LEN, (lid_it->second)->_data, FID_LEN);
-                    }
-                    lid_it++;
-                }
-                /*Now, check all the LIDs for the Node->RV/TM direction - having a working TM_to_nodeFID*/
-                if (!(*(tm_igraph->getTM_to_nodeFID(nodeID))).zero()) {
-                    /*The node still reachable with new FID, so check if RV/TM FIDs are affected*/
                     lid_it = freedLIDs.begin();
                     for (unsigned int j = 0; j < no_affectedLIDs; j++) {
-                        AND_CMP = *(lid_it->second) & *(tm_igraph->getRVFID(nodeID));
-                        if (AND_CMP == *(lid_it->second)) {
-                            /*RVFID is affected, calculate and send an updated RVFID*/
-                            update_RVTMFID = tm_igraph->calculateFID(nodeID, tm_igraph->getRVNodeID());
-                            /*update the RVFID state*/
-                            tm_igraph->setRVFID(nodeID, update_RVTMFID);
-                            response_type = UPDATE_RVFID;
-                            memcpy(response, &response_type, sizeof (response_type));
-                            memcpy(response + sizeof (response_type), (char *)update_RVTMFID->_data, FID_LEN);
-                            response_id = resp_bin_prefix_id + nodeID;
-                            ba->publish_data(response_id, IMPLICIT_RENDEZVOUS, (char *) tm_igraph->getTM_to_nodeFID(nodeID)->_data, FID_LEN, response, response_size);
-                        }
-                        AND_CMP = *(lid_it->second) & *tm_igraph->getTMFID(nodeID);
-                        if (AND_CMP == *(lid_it->second)) {
-                            /*TMFID is affected, calculate and send an updated TMFID*/
-                            update_RVTMFID = tm_igraph->calculateFID(nodeID, tm_igraph->getNodeID());
-                            /*update the TMFID state*/
-                            tm_igraph->setTMFID(nodeID, update_RVTMFID);
-                            response_type = UPDATE_TMFID;
-                            memcpy(response, &response_type, sizeof (response_type));
-                            memcpy(response + sizeof (response_type), (char *)update_RVTMFID->_data, FID_LEN);
-                            response_id = resp_bin_prefix_id + nodeID;
-                            ba->publish_data(response_id, IMPLICIT_RENDEZVOUS, (char *) tm_igraph->getTM_to_nodeFID(nodeID)->_data, FID_LEN, response, response_size);
-                        }
+                        ba->publish_data(pathMgmt_bin_full_id, IMPLICIT_RENDEZVOUS, (char *)(*return_fid_it).second->_data, FID_LEN, (lid_it->second)->_data, FID_LEN);
                         lid_it++;
                     }
                 }
-                else {
-                    /*no TM_to_nodeFID is found, so it is safe to assume that the node is disconnected and therefore no RVFID or TMFID will be found either*/
-                    cout << "TM: Node: " << nodeID << " is now isolated" << endl;
-                    tm_igraph->setRVFID(nodeID, AllzeroFID);
-                    tm_igraph->setTMFID(nodeID, AllzeroFID);
-                }
-                *TM_to_all_FID = *TM_to_all_FID | *(tm_igraph->TM_to_nodeFID[nodeID]);
+                *TM_to_all_FID = *TM_to_all_FID | *((*return_fid_it).second);
                 return_fid_it++;
             }
             lid_it = freedLIDs.begin();
@@ -618,52 +642,16 @@ void handleLinkStateNotificationPM(char *request, int request_len, const string
                     lid_it++;
                 }
             }
-            free(response);
         }
         else {
-            /*either a new link is being added or a broken link is restored, in either case check if there are any unreachable nodes*/
+            /*either a new link is being added or a broken link is restored, in either case disconnected nodes may be reachable again and other paths may be shorter*/
             cout << "TM: Link Restoration: " << request_publisher << " - " << affected_node << endl;
-            int response_size = sizeof(response_type) + FID_LEN;
-            char * response = (char *) malloc (response_size);
-            return_fid_it = tm_igraph->TM_to_nodeFID.begin();
-            for (unsigned int j = 0; j < no_nodes; j++) {
-                nodeID = (*return_fid_it).first;
-                if((*(*return_fid_it).second).zero()){
-                    /*the node was disconnected, calculate a new TM_to_nodeFID*/
-                    update_TM_to_nodeFID = tm_igraph->calculateFID(tm_igraph->getNodeID(), nodeID);
-                    if (!(*update_TM_to_nodeFID).zero()) {
-                        cout << "TM: node " << nodeID << " reconnected to ICN, will provide it with RV/TM FIDs" << endl;
-                        /*there is now a path to the node, update the TM_to_nodeFID*/
-                        tm_igraph->setTM_to_nodeFID(nodeID, update_TM_to_nodeFID);
-                        /*calculate and send the new RVFID*/
-                        update_RVTMFID = tm_igraph->calculateFID(nodeID, tm_igraph->getRVNodeID());
-                        tm_igraph->setRVFID(nodeID, update_RVTMFID);
-                        response_type = UPDATE_RVFID;
-                        memcpy(response, &response_type, sizeof (response_type));
-                        memcpy(response + sizeof (response_type), (char *)update_RVTMFID->_data, FID_LEN);
-                        response_id = resp_bin_prefix_id + nodeID;
-                        ba->publish_data(response_id, IMPLICIT_RENDEZVOUS, (char *) tm_igraph->getTM_to_nodeFID(nodeID)->_data, FID_LEN, response, response_size);
-                        /*calculate and send the new TMFID*/
-                        update_RVTMFID = tm_igraph->calculateFID(nodeID, tm_igraph->getNodeID());
-                        tm_igraph->setTMFID(nodeID, update_RVTMFID);
-                        response_type = UPDATE_TMFID;
-                        memcpy(response, &response_type, sizeof (response_type));
-                        memcpy(response + sizeof (response_type), (char *)update_RVTMFID->_data, FID_LEN);
-                        response_id = resp_bin_prefix_id + nodeID;
-                        ba->publish_data(response_id, IMPLICIT_RENDEZVOUS, (char *) tm_igraph->getTM_to_nodeFID(nodeID)->_data, FID_LEN, response, response_size);
-                    }
-                }
-                return_fid_it++;
-            }
-            free(response);
+            updateReroutedFIDs();
         }
     }
     else {
         cout << "TM: no update to be published" << endl;
     }
-    delete AllzeroFID;
-    delete update_TM_to_nodeFID;
-    delete update_RVTMFID;
     delete TM_to_all_FID;
     cout<<"---------------- EoR --------------------"<<endl;
 }
@@ -671,163 +659,53 @@ void handleLinkStateNotificationRM(char *request, int request_len, const string
     cout<<"---------------- LSN REQUEST--------------------"<<endl;
     bool update = false;
     bool remove = false;
-    bool match = false;
     bool bidirectional = false;
-    unsigned int no_affectedLIDs;
-    unsigned int no_nodes = tm_igraph->reverse_node_index.size();
     unsigned int offset = 0;
-    unsigned char response_type;
     unsigned char rm_request_type;
     unsigned char lsn_type;
     unsigned char net_type;
-    map<ICNEdge, Bitvector *> freedLIDs;
-    map<ICNEdge, Bitvector *>::iterator lid_it;
-    map<string, Bitvector *>::iterator return_fid_it;
-    Bitvector AND_CMP (FID_LEN * 8);
-    Bitvector * AllzeroFID = new Bitvector(FID_LEN * 8);
-    Bitvector * update_TM_to_nodeFID = new Bitvector(FID_LEN * 8);
-    Bitvector * update_RVTMFID = new Bitvector(FID_LEN * 8);
-    Bitvector * TM_to_all_FID = new Bitvector(FID_LEN * 8);
     /*parse the control message feilds*/
     memcpy(&lsn_type, request, sizeof(lsn_type));
     offset += sizeof(lsn_type);
     memcpy(&net_type, request + offset, sizeof(net_type));
     offset += sizeof(net_type);
-    string nodeID;
     string affected_node = string(request, offset, NODEID_LEN);
     remove = (lsn_type == REMOVE_LINK);
     bidirectional = (bool) net_type;
     update = tm_igraph->updateGraph(affected_node, request_publisher, bidirectional, remove);
     if (update) {
-        string response_id;
         string rm_request_id;
         if(remove){
             cout << "TM: Link Failure: " << request_publisher << " - " << affected_node << endl;
-            /*check the TM FIDs state and update affected FIDs, if any*/
-            int response_size = sizeof(response_type) + FID_LEN;
-            char * response = (char *) malloc (response_size);
-            freedLIDs = tm_igraph->getFreedLIDs();
-            no_affectedLIDs = freedLIDs.size();
-            return_fid_it = tm_igraph->TM_to_nodeFID.begin();
-            for (unsigned int i = 0; i < no_nodes; i++) {
-                /*check all LIDs for the TM->Node direction before checking the Node->RV/TM direction, because otherwise a break on both directions will not be correctly detected*/
-                lid_it = freedLIDs.begin();
-                for (unsigned int j = 0; j < no_affectedLIDs; j++) {
-                    nodeID = (*return_fid_it).first;
-                    AND_CMP = *(lid_it->second) & *((*return_fid_it).second);
-                    match = (AND_CMP == *(lid_it->second));
-                    if(match){
-                        /*TM-to-node FID is affected*/
-                        update_TM_to_nodeFID = tm_igraph->calculateFID(tm_igraph->getNodeID(), nodeID);
-                        /*update the TM_to_nodeFID state */
-                        tm_igraph->setTM_to_nodeFID(nodeID, update_TM_to_nodeFID);
-                    }
-                    lid_it++;
-                }
-                /*Now, check all the LIDs for the Node->RV/TM direction - having a working TM_to_nodeFID*/
-                if (!(*(tm_igraph->getTM_to_nodeFID(nodeID))).zero()) {
-                    /*The node still reachable with new FID, so check if RV/TM FIDs are affected*/
-                    lid_it = freedLIDs.begin();
-                    for (unsigned int j = 0; j < no_affectedLIDs; j++) {
-                        AND_CMP = *(lid_it->second) & *(tm_igraph->getRVFID(nodeID));
-                        if (AND_CMP == *(lid_it->second)) {
-                            /*RVFID is affected, calculate and send an updated RVFID*/
-                            update_RVTMFID = tm_igraph->calculateFID(nodeID, tm_igraph->getRVNodeID());
-                            /*update the RVFID state*/
-                            tm_igraph->setRVFID(nodeID, update_RVTMFID);
-                            response_type = UPDATE_RVFID;
-                            memcpy(response, &response_type, sizeof (response_type));
-                            memcpy(response + sizeof (response_type), (char *)update_RVTMFID->_data, FID_LEN);
-                            response_id = resp_bin_prefix_id + nodeID;
-                            ba->publish_data(response_id, IMPLICIT_RENDEZVOUS, (char *) tm_igraph->getTM_to_nodeFID(nodeID)->_data, FID_LEN, response, response_size);
-                        }
-                        AND_CMP = *(lid_it->second) & *tm_igraph->getTMFID(nodeID);
-                        if (AND_CMP == *(lid_it->second)) {
-                            /*TMFID is affected, calculate and send an updated TMFID*/
-                            update_RVTMFID = tm_igraph->calculateFID(nodeID, tm_igraph->getNodeID());
-                            /*update the TMFID state*/
-                            tm_igraph->setTMFID(nodeID, update_RVTMFID);
-                            response_type = UPDATE_TMFID;
-                            memcpy(response, &response_type, sizeof (response_type));
-                            memcpy(response + sizeof (response_type), (char *)update_RVTMFID->_data, FID_LEN);
-                            response_id = resp_bin_prefix_id + nodeID;
-                            ba->publish_data(response_id, IMPLICIT_RENDEZVOUS, (char *) tm_igraph->getTM_to_nodeFID(nodeID)->_data, FID_LEN, response, response_size);
-                        }
-                        lid_it++;
-                    }
-                }
-                else {
-                    /*no TM_to_nodeFID is found, so it is safe to assume that the node is disconnected and therefore no RVFID or TMFID will be found either*/
-                    cout << "TM: Node: " << nodeID << " is now isolated" << endl;
-                    tm_igraph->setRVFID(nodeID, AllzeroFID);
-                    tm_igraph->setTMFID(nodeID, AllzeroFID);
-                }
-                *TM_to_all_FID = *TM_to_all_FID | *(tm_igraph->TM_to_nodeFID[nodeID]);
-                return_fid_it++;
-            }
             /*request RM Assistance to discover failed information delivery*/
-            offset = 0;
             rm_request_type = DISCOVER_FAILURE;
-            int rm_request_size = sizeof(rm_request_type) + sizeof(net_type) + NODEID_LEN /*request_publisher*/ + NODEID_LEN /*affected_node*/;
-            char * rm_request = (char *) malloc (rm_request_size);
-            memcpy(rm_request, &rm_request_type, sizeof(rm_request_type));
-            offset += sizeof (rm_request_type);
-            memcpy(rm_request + offset , &net_type, sizeof (net_type));
-            offset += sizeof (net_type);
-            memcpy(rm_request + offset, (char*)request_publisher.c_str() , NODEID_LEN);
-            offset += NODEID_LEN;
-            memcpy(rm_request + offset, (char*)affected_node.c_str(), NODEID_LEN);
-            offset += NODEID_LEN;
-            rm_request_id = DiscoverFailureId + tm_igraph->getRMNodeID();
-            ba->publish_data(rm_request_id, IMPLICIT_RENDEZVOUS, (char *) tm_igraph->getTM_to_nodeFID(tm_igraph->RMnodeID)->_data, FID_LEN, rm_request, rm_request_size);
-            free(rm_request);
-            free(response);
         }
         else {
-            /*either a new link is being added or a broken link is restored, in either case check if there are any unreachable nodes*/
+            /*either a new link is being added or a broken link is restored, in either case disconnected nodes may be reachable again and other paths may be shorter*/
             cout << "TM: Link Restoration: " << request_publisher << " - " << affected_node << endl;
-            int response_size = sizeof(response_type) + FID_LEN;
-            char * response = (char *) malloc (response_size);
-            return_fid_it = tm_igraph->TM_to_nodeFID.begin();
-            for (unsigned int j = 0; j < no_nodes; j++) {
-                nodeID = (*return_fid_it).first;
-                if((*(*return_fid_it).second).zero()){
-                    /*the node was disconnected, calculate a new TM_to_nodeFID*/
-                    update_TM_to_nodeFID = tm_igraph->calculateFID(tm_igraph->getNodeID(), nodeID);
-                    if (!(*update_TM_to_nodeFID).zero()) {
-                        cout << "TM: node " << nodeID << " reconnected to ICN, will provide it with RV/TM FIDs" << endl;
-                        /*there is now a path to the node, update the TM_to_nodeFID*/
-                        tm_igraph->setTM_to_nodeFID(nodeID, update_TM_to_nodeFID);
-                        /*calculate and send the new RVFID*/
-                        update_RVTMFID = tm_igraph->calculateFID(nodeID, tm_igraph->getRVNodeID());
-                        tm_igraph->setRVFID(nodeID, update_RVTMFID);
-                        response_type = UPDATE_RVFID;
-                        memcpy(response, &response_type, sizeof (response_type));
-                        memcpy(response + sizeof (response_type), (char *)update_RVTMFID->_data, FID_LEN);
-                        response_id = resp_bin_prefix_id + nodeID;
-                        ba->publish_data(response_id, IMPLICIT_RENDEZVOUS, (char *) tm_igraph->getTM_to_nodeFID(nodeID)->_data, FID_LEN, response, response_size);
-                        /*calculate and send the new TMFID*/
-                        update_RVTMFID = tm_igraph->calculateFID(nodeID, tm_igraph->getNodeID());
-                        tm_igraph->setTMFID(nodeID, update_RVTMFID);
-                        response_type = UPDATE_TMFID;
-                        memcpy(response, &response_type, sizeof (response_type));
-                        memcpy(response + sizeof (response_type), (char *)update_RVTMFID->_data, FID_LEN);
-                        response_id = resp_bin_prefix_id + nodeID;
-                        ba->publish_data(response_id, IMPLICIT_RENDEZVOUS, (char *) tm_igraph->getTM_to_nodeFID(nodeID)->_data, FID_LEN, response, response_size);
-                    }
-                }
-                return_fid_it++;
-            }
-            free(response);
+            /*the RM follows the restoration in its own topology*/
+            rm_request_type = DISCOVER_RECOVERY;
         }
+        /*only the nodes whose RV/TM tree paths crossed the changed link get new FIDs*/
+        updateReroutedFIDs();
+        offset = 0;
+        int rm_request_size = sizeof(rm_request_type) + sizeof(net_type) + NODEID_LEN /*request_publisher*/ + NODEID_LEN /*affected_node*/;
+        char * rm_request = (char *) malloc (rm_request_size);
+        memcpy(rm_request, &rm_request_type, sizeof(rm_request_type));
+        offset += sizeof (rm_request_type);
+        memcpy(rm_request + offset , &net_type, sizeof (net_type));
+        offset += sizeof (net_type);
+        memcpy(rm_request + offset, (char*)request_publisher.c_str() , NODEID_LEN);
+        offset += NODEID_LEN;
+        memcpy(rm_request + offset, (char*)affected_node.c_str(), NODEID_LEN);
+        offset += NODEID_LEN;
+        rm_request_id = DiscoverFailureId + tm_igraph->getRMNodeID();
+        ba->publish_data(rm_request_id, IMPLICIT_RENDEZVOUS, (char *) tm_igraph->getTM_to_nodeFID(tm_igraph->RMnodeID)->_data, FID_LEN, rm_request, rm_request_size);
+        free(rm_request);
     }
     else {
         cout << "TM: no update to be published" << endl;
     }
-    delete AllzeroFID;
-    delete update_TM_to_nodeFID;
-    delete update_RVTMFID;
-    delete TM_to_all_FID;
     cout<<"---------------- EoR --------------------"<<endl;
     
 }
@@ -843,47 +721,197 @@ void handleLSMUpdate(uint8_t * data, int data_len, const string & request_pub){
     // cout<<(tm_igraph->qlwm)<<endl;
 }
 
+/**@brief path computation worker: serves the path requests hashed onto its queue.
+ * Requests only read the topology, so all workers run concurrently while holding graph_lock for reading (on a thread-safe igraph, see no_workers).
+ */
+void *path_worker_loop(void *arg) {
+    PathRequestQueue *queue = (PathRequestQueue *) arg;
+    string prefix_id;
+    /*the attribute table is thread-local in a thread-safe igraph*/
+    igraph_i_set_attribute_table(&igraph_cattribute_table);
+    while (true) {
+        pthread_mutex_lock(&queue->mutex);
+        while (queue->events.empty()) {
+            pthread_cond_wait(&queue->cond, &queue->mutex);
+        }
+        Event *ev = queue->events.front();
+        queue->events.pop();
+        pthread_mutex_unlock(&queue->mutex);
+        /*a NULL event is the signal to exit*/
+        if (ev == NULL) {
+            return NULL;
+        }
+        prefix_id = ev->id.substr(0, ev->id.length() - PURSUIT_ID_LEN);
+        pthread_rwlock_rdlock(&graph_lock);
+        if ((prefix_id == UnicastDeliveryId) || (prefix_id == RecoverUnicastDeliveryId)) {
+            cout << "TM: request for unicast path" << endl;
+            __sync_fetch_and_add(&start, 1);
+            handleUnicastPathRequest((char*) ev->data, ev->data_len);
+        }
+        else {
+            cout << "TM: id: " << chararray_to_hex(ev->id) << endl;
+            handleMulticastPathRequest((char *) ev->data, ev->data_len);
+        }
+        pthread_rwlock_unlock(&graph_lock);
+        delete ev;
+    }
+    return NULL;
+}
+/**@brief the identifier of the information item a path request is about, as its handler reads it:
+ * the first ID after the publishers and subscribers of MATCH_PUB_SUBS and UPDATE_FID, after the subscribers of SCOPE_PUBLISHED and SCOPE_UNPUBLISHED, and the ID of QoS_METADATA.
+ * The layout is the same for multicast and unicast (*-over-ICN) requests.
+ * @return false if the request is too short for its type or of an unknown type
+ */
+bool requestItemID(const char *request, unsigned int request_len, string &id) {
+    unsigned int offset = 2 * sizeof (unsigned char); /*request type and strategy*/
+    unsigned char count;
+    if (request_len < offset) {
+        return false;
+    }
+    switch ((unsigned char) request[0]) {
+        case QoS_METADATA:
+            /*request type, ID length in fragments, ID*/
+            offset = sizeof (unsigned char);
+            break;
+        case MATCH_PUB_SUBS:
+        case UPDATE_FID:
+            /*the publishers*/
+            count = request[offset];
+            offset += sizeof (count) + count * PURSUIT_ID_LEN;
+            if (request_len < offset) {
+                return false;
+            }
+            /*fall through: the subscribers and the IDs*/
+        case SCOPE_PUBLISHED:
+        case SCOPE_UNPUBLISHED:
+            if (request_len < offset + sizeof (count)) {
+                return false;
+            }
+            count = request[offset];
+            /*the subscribers and the number of IDs*/
+            offset += sizeof (count) + count * PURSUIT_ID_LEN + sizeof (count);
+            break;
+        default:
+            return false;
+    }
+    if (request_len < offset + sizeof (count)) {
+        return false;
+    }
+    count = request[offset];
+    offset += sizeof (count);
+    if (request_len < offset + count * PURSUIT_ID_LEN) {
+        return false;
+    }
+    id.assign(request + offset, count * PURSUIT_ID_LEN);
+    return true;
+}
+/**@brief hand a path request over to a worker.
+ * Requests are hashed on the identifier of their information item (see requestItemID), so requests for the same item are served by the same worker, and therefore in order.
+ * Requests that cannot be parsed are hashed as a whole.
+ */
+void dispatchPathRequest(Event *ev) {
+    string id;
+    Fnv64_t hash;
+    if (requestItemID((const char *) ev->data, ev->data_len, id)) {
+        hash = fnv1a_64((const unsigned char *) id.data(), id.length());
+    } else {
+        hash = fnv1a_64((unsigned char *) ev->data, ev->data_len);
+    }
+    PathRequestQueue *queue = workers[hash % workers.size()];
+    pthread_mutex_lock(&queue->mutex);
+    queue->events.push(ev);
+    pthread_cond_signal(&queue->cond);
+    pthread_mutex_unlock(&queue->mutex);
+}
+void startPathWorkers() {
+    if (no_workers == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        no_workers = (cpus > 0) ? (unsigned int) cpus : 1;
+    }
+#if !IGRAPH_TLS
+    if (no_workers > 1) {
+        cout << "TM: igraph is not built with thread-local storage (--enable-tls), a single path computation worker is used" << endl;
+        no_workers = 1;
+    }
+#endif
+    cout << "TM: starting " << no_workers << " path computation workers" << endl;
+    for (unsigned int i = 0; i < no_workers; i++) {
+        PathRequestQueue *queue = new PathRequestQueue();
+        pthread_mutex_init(&queue->mutex, NULL);
+        pthread_cond_init(&queue->cond, NULL);
+        pthread_create(&queue->thread, NULL, path_worker_loop, (void *) queue);
+        workers.push_back(queue);
+    }
+}
+void stopPathWorkers() {
+    for (unsigned int i = 0; i < workers.size(); i++) {
+        PathRequestQueue *queue = workers[i];
+        pthread_mutex_lock(&queue->mutex);
+        queue->events.push(NULL);
+        pthread_cond_signal(&queue->cond);
+        pthread_mutex_unlock(&queue->mutex);
+        pthread_join(queue->thread, NULL);
+        while (!queue->events.empty()) {
+            delete queue->events.front();
+            queue->events.pop();
+        }
+        pthread_mutex_destroy(&queue->mutex);
+        pthread_cond_destroy(&queue->cond);
+        delete queue;
+    }
+    workers.clear();
+}
+
 /*\TODO: introduce a function dispatcher based on type and prefixID, to clean up the mess of the event_listner_loop. accordingly also clean up the handling functions above*/
+/**@brief the listener only receives events: topology updates are applied here under the write lock, path requests are handed to the workers
+ */
 void *event_listener_loop(void *arg) {
     Blackadder *ba = (Blackadder *) arg;
     string prefix_id;
     string publisher;
+    /*the attribute table is thread-local in a thread-safe igraph*/
+    igraph_i_set_attribute_table(&igraph_cattribute_table);
     while (listening) {
-        Event ev;
-        ba->getEvent(ev);
-        if (ev.type == UNDEF_EVENT) {
+        Event *ev = new Event();
+        ba->getEvent(*ev);
+        if (ev->type == UNDEF_EVENT) {
             if (!listening)
             cout << "TM: final event" << endl;
+            delete ev;
             return NULL;
-        } else if (ev.type == PUBLISHED_DATA) {
-            publisher = ev.id.substr(ev.id.length() - PURSUIT_ID_LEN, PURSUIT_ID_LEN);
-            prefix_id = ev.id.substr(0, ev.id.length() - PURSUIT_ID_LEN);
+        } else if (ev->type == PUBLISHED_DATA) {
+            publisher = ev->id.substr(ev->id.length() - PURSUIT_ID_LEN, PURSUIT_ID_LEN);
+            prefix_id = ev->id.substr(0, ev->id.length() - PURSUIT_ID_LEN);
             if ((prefix_id == lsn_bin_id) && (tm_igraph->getExten(PM))){
                 /*Path Management*/
                 cout << "TM: handle network change through path management" << endl;
-                handleLinkStateNotificationPM((char *) ev.data, ev.data_len, publisher);
+                pthread_rwlock_wrlock(&graph_lock);
+                handleLinkStateNotificationPM((char *) ev->data, ev->data_len, publisher);
+                pthread_rwlock_unlock(&graph_lock);
+                delete ev;
             }
             else if ((prefix_id == lsn_bin_id) && (tm_igraph->getExten(RS))) {
                 /*Resilience using the central RM*/
-                handleLinkStateNotificationRM((char *) ev.data, ev.data_len, publisher);
+                pthread_rwlock_wrlock(&graph_lock);
+                handleLinkStateNotificationRM((char *) ev->data, ev->data_len, publisher);
+                pthread_rwlock_unlock(&graph_lock);
+                delete ev;
             }
             else if ((prefix_id==lsm_bin_scope) && (tm_igraph->getExten(QOS))) { 	// mac_qos
                 /*Call the handler for LSM... This should update the internal link*/
                 /*status structure and the Graph's edge weight map...*/
-                handleLSMUpdate( (uint8_t *) ev.data, ev.data_len, publisher);
-            }
-            /*request for unicast path of *-over-icn*/
-            else if ((prefix_id == UnicastDeliveryId) || (prefix_id == RecoverUnicastDeliveryId)) {
-                cout << "TM: request for unicast path" << endl;
-                start++;
-                handleUnicastPathRequest((char*) ev.data, ev.data_len);
+                pthread_rwlock_wrlock(&graph_lock);
+                handleLSMUpdate( (uint8_t *) ev->data, ev->data_len, publisher);
+                pthread_rwlock_unlock(&graph_lock);
+                delete ev;
             }
             else {
-                cout << "TM: id: " << chararray_to_hex(ev.id) << endl;
-                handleMulticastPathRequest((char *) ev.data, ev.data_len);
+                /*multicast and unicast (*-over-icn) path requests*/
+                dispatchPathRequest(ev);
             }
         } else {
             cout << "TM: I am not expecting any other notification...FATAL" << endl;
+            delete ev;
         }
     }
     return NULL;
@@ -919,7 +947,7 @@ int main(int argc, char* argv[]) {
     double defaultBW=1e9;
     int index = 0;
     char c;
-    while ((c = getopt (argc, argv, "prqtdu:")) != -1){
+    while ((c = getopt (argc, argv, "prqtdu:w:")) != -1){
         switch (c)
         {
                 case 't':
@@ -950,6 +978,9 @@ int main(int argc, char* argv[]) {
                 case 'u':
                 uc_notification = (bool)atoi(optarg);
                 break;
+                case 'w':
+                no_workers = atoi(optarg);
+                break;
                 case '?':
                 if (isprint (optopt))
                 fprintf (stderr, "Unknown option `-%c'.\n", optopt);
@@ -1008,6 +1039,7 @@ int main(int argc, char* argv[]) {
         pthread_create(&_te_thread, NULL, te_loop,(void*)tm_igraph);
         te_thread = &_te_thread;
     }
+    startPathWorkers();
     pthread_create(&_event_listener, NULL, event_listener_loop, (void *) ba);
     event_listener = &_event_listener;
     ba->subscribe_scope(req_bin_id, req_bin_prefix_id, IMPLICIT_RENDEZVOUS, NULL, 0);
@@ -1023,6 +1055,7 @@ int main(int argc, char* argv[]) {
     ba->subscribe_scope(lsm_bin_scope, "", DOMAIN_LOCAL, NULL, 0);
     sleep(5);
     pthread_join(*event_listener, NULL);
+    stopPathWorkers();
     cout << "TM: disconnecting" << endl;
     ba->disconnect();
     delete ba;
@@ -0,0 +1,254 @@
+/*
+ * This file is part of Blackadder.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+#include "tm_backup.hpp"
+#include <climits>
+#include <queue>
+#include <functional>
+
+/*an arc of the graph Suurballe runs on, in node-disjoint mode every vertex v is split into v_in -> v_out*/
+struct SuurballeArc {
+	int from;
+	int to;
+	unsigned int cost;
+};
+
+/*Dijkstra over the arcs; an arc on the first path is traversed backwards with a zero cost*/
+static void suurballeDijkstra(const vector<SuurballeArc> &arcs, const vector<vector<int> > &out_arcs, const vector<vector<int> > &in_arcs,
+		const vector<bool> &on_first, int source, vector<unsigned int> &dist, vector<int> &pred) {
+	typedef pair<unsigned int, int> dist_vertex;
+	priority_queue<dist_vertex, vector<dist_vertex>, greater<dist_vertex> > heap;
+	dist.assign(out_arcs.size(), UINT_MAX);
+	/*pred holds arc + 1 for a forward arc, -(arc + 1) for a reversed one and 0 for none*/
+	pred.assign(out_arcs.size(), 0);
+	dist[source] = 0;
+	heap.push(dist_vertex(0, source));
+	while (!heap.empty()) {
+		dist_vertex top = heap.top();
+		heap.pop();
+		if (top.first != dist[top.second]) {
+			continue;
+		}
+		const vector<int> &forward = out_arcs[top.second];
+		for (unsigned int i = 0; i < forward.size(); i++) {
+			const SuurballeArc &arc = arcs[forward[i]];
+			if (!on_first[forward[i]] && top.first + arc.cost < dist[arc.to]) {
+				dist[arc.to] = top.first + arc.cost;
+				pred[arc.to] = forward[i] + 1;
+				heap.push(dist_vertex(dist[arc.to], arc.to));
+			}
+		}
+		const vector<int> &backward = in_arcs[top.second];
+		for (unsigned int i = 0; i < backward.size(); i++) {
+			const SuurballeArc &arc = arcs[backward[i]];
+			if (on_first[backward[i]] && top.first < dist[arc.from]) {
+				dist[arc.from] = top.first;
+				pred[arc.from] = -(backward[i] + 1);
+				heap.push(dist_vertex(dist[arc.from], arc.from));
+			}
+		}
+	}
+}
+
+TMBackupPaths::TMBackupPaths(TMIgraph *tm_igraph, bool node_disjoint) : _tm_igraph(tm_igraph), _node_disjoint(node_disjoint) {
+}
+
+bool TMBackupPaths::suurballe(const igraph_t *graph, int source, int destination, bool node_disjoint, vector<int> &first, vector<int> &second) {
+	unsigned int no_vertices = igraph_vcount(graph);
+	unsigned int no_edges = igraph_ecount(graph);
+	unsigned int no_split = node_disjoint ? 2 * no_vertices : no_vertices;
+	vector<SuurballeArc> arcs;
+	vector<vector<int> > out_arcs(no_split);
+	vector<vector<int> > in_arcs(no_split);
+	vector<unsigned int> dist;
+	vector<unsigned int> potential;
+	vector<int> pred;
+	igraph_integer_t from, to;
+	first.clear();
+	second.clear();
+	if (source == destination) {
+		return false;
+	}
+	/*v_in is 2v and v_out 2v + 1 when splitting, both are v otherwise*/
+	for (unsigned int e = 0; e < no_edges; e++) {
+		igraph_edge(graph, e, &from, &to);
+		SuurballeArc arc = {node_disjoint ? 2 * from + 1 : from, node_disjoint ? 2 * to : to, 1};
+		arcs.push_back(arc);
+	}
+	if (node_disjoint) {
+		for (unsigned int v = 0; v < no_vertices; v++) {
+			SuurballeArc arc = {(int) (2 * v), (int) (2 * v + 1), 0};
+			arcs.push_back(arc);
+		}
+	}
+	for (unsigned int a = 0; a < arcs.size(); a++) {
+		out_arcs[arcs[a].from].push_back(a);
+		in_arcs[arcs[a].to].push_back(a);
+	}
+	int s = node_disjoint ? 2 * source + 1 : source;
+	int t = node_disjoint ? 2 * destination : destination;
+	/*the first path is a plain shortest path*/
+	vector<bool> on_first(arcs.size(), false);
+	suurballeDijkstra(arcs, out_arcs, in_arcs, on_first, s, potential, pred);
+	if (potential[t] == UINT_MAX) {
+		return false;
+	}
+	for (int v = t; v != s; v = arcs[pred[v] - 1].from) {
+		on_first[pred[v] - 1] = true;
+	}
+	/*the second one runs over the reduced costs, in which the arcs of the first path cost nothing and are reversed*/
+	for (unsigned int a = 0; a < arcs.size(); a++) {
+		if (potential[arcs[a].from] != UINT_MAX && potential[arcs[a].to] != UINT_MAX) {
+			arcs[a].cost = arcs[a].cost + potential[arcs[a].from] - potential[arcs[a].to];
+		}
+	}
+	suurballeDijkstra(arcs, out_arcs, in_arcs, on_first, s, dist, pred);
+	if (dist[t] == UINT_MAX) {
+		return false;
+	}
+	/*the union of both paths minus the arcs traversed in opposite directions makes up the disjoint pair*/
+	vector<bool> used(on_first);
+	for (int v = t; v != s; ) {
+		if (pred[v] > 0) {
+			used[pred[v] - 1] = true;
+			v = arcs[pred[v] - 1].from;
+		} else {
+			used[-pred[v] - 1] = false;
+			v = arcs[-pred[v] - 1].to;
+		}
+	}
+	/*a link used in both directions by the two paths would go down with both, cancel it out as well*/
+	if (!node_disjoint) {
+		map<pair<int, int>, int> used_arcs;
+		for (unsigned int a = 0; a < arcs.size(); a++) {
+			if (used[a]) {
+				used_arcs[make_pair(arcs[a].from, arcs[a].to)] = a;
+			}
+		}
+		for (map<pair<int, int>, int>::iterator arc_it = used_arcs.begin(); arc_it != used_arcs.end(); arc_it++) {
+			map<pair<int, int>, int>::iterator reverse_it = used_arcs.find(make_pair((*arc_it).first.second, (*arc_it).first.first));
+			if (reverse_it != used_arcs.end() && used[(*arc_it).second] && used[(*reverse_it).second]) {
+				used[(*arc_it).second] = false;
+				used[(*reverse_it).second] = false;
+			}
+		}
+	}
+	for (int p = 0; p < 2; p++) {
+		vector<int> &path = (p == 0) ? first : second;
+		int v = s;
+		path.push_back(source);
+		while (v != t) {
+			const vector<int> &forward = out_arcs[v];
+			unsigned int i = 0;
+			while (i < forward.size() && !used[forward[i]]) {
+				i++;
+			}
+			if (i == forward.size()) {
+				first.clear();
+				second.clear();
+				return false;
+			}
+			used[forward[i]] = false;
+			v = arcs[forward[i]].to;
+			/*skip the v_in -> v_out arcs*/
+			if (!node_disjoint || v % 2 == 0) {
+				path.push_back(node_disjoint ? v / 2 : v);
+			}
+		}
+	}
+	if (second.size() < first.size()) {
+		first.swap(second);
+	}
+	return true;
+}
+
+bool TMBackupPaths::crossesLink(const vector<string> &nodes, const string &a, const string &b) {
+	for (unsigned int j = 1; j < nodes.size(); j++) {
+		if ((nodes[j - 1] == a && nodes[j] == b) || (nodes[j - 1] == b && nodes[j] == a)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void TMBackupPaths::nodeLabels(const vector<int> &vertices, vector<string> &nodes) {
+	nodes.clear();
+	for (unsigned int j = 0; j < vertices.size(); j++) {
+		nodes.push_back(string(igraph_cattribute_VAS(&_tm_igraph->graph, "NODEID", vertices[j])));
+	}
+}
+
+bool TMBackupPaths::protect(const string &path) {
+	vector<string> nodes;
+	vector<int> first, second;
+	map<string, int>::iterator source_it, destination_it;
+	TMIgraph::splitPathVector(path, nodes);
+	if (nodes.size() < 2) {
+		return false;
+	}
+	pair<string, string> end_points = make_pair(nodes.front(), nodes.back());
+	if (_pairs.find(end_points) != _pairs.end()) {
+		return true;
+	}
+	source_it = _tm_igraph->reverse_node_index.find(end_points.first);
+	destination_it = _tm_igraph->reverse_node_index.find(end_points.second);
+	if (source_it == _tm_igraph->reverse_node_index.end() || destination_it == _tm_igraph->reverse_node_index.end()) {
+		return false;
+	}
+	if (!suurballe(&_tm_igraph->graph, (*source_it).second, (*destination_it).second, _node_disjoint, first, second)) {
+		return false;
+	}
+	DisjointPair &disjoint_pair = _pairs[end_points];
+	nodeLabels(first, disjoint_pair.first);
+	nodeLabels(second, disjoint_pair.second);
+	return true;
+}
+
+bool TMBackupPaths::backup(const string &path, const string &a, const string &b, string &backup_path) {
+	vector<string> nodes;
+	map<pair<string, string>, DisjointPair>::iterator pair_it;
+	TMIgraph::splitPathVector(path, nodes);
+	if (nodes.size() < 2) {
+		return false;
+	}
+	pair_it = _pairs.find(make_pair(nodes.front(), nodes.back()));
+	if (pair_it == _pairs.end()) {
+		return false;
+	}
+	/*at most one member of a disjoint pair crosses the link, prefer the shorter one*/
+	if (!crossesLink((*pair_it).second.first, a, b)) {
+		backup_path = TMIgraph::joinPathVector((*pair_it).second.first);
+	} else if (!crossesLink((*pair_it).second.second, a, b)) {
+		backup_path = TMIgraph::joinPathVector((*pair_it).second.second);
+	} else {
+		return false;
+	}
+	return true;
+}
+
+void TMBackupPaths::linkFailed(const string &a, const string &b) {
+	map<pair<string, string>, DisjointPair>::iterator pair_it = _pairs.begin();
+	while (pair_it != _pairs.end()) {
+		if (crossesLink((*pair_it).second.first, a, b) || crossesLink((*pair_it).second.second, a, b)) {
+			_pairs.erase(pair_it++);
+		} else {
+			pair_it++;
+		}
+	}
+}
+
+unsigned int TMBackupPaths::size() const {
+	return _pairs.size();
+}
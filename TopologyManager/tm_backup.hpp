@@ -0,0 +1,90 @@
+/*
+ * This file is part of Blackadder.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+#ifndef TM_BACKUP_HH
+#define TM_BACKUP_HH
+
+#include <map>
+#include <string>
+#include <vector>
+#include <utility>
+#include "tm_igraph.hpp"
+
+using namespace std;
+
+/**@brief (Resiliency Manager) precomputed backup paths for the delivery paths the TM notifies the RM about.
+ *
+ * For the publisher and the subscriber of every delivery path, a pair of link-disjoint (or node-disjoint) paths
+ * is computed with Suurballe's algorithm. When a link of the delivery path fails, the member of the pair that
+ * does not cross the link replaces it, so rebinding the delivery is a table lookup instead of a new path request.
+ */
+class TMBackupPaths {
+public:
+	/**@brief Constructor
+	 *
+	 * @param tm_igraph the topology the pairs are computed on
+	 * @param node_disjoint compute node-disjoint instead of link-disjoint pairs
+	 */
+	TMBackupPaths(TMIgraph *tm_igraph, bool node_disjoint);
+	/**@brief computes the disjoint pair between the end points of a path vector, unless it is already known
+	 *
+	 * @param path a path vector as reported by the TM (NODEID->NODEID->...)
+	 * @return false if no disjoint pair exists between the end points
+	 */
+	bool protect(const string &path);
+	/**@brief looks up the path that replaces a delivery path after the link between a and b failed
+	 *
+	 * @param path the broken path vector
+	 * @param a the node label of one end of the failed link
+	 * @param b the node label of the other end of the failed link
+	 * @param backup_path the replacement path vector
+	 * @return false if no precomputed path avoids the link
+	 */
+	bool backup(const string &path, const string &a, const string &b, string &backup_path);
+	/**@brief forgets the pairs crossing the failed link, they are computed again by the next protect
+	 */
+	void linkFailed(const string &a, const string &b);
+	/**@brief the number of known pairs
+	 */
+	unsigned int size() const;
+	/**@brief Suurballe's algorithm with hop-count weights: two disjoint paths of minimum total length
+	 *
+	 * The links of the graph are assumed to be bidirectional, a pair never uses a link in both directions.
+	 *
+	 * @param graph the igraph graph
+	 * @param source the igraph vertex id of the source
+	 * @param destination the igraph vertex id of the destination
+	 * @param node_disjoint whether the paths may share intermediate nodes
+	 * @param first the vertices of the shorter path, source and destination included
+	 * @param second the vertices of the other path
+	 * @return false if the destination is not reachable over two disjoint paths
+	 */
+	static bool suurballe(const igraph_t *graph, int source, int destination, bool node_disjoint, vector<int> &first, vector<int> &second);
+	/**@brief whether the path vector crosses the link between a and b (in either direction)
+	 */
+	static bool crossesLink(const vector<string> &nodes, const string &a, const string &b);
+private:
+	typedef pair<vector<string>, vector<string> > DisjointPair;
+	/**@brief converts a path of igraph vertex ids to node labels
+	 */
+	void nodeLabels(const vector<int> &vertices, vector<string> &nodes);
+	TMIgraph *_tm_igraph;
+	bool _node_disjoint;
+	/**@brief the disjoint pairs indexed by publisher and subscriber node labels
+	 */
+	map<pair<string, string>, DisjointPair> _pairs;
+};
+
+#endif
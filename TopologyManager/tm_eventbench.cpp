@@ -0,0 +1,218 @@
+/*
+ * This file is part of Blackadder.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+/*
+ * Path request benchmark for the TM worker pool: stands in for the
+ * Blackadder node on its event socket (the netlink address PID_BLACKADDER,
+ * so no node may run at the same time), starts ./tm on a topology with a
+ * given number of path computation workers and feeds it synthetic
+ * MATCH_PUB_SUBS requests between random node pairs, each for its own
+ * information item. Every request is answered with exactly one publication
+ * to its publisher, the benchmark times how long it takes until all of them
+ * have arrived. The TM only runs several workers on an igraph built with
+ * thread-local storage (IGRAPH_TLS), otherwise every run uses one worker.
+ *
+ * Usage: tm_eventbench <topology.graphml> [requests] [workers...]
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <linux/netlink.h>
+#include <blackadder.hpp>
+#include "tm_igraph.hpp"
+
+static double now() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/*the publications the TM makes while it connects: 6 subscriptions, a scope and an item*/
+#define TM_STARTUP_MESSAGES 8
+
+static int sock_fd;
+static unsigned int tm_messages;
+static unsigned int responses;
+static volatile bool stopping;
+
+/*counts the requests of the TM and its PUBLISH_DATA requests (the responses), after the TM is killed until it has been quiet for a timeout*/
+static void *receiver_loop(void *arg) {
+	char buffer[65536];
+	int bytes;
+	while (true) {
+		bytes = recv(sock_fd, buffer, sizeof(buffer), 0);
+		if (bytes < 0) {
+			if (stopping || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+				break;
+			}
+			continue;
+		}
+		__sync_fetch_and_add(&tm_messages, 1);
+		if (bytes > (int) sizeof(struct nlmsghdr) && (unsigned char) buffer[sizeof(struct nlmsghdr)] == PUBLISH_DATA) {
+			__sync_fetch_and_add(&responses, 1);
+		}
+	}
+	return NULL;
+}
+
+/*sends a PUBLISHED_DATA event to the TM, as the node does when a request is published to it*/
+static bool sendEvent(pid_t tm_pid, const string &id, const string &data) {
+	string message(sizeof(struct nlmsghdr), '\0');
+	struct nlmsghdr *nlh;
+	struct sockaddr_nl d_nladdr;
+	message += (char) PUBLISHED_DATA;
+	message += (char) (id.length() / PURSUIT_ID_LEN);
+	message += id;
+	message += data;
+	nlh = (struct nlmsghdr *) &message[0];
+	nlh->nlmsg_len = message.length();
+	nlh->nlmsg_pid = PID_BLACKADDER;
+	memset(&d_nladdr, 0, sizeof(d_nladdr));
+	d_nladdr.nl_family = AF_NETLINK;
+	d_nladdr.nl_pid = tm_pid;
+	return sendto(sock_fd, message.data(), message.length(), 0, (struct sockaddr *) &d_nladdr, sizeof(d_nladdr)) >= 0;
+}
+
+/*a MATCH_PUB_SUBS request for item number i, the item identifier is the scope of all requests followed by i*/
+static string matchRequest(const string &publisher, const string &subscriber, unsigned int i) {
+	string request;
+	string item(PURSUIT_ID_LEN, '\0');
+	memcpy(&item[0], &i, sizeof(i));
+	request += (char) MATCH_PUB_SUBS;
+	request += (char) IMPLICIT_RENDEZVOUS;
+	request += (char) 1;
+	request += publisher;
+	request += (char) 1;
+	request += subscriber;
+	request += (char) 1;
+	request += (char) 2;
+	request += string(PURSUIT_ID_LEN, 'B');
+	request += item;
+	return request;
+}
+
+/*runs the TM with no_workers workers, returns the seconds until all requests were answered or a negative value*/
+static double run(const char *topology, vector<string> &nodes, unsigned int no_requests, unsigned int no_workers) {
+	char workers[16];
+	pthread_t receiver;
+	double start, seconds = -1;
+	string request_id = hex_to_chararray(string(PURSUIT_ID_LEN * 2 - 1, 'F') + "E") + string(PURSUIT_ID_LEN, 'A');
+	snprintf(workers, sizeof(workers), "%u", no_workers);
+	pid_t tm_pid = fork();
+	if (tm_pid == 0) {
+		int null_fd = open("/dev/null", O_WRONLY);
+		dup2(null_fd, STDOUT_FILENO);
+		execl("./tm", "tm", "-w", workers, topology, (char *) NULL);
+		perror("./tm");
+		_exit(EXIT_FAILURE);
+	}
+	tm_messages = 0;
+	responses = 0;
+	stopping = false;
+	pthread_create(&receiver, NULL, receiver_loop, NULL);
+	/*the TM is connected once it has made its startup publications*/
+	start = now();
+	while (tm_messages < TM_STARTUP_MESSAGES && now() - start < 60) {
+		usleep(1000);
+	}
+	if (tm_messages >= TM_STARTUP_MESSAGES) {
+		srand(1);
+		start = now();
+		for (unsigned int i = 0; i < no_requests; i++) {
+			string publisher = nodes[rand() % nodes.size()];
+			string subscriber = nodes[rand() % nodes.size()];
+			sendEvent(tm_pid, request_id, matchRequest(publisher, subscriber, i));
+		}
+		while (responses < no_requests && now() - start < 60) {
+			usleep(100);
+		}
+		if (responses == no_requests) {
+			seconds = now() - start;
+		}
+	}
+	kill(tm_pid, SIGKILL);
+	waitpid(tm_pid, NULL, 0);
+	stopping = true;
+	pthread_join(receiver, NULL);
+	return seconds;
+}
+
+int main(int argc, char* argv[]) {
+	unsigned int no_requests = 10000;
+	vector<unsigned int> no_workers;
+	vector<string> nodes;
+	struct sockaddr_nl s_nladdr;
+	struct timeval timeout = {1, 0};
+	bool failed = false;
+	double single = 0;
+	if (argc < 2) {
+		fprintf(stderr, "usage: tm_eventbench <topology.graphml> [requests] [workers...]\n");
+		exit(EXIT_FAILURE);
+	}
+	if (argc > 2) {
+		no_requests = atoi(argv[2]);
+	}
+	for (int i = 3; i < argc; i++) {
+		no_workers.push_back(atoi(argv[i]));
+	}
+	if (no_workers.empty()) {
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		no_workers.push_back(1);
+		if (cpus > 1) {
+			no_workers.push_back(cpus);
+		}
+	}
+	TMIgraph tm_igraph;
+	if (tm_igraph.readTopology(argv[1]) < 0) {
+		fprintf(stderr, "could not read %s\n", argv[1]);
+		exit(EXIT_FAILURE);
+	}
+	for (map<string, int>::iterator it = tm_igraph.reverse_node_index.begin(); it != tm_igraph.reverse_node_index.end(); it++) {
+		nodes.push_back((*it).first);
+	}
+	sock_fd = socket(AF_NETLINK, SOCK_RAW, NETLINK_GENERIC);
+	memset(&s_nladdr, 0, sizeof(s_nladdr));
+	s_nladdr.nl_family = AF_NETLINK;
+	s_nladdr.nl_pid = PID_BLACKADDER;
+	if (sock_fd < 0 || bind(sock_fd, (struct sockaddr *) &s_nladdr, sizeof(s_nladdr)) < 0) {
+		perror("tm_eventbench: the event socket of the node is not free");
+		exit(EXIT_FAILURE);
+	}
+	/*the receiver of a run ends once the killed TM has been quiet for a second, so the next run starts on an empty socket*/
+	setsockopt(sock_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	for (unsigned int w = 0; w < no_workers.size(); w++) {
+		double seconds = run(argv[1], nodes, no_requests, no_workers[w]);
+		if (seconds < 0) {
+			fprintf(stderr, "%s: %u workers: not all of %u requests were answered\n", argv[1], no_workers[w], no_requests);
+			failed = true;
+			continue;
+		}
+		if (w == 0) {
+			single = seconds;
+		}
+		fprintf(stderr, "%s: %u workers: %u path requests in %.3fs, %.0f requests/s (x%.1f)\n",
+				argv[1], no_workers[w], no_requests, seconds, no_requests / seconds, single / seconds);
+	}
+	close(sock_fd);
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,176 @@
+/*
+ * This file is part of Blackadder.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+/*
+ * Link failure benchmark for the TM/RV FIDs: fails random links on the
+ * TM paths of a topology one at a time, on two copies of the graph, and
+ * times the two ways of getting the new TM_to_nodeFIDs, RVFIDs and TMFIDs:
+ * recomputing all of them (what the LSN handlers used to do) and repairing
+ * the shortest path trees, then recomputing the rerouted nodes only (what
+ * they do now). After every failure it checks that the repaired trees give
+ * the same reachability and hop counts as the full recomputation and that
+ * the FIDs kept for the nodes that were not rerouted are still the ones of
+ * their tree paths.
+ *
+ * Usage: tm_failbench <topology.graphml> [failures]
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <climits>
+#include <sys/time.h>
+#include "tm_igraph.hpp"
+
+static double now() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/*the three RV/TM FIDs of a node: TM to node, node to TM, node to RV*/
+enum {TM_TO_NODE, NODE_TO_TM, NODE_TO_RV, NO_TREES};
+
+class TMFailIgraph : public TMIgraph {
+public:
+	/*the number of vertices on the tree path of node, UINT_MAX if there is none (as calculateFID reports it)*/
+	unsigned int treeHops(int tree, const string &node) {
+		const TMSPTree *trees[NO_TREES] = {&TM_to_node_tree, &node_to_TM_tree, &node_to_RV_tree};
+		int vertex = (*reverse_node_index.find(node)).second;
+		unsigned int hops = 1;
+		if (!trees[tree]->reachable(vertex)) {
+			return UINT_MAX;
+		}
+		for (; vertex != trees[tree]->root(); vertex = trees[tree]->parent(vertex)) {
+			hops++;
+		}
+		return hops;
+	}
+};
+
+static Bitvector *rvtmFID(TMIgraph &tm_igraph, int tree, string &node) {
+	switch (tree) {
+	case TM_TO_NODE:
+		return tm_igraph.calculateFID(tm_igraph.getNodeID(), node);
+	case NODE_TO_TM:
+		return tm_igraph.calculateFID(node, tm_igraph.getNodeID());
+	default:
+		return tm_igraph.calculateFID(node, tm_igraph.getRVNodeID());
+	}
+}
+
+int main(int argc, char* argv[]) {
+	int no_failures = 20;
+	int failures = 0;
+	vector<string> nodes;
+	vector<string> path_nodes;
+	double full_time = 0, incremental_time = 0;
+	unsigned int rerouted = 0, wrong_hops = 0, stale = 0;
+	if (argc < 2) {
+		fprintf(stderr, "usage: tm_failbench <topology.graphml> [failures]\n");
+		exit(EXIT_FAILURE);
+	}
+	if (argc > 2) {
+		no_failures = atoi(argv[2]);
+	}
+	/*incremental keeps the shortest path trees, full computes every FID with igraph*/
+	TMFailIgraph incremental;
+	TMIgraph full;
+	if (incremental.readTopology(argv[1]) < 0 || full.readTopology(argv[1]) < 0) {
+		fprintf(stderr, "could not read %s\n", argv[1]);
+		exit(EXIT_FAILURE);
+	}
+	for (map<string, int>::iterator it = incremental.reverse_node_index.begin(); it != incremental.reverse_node_index.end(); it++) {
+		nodes.push_back((*it).first);
+	}
+	incremental.calculateRVTMFIDs();
+	/*the FIDs the TM keeps, indexed like nodes*/
+	vector<Bitvector *> fids[NO_TREES];
+	for (int t = 0; t < NO_TREES; t++) {
+		for (unsigned int n = 0; n < nodes.size(); n++) {
+			fids[t].push_back(rvtmFID(incremental, t, nodes[n]));
+		}
+	}
+	srand(1);
+	for (int attempt = 0; failures < no_failures && attempt < 100 * no_failures; attempt++) {
+		/*fail a random link on the TM path of a random node*/
+		string node = nodes[rand() % nodes.size()];
+		Bitvector FID(FID_LEN * 8);
+		unsigned int hops;
+		string path;
+		full.calculateFID(full.getNodeID(), node, FID, hops, path);
+		if (hops == UINT_MAX || hops < 2) {
+			continue;
+		}
+		TMIgraph::splitPathVector(path, path_nodes);
+		unsigned int hop = rand() % (path_nodes.size() - 1);
+		string a = path_nodes[hop];
+		string b = path_nodes[hop + 1];
+		failures++;
+		/*what the LSN handlers used to do: every FID is recomputed*/
+		double start = now();
+		full.updateGraph(a, b, true, true);
+		for (int t = 0; t < NO_TREES; t++) {
+			for (unsigned int n = 0; n < nodes.size(); n++) {
+				delete rvtmFID(full, t, nodes[n]);
+			}
+		}
+		full_time += now() - start;
+		/*what they do now: the trees are repaired and the rerouted nodes get new FIDs*/
+		start = now();
+		incremental.updateGraph(a, b, true, true);
+		set<string> &rerouted_nodes = incremental.getReroutedNodes();
+		for (set<string>::iterator r_it = rerouted_nodes.begin(); r_it != rerouted_nodes.end(); r_it++) {
+			string rerouted_node = *r_it;
+			unsigned int n = lower_bound(nodes.begin(), nodes.end(), rerouted_node) - nodes.begin();
+			for (int t = 0; t < NO_TREES; t++) {
+				delete fids[t][n];
+				fids[t][n] = rvtmFID(incremental, t, rerouted_node);
+			}
+		}
+		incremental_time += now() - start;
+		rerouted += rerouted_nodes.size();
+		/*compare against the full recomputation*/
+		for (unsigned int n = 0; n < nodes.size(); n++) {
+			for (int t = 0; t < NO_TREES; t++) {
+				string source = (t == TM_TO_NODE) ? full.getNodeID() : nodes[n];
+				string destination = (t == TM_TO_NODE) ? nodes[n] : ((t == NODE_TO_TM) ? full.getNodeID() : full.getRVNodeID());
+				FID.clear();
+				path.clear();
+				full.calculateFID(source, destination, FID, hops, path);
+				if (hops != incremental.treeHops(t, nodes[n])) {
+					wrong_hops++;
+				}
+				Bitvector *current = rvtmFID(incremental, t, nodes[n]);
+				if (!(*current == *fids[t][n])) {
+					stale++;
+				}
+				delete current;
+			}
+		}
+	}
+	for (int t = 0; t < NO_TREES; t++) {
+		for (unsigned int n = 0; n < nodes.size(); n++) {
+			delete fids[t][n];
+		}
+	}
+	fprintf(stderr, "%s: %d failures, %u nodes rerouted, %u wrong hop counts, %u stale FIDs\n",
+			argv[1], failures, rerouted, wrong_hops, stale);
+	if (failures > 0) {
+		fprintf(stderr, "%s: time to the new RV/TM FIDs: full recomputation %.3fms, tree repair %.3fms per failure (x%.1f)\n",
+				argv[1], full_time * 1e3 / failures, incremental_time * 1e3 / failures, full_time / incremental_time);
+	}
+	return (wrong_hops == 0 && stale == 0) ? 0 : 1;
+}
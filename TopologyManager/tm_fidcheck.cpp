@@ -0,0 +1,117 @@
+/*
+ * This file is part of Blackadder.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+/*
+ * FID correctness check for the 64-bit word LIDs of TMIgraph: for all node
+ * pairs of a topology, the FIDs of calculateFID (both forms) and of
+ * calculatePathFID are compared against the FID the string implementation
+ * builds for the same path, OR-ing the '0'/'1' LID attributes of the edges
+ * and the iLID attribute of the destination character by character.
+ *
+ * Usage: tm_fidcheck <topology.graphml>...
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <climits>
+#include "tm_igraph.hpp"
+
+/*the FID of a path vector the way calculateFID used to build it*/
+static void stringFID(TMIgraph &tm_igraph, const vector<string> &nodes, const string &destination, Bitvector &result) {
+	igraph_integer_t eid;
+	for (unsigned int j = 0; j + 1 < nodes.size(); j++) {
+		int from = (*tm_igraph.reverse_node_index.find(nodes[j])).second;
+		int to = (*tm_igraph.reverse_node_index.find(nodes[j + 1])).second;
+#if IGRAPH_V >= IGRAPH_V_0_6
+		igraph_get_eid(&tm_igraph.graph, &eid, from, to, true, false);
+#else
+		igraph_get_eid(&tm_igraph.graph, &eid, from, to, true);
+#endif
+		string LID(igraph_cattribute_EAS(&tm_igraph.graph, "LID", eid));
+		for (int k = 0; k < FID_LEN * 8 && k < (int) LID.length(); k++) {
+			if (LID[k] == '1') {
+				result[FID_LEN * 8 - k - 1].operator |=(true);
+			}
+		}
+	}
+	int vertex_id = (*tm_igraph.reverse_node_index.find(destination)).second;
+	string iLID(igraph_cattribute_VAS(&tm_igraph.graph, "iLID", vertex_id));
+	for (int k = 0; k < FID_LEN * 8 && k < (int) iLID.length(); k++) {
+		if (iLID[k] == '1') {
+			result[FID_LEN * 8 - k - 1].operator |=(true);
+		}
+	}
+}
+
+int main(int argc, char* argv[]) {
+	unsigned int failures = 0;
+	if (argc < 2) {
+		fprintf(stderr, "usage: tm_fidcheck <topology.graphml>...\n");
+		exit(EXIT_FAILURE);
+	}
+	for (int t = 1; t < argc; t++) {
+		TMIgraph tm_igraph;
+		vector<string> nodes;
+		vector<string> path_nodes;
+		unsigned int pairs = 0, unreachable = 0, wrong = 0;
+		if (tm_igraph.readTopology(argv[t]) < 0) {
+			fprintf(stderr, "could not read %s\n", argv[t]);
+			exit(EXIT_FAILURE);
+		}
+		for (map<string, int>::iterator it = tm_igraph.reverse_node_index.begin(); it != tm_igraph.reverse_node_index.end(); it++) {
+			nodes.push_back((*it).first);
+		}
+		for (unsigned int s = 0; s < nodes.size(); s++) {
+			for (unsigned int d = 0; d < nodes.size(); d++) {
+				if (s == d) {
+					continue;
+				}
+				Bitvector FID(FID_LEN * 8);
+				Bitvector expected(FID_LEN * 8);
+				unsigned int hops;
+				string path;
+				pairs++;
+				tm_igraph.calculateFID(nodes[s], nodes[d], FID, hops, path);
+				path_nodes.clear();
+				if (hops != UINT_MAX) {
+					TMIgraph::splitPathVector(path, path_nodes);
+				}
+				stringFID(tm_igraph, path_nodes, nodes[d], expected);
+				if (!(FID == expected)) {
+					wrong++;
+				}
+				if (hops == UINT_MAX) {
+					unreachable++;
+					continue;
+				}
+				/*the same igraph shortest path, so the same FID*/
+				Bitvector *tm_FID = tm_igraph.calculateFID(nodes[s], nodes[d]);
+				if (!(*tm_FID == expected)) {
+					wrong++;
+				}
+				delete tm_FID;
+				Bitvector *path_FID = tm_igraph.calculatePathFID(path);
+				if (path_FID == NULL || !(*path_FID == expected)) {
+					wrong++;
+				}
+				delete path_FID;
+			}
+		}
+		fprintf(stderr, "%s: %u node pairs, %u unreachable, %u FIDs differ from the string implementation\n",
+				argv[t], pairs, unreachable, wrong);
+		failures += wrong;
+	}
+	return failures == 0 ? 0 : 1;
+}
@@ -50,6 +50,9 @@ void TMgraph::setExten(int idx){
 std::map<ICNEdge, Bitvector *> & TMgraph::getFreedLIDs() {
 	return freedLIDs;
 }
+std::set<std::string> & TMgraph::getReroutedNodes() {
+	return rerouted_nodes;
+}
 Bitvector * TMgraph::getTM_to_nodeFID(const string &nodeID){
 	return (*TM_to_nodeFID.find(nodeID)).second;
 }
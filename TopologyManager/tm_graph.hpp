@@ -112,6 +112,10 @@ public:
      *
      */
     virtual std::map<ICNEdge, Bitvector *> & getFreedLIDs();
+    /**@breif retreive the nodes whose TM_to_nodeFID, TMFID or RVFID path was rerouted by the last edge removal
+     *
+     */
+    virtual std::set<std::string> & getReroutedNodes();
     /**@breif retreive a TM_to_nodeFID from TM to a nodeID
      *
      * @param nodeID the ID of the network node
@@ -228,6 +232,9 @@ public:
     /** @breif an index that maps freed LIDs after edges are removed - possibly due to faiure
      */
     std::map<ICNEdge, Bitvector *> freedLIDs;
+    /** @breif the node labels whose TM_to_nodeFID, TMFID or RVFID path crossed the edges removed by the last updateGraph
+     */
+    std::set<std::string> rerouted_nodes;
     /**@brief number of connections in the graph.
      */
     int number_of_connections;
@@ -21,11 +21,16 @@ extern int EF_ALLOW_MALLOC_0;
 #include <unistd.h>
 #include <iostream> 
 #include <string>
+#include <cfloat>
+#include <cctype>
+#include <queue>
+#include <functional>
 
 
 TMIgraph::TMIgraph() {
 	igraph_i_set_attribute_table(&igraph_cattribute_table);
 	//igraph_empty(&graph, 0, IGRAPH_DIRECTED); // No, read from file instead
+	pthread_mutex_init(&qos_trees_mutex, NULL);
 }
 
 TMIgraph::~TMIgraph() {
@@ -37,11 +42,229 @@ TMIgraph::~TMIgraph() {
 	for (edge_LID_iter = edge_LID.begin(); edge_LID_iter != edge_LID.end(); edge_LID_iter++) {
 		delete (*edge_LID_iter).second;
 	}
+	pthread_mutex_destroy(&qos_trees_mutex);
 	igraph_i_attribute_destroy(&graph);
 	igraph_destroy(&graph);
 }
 
 int TMIgraph::readTopology(const char *file_name) {
+	/*the single pass loader handles the files written by the deployment tool and igraph, igraph reads anything else*/
+	if (readTopologyFast(file_name) == 0) {
+		return 0;
+	}
+	cout << "TM: falling back to the igraph GraphML reader" << endl;
+	return readTopologyIgraph(file_name);
+}
+
+/*the value of the XML attribute name in tag, empty if it is not there*/
+static string graphmlAttribute(const string &tag, const char *name) {
+	string pattern = string(name) + "=\"";
+	size_t first = 0;
+	while ((first = tag.find(pattern, first)) != string::npos) {
+		/*must be a whole attribute name, e.g. not "xsi:" + name*/
+		if (first > 0 && isspace(tag[first - 1])) {
+			first += pattern.length();
+			size_t second = tag.find('"', first);
+			if (second == string::npos) {
+				return string();
+			}
+			return tag.substr(first, second - first);
+		}
+		first += pattern.length();
+	}
+	return string();
+}
+
+int TMIgraph::readTopologyFast(const char *file_name) {
+	FILE *instream;
+	std::string text;
+	char buffer[65536];
+	size_t read_bytes;
+	/*GraphML key id -> attribute name and type*/
+	map<string, pair<string, string> > keys;
+	map<string, int> graphml_node_index;
+	vector<string> node_ids;
+	vector<string> node_ilids;
+	vector<string> edge_lids;
+	vector<int> edge_ends;
+	/*any other node and edge attributes (e.g. the QoS ones), by name: element index -> value*/
+	map<string, map<int, string> > vertex_attributes;
+	map<string, map<int, string> > edge_attributes;
+	std::string graph_fid_len, graph_tm, graph_rv, graph_mode;
+	enum {IN_GRAPH, IN_NODE, IN_EDGE} element = IN_GRAPH;
+	size_t pos = 0;
+	instream = fopen(file_name, "r");
+	if (instream == NULL) {
+		return -1;
+	}
+	while ((read_bytes = fread(buffer, 1, sizeof(buffer), instream)) > 0) {
+		text.append(buffer, read_bytes);
+	}
+	fclose(instream);
+	while ((pos = text.find('<', pos)) != string::npos) {
+		if (text.compare(pos, 4, "<!--") == 0) {
+			pos = text.find("-->", pos);
+			if (pos == string::npos) {
+				return -1;
+			}
+			continue;
+		}
+		size_t end = text.find('>', pos);
+		if (end == string::npos) {
+			return -1;
+		}
+		std::string tag = text.substr(pos, end - pos + 1);
+		bool empty_element = (tag[tag.length() - 2] == '/');
+		size_t name_end = tag.find_first_of(" \t\r\n/>", 1);
+		std::string name = tag.substr(1, name_end - 1);
+		pos = end + 1;
+		if (name == "key") {
+			std::string attr_name = graphmlAttribute(tag, "attr.name");
+			if (attr_name.empty()) {
+				attr_name = graphmlAttribute(tag, "id");
+			}
+			keys[graphmlAttribute(tag, "id")] = pair<string, string>(attr_name, graphmlAttribute(tag, "attr.type"));
+		} else if (name == "graph") {
+			if (graphmlAttribute(tag, "edgedefault") == "undirected") {
+				return -1;
+			}
+		} else if (name == "node") {
+			graphml_node_index[graphmlAttribute(tag, "id")] = node_ids.size();
+			node_ids.push_back(string());
+			node_ilids.push_back(string());
+			element = empty_element ? IN_GRAPH : IN_NODE;
+		} else if (name == "edge") {
+			map<string, int>::iterator source_it = graphml_node_index.find(graphmlAttribute(tag, "source"));
+			map<string, int>::iterator target_it = graphml_node_index.find(graphmlAttribute(tag, "target"));
+			if (source_it == graphml_node_index.end() || target_it == graphml_node_index.end()) {
+				return -1;
+			}
+			edge_ends.push_back((*source_it).second);
+			edge_ends.push_back((*target_it).second);
+			edge_lids.push_back(string());
+			element = empty_element ? IN_GRAPH : IN_EDGE;
+		} else if (name == "/node" || name == "/edge") {
+			element = IN_GRAPH;
+		} else if (name == "data" && !empty_element) {
+			size_t value_end = text.find("</data>", pos);
+			if (value_end == string::npos) {
+				return -1;
+			}
+			std::string value = text.substr(pos, value_end - pos);
+			pos = value_end + 7;
+			std::string key = graphmlAttribute(tag, "key");
+			map<string, pair<string, string> >::iterator key_it = keys.find(key);
+			std::string attr_name = (key_it == keys.end()) ? key : (*key_it).second.first;
+			if (element == IN_NODE) {
+				if (attr_name == "NODEID") {
+					node_ids.back() = value;
+				} else if (attr_name == "iLID") {
+					node_ilids.back() = value;
+				} else {
+					vertex_attributes[attr_name][node_ids.size() - 1] = value;
+				}
+			} else if (element == IN_EDGE) {
+				if (attr_name == "LID") {
+					edge_lids.back() = value;
+				} else {
+					edge_attributes[attr_name][edge_lids.size() - 1] = value;
+				}
+			} else if (attr_name == "FID_LEN") {
+				graph_fid_len = value;
+			} else if (attr_name == "TM") {
+				graph_tm = value;
+			} else if (attr_name == "RV") {
+				graph_rv = value;
+			} else if (attr_name == "TM_MODE") {
+				graph_mode = value;
+			}
+		}
+	}
+	for (unsigned int i = 0; i < node_ids.size(); i++) {
+		if (node_ids[i].empty() || node_ilids[i].empty()) {
+			return -1;
+		}
+	}
+	for (unsigned int i = 0; i < edge_lids.size(); i++) {
+		if (edge_lids[i].empty()) {
+			return -1;
+		}
+	}
+	/*parsed: now build the graph and the indexes*/
+	if (!graph_fid_len.empty()) {
+		sscanf(graph_fid_len.c_str(), "%d", &fid_len);
+	}
+	if (!graph_tm.empty()) {
+		nodeID = graph_tm;
+		/*\TODO: the RM need to provide its nodeID to the TM when it comes alive - at the moment, it is assumed to be the same as the TMnodeID*/
+		RMnodeID = nodeID;
+	}
+	if (!graph_rv.empty()) {
+		RVnodeID = graph_rv;
+	}
+	if (!graph_mode.empty()) {
+		mode = graph_mode;
+	}
+	igraph_vector_t edges;
+	igraph_vector_init(&edges, edge_ends.size());
+	for (unsigned int i = 0; i < edge_ends.size(); i++) {
+		VECTOR(edges)[i] = edge_ends[i];
+	}
+	igraph_empty(&graph, node_ids.size(), IGRAPH_DIRECTED);
+	igraph_add_edges(&graph, &edges, 0);
+	igraph_vector_destroy(&edges);
+	cout << "TM: " << igraph_vcount(&graph) << " nodes" << endl;
+	cout << "TM: " << igraph_ecount(&graph) << " edges" << endl;
+	vertex_iLID_words.resize(node_ids.size());
+	edge_LID_words.resize(edge_lids.size());
+	for (unsigned int i = 0; i < node_ids.size(); i++) {
+		igraph_cattribute_VAS_set(&graph, "NODEID", i, node_ids[i].c_str());
+		igraph_cattribute_VAS_set(&graph, "iLID", i, node_ilids[i].c_str());
+		reverse_node_index.insert(pair<std::string, int>(node_ids[i], i));
+		LIDStringToWords(node_ilids[i].c_str(), vertex_iLID_words[i]);
+		Bitvector *ilid = new Bitvector(node_ilids[i]);
+		nodeID_iLID.insert(pair<std::string, Bitvector *>(node_ids[i], ilid));
+		vertex_iLID.insert(pair<int, Bitvector *>(i, ilid));
+		RVFID.insert(pair<std::string, Bitvector *>(node_ids[i], NULL));
+		TMFID.insert(pair<std::string, Bitvector *>(node_ids[i], NULL));
+	}
+	for (unsigned int i = 0; i < edge_lids.size(); i++) {
+		igraph_cattribute_EAS_set(&graph, "LID", i, edge_lids[i].c_str());
+		reverse_edge_index.insert(pair<std::string, int>(edge_lids[i], i));
+		LIDStringToWords(edge_lids[i].c_str(), edge_LID_words[i]);
+		edge_LID.insert(pair<int, Bitvector *>(i, new Bitvector(edge_lids[i])));
+	}
+	/*numeric GraphML types become numeric igraph attributes, as with igraph's reader*/
+	for (map<string, map<int, string> >::iterator a_it = vertex_attributes.begin(); a_it != vertex_attributes.end(); a_it++) {
+		std::string type;
+		for (map<string, pair<string, string> >::iterator key_it = keys.begin(); key_it != keys.end(); key_it++) {
+			if ((*key_it).second.first == (*a_it).first) type = (*key_it).second.second;
+		}
+		for (map<int, string>::iterator v_it = (*a_it).second.begin(); v_it != (*a_it).second.end(); v_it++) {
+			if (type == "string" || type.empty()) {
+				igraph_cattribute_VAS_set(&graph, (*a_it).first.c_str(), (*v_it).first, (*v_it).second.c_str());
+			} else {
+				igraph_cattribute_VAN_set(&graph, (*a_it).first.c_str(), (*v_it).first, atof((*v_it).second.c_str()));
+			}
+		}
+	}
+	for (map<string, map<int, string> >::iterator a_it = edge_attributes.begin(); a_it != edge_attributes.end(); a_it++) {
+		std::string type;
+		for (map<string, pair<string, string> >::iterator key_it = keys.begin(); key_it != keys.end(); key_it++) {
+			if ((*key_it).second.first == (*a_it).first) type = (*key_it).second.second;
+		}
+		for (map<int, string>::iterator e_it = (*a_it).second.begin(); e_it != (*a_it).second.end(); e_it++) {
+			if (type == "string" || type.empty()) {
+				igraph_cattribute_EAS_set(&graph, (*a_it).first.c_str(), (*e_it).first, (*e_it).second.c_str());
+			} else {
+				igraph_cattribute_EAN_set(&graph, (*a_it).first.c_str(), (*e_it).first, atof((*e_it).second.c_str()));
+			}
+		}
+	}
+	return 0;
+}
+
+int TMIgraph::readTopologyIgraph(const char *file_name) {
 	int ret;
 	Bitvector *lid;
 	Bitvector *ilid;
@@ -96,10 +319,13 @@ int TMIgraph::readTopology(const char *file_name) {
 	}
 	cout << "TM: " << igraph_vcount(&graph) << " nodes" << endl;
 	cout << "TM: " << igraph_ecount(&graph) << " edges" << endl;
+	vertex_iLID_words.resize(igraph_vcount(&graph));
+	edge_LID_words.resize(igraph_ecount(&graph));
 	for (int i = 0; i < igraph_vcount(&graph); i++) {
 		std::string nID = std::string(igraph_cattribute_VAS(&graph, "NODEID", i));
 		std::string iLID = std::string(igraph_cattribute_VAS(&graph, "iLID", i));
 		reverse_node_index.insert(pair<std::string, int>(nID, i));
+		LIDStringToWords(iLID.c_str(), vertex_iLID_words[i]);
 		ilid = new Bitvector(iLID);
 		nodeID_iLID.insert(pair<std::string, Bitvector *>(nID, ilid));
 		vertex_iLID.insert(pair<int, Bitvector *>(i, ilid));
@@ -111,6 +337,7 @@ int TMIgraph::readTopology(const char *file_name) {
 	for (int i = 0; i < igraph_ecount(&graph); i++) {
 		std::string LID = std::string(igraph_cattribute_EAS(&graph, "LID", i));
 		reverse_edge_index.insert(pair<std::string, int>(LID, i));
+		LIDStringToWords(LID.c_str(), edge_LID_words[i]);
 		lid = new Bitvector(LID);
 		//LIDs.insert(lid);
 		edge_LID.insert(pair<int, Bitvector *>(i, lid));
@@ -123,6 +350,23 @@ int TMIgraph::readTopology(const char *file_name) {
 	}
 	return ret;
 }
+void TMIgraph::LIDStringToWords(const char *lid, LIDWords &words) {
+	memset(words.w, 0, sizeof(words.w));
+	/*same bit order as Bitvector(string): character k is bit FID_LEN * 8 - k - 1*/
+	for (int k = 0; k < FID_LEN * 8 && lid[k] != '\0'; k++) {
+		if (lid[k] == '1') {
+			int bit = FID_LEN * 8 - k - 1;
+			words.w[bit >> 6] |= ((uint64_t) 1) << (bit & 63);
+		}
+	}
+}
+void TMIgraph::orWordsIntoBitvector(const LIDWords &words, Bitvector &bv) {
+	Bitvector::data_word_type *data = bv.data_words();
+	for (int i = 0; i < FID_LEN / 8; i++) {
+		data[2 * i] |= (Bitvector::data_word_type) (words.w[i] & 0xFFFFFFFF);
+		data[2 * i + 1] |= (Bitvector::data_word_type) (words.w[i] >> 32);
+	}
+}
 int TMIgraph::reportTopology(Moly &moly) {
     unsigned int node_type;
     int lid_int;
@@ -264,16 +508,109 @@ void TMIgraph::updateLinkState(const string &lid, const QoSList &status){
 		vec = &mit->second;
 		if (mit->first < lp){
 			// For any priority lower than this edge's... avoid using this edge
-			igraph_vector_set(vec, eid, UCHAR_MAX);
+			updateQoSWeight(vec, eid, UCHAR_MAX);
 		}
 		else {
 			// For all the others keep the real weight
-			igraph_vector_set(vec, eid, (MAX_PRIO-lp));
+			updateQoSWeight(vec, eid, (MAX_PRIO-lp));
 		}
 	}
 	
 }
 
+void TMIgraph::updateQoSWeight(igraph_vector_t *weights, int eid, igraph_real_t weight){
+	igraph_real_t old_weight = VECTOR(*weights)[eid];
+	igraph_integer_t edge_from, edge_to;
+	if (old_weight == weight) {
+		return;
+	}
+	igraph_vector_set(weights, eid, weight);
+	pthread_mutex_lock(&qos_trees_mutex);
+	if (weight > old_weight) {
+		// Only the trees of this plane using the edge get longer
+		map<int, set<QoSSPTreeKey> >::iterator eit = qos_tree_edges.find(eid);
+		if (eit != qos_tree_edges.end()) {
+			vector<QoSSPTreeKey> stale;
+			for (set<QoSSPTreeKey>::iterator kit = eit->second.begin(); kit != eit->second.end(); ++kit) {
+				if (kit->first == weights) stale.push_back(*kit);
+			}
+			for (unsigned int i = 0; i < stale.size(); i++) {
+				eraseQoSSPTree(stale[i]);
+			}
+		}
+	} else {
+		// A lighter edge may shorten any tree of this plane
+		igraph_edge(&graph, eid, &edge_from, &edge_to);
+		vector<QoSSPTreeKey> stale;
+		map<QoSSPTreeKey, QoSSPTree>::iterator tit = qos_trees.lower_bound(QoSSPTreeKey(weights, INT_MIN));
+		for (; tit != qos_trees.end() && tit->first.first == weights; ++tit) {
+			const QoSSPTree &tree = tit->second;
+			if (tree.in_edge[edge_to] == eid || tree.dist[edge_from] + weight < tree.dist[edge_to]) {
+				stale.push_back(tit->first);
+			}
+		}
+		for (unsigned int i = 0; i < stale.size(); i++) {
+			eraseQoSSPTree(stale[i]);
+		}
+	}
+	pthread_mutex_unlock(&qos_trees_mutex);
+}
+
+void TMIgraph::eraseQoSSPTree(const QoSSPTreeKey &key){
+	map<QoSSPTreeKey, QoSSPTree>::iterator tit = qos_trees.find(key);
+	if (tit == qos_trees.end()) {
+		return;
+	}
+	const vector<int> &in_edge = tit->second.in_edge;
+	for (unsigned int v = 0; v < in_edge.size(); v++) {
+		if (in_edge[v] < 0) continue;
+		map<int, set<QoSSPTreeKey> >::iterator eit = qos_tree_edges.find(in_edge[v]);
+		eit->second.erase(key);
+		if (eit->second.empty()) qos_tree_edges.erase(eit);
+	}
+	qos_trees.erase(tit);
+}
+
+void TMIgraph::buildQoSSPTree(int root, const igraph_vector_t *weights, QoSSPTree &tree){
+	typedef pair<igraph_real_t, int> dist_vertex;
+	int no_vertices = igraph_vcount(&graph);
+	igraph_vector_t eids;
+	igraph_integer_t edge_from, edge_to;
+	priority_queue<dist_vertex, vector<dist_vertex>, greater<dist_vertex> > heap;
+	tree.in_edge.assign(no_vertices, -1);
+	tree.parent.assign(no_vertices, -1);
+	tree.dist.assign(no_vertices, DBL_MAX);
+	tree.dist[root] = 0;
+	// A plane without a weight for every edge cannot be used (as with igraph's dijkstra)
+	if (igraph_vector_size(weights) < igraph_ecount(&graph)) {
+		return;
+	}
+	igraph_vector_init(&eids, 0);
+	heap.push(dist_vertex(0, root));
+	while (!heap.empty()) {
+		dist_vertex top = heap.top();
+		heap.pop();
+		if (top.first > tree.dist[top.second]) continue;
+#if IGRAPH_V >= IGRAPH_V_0_6
+		igraph_incident(&graph, &eids, top.second, IGRAPH_OUT);
+#else
+		igraph_adjacent(&graph, &eids, top.second, IGRAPH_OUT);
+#endif
+		for (int e = 0; e < igraph_vector_size(&eids); e++) {
+			int eid = VECTOR(eids)[e];
+			igraph_edge(&graph, eid, &edge_from, &edge_to);
+			igraph_real_t d = top.first + VECTOR(*weights)[eid];
+			if (d < tree.dist[edge_to]) {
+				tree.dist[edge_to] = d;
+				tree.in_edge[edge_to] = eid;
+				tree.parent[edge_to] = top.second;
+				heap.push(dist_vertex(d, edge_to));
+			}
+		}
+	}
+	igraph_vector_destroy(&eids);
+}
+
 void TMIgraph::createNewQoSLinkPrioMap(const uint8_t & map_prio){
 	cout<<"Creating new priority plane: "<<(int)map_prio<<endl;
 	// Create the line as a c array!
@@ -370,6 +707,19 @@ bool TMIgraph::updateGraph(const string &source, const string &destination, bool
 		igraph_delete_edges(&graph, es);
 		cout << "TM: removed " << NoEdges << " edges" << endl;
 		updateTMStates();
+		/*repair only the tree paths that crossed the removed edge(s)*/
+		set<int> rerouted;
+		TMSPTree *trees[3] = {&TM_to_node_tree, &node_to_TM_tree, &node_to_RV_tree};
+		for (int t = 0; t < 3; t++) {
+			trees[t]->removeEdge(&graph, source_vertex, destination_vertex, rerouted);
+			if (NoEdges == 2) {
+				trees[t]->removeEdge(&graph, destination_vertex, source_vertex, rerouted);
+			}
+		}
+		rerouted_nodes.clear();
+		for (set<int>::iterator r_it = rerouted.begin(); r_it != rerouted.end(); r_it++) {
+			rerouted_nodes.insert(string(igraph_cattribute_VAS(&graph, "NODEID", *r_it)));
+		}
 		ret = true;
 	}
 	else if ((!remove) && (!exists)){
@@ -396,6 +746,20 @@ bool TMIgraph::updateGraph(const string &source, const string &destination, bool
 			freedLIDs.erase(backward_edge);
 		}
 		updateTMStates();
+		/*a new edge may shorten any path, rebuild the trees and keep the nodes whose paths moved*/
+		rerouted_nodes.clear();
+		if (TM_to_node_tree.valid()) {
+			set<int> rerouted;
+			TMSPTree previous[3] = {TM_to_node_tree, node_to_TM_tree, node_to_RV_tree};
+			TMSPTree *trees[3] = {&TM_to_node_tree, &node_to_TM_tree, &node_to_RV_tree};
+			buildRVTMTrees();
+			for (int t = 0; t < 3; t++) {
+				trees[t]->changedPaths(previous[t], rerouted);
+			}
+			for (set<int>::iterator r_it = rerouted.begin(); r_it != rerouted.end(); r_it++) {
+				rerouted_nodes.insert(string(igraph_cattribute_VAS(&graph, "NODEID", *r_it)));
+			}
+		}
 		ret = true;
 	}
 	else {
@@ -430,15 +794,73 @@ void TMIgraph::updateTMStates(){
 	/*update edge states after as a consequence of graph update*/
 	edge_LID.clear();
 	reverse_edge_index.clear();
+	edge_LID_words.resize(no_edges);
 	for (unsigned int i = 0; i < no_edges; i++) {
 		std::string LID = string(igraph_cattribute_EAS(&graph, "LID", i));
 		reverse_edge_index.insert(pair<string, int>(LID, i));
+		LIDStringToWords(LID.c_str(), edge_LID_words[i]);
 		Bitvector* lid = new Bitvector(LID);
 		edge_LID.insert(pair<int, Bitvector *>(i, lid));
 	}
+	/*edge ids may have changed, drop the cached QoS trees*/
+	pthread_mutex_lock(&qos_trees_mutex);
+	qos_trees.clear();
+	qos_tree_edges.clear();
+	pthread_mutex_unlock(&qos_trees_mutex);
+}
+
+void TMIgraph::buildRVTMTrees() {
+	int tm_vertex = (*reverse_node_index.find(nodeID)).second;
+	int rv_vertex = (*reverse_node_index.find(RVnodeID)).second;
+	TM_to_node_tree.build(&graph, tm_vertex, false);
+	node_to_TM_tree.build(&graph, tm_vertex, true);
+	node_to_RV_tree.build(&graph, rv_vertex, true);
+}
+
+Bitvector *TMIgraph::calculateTreeFID(const TMSPTree &tree, int vertex) {
+	Bitvector *result = new Bitvector(FID_LEN * 8);
+	LIDWords fid_words;
+	igraph_integer_t eid;
+	if (!tree.reachable(vertex)) {
+		return result;
+	}
+	memset(fid_words.w, 0, sizeof(fid_words.w));
+	/*walk up the tree, the edges point away from the root in a source tree and towards it in a sink tree*/
+	for (int v = vertex; v != tree.root(); v = tree.parent(v)) {
+		int head = tree.toRoot() ? v : tree.parent(v);
+		int tail = tree.toRoot() ? tree.parent(v) : v;
+#if IGRAPH_V >= IGRAPH_V_0_6
+		igraph_get_eid(&graph, &eid, head, tail, true, true);
+#else
+		igraph_get_eid(&graph, &eid, head, tail, true);
+#endif
+		const LIDWords &lid = edge_LID_words[eid];
+		for (int k = 0; k < FID_LEN / 8; k++) {
+			fid_words.w[k] |= lid.w[k];
+		}
+	}
+	/*"or" the internal linkID of the path destination*/
+	const LIDWords &ilid = vertex_iLID_words[tree.toRoot() ? tree.root() : vertex];
+	for (int k = 0; k < FID_LEN / 8; k++) {
+		fid_words.w[k] |= ilid.w[k];
+	}
+	orWordsIntoBitvector(fid_words, *result);
+	return result;
 }
 
 Bitvector *TMIgraph::calculateFID(string &source, string &destination) {
+	/*the TM/RV paths are served from the shortest path trees*/
+	if (TM_to_node_tree.valid()) {
+		if (source == nodeID) {
+			return calculateTreeFID(TM_to_node_tree, (*reverse_node_index.find(destination)).second);
+		}
+		if (destination == nodeID) {
+			return calculateTreeFID(node_to_TM_tree, (*reverse_node_index.find(source)).second);
+		}
+		if (destination == RVnodeID) {
+			return calculateTreeFID(node_to_RV_tree, (*reverse_node_index.find(source)).second);
+		}
+	}
 	int vertex_id;
 	Bitvector *result = new Bitvector(FID_LEN * 8);
 	igraph_vs_t vs;
@@ -446,8 +868,10 @@ Bitvector *TMIgraph::calculateFID(string &source, string &destination) {
 	igraph_vector_t to_vector;
 	igraph_vector_t *temp_v;
 	igraph_integer_t eid;
+	LIDWords fid_words;
 	
 	/*find the vertex id in the reverse index*/
+	memset(fid_words.w, 0, sizeof(fid_words.w));
 	int from = (*reverse_node_index.find(source)).second;
 	igraph_vector_init(&to_vector, 1);
 	VECTOR(to_vector)[0] = (*reverse_node_index.find(destination)).second;
@@ -478,26 +902,20 @@ Bitvector *TMIgraph::calculateFID(string &source, string &destination) {
 		igraph_get_eid(&graph, &eid, VECTOR(*temp_v)[j], VECTOR(*temp_v)[j + 1], true);
 #endif
 		//click_chatter("node %s -> node %s", igraph_cattribute_VAS(&graph, "NODEID", VECTOR(*temp_v)[j]), igraph_cattribute_VAS(&graph, "NODEID", VECTOR(*temp_v)[j + 1]));
-		//click_chatter("link: %s", igraph_cattribute_EAS(&graph, "LID", eid));
-		string LID(igraph_cattribute_EAS(&graph, "LID", eid), FID_LEN * 8);
-		for (int k = 0; k < FID_LEN * 8; k++) {
-			if (LID[k] == '1') {
-				(*result)[ FID_LEN * 8 - k - 1].operator |=(true);
-			}
+		const LIDWords &lid = edge_LID_words[eid];
+		for (int k = 0; k < FID_LEN / 8; k++) {
+			fid_words.w[k] |= lid.w[k];
 		}
-		//click_chatter("FID of the shortest path: %s", result.to_string().c_str());
 	}
 	if (igraph_vector_size(temp_v) > 0) {
 		/*now, if a path is found, for all destinations "or" the internal linkID*/
 		vertex_id = (*reverse_node_index.find(destination)).second;
-		string iLID(igraph_cattribute_VAS(&graph, "iLID", vertex_id));
-		//click_chatter("internal link for node %s: %s", igraph_cattribute_VAS(&graph, "NODEID", vertex_id), iLID.c_str());
-		for (int k = 0; k < FID_LEN * 8; k++) {
-			if (iLID[k] == '1') {
-				(*result)[ FID_LEN * 8 - k - 1].operator |=(true);
-			}
+		const LIDWords &ilid = vertex_iLID_words[vertex_id];
+		for (int k = 0; k < FID_LEN / 8; k++) {
+			fid_words.w[k] |= ilid.w[k];
 		}
 	}
+	orWordsIntoBitvector(fid_words, *result);
 	igraph_vector_destroy((igraph_vector_t *) VECTOR(res)[0]);
 	igraph_vector_destroy(&to_vector);
 	igraph_vector_ptr_destroy_all(&res);
@@ -505,6 +923,75 @@ Bitvector *TMIgraph::calculateFID(string &source, string &destination) {
 	return result;
 }
 
+Bitvector *TMIgraph::calculatePathFID(const string &path) {
+	vector<string> nodes;
+	map<string, int>::iterator vertex_it;
+	int from, to = -1;
+	igraph_integer_t eid;
+	LIDWords fid_words;
+	splitPathVector(path, nodes);
+	memset(fid_words.w, 0, sizeof(fid_words.w));
+	for (unsigned int j = 0; j < nodes.size(); j++) {
+		vertex_it = reverse_node_index.find(nodes[j]);
+		if (vertex_it == reverse_node_index.end()) {
+			return NULL;
+		}
+		from = to;
+		to = (*vertex_it).second;
+		if (j == 0) {
+			continue;
+		}
+#if IGRAPH_V >= IGRAPH_V_0_6
+		igraph_get_eid(&graph, &eid, from, to, true, false);
+#else
+		igraph_get_eid(&graph, &eid, from, to, true);
+#endif
+		if (eid < 0) {
+			return NULL;
+		}
+		const LIDWords &lid = edge_LID_words[eid];
+		for (int k = 0; k < FID_LEN / 8; k++) {
+			fid_words.w[k] |= lid.w[k];
+		}
+	}
+	if (to < 0) {
+		return NULL;
+	}
+	/*"or" the internal linkID of the path destination*/
+	const LIDWords &ilid = vertex_iLID_words[to];
+	for (int k = 0; k < FID_LEN / 8; k++) {
+		fid_words.w[k] |= ilid.w[k];
+	}
+	Bitvector *result = new Bitvector(FID_LEN * 8);
+	orWordsIntoBitvector(fid_words, *result);
+	return result;
+}
+
+void TMIgraph::splitPathVector(const string &path, vector<string> &nodes) {
+	size_t start = 0;
+	size_t delim;
+	nodes.clear();
+	if (path.empty()) {
+		return;
+	}
+	while ((delim = path.find("->", start)) != string::npos) {
+		nodes.push_back(path.substr(start, delim - start));
+		start = delim + 2;
+	}
+	nodes.push_back(path.substr(start));
+}
+
+string TMIgraph::joinPathVector(const vector<string> &nodes) {
+	string path;
+	for (unsigned int j = 0; j < nodes.size(); j++) {
+		path += nodes[j];
+		if (j < nodes.size() - 1) {
+			path += "->";
+		}
+	}
+	return path;
+}
+
 /*main function for rendezvous*/
 void TMIgraph::calculateFID(set<string> &publishers, set<string> &subscribers, map<string, Bitvector *> &result, map<string, set<string> > &path_vectors) {
 	set<string>::iterator subscribers_it;
@@ -572,8 +1059,10 @@ void TMIgraph::calculateFID(string &source, string &destination, Bitvector &resu
 	igraph_vector_t to_vector;
 	igraph_vector_t *temp_v;
 	igraph_integer_t eid;
+	LIDWords fid_words;
 	
 	/*find the vertex id in the reverse index*/
+	memset(fid_words.w, 0, sizeof(fid_words.w));
 	int from = (*reverse_node_index.find(source)).second;
 	igraph_vector_init(&to_vector, 1);
 	VECTOR(to_vector)[0] = (*reverse_node_index.find(destination)).second;
@@ -608,15 +1097,20 @@ void TMIgraph::calculateFID(string &source, string &destination, Bitvector &resu
 #else
 		igraph_get_eid(&graph, &eid, VECTOR(*temp_v)[j], VECTOR(*temp_v)[j + 1], true);
 #endif
-		Bitvector *lid = (*edge_LID.find(eid)).second;
-		(resultFID) = (resultFID) | (*lid);
+		const LIDWords &lid = edge_LID_words[eid];
+		for (int k = 0; k < FID_LEN / 8; k++) {
+			fid_words.w[k] |= lid.w[k];
+		}
 	}
 	numberOfHops = igraph_vector_size(temp_v);
 	if(numberOfHops == 0)
 		numberOfHops=UINT_MAX;
 	/*now for the destination "or" the internal linkID*/
-	Bitvector *ilid = (*nodeID_iLID.find(destination)).second;
-	(resultFID) = (resultFID) | (*ilid);
+	const LIDWords &ilid = vertex_iLID_words[(int) VECTOR(to_vector)[0]];
+	for (int k = 0; k < FID_LEN / 8; k++) {
+		fid_words.w[k] |= ilid.w[k];
+	}
+	orWordsIntoBitvector(fid_words, resultFID);
 	//cout << "FID of the shortest path: " << resultFID.to_string() << endl;
 	igraph_vector_destroy((igraph_vector_t *) VECTOR(res)[0]);
 	igraph_vector_destroy(&to_vector);
@@ -669,6 +1163,7 @@ void TMIgraph::calculateRVTMFIDs()
 	map<string, int>::iterator subscriber;
 	string subscriber_nodeID;
 	unsigned int subscribers_count = reverse_node_index.size();
+	buildRVTMTrees();
 	subscriber = reverse_node_index.begin();
 	for (unsigned int i = 0; i < subscribers_count; i++) {
 		subscriber_nodeID = subscriber->first;
@@ -745,75 +1240,56 @@ void TMIgraph::calculateFID_weighted(set<string> &publishers, set<string> &subsc
 	}
 }
 void TMIgraph::calculateFID_weighted(string &source, string &destination, Bitvector &resultFID, unsigned int &numberOfHops, string &path, const igraph_vector_t *weights) {
-	igraph_vs_t vs;
-	igraph_vector_ptr_t res;
-#if IGRAPH_V >= IGRAPH_V_0_6
-	igraph_vector_ptr_t edges;
-#endif
-	igraph_vector_t to_vector;
-	igraph_vector_t *temp_v;
-	igraph_integer_t eid;
-	/*find the vertex id in the reverse index*/
+	LIDWords fid_words;
+	vector<int> path_edges;
+	vector<int> path_vertices;
+	/*find the vertex ids in the reverse index*/
+	memset(fid_words.w, 0, sizeof(fid_words.w));
 	int from = (*reverse_node_index.find(source)).second;
-	igraph_vector_init(&to_vector, 1);
-	VECTOR(to_vector)[0] = (*reverse_node_index.find(destination)).second;
-	/*initialize the sequence*/
-	igraph_vs_vector(&vs, &to_vector);
-	/*initialize the vector that contains pointers*/
-	igraph_vector_ptr_init(&res, 1);
-	temp_v = (igraph_vector_t *) VECTOR(res)[0];
-	temp_v = (igraph_vector_t *) malloc(sizeof (igraph_vector_t));
-	VECTOR(res)[0] = temp_v;
-	igraph_vector_init(temp_v, 1);
-	/*run the shortest path algorithm from "from"*/
-#if IGRAPH_V >= IGRAPH_V_0_6
-	cout<<"v0.6 Init"<<endl;
-	// Init a vector ptr
-	igraph_vector_ptr_init(&edges, 1);
-	VECTOR(edges)[0]=calloc(1, sizeof(igraph_vector_t));
-	igraph_vector_init((igraph_vector_t*)VECTOR(edges)[0],1);
-	cout<<"v0.6 Calculation..."<<endl;
-#if IGRAPH_V >= IGRAPH_V_0_7
-	int rc=igraph_get_shortest_paths_dijkstra(&graph, &res, &edges, from, vs, weights, IGRAPH_OUT,NULL,NULL);
-	cout<<"rc="<<rc<<endl;
-#else
-	int rc=igraph_get_shortest_paths_dijkstra(&graph, &res, &edges, from, vs, weights, IGRAPH_OUT);
-	cout<<"rc="<<rc<<endl;
-#endif //IGRAPH_V >= IGRAPH_V_0_6
-#else
-	igraph_get_shortest_paths_dijkstra(&graph, &res, from, vs, weights, IGRAPH_OUT);
-#endif
+	int to = (*reverse_node_index.find(destination)).second;
+	QoSSPTreeKey key(weights, from);
+	/*the weighted shortest path tree of the source is cached per priority plane until updateLinkState changes it*/
+	pthread_mutex_lock(&qos_trees_mutex);
+	map<QoSSPTreeKey, QoSSPTree>::iterator tree_it = qos_trees.find(key);
+	if (tree_it == qos_trees.end()) {
+		pthread_mutex_unlock(&qos_trees_mutex);
+		QoSSPTree tree;
+		buildQoSSPTree(from, weights, tree);
+		pthread_mutex_lock(&qos_trees_mutex);
+		pair<map<QoSSPTreeKey, QoSSPTree>::iterator, bool> inserted = qos_trees.insert(pair<QoSSPTreeKey, QoSSPTree>(key, tree));
+		tree_it = inserted.first;
+		if (inserted.second) {
+			for (unsigned int v = 0; v < tree.in_edge.size(); v++) {
+				if (tree.in_edge[v] >= 0) qos_tree_edges[tree.in_edge[v]].insert(key);
+			}
+		}
+	}
+	const QoSSPTree &tree = tree_it->second;
+	if (to == from || tree.in_edge[to] >= 0) {
+		int v = to;
+		path_vertices.push_back(v);
+		while (v != from) {
+			path_edges.push_back(tree.in_edge[v]);
+			v = tree.parent[v];
+			path_vertices.push_back(v);
+		}
+	}
+	pthread_mutex_unlock(&qos_trees_mutex);
 	/*construct a string of the current path represented by nodes*/
-	for (int j = 0; j < igraph_vector_size(temp_v); j++) {
-		path += igraph_cattribute_VAS(&graph, "NODEID", VECTOR(*temp_v)[j]); //VECTOR(*temp_v)[j];
-		if (j < igraph_vector_size(temp_v)-1) {
+	for (int j = path_vertices.size() - 1; j >= 0; j--) {
+		path += igraph_cattribute_VAS(&graph, "NODEID", path_vertices[j]);
+		if (j > 0) {
 			path+="->";
 		}
 	}
-	/*check the shortest path to each destination*/
-	temp_v = (igraph_vector_t *) VECTOR(res)[0];
 	/*now let's "or" the FIDs for each link in the shortest path*/
-	
-#if IGRAPH_V >= IGRAPH_V_0_6
-	cout<<"Constructing FID based on edges..."<<endl;
-	igraph_vector_t *temp_ev = (igraph_vector_t *)VECTOR(edges)[0];
-	for (int j = 0; j < igraph_vector_size(temp_ev); j++) {
-		eid = VECTOR(*temp_ev)[j];
-		Bitvector *lid = (*edge_LID.find(eid)).second;
-		(resultFID) = (resultFID) | (*lid);
-	}
-#else
-	for (int j = 0; j < igraph_vector_size(temp_v) - 1; j++) {
-		igraph_get_eid(&graph, &eid, VECTOR(*temp_v)[j], VECTOR(*temp_v)[j + 1], true);
-		Bitvector *lid = (*edge_LID.find(eid)).second;
-		(resultFID) = (resultFID) | (*lid);
+	for (unsigned int j = 0; j < path_edges.size(); j++) {
+		const LIDWords &lid = edge_LID_words[path_edges[j]];
+		for (int k = 0; k < FID_LEN / 8; k++) {
+			fid_words.w[k] |= lid.w[k];
+		}
 	}
-#endif
-#if IGRAPH_V >= IGRAPH_V_0_6
-	numberOfHops = igraph_vector_size(temp_ev);
-#else
-	numberOfHops = igraph_vector_size(temp_v);
-#endif
+	numberOfHops = path_edges.size();
 	
 	if(numberOfHops == 0) numberOfHops=UINT_MAX;
 	// Fix: Cause it seems that edges without weight are getting ignored from dijkstra
@@ -821,12 +1297,10 @@ void TMIgraph::calculateFID_weighted(string &source, string &destination, Bitvec
 	if (source == destination) numberOfHops=1;
 	
 	/*now for the destination "or" the internal linkID*/
-	Bitvector *ilid = (*nodeID_iLID.find(destination)).second;
-	(resultFID) = (resultFID) | (*ilid);
+	const LIDWords &ilid = vertex_iLID_words[to];
+	for (int k = 0; k < FID_LEN / 8; k++) {
+		fid_words.w[k] |= ilid.w[k];
+	}
+	orWordsIntoBitvector(fid_words, resultFID);
 	//cout << "FID of the shortest path: " << resultFID.to_string() << endl;
-	igraph_vector_destroy((igraph_vector_t *) VECTOR(res)[0]);
-	//     igraph_vector_destroy((igraph_vector_t *) VECTOR(edge)[0]);
-	igraph_vector_destroy(&to_vector);
-	igraph_vector_ptr_destroy_all(&res);
-	igraph_vs_destroy(&vs);
 }
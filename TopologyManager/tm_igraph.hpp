@@ -28,11 +28,13 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <pthread.h>
 #include <bitvector.hpp>
 #include "blackadder_enums.hpp"
 
 
 #include "tm_graph.hpp"
+#include "tm_sptree.hpp"
 // igraph_version.hpp should be remade using make clean && make igraph_version.hpp
 // if igraph major or minor version changes
 #include "igraph_version.hpp"
@@ -40,6 +42,32 @@
 
 using namespace std;
 
+/**@brief a LIPSIN identifier stored as 64-bit words, bit i of the Bitvector being bit (i % 64) of word (i / 64).
+ *
+ * FIDs are built by OR-ing these words hop by hop instead of OR-ing '0'/'1' strings or Bitvector copies.
+ */
+struct LIDWords {
+	uint64_t w[FID_LEN / 8];
+};
+
+/**@brief a weighted shortest path tree of one QoS priority plane, cached by calculateFID_weighted.
+ */
+struct QoSSPTree {
+	/**@brief the igraph edge id of the tree edge into each vertex, -1 for the root and unreachable vertices
+	 */
+	vector<int> in_edge;
+	/**@brief the tree parent of each vertex, -1 for the root and unreachable vertices
+	 */
+	vector<int> parent;
+	/**@brief the weighted distance of each vertex from the root
+	 */
+	vector<igraph_real_t> dist;
+};
+
+/**@brief a QoS tree is identified by its priority plane (the weight vector in qlwm) and its root vertex
+ */
+typedef pair<const igraph_vector_t *, int> QoSSPTreeKey;
+
 /**@brief (Topology Manager) This is a representation of the network topology (using the iGraph library) for the Topology Manager.
  */
 class TMIgraph : public TMgraph {
@@ -58,8 +86,28 @@ public:
 	 *
 	 * @param name the /graphML file name
 	 * @return <0 if there was a problem reading the file
+	 *
+	 * readTopologyFast is tried first, readTopologyIgraph if it cannot parse the file.
 	 */
 	virtual int readTopology(const char *name);
+	/**
+	 * @brief reads the topology with igraph's GraphML reader and then builds the indexes from the igraph attributes.
+	 *
+	 * @param name the /graphML file name
+	 * @return <0 if there was a problem reading the file
+	 */
+	int readTopologyIgraph(const char *name);
+	/**
+	 * @brief reads the topology in a single pass over the graphML file, building the igraph graph, the node and edge
+	 * indexes and the LID arrays while parsing.
+	 *
+	 * It understands the directed GraphML written by the deployment tool and by igraph (data keys mapped through their
+	 * attr.name). Nothing is changed if the file cannot be parsed.
+	 *
+	 * @param name the /graphML file name
+	 * @return <0 if the file could not be read or parsed
+	 */
+	int readTopologyFast(const char *name);
     /** @brief report the Topology to MOLY for monitoring
      *
      */
@@ -91,6 +139,8 @@ public:
 	 * RVFID: the FID from each node in the network to the RV node
 	 * TMFID: the FID from each node in the network to the TM node
 	 * TM_to_nodeFID: the FID from the TM to each node in the network
+	 *
+	 * The three sets are derived from shortest path trees that updateGraph repairs incrementally on link failures.
 	 */
 	void calculateRVTMFIDs();
 	/**@brief used internally by the above method.
@@ -123,6 +173,9 @@ public:
 	 * carefull, the function assumes persistent vertex Ids, meaning vertices don't get deleted from the graph
 	 * different function will be required for considering add/remove vertices
 	 *
+	 * On removal, only the parts of the RV/TM shortest path trees below the removed edges are recomputed. On addition,
+	 * the trees are rebuilt. In both cases the nodes whose RV/TM paths changed are left in rerouted_nodes.
+	 *
 	 * @param srouce source of the edge (notification publisher)
 	 * @param destination the node on the other side of the link
 	 * @param bidirectional the type of update, uni- or bi-directional
@@ -139,12 +192,39 @@ public:
 	 * updateLinkState(const LSMPacket &ptk)
 	 */
 	virtual void updateLinkState(const string &lid, const QoSList &status);
+	/**@brief converts a '0'/'1' LID string (as stored in the graphML) to its word representation
+	 *
+	 * @param lid the LID string, FID_LEN * 8 characters long
+	 * @param words the resulting words
+	 */
+	static void LIDStringToWords(const char *lid, LIDWords &words);
+	/**@brief ORs the words of an identifier into a Bitvector of FID_LEN * 8 bits
+	 */
+	static void orWordsIntoBitvector(const LIDWords &words, Bitvector &bv);
+	/**@brief it calculates the LIPSIN identifier of a given path vector
+	 *
+	 * @param path a path vector (NODEID->NODEID->...) as produced by calculateFID
+	 * @return a pointer to the FID, including the internal link identifier of the last node, or NULL if a link of the path is not in the graph
+	 */
+	Bitvector *calculatePathFID(const string &path);
+	/**@brief splits a path vector into its node labels
+	 */
+	static void splitPathVector(const string &path, vector<string> &nodes);
+	/**@brief joins node labels into a path vector
+	 */
+	static string joinPathVector(const vector<string> &nodes);
 	
 	
 public:
 	/**@brief the igraph graph
 	 */
 	igraph_t graph;
+	/**@brief the LIDs of the graph edges as words, indexed by igraph edge id (kept next to edge_LID)
+	 */
+	vector<LIDWords> edge_LID_words;
+	/**@brief the internal LIDs of the graph vertices as words, indexed by igraph vertex id
+	 */
+	vector<LIDWords> vertex_iLID_words;
 protected:
 	
 	/**
@@ -153,6 +233,42 @@ protected:
 	 * Each "line"/entry represents the network plane for a specific queueing priority
 	 */
 	virtual void createNewQoSLinkPrioMap(const uint8_t & prio);
+	/**@brief the FID of the tree path between the root of tree and vertex, including the iLID of the path's destination
+	 *
+	 * @return an all-zero FID if vertex is unreachable
+	 */
+	Bitvector *calculateTreeFID(const TMSPTree &tree, int vertex);
+	/**@brief (re)builds the TM_to_node, node_to_TM and node_to_RV shortest path trees
+	 */
+	void buildRVTMTrees();
+	/**@brief shortest paths from the TM to every node
+	 */
+	TMSPTree TM_to_node_tree;
+	/**@brief shortest paths from every node to the TM
+	 */
+	TMSPTree node_to_TM_tree;
+	/**@brief shortest paths from every node to the RV
+	 */
+	TMSPTree node_to_RV_tree;
+	/**@brief runs a Dijkstra from root over the weights of a QoS priority plane
+	 */
+	void buildQoSSPTree(int root, const igraph_vector_t *weights, QoSSPTree &tree);
+	/**@brief sets the weight of an edge in a QoS priority plane and drops the cached trees of the plane that it affects:
+	 * a heavier edge only affects the trees using it, a lighter one also the trees it would now shorten
+	 */
+	void updateQoSWeight(igraph_vector_t *weights, int eid, igraph_real_t weight);
+	/**@brief drops a cached QoS tree and its entries in the edge index
+	 */
+	void eraseQoSSPTree(const QoSSPTreeKey &key);
+	/**@brief cached weighted shortest path trees per QoS priority plane and source
+	 */
+	map<QoSSPTreeKey, QoSSPTree> qos_trees;
+	/**@brief an index that maps igraph edge ids to the cached QoS trees using them
+	 */
+	map<int, set<QoSSPTreeKey> > qos_tree_edges;
+	/**@brief protects qos_trees and qos_tree_edges between concurrent path requests
+	 */
+	pthread_mutex_t qos_trees_mutex;
 	
 	
 };
@@ -19,9 +19,209 @@
 
 #include "tm_max_flow.hpp" // XXX: Include this first
 #include <float.h>
+#include <iostream>
+#include <pthread.h>
 #include <boost/graph/copy.hpp>
+#include <boost/property_map/property_map.hpp>
 using namespace boost;
 
+// weight of the previous length function in the warm-started initial
+// lengths, 0 is a cold start and 1 starts from the previous lengths
+static const double warm_length_weight = 0.5;
+
+// one Dijkstra with its own colour map, so that several of them can
+// run on the same (unchanging) graph at once
+static void shortest_path_tree(const NetGraph &g, Vertex source,
+			       std::vector<Vertex> &penult,
+			       std::vector<double> &dist) {
+  std::vector<default_color_type> color(num_vertices(g));
+  dijkstra_shortest_paths(g, source,
+			  predecessor_map(&penult[0]).distance_map(&dist[0]).
+			  color_map(make_iterator_property_map(color.begin(),
+							       get(vertex_index,g))));
+}
+
+struct sp_tree_job {
+  const NetGraph *g;
+  const std::vector<Vertex> *sources;
+  std::vector<std::vector<Vertex> > *penults;
+  std::vector<std::vector<double> > *dists;
+};
+
+static void sp_tree_slots(const sp_tree_job &job, unsigned int first,
+			  unsigned int step) {
+  for(unsigned int i=first; i<job.sources->size(); i+=step) {
+    shortest_path_tree(*job.g, (*job.sources)[i],
+		       (*job.penults)[i], (*job.dists)[i]);
+  }
+}
+
+// threads kept for a whole max-flow run, so that the shortest path trees
+// of every phase do not create and join their own threads: run() wakes
+// them up with a new generation and waits until all of them are done
+struct sp_tree_pool {
+  struct worker {
+    sp_tree_pool *pool;
+    unsigned int index;
+    pthread_t thread;
+  };
+  pthread_mutex_t mutex;
+  pthread_cond_t start;
+  pthread_cond_t done;
+  unsigned long generation;
+  unsigned int running;
+  bool stop;
+  sp_tree_job job;
+  std::vector<worker> workers;
+
+  sp_tree_pool(unsigned int num_threads)
+    : generation(0), running(0), stop(false) {
+    pthread_mutex_init(&mutex,NULL);
+    pthread_cond_init(&start,NULL);
+    pthread_cond_init(&done,NULL);
+    // the caller computes slot 0, a thread that cannot be created
+    // leaves its slots to the others
+    workers.resize(num_threads > 1 ? num_threads - 1 : 0);
+    unsigned int started = 0;
+    for(unsigned int t=0; t<workers.size(); t++) {
+      workers[started].pool = this;
+      workers[started].index = started + 1;
+      if(pthread_create(&workers[started].thread,NULL,main,
+			&workers[started]) == 0) {
+	started++;
+      }
+    }
+    workers.resize(started);
+  }
+
+  ~sp_tree_pool() {
+    pthread_mutex_lock(&mutex);
+    stop = true;
+    pthread_cond_broadcast(&start);
+    pthread_mutex_unlock(&mutex);
+    for(unsigned int t=0; t<workers.size(); t++) {
+      pthread_join(workers[t].thread,NULL);
+    }
+    pthread_cond_destroy(&done);
+    pthread_cond_destroy(&start);
+    pthread_mutex_destroy(&mutex);
+  }
+
+  unsigned int size() const {
+    return workers.size() + 1;
+  }
+
+  void run(const sp_tree_job &new_job) {
+    pthread_mutex_lock(&mutex);
+    job = new_job;
+    running = workers.size();
+    generation++;
+    pthread_cond_broadcast(&start);
+    pthread_mutex_unlock(&mutex);
+    sp_tree_slots(new_job,0,size());
+    pthread_mutex_lock(&mutex);
+    while(running > 0) {
+      pthread_cond_wait(&done,&mutex);
+    }
+    pthread_mutex_unlock(&mutex);
+  }
+
+  static void *main(void *arg) {
+    worker *w = (worker *) arg;
+    sp_tree_pool *pool = w->pool;
+    unsigned long seen = 0;
+    pthread_mutex_lock(&pool->mutex);
+    while(true) {
+      while(!pool->stop && pool->generation == seen) {
+	pthread_cond_wait(&pool->start,&pool->mutex);
+      }
+      if(pool->stop) {
+	break;
+      }
+      seen = pool->generation;
+      sp_tree_job job = pool->job;
+      unsigned int step = pool->size();
+      pthread_mutex_unlock(&pool->mutex);
+      sp_tree_slots(job,w->index,step);
+      pthread_mutex_lock(&pool->mutex);
+      if(--pool->running == 0) {
+	pthread_cond_signal(&pool->done);
+      }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+  }
+};
+
+// keeps a pool of num_threads threads for as long as it is in scope,
+// unless an enclosing call already has one
+class sp_tree_pool_scope {
+public:
+  sp_tree_pool_scope(sp_tree_pool *&pool, unsigned int num_threads)
+    : pool(pool), owner(pool == NULL && num_threads > 1) {
+    if(owner) {
+      pool = new sp_tree_pool(num_threads);
+    }
+  }
+  ~sp_tree_pool_scope() {
+    if(owner) {
+      delete pool;
+      pool = NULL;
+    }
+  }
+private:
+  sp_tree_pool *&pool;
+  bool owner;
+};
+
+void Graph_mf::commodity_sources(std::vector<mf_demand> &demands,
+				 std::vector<Vertex> &sources,
+				 std::vector<int> &source_slot) {
+  source_slot.assign(num_vertices(*this),-1);
+  sources.clear();
+  std::vector<mf_demand>::iterator di;
+  for(di=demands.begin(); di != demands.end(); di++) {
+    if(source_slot[di->source] < 0) {
+      source_slot[di->source] = sources.size();
+      sources.push_back(di->source);
+    }
+  }
+}
+
+// shortest path trees in gdual of all sources, source i is computed by
+// pool thread i % size so the result does not depend on the threads
+void Graph_mf::shortest_path_trees(const std::vector<Vertex> &sources,
+				   std::vector<std::vector<Vertex> > &penults,
+				   std::vector<std::vector<double> > &dists) {
+  int N = num_vertices(gdual);
+  penults.assign(sources.size(),std::vector<Vertex>(N));
+  dists.assign(sources.size(),std::vector<double>(N));
+  sp_tree_job job;
+  job.g = &gdual;
+  job.sources = &sources;
+  job.penults = &penults;
+  job.dists = &dists;
+  if(pool == NULL || sources.size() < 2) {
+    sp_tree_slots(job,0,1);
+  } else {
+    pool->run(job);
+  }
+}
+
+// length of the tree path from source to sink, DBL_MAX if the sink
+// is not reachable (dijkstra leaves its predecessor at itself)
+double Graph_mf::path_length(const std::vector<Vertex> &penult,
+			     Vertex source, Vertex sink) {
+  double l = 0;
+  for(Vertex f = sink; f != source; f = penult[f]) {
+    if(penult[f] == f) {
+      return(DBL_MAX);
+    }
+    l += get(edge_weight,gdual,edge(penult[f],f,gdual).first);
+  }
+  return(l);
+}
+
 inline double Graph_mf::calcD() {
   using namespace boost;
   double sum =0.0;
@@ -75,6 +275,7 @@ inline double Graph_mf::calcLambda(std::vector<mf_demand> &demands) {
   return(lambda);
 }
 void Graph_mf:: sp_concurrent_flow(std::vector<mf_demand> &demands) {
+  sp_tree_pool_scope pool_scope(pool,num_threads);
 
   std::vector<mf_demand>::iterator di;
   for(di=demands.begin(); di != demands.end(); di++) {
@@ -90,7 +291,6 @@ void Graph_mf:: sp_concurrent_flow(std::vector<mf_demand> &demands) {
   for(int i=0 ; i<num_dem; i++) {
     demands[i].flow = 0;
   }
-  int N = num_vertices(*this);
   number_flows = 0;
 
   graph_traits < NetGraph >::edge_iterator ei, eend;
@@ -105,26 +305,34 @@ void Graph_mf:: sp_concurrent_flow(std::vector<mf_demand> &demands) {
 	     vertex(t,gflow),gflow);
     put(edge_weight,gflow,e.first,0.0);
   }
+  // the lengths do not change, so calculate the shortest path tree
+  // of every source at once
+  std::vector<Vertex> sources;
+  std::vector<int> source_slot;
+  std::vector<std::vector<Vertex> > penults;
+  std::vector<std::vector<double> > dists;
+  commodity_sources(demands,sources,source_slot);
+  shortest_path_trees(sources,penults,dists);
   // for each demand
   for(int i=0; i<num_dem;i++) {
     mf_demand demand = demands[i];
 
-    std::vector<Vertex> penult(N);
-    std::vector<double> dist(N);
     std::vector<mf_demand>::iterator vi,ve;
     Vertex source = demand.source;
     Vertex sink = demand.sink;
     Vertex f,p;
+    std::vector<Vertex> &penult = penults[source_slot[source]];
 
-    // calculated shortest path
-    dijkstra_shortest_paths(gdual, source,
-			    predecessor_map(&penult[0]).distance_map(&dist[0]));
     // record the path (in reverse as its easier from penult)
     // and add to the weight (flow) in gflow
     std::list<Vertex> path;
 
     f = sink;
     p = penult[f];
+    if(p == f) {
+      // no path, the demand cannot be routed
+      continue;
+    }
 
     std::pair<Edge, bool> ed = edge(p,f,gdual);
 
@@ -158,16 +366,17 @@ void Graph_mf:: sp_concurrent_flow(std::vector<mf_demand> &demands) {
 
 double Graph_mf::calcBeta(std::vector<mf_demand> &demands) {
   double Alpha=0;
-  int N = num_vertices(*this);
 
   std::vector<mf_demand>::iterator di;
-  std::vector<Vertex> penult(N);
-  std::vector<double> dist(N);
+  std::vector<Vertex> sources;
+  std::vector<int> source_slot;
+  std::vector<std::vector<Vertex> > penults;
+  std::vector<std::vector<double> > dists;
+  commodity_sources(demands,sources,source_slot);
+  shortest_path_trees(sources,penults,dists);
 
   for(di=demands.begin(); di != demands.end(); di++) {
-    dijkstra_shortest_paths(gdual, di->source,
-			    predecessor_map(&penult[0]).distance_map(&dist[0]));
-    Alpha += (*di).demand * dist[di->sink];
+    Alpha += (*di).demand * dists[source_slot[di->source]][di->sink];
   }
   double D= calcD();
   return(D/Alpha);
@@ -196,6 +405,7 @@ void Graph_mf::rescale_demands_flows(std::vector<mf_demand> &demands,double scal
 
 void Graph_mf:: max_concurrent_flow_prescaled(std::vector<mf_demand> &demands,
 					      double e) {
+  sp_tree_pool_scope pool_scope(pool,num_threads);
 
   std::vector<mf_demand> save_demands = demands;
   long num_dem=demands.size();
@@ -219,13 +429,121 @@ void Graph_mf:: max_concurrent_flow_prescaled(std::vector<mf_demand> &demands,
 
 void Graph_mf:: min_congestion_flow(std::vector<mf_demand> &demands,
 				     double e) {
+  sp_tree_pool_scope pool_scope(pool,num_threads);
   max_concurrent_flow_prescaled(demands,e);
   rescale_demands_flows(demands,1/lambda);
   assign_gflow(demands);
 }
 
+double Graph_mf::demand_change(std::vector<mf_demand> &demands) {
+  // relative L1 distance between the normalised demand matrices, the
+  // routing does not change when all demands are scaled alike
+  double old_sum = 0, new_sum = 0, change = 0;
+  if(warm_demands.size() != demands.size()) {
+    return DBL_MAX;
+  }
+  for(unsigned int i=0; i<demands.size(); i++) {
+    if(warm_demands[i].source != demands[i].source ||
+       warm_demands[i].sink != demands[i].sink) {
+      return DBL_MAX;
+    }
+    old_sum += warm_demands[i].demand;
+    new_sum += demands[i].demand;
+  }
+  if(old_sum <= 0 || new_sum <= 0) {
+    return DBL_MAX;
+  }
+  for(unsigned int i=0; i<demands.size(); i++) {
+    change += fabs(demands[i].demand / new_sum -
+		   warm_demands[i].demand / old_sum);
+  }
+  return(change);
+}
+
+bool Graph_mf::warm_flows(std::vector<mf_demand> &demands) {
+  // route the new demands with the path split of the previous solution
+  for(unsigned int i=0; i<demands.size(); i++) {
+    mf_demand &prev = warm_demands[i];
+    if(prev.flow <= 0 || prev.path_flow_map.empty()) {
+      return false;
+    }
+    demands[i].path_flow_map = prev.path_flow_map;
+    std::map<const std::list<Vertex>,double>::iterator mi;
+    for(mi=demands[i].path_flow_map.begin() ;
+	mi != demands[i].path_flow_map.end(); mi++) {
+      mi->second = mi->second / prev.flow * demands[i].demand;
+    }
+    demands[i].flow = demands[i].demand;
+  }
+  assign_gflow(demands);
+  lambda = DBL_MAX;
+  graph_traits < NetGraph >::edge_iterator ei, eend;
+  for(tie(ei,eend) = edges(gflow); ei != eend; ei++) {
+    double w = get(edge_weight,gflow,*ei);
+    double c = get(edge_capacity,gflow,*ei);
+    if(w > 0) {
+      lambda = c/w < lambda ? c/w : lambda;
+    }
+  }
+  gamma= 1.0 - 1.0/lambda;
+  return(true);
+}
+
+void Graph_mf::save_warm(std::vector<mf_demand> &demands) {
+  warm_demands = demands;
+  warm_lengths.clear();
+  graph_traits < NetGraph >::edge_iterator ei, eend;
+  for(tie(ei,eend) = edges(gdual); ei != eend; ei++) {
+    double l = get(edge_weight,gdual,*ei);
+    double c = get(edge_capacity,gdual,*ei);
+    warm_lengths[std::make_pair(source(*ei,gdual),target(*ei,gdual))] = l*c;
+  }
+}
+
+void Graph_mf:: min_congestion_flow_warm(std::vector<mf_demand> &demands,
+					  double e, double exit_e) {
+  sp_tree_pool_scope pool_scope(pool,num_threads);
+  double change = demand_change(demands);
+  if(change == DBL_MAX || !warm_flows(demands)) {
+    min_congestion_flow(demands,e);
+    save_warm(demands);
+    return;
+  }
+  if(change <= exit_e) {
+    // the previous split is still within the approximation, the flows
+    // are already the demands as min_congestion_flow returns them
+    // (warm_demands is kept so that small changes cannot accumulate)
+    std::cout<<"min congestion flow: demand change "<<change
+	     <<" reusing previous paths"<<std::endl;
+    return;
+  }
+  std::cout<<"min congestion flow: demand change "<<change
+	   <<" warm start"<<std::endl;
+  // the previous split is a feasible concurrent flow so lambda is a
+  // lower bound of the optimum, it replaces the shortest path and
+  // 2-approximate prescaling passes of max_concurrent_flow_prescaled
+  std::vector<mf_demand> save_demands = demands;
+  long num_dem=demands.size();
+  rescale_demands(demands,lambda);
+  max_concurrent_flow(demands,e,true);
+  for(int i=0; i<num_dem; i++) {
+    demands[i].demand = save_demands[i].demand;
+  }
+  lambda = calcLambda(demands);
+  beta = calcBeta(demands);
+  rescale_demands_flows(demands,1/lambda);
+  assign_gflow(demands);
+  save_warm(demands);
+}
+
 void Graph_mf::  max_concurrent_flow(std::vector<mf_demand> &demands,
 				     double e) {
+  sp_tree_pool_scope pool_scope(pool,num_threads);
+  max_concurrent_flow(demands,e,false);
+}
+
+void Graph_mf::  max_concurrent_flow(std::vector<mf_demand> &demands,
+				     double e, bool warm) {
 
   std::vector<mf_demand>::iterator di;
   for(di=demands.begin(); di != demands.end(); di++) {
@@ -241,7 +559,6 @@ void Graph_mf::  max_concurrent_flow(std::vector<mf_demand> &demands,
   for(int i=0 ; i<num_dem; i++) {
     demands[i].flow = 0;
   }
-  int N = num_vertices(*this);
   int m = num_edges(*this);
   number_flows = 0;
   double delta = pow(double(m) / (1.0 - e),-1.0/e);
@@ -254,7 +571,18 @@ void Graph_mf::  max_concurrent_flow(std::vector<mf_demand> &demands,
     std::pair<Edge, bool> e = edge(vertex(s,gdual),
 				   vertex(t,gdual),gdual);
     double c = get(edge_capacity,gdual,e.first);
-    put(edge_weight,gdual,e.first,delta/c);
+    double lc = delta;
+    if(warm) {
+      // geometric mean of the cold start length and the previous final
+      // length: never below delta, so the final scaling stays feasible
+      std::map<std::pair<vertex_descriptor, vertex_descriptor>, double>::iterator wi =
+	warm_lengths.find(std::make_pair(vertex_descriptor(s),vertex_descriptor(t)));
+      if(wi != warm_lengths.end() && wi->second > delta) {
+	double prev = wi->second < 1.0 ? wi->second : 1.0;
+	lc = pow(delta,1.0-warm_length_weight) * pow(prev,warm_length_weight);
+      }
+    }
+    put(edge_weight,gdual,e.first,lc/c);
   }
 	
 
@@ -268,9 +596,12 @@ void Graph_mf::  max_concurrent_flow(std::vector<mf_demand> &demands,
   int phases =0;
   totalphases =0;
   
-  std::vector<Vertex> penult(N);
-  std::vector<double> dist(N);
   std::vector<mf_demand>::iterator vi,ve;
+  std::vector<Vertex> sources;
+  std::vector<int> source_slot;
+  std::vector<std::vector<Vertex> > penults;
+  std::vector<std::vector<double> > dists;
+  commodity_sources(demands,sources,source_slot);
 
 
   std::vector<int> demand_index(num_dem);
@@ -291,7 +622,11 @@ void Graph_mf::  max_concurrent_flow(std::vector<mf_demand> &demands,
       phases = 0;
       }*/
     // steps
+    double phase_D = D;
     random_shuffle(demand_index.begin(),demand_index.end());
+    // shortest path trees of all sources for the lengths at the start
+    // of the phase, calculated in parallel
+    shortest_path_trees(sources,penults,dists);
 	  
     for(int j=0; j<num_dem;j++) {
       int i= demand_index[j];
@@ -302,8 +637,18 @@ void Graph_mf::  max_concurrent_flow(std::vector<mf_demand> &demands,
 
       //iterations
       while( D < 1.0 && demand.demand > 0) {
-	dijkstra_shortest_paths(gdual, source,
-				predecessor_map(&penult[0]).distance_map(&dist[0]));
+	// lengths only grow, so the tree distance is a lower bound and
+	// the tree path is used while it is a (1+e)-approximate shortest
+	// path, otherwise the tree is recalculated with the current lengths
+	int slot = source_slot[source];
+	std::vector<Vertex> &penult = penults[slot];
+	if(path_length(penult,source,sink) > (1+e) * dists[slot][sink]) {
+	  shortest_path_tree(gdual,source,penult,dists[slot]);
+	}
+	if(penult[sink] == sink) {
+	  // no path, the demand cannot be routed
+	  break;
+	}
 
 	// go through the path (backwards) and find minimum capacity
 	f = sink;
@@ -375,9 +720,22 @@ void Graph_mf::  max_concurrent_flow(std::vector<mf_demand> &demands,
     }
     phases++;
     totalphases++;
+    if(D == phase_D) {
+      // nothing could be routed (all sinks left are unreachable)
+      break;
+    }
   }
   
   double scalef = 1.0 / (log(1.0/delta) / log(1+e) );
+  if(warm) {
+    // the lengths did not all start at delta, so scale by the actual
+    // congestion rather than by the worst case number of augmentations,
+    // unless nothing was routed (congestion 0) and the cold scale is kept
+    double congestion = 1.0 - assign_gflow(demands);
+    if(congestion > 0 && congestion < DBL_MAX) {
+      scalef = 1.0 / congestion;
+    }
+  }
   rescale_demands_flows(demands,scalef);
   lambda = calcLambda(demands);
   beta = calcBeta(demands);
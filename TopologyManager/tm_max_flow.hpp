@@ -21,6 +21,7 @@
 #define MAX_FLOW_HPP
 #include <vector>
 #include <list>
+#include <map>
 #include <utility>
 
 // This required to stop warning about depcricated header in Boost Graph library
@@ -30,6 +31,7 @@
 #include <boost/graph/dijkstra_shortest_paths.hpp>
 
 class mf_demand;
+struct sp_tree_pool;
 
 typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS,
 			      boost::property<boost::vertex_color_t, 
@@ -46,22 +48,24 @@ public:
   typedef NetGraph::edges_size_type edges_size_type;
   
   long number_flows;
+  // threads computing the shortest path trees of the commodity sources
+  unsigned int num_threads;
    Graph_mf()
-    : NetGraph() { }
+    : NetGraph(), num_threads(1), pool(NULL) { }
    Graph_mf(const graph_property_type& p)
-  : NetGraph(p) { }
+  : NetGraph(p), num_threads(1), pool(NULL) { }
    Graph_mf(const NetGraph& x)
-  : NetGraph(x) { }
+  : NetGraph(x), num_threads(1), pool(NULL) { }
    Graph_mf(vertices_size_type num_vertices)
-  : NetGraph(num_vertices) { }
+  : NetGraph(num_vertices), num_threads(1), pool(NULL) { }
    Graph_mf(vertices_size_type num_vertices,
 		  const graph_property_type& p)
-    : NetGraph(num_vertices, p) { }
+    : NetGraph(num_vertices, p), num_threads(1), pool(NULL) { }
 
    Graph_mf(int num_vertices,
 		  const std::vector< int > &edges,
 		  const std::vector<double> &capacities)
-    : NetGraph(num_vertices)
+    : NetGraph(num_vertices), num_threads(1), pool(NULL)
   {
     int NE = edges.size()/2;
     for (int i = 0, j=0; i < NE ;  i++, j+=2 ) {
@@ -79,7 +83,12 @@ public:
 				     double e);
   void min_congestion_flow(std::vector<mf_demand> &demands,
 			   double e);
-
+  // as min_congestion_flow but warm-started from the previous call:
+  // if the (normalised) demands moved by less than exit_e the previous
+  // path split is reused as is, otherwise the previous flows give the
+  // prescaling and the previous length function the initial lengths
+  void min_congestion_flow_warm(std::vector<mf_demand> &demands,
+				double e, double exit_e);
 
 
   NetGraph gdual;
@@ -95,6 +104,25 @@ private:
   double calcBeta(std::vector<mf_demand> &demands);
   double calcLambda(std::vector<mf_demand> &demands);
   double assign_gflow(std::vector<mf_demand> &demands);
+  void max_concurrent_flow(std::vector<mf_demand> &demands,
+			   double e, bool warm);
+  double demand_change(std::vector<mf_demand> &demands);
+  bool warm_flows(std::vector<mf_demand> &demands);
+  void save_warm(std::vector<mf_demand> &demands);
+  void commodity_sources(std::vector<mf_demand> &demands,
+			 std::vector<vertex_descriptor> &sources,
+			 std::vector<int> &source_slot);
+  void shortest_path_trees(const std::vector<vertex_descriptor> &sources,
+			   std::vector<std::vector<vertex_descriptor> > &penults,
+			   std::vector<std::vector<double> > &dists);
+  double path_length(const std::vector<vertex_descriptor> &penult,
+		     vertex_descriptor source, vertex_descriptor sink);
+  // threads of the shortest path trees while a max-flow run is going on
+  sp_tree_pool *pool;
+  // solution of the last min_congestion_flow_warm call
+  std::vector<mf_demand> warm_demands;
+  // final length * capacity of each edge of the last solution
+  std::map<std::pair<vertex_descriptor, vertex_descriptor>, double> warm_lengths;
 };
 
 typedef boost::graph_traits < NetGraph >::edge_descriptor Edge;
@@ -0,0 +1,237 @@
+/*
+ * This file is part of Blackadder.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+/*
+ * Concurrency stress test for the IIMetaCache of the TM: a number of
+ * threads query, look up and update the QoS meta data of random items, as
+ * the TM request workers do, on a cache much smaller than the item space,
+ * so that items are evicted and their queries expire all the time. The
+ * test stands in for the Blackadder node on its event socket (the netlink
+ * address PID_BLACKADDER, so no node may run at the same time) and keeps
+ * track of the meta data subscriptions the cache makes. It checks that
+ * lookups only return the priority an item was updated with (or the
+ * default), that no unsubscription arrives before its subscription, and
+ * at the end that every shard is within its capacity with a consistent
+ * eviction order and that the items still subscribed are exactly the
+ * querying ones.
+ *
+ * Usage: tm_metastress [threads] [seconds] [items] [cache size]
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <linux/netlink.h>
+#include "tm_qos.hpp"
+
+class IIMetaStressCache : public IIMetaCache {
+public:
+	IIMetaStressCache(size_t max_entries) : IIMetaCache(max_entries) {
+	}
+	/*checks every shard, adds the querying items to querying and returns the number of inconsistencies*/
+	unsigned int check(set<string> &querying) {
+		unsigned int wrong = 0;
+		for (int i = 0; i < META_CACHE_SHARDS; i++) {
+			IIMetaCacheShard &shard = shards[i];
+			pthread_rwlock_rdlock(&shard.lock);
+			if (shard.ii_meta.size() > shard_capacity || shard.lru.size() != shard.ii_meta.size()) {
+				wrong++;
+			}
+			for (IIMetaDataMap::iterator it = shard.ii_meta.begin(); it != shard.ii_meta.end(); it++) {
+				if (*it->second.lru != it->first) {
+					wrong++;
+				}
+				if (it->second.querying) {
+					querying.insert(it->first.substr(0, it->first.length() - PURSUIT_ID_LEN) + getQoSID(it->first));
+				}
+			}
+			pthread_rwlock_unlock(&shard.lock);
+		}
+		return wrong;
+	}
+};
+
+static int sock_fd;
+static Blackadder *ba;
+static IIMetaStressCache *cache;
+static unsigned int no_items;
+static volatile bool stopping;
+static volatile bool running;
+/*the subscriptions the node has got, by prefix and identifier*/
+static map<string, int> subscriptions;
+static unsigned int subscribes, unsubscribes, overtaken, wrong_prio;
+
+/*an item of the scope "QQQQQQQQ", the priority it is updated with only depends on it*/
+static string itemID(unsigned int i) {
+	string id(PURSUIT_ID_LEN, '\0');
+	memcpy(&id[0], &i, sizeof(i));
+	return string(PURSUIT_ID_LEN, 'Q') + id;
+}
+
+static uint16_t itemPrio(unsigned int i) {
+	return 1 + i % 90;
+}
+
+/*records the (un)subscriptions of the cache, until it has been quiet for a timeout after stopping*/
+static void *node_loop(void *arg) {
+	unsigned char buffer[65536];
+	int bytes;
+	while (true) {
+		bytes = recv(sock_fd, buffer, sizeof(buffer), 0);
+		if (bytes < 0) {
+			if (stopping || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+				break;
+			}
+			continue;
+		}
+		unsigned char *p = buffer + sizeof(struct nlmsghdr);
+		if (bytes < (int) sizeof(struct nlmsghdr) + 2 || (p[0] != SUBSCRIBE_INFO && p[0] != UNSUBSCRIBE_INFO)) {
+			continue;
+		}
+		string id((char *) p + 2, p[1] * PURSUIT_ID_LEN);
+		string prefix_id((char *) p + 3 + id.length(), p[2 + id.length()] * PURSUIT_ID_LEN);
+		if (p[0] == SUBSCRIBE_INFO) {
+			subscriptions[prefix_id + id]++;
+			subscribes++;
+		} else if (--subscriptions[prefix_id + id] < 0) {
+			overtaken++;
+		} else {
+			unsubscribes++;
+		}
+	}
+	return NULL;
+}
+
+/*a TM request worker: queries the meta data of random items and answers its own queries later, as the meta data publications do*/
+static void *worker_loop(void *arg) {
+	unsigned int seed = (unsigned long) arg;
+	list<unsigned int> queried;
+	QoSList qos;
+	while (running) {
+		unsigned int i = rand_r(&seed) % no_items;
+		string ii = itemID(i);
+		switch (rand_r(&seed) % 4) {
+		case 0:
+			if (cache->sendQueryIfNeeded(ii, ba)) {
+				queried.push_back(i);
+			}
+			break;
+		case 1:
+			if (!queried.empty()) {
+				i = queried.front();
+				queried.pop_front();
+				qos.clear();
+				qos[QoS_PRIO] = itemPrio(i);
+				cache->update(itemID(i), qos, ba);
+			}
+			break;
+		case 2: {
+			uint16_t prio = cache->getIIQoSPrio(ii, ba);
+			if (prio != DEFAULT_QOS_PRIO && prio != itemPrio(i)) {
+				__sync_fetch_and_add(&wrong_prio, 1);
+			}
+			break;
+		}
+		default:
+			qos.clear();
+			if (cache->getIIMeta(ii, qos, ba) && !qos.empty() && qos[QoS_PRIO] != itemPrio(i)) {
+				__sync_fetch_and_add(&wrong_prio, 1);
+			}
+			cache->exists(ii);
+			cache->quering(ii);
+		}
+	}
+	return NULL;
+}
+
+int main(int argc, char* argv[]) {
+	unsigned int no_threads = 8;
+	double seconds = 3;
+	size_t cache_size = 1024;
+	struct sockaddr_nl s_nladdr;
+	struct timeval timeout = {1, 0};
+	pthread_t node;
+	vector<pthread_t> workers;
+	set<string> querying;
+	unsigned int wrong, stale = 0;
+	no_items = 8192;
+	if (argc > 1) {
+		no_threads = atoi(argv[1]);
+	}
+	if (argc > 2) {
+		seconds = atof(argv[2]);
+	}
+	if (argc > 3) {
+		no_items = atoi(argv[3]);
+	}
+	if (argc > 4) {
+		cache_size = atoi(argv[4]);
+	}
+	sock_fd = socket(AF_NETLINK, SOCK_RAW, NETLINK_GENERIC);
+	memset(&s_nladdr, 0, sizeof(s_nladdr));
+	s_nladdr.nl_family = AF_NETLINK;
+	s_nladdr.nl_pid = PID_BLACKADDER;
+	if (sock_fd < 0 || bind(sock_fd, (struct sockaddr *) &s_nladdr, sizeof(s_nladdr)) < 0) {
+		perror("tm_metastress: the event socket of the node is not free");
+		exit(EXIT_FAILURE);
+	}
+	setsockopt(sock_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	pthread_create(&node, NULL, node_loop, NULL);
+	/*the cache reports items it cannot update on cerr, which is expected here*/
+	ofstream null("/dev/null");
+	streambuf *cerr_buf = cerr.rdbuf(null.rdbuf());
+	ba = Blackadder::Instance(true);
+	cache = new IIMetaStressCache(cache_size);
+	running = true;
+	for (unsigned long t = 0; t < no_threads; t++) {
+		pthread_t worker;
+		pthread_create(&worker, NULL, worker_loop, (void *) (t + 1));
+		workers.push_back(worker);
+	}
+	usleep(seconds * 1e6);
+	running = false;
+	for (unsigned int t = 0; t < workers.size(); t++) {
+		pthread_join(workers[t], NULL);
+	}
+	/*every request has been sent, the node is done when it has been quiet for a second*/
+	stopping = true;
+	pthread_join(node, NULL);
+	wrong = cache->check(querying);
+	for (map<string, int>::iterator it = subscriptions.begin(); it != subscriptions.end(); it++) {
+		if ((*it).second != (querying.find((*it).first) != querying.end() ? 1 : 0)) {
+			stale++;
+		}
+	}
+	for (set<string>::iterator it = querying.begin(); it != querying.end(); it++) {
+		if (subscriptions.find(*it) == subscriptions.end()) {
+			stale++;
+		}
+	}
+	fprintf(stderr, "%u threads, %.1fs, %u items on a cache of %u: %u subscriptions, %u unsubscriptions, %u cached items\n",
+			no_threads, seconds, no_items, (unsigned int) cache_size, subscribes, unsubscribes, (unsigned int) cache->size());
+	fprintf(stderr, "%u wrong priorities, %u unsubscriptions before their subscription, %u inconsistent shards/items, %u stale subscriptions\n",
+			wrong_prio, overtaken, wrong, stale);
+	cerr.rdbuf(cerr_buf);
+	ba->disconnect();
+	delete ba;
+	delete cache;
+	close(sock_fd);
+	return (wrong_prio == 0 && overtaken == 0 && wrong == 0 && stale == 0) ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+/*
+ * This file is part of Blackadder.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+/*
+ * Perturbed demand benchmark for the TE max-concurrent-flow: routes random
+ * source/sink demands over a topology (unit capacities, as the TE assumes
+ * them), then perturbs every demand by up to the given fraction once per
+ * period and times the two ways of getting the new min congestion flow:
+ * solving from scratch (min_congestion_flow) and warm-starting from the
+ * previous period (min_congestion_flow_warm, what the TE does now). After
+ * every period it checks that the warm-started congestion is finite and
+ * within the approximation of the cold one.
+ *
+ * Usage: tm_mfbench <topology.graphml> [demands] [periods] [perturbation]
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <float.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include "tm_igraph.hpp"
+
+static double now() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/*the largest flow / capacity of the last solution of g*/
+static double congestion(Graph_mf &g) {
+	double max = 0;
+	boost::graph_traits<NetGraph>::edge_iterator ei, eend;
+	for (boost::tie(ei, eend) = boost::edges(g.gflow); ei != eend; ei++) {
+		double w = boost::get(boost::edge_weight, g.gflow, *ei);
+		double c = boost::get(boost::edge_capacity, g.gflow, *ei);
+		max = w / c > max ? w / c : max;
+	}
+	return max;
+}
+
+int main(int argc, char* argv[]) {
+	int no_demands = 50;
+	int no_periods = 10;
+	double perturbation = 0.2;
+	double e = 0.1;
+	double cold_time = 0, warm_time = 0, worst_ratio = 0;
+	unsigned int bad = 0;
+	if (argc < 2) {
+		fprintf(stderr, "usage: tm_mfbench <topology.graphml> [demands] [periods] [perturbation]\n");
+		exit(EXIT_FAILURE);
+	}
+	if (argc > 2) {
+		no_demands = atoi(argv[2]);
+	}
+	if (argc > 3) {
+		no_periods = atoi(argv[3]);
+	}
+	if (argc > 4) {
+		perturbation = atof(argv[4]);
+	}
+	TMIgraph tm_igraph;
+	if (tm_igraph.readTopology(argv[1]) < 0) {
+		fprintf(stderr, "could not read %s\n", argv[1]);
+		exit(EXIT_FAILURE);
+	}
+	/*the max-flow graph as TEgraphMF builds it*/
+	std::vector<int> edgepairs;
+	std::vector<double> capacities;
+	for (int i = 0; i < igraph_ecount(&tm_igraph.graph); i++) {
+		igraph_integer_t head;
+		igraph_integer_t tail;
+		igraph_edge(&tm_igraph.graph, i, &head, &tail);
+		edgepairs.push_back(head);
+		edgepairs.push_back(tail);
+		capacities.push_back(1);
+	}
+	int no_vertices = igraph_vcount(&tm_igraph.graph);
+	long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	Graph_mf cold(no_vertices, edgepairs, capacities);
+	Graph_mf warm(no_vertices, edgepairs, capacities);
+	cold.num_threads = warm.num_threads = cores > 0 ? cores : 1;
+	srand(1);
+	std::vector<mf_demand> demands;
+	while ((int)demands.size() < no_demands) {
+		mf_demand demand;
+		demand.source = rand() % no_vertices;
+		demand.sink = rand() % no_vertices;
+		demand.demand = 1.0;
+		demand.flow = 0;
+		if (demand.source != demand.sink) {
+			demands.push_back(demand);
+		}
+	}
+	/*period 0 has no previous solution, both solve from scratch*/
+	std::vector<mf_demand> warm_demands = demands;
+	warm.min_congestion_flow_warm(warm_demands, e, 0.01);
+	for (int p = 1; p <= no_periods; p++) {
+		for (unsigned int d = 0; d < demands.size(); d++) {
+			demands[d].demand *= 1 + perturbation * (2.0 * rand() / RAND_MAX - 1);
+			warm_demands[d].demand = demands[d].demand;
+		}
+		std::vector<mf_demand> cold_demands = demands;
+		double start = now();
+		cold.min_congestion_flow(cold_demands, e);
+		cold_time += now() - start;
+		start = now();
+		warm.min_congestion_flow_warm(warm_demands, e, 0.01);
+		warm_time += now() - start;
+		double cold_congestion = congestion(cold);
+		double warm_congestion = congestion(warm);
+		double ratio = warm_congestion / cold_congestion;
+		/*both are (1+e)^3 approximations of the same optimum*/
+		if (!(warm_congestion > 0 && warm_congestion < DBL_MAX) || ratio > pow(1 + e, 6)) {
+			bad++;
+		}
+		worst_ratio = ratio > worst_ratio ? ratio : worst_ratio;
+	}
+	fprintf(stderr, "%s: %d demands, %d periods perturbed by up to %.0f%%, worst warm/cold congestion %.3f, %u bad\n",
+			argv[1], (int)demands.size(), no_periods, perturbation * 100, worst_ratio, bad);
+	if (no_periods > 0) {
+		fprintf(stderr, "%s: min congestion flow: cold %.3fs, warm start %.3fs per period (x%.1f)\n",
+				argv[1], cold_time / no_periods, warm_time / no_periods, cold_time / warm_time);
+	}
+	return bad == 0 ? 0 : 1;
+}
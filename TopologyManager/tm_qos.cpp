@@ -11,67 +11,150 @@
 
 #include "tm_qos.hpp"
 
-IIMetaCache::IIMetaCache(){
+IIMetaCache::IIMetaCache(size_t max_entries){
   last_non_lazy_update=time(NULL);
+  shard_capacity = max_entries / META_CACHE_SHARDS;
+  if (shard_capacity == 0) shard_capacity = 1;
+  for (int i=0; i<META_CACHE_SHARDS; i++)
+    pthread_rwlock_init(&shards[i].lock, NULL);
+}
+
+IIMetaCache::~IIMetaCache(){
+  for (int i=0; i<META_CACHE_SHARDS; i++)
+    pthread_rwlock_destroy(&shards[i].lock);
+}
+
+IIMetaCacheShard & IIMetaCache::shardOf(const string & ii){
+  // The last PURSUIT_ID_LEN bytes (the item ID) are the most random
+  size_t len = ii.length() < PURSUIT_ID_LEN ? ii.length() : PURSUIT_ID_LEN;
+  Fnv64_t hash = fnv1a_64((const unsigned char *) ii.data() + ii.length() - len, len);
+  return shards[hash % META_CACHE_SHARDS];
 }
 
 bool IIMetaCache::exists(const string & ii){
-  IIMetaDataMap::iterator it = ii_meta.find(ii);
-  return (it!=ii_meta.end());
+  IIMetaCacheShard & shard = shardOf(ii);
+  pthread_rwlock_rdlock(&shard.lock);
+  IIMetaDataMap::iterator it = shard.ii_meta.find(ii);
+  bool found = (it!=shard.ii_meta.end());
+  pthread_rwlock_unlock(&shard.lock);
+  return found;
 }
 
 
 bool IIMetaCache::quering(const string & ii){
-  IIMetaDataMap::iterator it = ii_meta.find(ii);
+  IIMetaCacheShard & shard = shardOf(ii);
+  bool querying = false;
+  pthread_rwlock_rdlock(&shard.lock);
+  IIMetaDataMap::iterator it = shard.ii_meta.find(ii);
   
   // II does not exist!
-  if (it==ii_meta.end()) return false;
+  if (it!=shard.ii_meta.end()) querying = it->second.querying;
+  pthread_rwlock_unlock(&shard.lock);
   
-  return (it->second.querying);
+  return querying;
+}
+
+size_t IIMetaCache::size(){
+  size_t total = 0;
+  for (int i=0; i<META_CACHE_SHARDS; i++){
+    pthread_rwlock_rdlock(&shards[i].lock);
+    total += shards[i].ii_meta.size();
+    pthread_rwlock_unlock(&shards[i].lock);
+  }
+  return total;
+}
+
+void IIMetaCache::eraseLocked(IIMetaCacheShard & shard, IIMetaDataMap::iterator it, Blackadder *ba){
+  // A querying II is still subscribed to its meta data
+  if (it->second.querying && ba != NULL){
+    string qos_id = getQoSID(it->first);
+    string qos_prefix = it->first.substr(0,it->first.length() - PURSUIT_ID_LEN);
+    ba->unsubscribe_info(qos_id, qos_prefix, DOMAIN_LOCAL, NULL, 0);
+  }
+  shard.lru.erase(it->second.lru);
+  shard.ii_meta.erase(it);
+}
+
+MetaDataContent & IIMetaCache::insertLocked(IIMetaCacheShard & shard, const string & ii, Blackadder *ba){
+  IIMetaDataMap::iterator it = shard.ii_meta.find(ii);
+  if (it!=shard.ii_meta.end()){
+    // Refresh its position
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lru);
+    return it->second;
+  }
+  
+  // Make room: the oldest II goes, unless it was looked up since it was
+  // last considered (second chance). Querying IIs can only go if we can
+  // unsubscribe them.
+  size_t attempts = 2 * shard.lru.size();
+  while (shard.ii_meta.size() >= shard_capacity && attempts-- > 0){
+    IIMetaDataMap::iterator victim = shard.ii_meta.find(shard.lru.back());
+    if (victim->second.referenced || (victim->second.querying && ba == NULL)){
+      victim->second.referenced = 0;
+      shard.lru.splice(shard.lru.begin(), shard.lru, victim->second.lru);
+      continue;
+    }
+    cout<<" - Evicted "<<chararray_to_hex(victim->first)<<endl;
+    eraseLocked(shard, victim, ba);
+  }
+  
+  shard.lru.push_front(ii);
+  MetaDataContent & mc = shard.ii_meta[ii];
+  mc.lru = shard.lru.begin();
+  return mc;
+}
+
+void IIMetaCache::cleanAllExpiredIfDue(Blackadder *ba){
+  time_t now = time(NULL);
+  time_t last = last_non_lazy_update;
+  // Only one of the concurrent callers does it
+  if (now - last > NON_LAZY_INT &&
+      __sync_bool_compare_and_swap(&last_non_lazy_update, last, now))
+    cleanAllExpired(ba);
 }
   
 void IIMetaCache::cleanAllExpired(Blackadder *ba){
-  IIMetaDataMap::iterator it = ii_meta.begin();
   time_t now = time(NULL);
-  for (; it!=ii_meta.end();/* ++it*/){
-    
-    // Check creation time
-    if (it->second.created>0){
-      if (now-it->second.created > EXPIRATION_TIME){
-	cout<<" - Cleaned (outdated)"<<chararray_to_hex(it->first)<<endl;
-	ii_meta.erase(it++);
-      }
-      else {
-	++it;
+  for (int i=0; i<META_CACHE_SHARDS; i++){
+    IIMetaCacheShard & shard = shards[i];
+    pthread_rwlock_wrlock(&shard.lock);
+    IIMetaDataMap::iterator it = shard.ii_meta.begin();
+    for (; it!=shard.ii_meta.end();/* ++it*/){
+      
+      // Check creation time
+      if (it->second.created>0){
+	if (now-it->second.created > EXPIRATION_TIME){
+	  cout<<" - Cleaned (outdated)"<<chararray_to_hex(it->first)<<endl;
+	  eraseLocked(shard, it++, ba);
+	}
+	else {
+	  ++it;
+	}
       }
-    }
-    
-    // Check quering ones
-    else if (it->second.querying){
-      if (now-it->second.querytime > QUERY_EXP_TIME){
-	cout<<" - Cleaned  (querying)"<<chararray_to_hex(it->first)<<endl;
-	
-	string item_id = it->first.substr(it->first.length() - PURSUIT_ID_LEN, PURSUIT_ID_LEN);
-	string item_pre = it->first.substr(0,it->first.length() - PURSUIT_ID_LEN);
-	ba->unsubscribe_info(item_id, item_pre, DOMAIN_LOCAL, NULL, 0);
-	ii_meta.erase(it++);
-      }else {
+      
+      // Check quering ones
+      else if (it->second.querying){
+	if (now-it->second.querytime > QUERY_EXP_TIME){
+	  cout<<" - Cleaned  (querying)"<<chararray_to_hex(it->first)<<endl;
+	  eraseLocked(shard, it++, ba);
+	}else {
+	  ++it;
+	}
+      }else{
 	++it;
       }
-    }else{
-      ++it;
-    }
-    
-  } // End of IIs
+      
+    } // End of IIs
+    pthread_rwlock_unlock(&shard.lock);
+  }
 }
 
 
-void IIMetaCache::checkClean(const string & ii, Blackadder *ba){
-  cout<<" - checkClean for: "<<chararray_to_hex(ii)<<endl;
-  IIMetaDataMap::iterator it = ii_meta.find(ii);
+void IIMetaCache::cleanLocked(IIMetaCacheShard & shard, const string & ii, Blackadder *ba){
+  IIMetaDataMap::iterator it = shard.ii_meta.find(ii);
   
   // II does not exist!
-  if (it==ii_meta.end()) return;
+  if (it==shard.ii_meta.end()) return;
   
   time_t now = time(NULL);
   
@@ -79,92 +162,111 @@ void IIMetaCache::checkClean(const string & ii, Blackadder *ba){
   if (it->second.created>0){
     if (now-it->second.created > EXPIRATION_TIME){
       cout<<" - Cleaned (outdated)"<<chararray_to_hex(it->first)<<endl;
-      ii_meta.erase(it);
+      eraseLocked(shard, it, ba);
     }
   }
   // Check quering ones
   else if (it->second.querying){
     if (now-it->second.querytime > QUERY_EXP_TIME){
       cout<<" - Cleaned (querying)"<<chararray_to_hex(it->first)<<endl;
-      string item_id = ii.substr(ii.length() - PURSUIT_ID_LEN, PURSUIT_ID_LEN);
-      string item_pre = ii.substr(0,ii.length() - PURSUIT_ID_LEN);
-      ba->unsubscribe_info(item_id, item_pre, DOMAIN_LOCAL, NULL, 0);
-      ii_meta.erase(it);
+      eraseLocked(shard, it, ba);
     }
   }
   
 }
 
+void IIMetaCache::checkClean(const string & ii, Blackadder *ba){
+  cout<<" - checkClean for: "<<chararray_to_hex(ii)<<endl;
+  IIMetaCacheShard & shard = shardOf(ii);
+  pthread_rwlock_wrlock(&shard.lock);
+  cleanLocked(shard, ii, ba);
+  pthread_rwlock_unlock(&shard.lock);
+}
+
  
 string IIMetaCache::getQoSID(const string & bin_item_identifier){
       string bin_item_last = bin_item_identifier.substr(bin_item_identifier.length() - PURSUIT_ID_LEN, PURSUIT_ID_LEN);
       unsigned char * qos_id_p = (unsigned char *) malloc(SHA_DIGEST_LENGTH);
       SHA1((const unsigned char*) bin_item_last.c_str(), bin_item_last.length(), qos_id_p);
       string qos_id_tmp = string((const char *) qos_id_p, PURSUIT_ID_LEN);
-      delete []qos_id_p;
+      free(qos_id_p);
       return qos_id_tmp;
   }
 
 
-QoSList * IIMetaCache::getIIMeta(const string & ii, Blackadder *ba) {
+bool IIMetaCache::getIIMeta(const string & ii, QoSList & qos, Blackadder *ba) {
   
   cout<<" - getIIMeta for: "<<chararray_to_hex(ii)<<endl;
   // Check the non-lazy
-  time_t now = time(NULL);
-  if (now - last_non_lazy_update > NON_LAZY_INT)
-    cleanAllExpired(ba);
+  cleanAllExpiredIfDue(ba);
   
+  IIMetaCacheShard & shard = shardOf(ii);
+  pthread_rwlock_wrlock(&shard.lock);
   // First of all try to clean it ... if it is needed
-  checkClean(ii,ba);
+  cleanLocked(shard, ii, ba);
   
   // Now try to find it
-  IIMetaDataMap::iterator it = ii_meta.find(ii);
+  IIMetaDataMap::iterator it = shard.ii_meta.find(ii);
   
   // II does not exist!
-  if (it==ii_meta.end()) return NULL;
-  
-  return &it->second.qos;
+  bool found = (it!=shard.ii_meta.end());
+  if (found) {
+    it->second.referenced = 1;
+    qos = it->second.qos;
+  }
+  pthread_rwlock_unlock(&shard.lock);
+  return found;
 }
 
 
 uint16_t IIMetaCache::getIIQoSPrio(const string & ii, Blackadder *ba){
   cout<<" - getIIQoSPrio for: "<<chararray_to_hex(ii)<<endl;
   // Check the non-lazy
-  time_t now = time(NULL);
-  if (now - last_non_lazy_update > NON_LAZY_INT)
-    cleanAllExpired(ba);
-  
-  // First of all try to clean it ... if it is needed
-  checkClean(ii,ba);
-  
-  // Now try to find it
-  IIMetaDataMap::iterator it = ii_meta.find(ii);
+  cleanAllExpiredIfDue(ba);
   
+  IIMetaCacheShard & shard = shardOf(ii);
+  uint16_t prio = DEFAULT_QOS_PRIO;
+  bool expired = false;
+  time_t now = time(NULL);
   
-  // II is queried now...
-  if (it->second.querying) return DEFAULT_QOS_PRIO;
+  // The common case (valid or missing II) only needs the read lock
+  pthread_rwlock_rdlock(&shard.lock);
+  IIMetaDataMap::iterator it = shard.ii_meta.find(ii);
+  if (it!=shard.ii_meta.end()){
+    MetaDataContent & mc = it->second;
+    if (mc.created>0 && now-mc.created > EXPIRATION_TIME) expired = true;
+    else if (mc.querying && now-mc.querytime > QUERY_EXP_TIME) expired = true;
+    // II is queried now...
+    else if (!mc.querying){
+      __sync_lock_test_and_set(&mc.referenced, 1);
+      QoSList::iterator qit = mc.qos.find(QoS_PRIO);
+      // QIT is now set
+      if (qit!=mc.qos.end()) prio = qit->second;
+    }
+  }
+  pthread_rwlock_unlock(&shard.lock);
   
-  // II does not exist!
-  if (it==ii_meta.end()) return DEFAULT_QOS_PRIO;
-  // Not set
-  QoSList::iterator qit = it->second.qos.find(QoS_PRIO);
-  if (qit==it->second.qos.end()) return DEFAULT_QOS_PRIO;
+  // Expired: clean it, it is then DEFAULT
+  if (expired){
+    pthread_rwlock_wrlock(&shard.lock);
+    cleanLocked(shard, ii, ba);
+    pthread_rwlock_unlock(&shard.lock);
+  }
   
-  // QIT is now set
-  return qit->second;
+  return prio;
 }
 
 
 bool IIMetaCache::sendQueryIfNeeded(const string & ii, Blackadder *ba){
+  IIMetaCacheShard & shard = shardOf(ii);
+  pthread_rwlock_wrlock(&shard.lock);
   // First of all try to clean it ... if it is needed
-  checkClean(ii,ba);
+  cleanLocked(shard, ii, ba);
   
   // Now we are sure that if it exists, is valid!
-  if (exists(ii)) return false;
-  
-  // Add it...
-  MetaDataContent mc;
-  mc.querying = true;
+  bool found = (shard.ii_meta.find(ii)!=shard.ii_meta.end());
+  pthread_rwlock_unlock(&shard.lock);
+  if (found) return false;
   
   string qos_id = getQoSID(ii);
   string qos_prefix = ii.substr(0, ii.length() - PURSUIT_ID_LEN);
@@ -173,44 +275,70 @@ bool IIMetaCache::sendQueryIfNeeded(const string & ii, Blackadder *ba){
   //  1. We subscribe
   //  2. We get a MATCH for the meta data II
   //  3. We must have its priority set!
-  addMetaItem(qos_prefix+qos_id);
-  cout<<" - sendQueryIfNeeded: subscribing to "<<chararray_to_hex(qos_prefix+qos_id)<<endl;
+  addMetaItem(qos_prefix+qos_id, ba);
   
-  ba->subscribe_info(qos_id, qos_prefix, DOMAIN_LOCAL, NULL, 0);
+  pthread_rwlock_wrlock(&shard.lock);
+  // Another worker may have added it meanwhile
+  if (shard.ii_meta.find(ii)!=shard.ii_meta.end()) {
+    pthread_rwlock_unlock(&shard.lock);
+    return false;
+  }
+  
+  // Add it... (under the same lock, so only one worker subscribes)
+  MetaDataContent & mc = insertLocked(shard, ii, ba);
+  mc.querying = true;
   mc.querytime = time(NULL);
-  ii_meta[ii] = mc;
+  
+  // Subscribe before the lock is released: evicting or cleaning the II
+  // unsubscribes it, which must not overtake the subscription
+  cout<<" - sendQueryIfNeeded: subscribing to "<<chararray_to_hex(qos_prefix+qos_id)<<endl;
+  ba->subscribe_info(qos_id, qos_prefix, DOMAIN_LOCAL, NULL, 0);
+  pthread_rwlock_unlock(&shard.lock);
   
   return true;
 }
 
 void IIMetaCache::update(const string & ii, QoSList meta, Blackadder * ba){
-  if (!exists(ii)) {
+  IIMetaCacheShard & shard = shardOf(ii);
+  pthread_rwlock_wrlock(&shard.lock);
+  IIMetaDataMap::iterator it = shard.ii_meta.find(ii);
+  if (it==shard.ii_meta.end()) {
+    pthread_rwlock_unlock(&shard.lock);
     cerr<<"Got update for an Item that does not exist! (Ignoring)"<<endl;
     return;
   }
   
-  ii_meta[ii].qos = meta;
-  ii_meta[ii].querying = false;
-  ii_meta[ii].created = time(NULL);
-  
+  MetaDataContent & mc = insertLocked(shard, ii, ba);
+  bool was_querying = mc.querying;
+  mc.qos = meta;
+  mc.querying = false;
+  mc.created = time(NULL);
   
-  // Unsubscribe!
+  // Unsubscribe! (once, and in order with the subscription)
   string qos_id = getQoSID(ii);
   string qos_prefix = ii.substr(0, ii.length() - PURSUIT_ID_LEN);
-  ba->unsubscribe_info(qos_id, qos_prefix, DOMAIN_LOCAL, NULL, 0);
+  if (was_querying) ba->unsubscribe_info(qos_id, qos_prefix, DOMAIN_LOCAL, NULL, 0);
+  pthread_rwlock_unlock(&shard.lock);
   
   // Remove MetaItem
-  IIMetaDataMap::iterator it = ii_meta.find(qos_prefix+qos_id);
-  if (it!=ii_meta.end()) ii_meta.erase(it);
+  IIMetaCacheShard & meta_shard = shardOf(qos_prefix+qos_id);
+  pthread_rwlock_wrlock(&meta_shard.lock);
+  it = meta_shard.ii_meta.find(qos_prefix+qos_id);
+  if (it!=meta_shard.ii_meta.end()) eraseLocked(meta_shard, it, NULL);
+  pthread_rwlock_unlock(&meta_shard.lock);
 }
 
 
-void IIMetaCache::addMetaItem(const string & ii){
+void IIMetaCache::addMetaItem(const string & ii, Blackadder *ba){
   cout<<" - addMetaItem FAKE: "<<chararray_to_hex(ii)<<endl;
-  ii_meta[ii] = MetaDataContent();
-  ii_meta[ii].qos[QoS_PRIO] = 99;
-  ii_meta[ii].querying = false;
-  ii_meta[ii].created = time(NULL);
+  IIMetaCacheShard & shard = shardOf(ii);
+  pthread_rwlock_wrlock(&shard.lock);
+  MetaDataContent & mc = insertLocked(shard, ii, ba);
+  mc.qos.clear();
+  mc.qos[QoS_PRIO] = 99;
+  mc.querying = false;
+  mc.created = time(NULL);
+  pthread_rwlock_unlock(&shard.lock);
 }
 
 
@@ -16,8 +16,10 @@
 
 #include <qos_structs.hpp>
 #include <map>
+#include <list>
 #include <ctime>
 #include <string>
+#include <pthread.h>
 #include <openssl/sha.h>
 
 #include <blackadder.hpp>
@@ -37,33 +39,77 @@ using namespace std; // XXX
 /// Default QoS flow priority (BE)
 #define DEFAULT_QOS_PRIO 0
 
+/// Number of independently locked shards of the cache
+#define META_CACHE_SHARDS 16
+
+/// Default maximum number of IIs kept in the cache (all shards)
+#define META_CACHE_MAX_ENTRIES 65536
+
 typedef struct __meta_data_cont {
   QoSList qos;
   bool querying;
   time_t querytime;
   time_t created;
+  /// set by lookups, cleared by the eviction clock
+  int referenced;
+  /// position in the eviction order of the shard
+  list<string>::iterator lru;
   
   // Constructor to ensure 0 times
   __meta_data_cont(){
     created=querytime=0;
     querying=false;
+    referenced=0;
   }
   
 } MetaDataContent;
 
 typedef map<string, MetaDataContent> IIMetaDataMap;
 
+/**
+ * One shard of the cache: the IIs hashing to it, their eviction order
+ * (most recently added/updated first) and the lock protecting both.
+ */
+typedef struct __meta_cache_shard {
+  IIMetaDataMap ii_meta;
+  list<string> lru;
+  pthread_rwlock_t lock;
+} IIMetaCacheShard;
+
 /**
  * Wrapper class to help on managing meta data cache and do
  * lazy clean up...
+ *
+ * The cache is thread-safe: IIs are spread over META_CACHE_SHARDS shards
+ * by hash, each with its own reader/writer lock, so that lookups from
+ * several request workers do not serialise. Each shard holds at most
+ * max_entries/META_CACHE_SHARDS IIs; when full the least recently used
+ * one is evicted (second chance over the insertion order). Entries also
+ * age out after EXPIRATION_TIME as before.
  */
 class IIMetaCache {
 protected:
-  IIMetaDataMap ii_meta;
+  IIMetaCacheShard shards[META_CACHE_SHARDS];
+  size_t shard_capacity;
   time_t last_non_lazy_update;
   
+  IIMetaCacheShard & shardOf(const string & ii);
+  
+  /**
+   * Non-lazy clean up, if it is due
+   */
+  void cleanAllExpiredIfDue(Blackadder *ba);
+  
+  /**
+   * The following expect the shard to be locked for writing
+   */
+  void cleanLocked(IIMetaCacheShard & shard, const string & ii, Blackadder *ba);
+  void eraseLocked(IIMetaCacheShard & shard, IIMetaDataMap::iterator it, Blackadder *ba);
+  MetaDataContent & insertLocked(IIMetaCacheShard & shard, const string & ii, Blackadder *ba);
+  
 public:
-  IIMetaCache();
+  IIMetaCache(size_t max_entries = META_CACHE_MAX_ENTRIES);
+  ~IIMetaCache();
   
   /**
    * Check if an II exists (true if it does)
@@ -89,12 +135,13 @@ public:
   void cleanAllExpired(Blackadder *ba);
   
   /**
-   * Get the QoS of an II. This returns:
-   * - NULL in case the Item is expired<br>
-   * - NULL in case the Item does not exist<br>
-   * - The QoSList of the item if it is valid and exits<br>
+   * Get the QoS of an II. This returns false:
+   * - in case the Item is expired<br>
+   * - in case the Item does not exist<br>
+   * and true, with a copy of the QoSList of the item in qos, if it is
+   * valid and exits<br>
    */
-  QoSList * getIIMeta(const string & ii, Blackadder *ba);
+  bool getIIMeta(const string & ii, QoSList & qos, Blackadder *ba);
   
   /**
    * Get the QoS of an II. This returns:
@@ -124,8 +171,16 @@ public:
   /**
    * Force add an High Priority II. This is used for the 
    * Subscription on the MetaData publication...
+   *
+   * Blackadder is only needed to unsubscribe a querying II that
+   * gets evicted to make room.
+   */
+  void addMetaItem(const string & ii, Blackadder *ba = NULL);
+  
+  /**
+   * Number of IIs currently cached
    */
-  void addMetaItem(const string & ii);
+  size_t size();
   
   
   static string getQoSID(const string & bin_item_identifier);
@@ -0,0 +1,251 @@
+/*
+ * This file is part of Blackadder.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+/*
+ * Trace replay benchmark for the QoS shortest path tree cache: replays a
+ * trace of LSM updates and QoS path requests on two copies of a topology
+ * and times the two ways of answering the requests: with the per priority
+ * plane tree cache that updateLinkState invalidates edge by edge (what the
+ * TM does now) and with every tree built again for each request (what
+ * calculateFID_weighted used to do). For every request it checks that both
+ * reach the subscriber with a path of the same weight.
+ *
+ * A trace has one event per line, '#' starts a comment:
+ *   lsm <node> <node> <prio>   the LSM of the link between the nodes announces QoS_PRIO prio
+ *   req <node> <node> <prio>   a path request of an item of priority prio from a publisher to a subscriber
+ * All links start in priority class 0. Without a trace, a synthetic one is
+ * replayed: every link announces one of the classes 0, 95 and 99, then the
+ * given number of events follow, one in ten of them an LSM of a random link.
+ *
+ * Usage: tm_qosreplay <topology.graphml> [trace | events]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <climits>
+#include <fstream>
+#include <sstream>
+#include <sys/time.h>
+#include "tm_igraph.hpp"
+
+static double now() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+struct TraceEvent {
+	bool lsm;
+	string a;
+	string b;
+	int prio;
+};
+
+class TMReplayIgraph : public TMIgraph {
+public:
+	/*the trees are built again for every request when cached is false*/
+	TMReplayIgraph(bool cached) : cached(cached), built(0) {
+	}
+	/*sets the priority class of all links, as if every node had announced it*/
+	void setLinkClasses(int prio) {
+		stringstream ss;
+		ss << "QoS_" << (int) QoS_PRIO;
+		for (int eid = 0; eid < igraph_ecount(&graph); eid++) {
+			SETEAN(&graph, ss.str().c_str(), eid, prio);
+		}
+	}
+	bool lsm(const string &a, const string &b, int prio) {
+		igraph_integer_t eid;
+		QoSList status;
+		if (!edgeID(a, b, eid)) {
+			return false;
+		}
+		status[QoS_PRIO] = prio;
+		updateLinkState(igraph_cattribute_EAS(&graph, "LID", eid), status);
+		return true;
+	}
+	/*the FID of a request, hops as calculateFID_weighted reports them and cost the weight of its path*/
+	void request(string &publisher, string &subscriber, int prio, unsigned int &hops, double &cost) {
+		Bitvector FID(FID_LEN * 8);
+		string path;
+		vector<string> path_nodes;
+		const igraph_vector_t *weights = &qlwm[getWeightKeyForIIPrio(prio)];
+		pthread_mutex_lock(&qos_trees_mutex);
+		if (!cached) {
+			qos_trees.clear();
+			qos_tree_edges.clear();
+		}
+		if (qos_trees.find(QoSSPTreeKey(weights, (*reverse_node_index.find(publisher)).second)) == qos_trees.end()) {
+			built++;
+		}
+		pthread_mutex_unlock(&qos_trees_mutex);
+		calculateFID_weighted(publisher, subscriber, FID, hops, path, weights);
+		cost = 0;
+		if (hops == UINT_MAX) {
+			return;
+		}
+		TMIgraph::splitPathVector(path, path_nodes);
+		for (unsigned int j = 0; j + 1 < path_nodes.size(); j++) {
+			igraph_integer_t eid;
+			edgeID(path_nodes[j], path_nodes[j + 1], eid);
+			cost += VECTOR(*weights)[eid];
+		}
+	}
+	bool cached;
+	/*the number of requests that had to build a tree*/
+	unsigned int built;
+private:
+	bool edgeID(const string &a, const string &b, igraph_integer_t &eid) {
+		map<string, int>::iterator from = reverse_node_index.find(a);
+		map<string, int>::iterator to = reverse_node_index.find(b);
+		if (from == reverse_node_index.end() || to == reverse_node_index.end()) {
+			return false;
+		}
+#if IGRAPH_V >= IGRAPH_V_0_6
+		igraph_get_eid(&graph, &eid, (*from).second, (*to).second, true, false);
+#else
+		igraph_get_eid(&graph, &eid, (*from).second, (*to).second, true);
+#endif
+		return eid >= 0;
+	}
+};
+
+static bool readTrace(const char *name, vector<TraceEvent> &trace) {
+	ifstream file(name);
+	string line;
+	if (!file.is_open()) {
+		return false;
+	}
+	while (getline(file, line)) {
+		istringstream words(line.substr(0, line.find('#')));
+		string type;
+		TraceEvent event;
+		if (!(words >> type)) {
+			continue;
+		}
+		if ((type != "lsm" && type != "req") || !(words >> event.a >> event.b >> event.prio)) {
+			fprintf(stderr, "%s: bad trace line: %s\n", name, line.c_str());
+			return false;
+		}
+		event.lsm = (type == "lsm");
+		trace.push_back(event);
+	}
+	return true;
+}
+
+static void syntheticTrace(TMIgraph &tm_igraph, vector<string> &nodes, int no_events, vector<TraceEvent> &trace) {
+	const int classes[] = {0, 95, 99};
+	igraph_integer_t head, tail;
+	TraceEvent event;
+	srand(1);
+	event.lsm = true;
+	for (int eid = 0; eid < igraph_ecount(&tm_igraph.graph); eid++) {
+		igraph_edge(&tm_igraph.graph, eid, &head, &tail);
+		event.a = igraph_cattribute_VAS(&tm_igraph.graph, "NODEID", head);
+		event.b = igraph_cattribute_VAS(&tm_igraph.graph, "NODEID", tail);
+		event.prio = classes[rand() % 3];
+		trace.push_back(event);
+	}
+	for (int i = 0; i < no_events; i++) {
+		event.lsm = (rand() % 10 == 0);
+		event.prio = classes[rand() % 3];
+		if (event.lsm) {
+			igraph_edge(&tm_igraph.graph, rand() % igraph_ecount(&tm_igraph.graph), &head, &tail);
+			event.a = igraph_cattribute_VAS(&tm_igraph.graph, "NODEID", head);
+			event.b = igraph_cattribute_VAS(&tm_igraph.graph, "NODEID", tail);
+		} else {
+			event.a = nodes[rand() % nodes.size()];
+			event.b = nodes[rand() % nodes.size()];
+		}
+		trace.push_back(event);
+	}
+}
+
+int main(int argc, char* argv[]) {
+	int no_events = 20000;
+	vector<string> nodes;
+	vector<TraceEvent> trace;
+	double cached_time = 0, uncached_time = 0;
+	unsigned int no_lsms = 0, no_requests = 0, skipped = 0, wrong = 0;
+	if (argc < 2) {
+		fprintf(stderr, "usage: tm_qosreplay <topology.graphml> [trace | events]\n");
+		exit(EXIT_FAILURE);
+	}
+	TMReplayIgraph cached(true);
+	TMReplayIgraph uncached(false);
+	if (cached.readTopology(argv[1]) < 0 || uncached.readTopology(argv[1]) < 0) {
+		fprintf(stderr, "could not read %s\n", argv[1]);
+		exit(EXIT_FAILURE);
+	}
+	for (map<string, int>::iterator it = cached.reverse_node_index.begin(); it != cached.reverse_node_index.end(); it++) {
+		nodes.push_back((*it).first);
+	}
+	if (argc > 2 && atoi(argv[2]) > 0) {
+		no_events = atoi(argv[2]);
+	} else if (argc > 2) {
+		if (!readTrace(argv[2], trace)) {
+			fprintf(stderr, "could not read %s\n", argv[2]);
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (trace.empty()) {
+		syntheticTrace(cached, nodes, no_events, trace);
+	}
+	cached.setLinkClasses(0);
+	uncached.setLinkClasses(0);
+	for (unsigned int i = 0; i < trace.size(); i++) {
+		TraceEvent &event = trace[i];
+		if (event.lsm) {
+			double start = now();
+			bool known = cached.lsm(event.a, event.b, event.prio);
+			cached_time += now() - start;
+			start = now();
+			uncached.lsm(event.a, event.b, event.prio);
+			uncached_time += now() - start;
+			if (known) {
+				no_lsms++;
+			} else {
+				skipped++;
+			}
+			continue;
+		}
+		/*the TM only serves QoS requests once the default class has a plane*/
+		if (!cached.isQoSMapOk() || cached.reverse_node_index.find(event.a) == cached.reverse_node_index.end()
+				|| cached.reverse_node_index.find(event.b) == cached.reverse_node_index.end()) {
+			skipped++;
+			continue;
+		}
+		unsigned int cached_hops, uncached_hops;
+		double cached_cost, uncached_cost;
+		double start = now();
+		cached.request(event.a, event.b, event.prio, cached_hops, cached_cost);
+		cached_time += now() - start;
+		start = now();
+		uncached.request(event.a, event.b, event.prio, uncached_hops, uncached_cost);
+		uncached_time += now() - start;
+		/*a kept tree may pick another path of the same weight, a stale one gives a heavier path*/
+		if ((cached_hops == UINT_MAX) != (uncached_hops == UINT_MAX) || cached_cost != uncached_cost) {
+			wrong++;
+		}
+		no_requests++;
+	}
+	fprintf(stderr, "%s: %u LSM updates, %u QoS requests (%u events skipped), %u trees built with the cache, %u paths differ\n",
+			argv[1], no_lsms, no_requests, skipped, cached.built, wrong);
+	if (no_requests > 0) {
+		fprintf(stderr, "%s: replay time: without the tree cache %.3fs, with it %.3fs (x%.1f)\n",
+				argv[1], uncached_time, cached_time, uncached_time / cached_time);
+	}
+	return wrong == 0 ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+/*
+ * This file is part of Blackadder.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+#include "tm_sptree.hpp"
+#include <climits>
+#include <queue>
+#include <functional>
+
+TMSPTree::TMSPTree() : _root(-1), _to_root(false) {
+}
+
+void TMSPTree::build(const igraph_t *graph, int root, bool to_root) {
+	unsigned int no_vertices = igraph_vcount(graph);
+	igraph_vector_t neis;
+	queue<int> bfs;
+	_root = root;
+	_to_root = to_root;
+	_parent.assign(no_vertices, -1);
+	_dist.assign(no_vertices, UINT_MAX);
+	igraph_vector_init(&neis, 0);
+	_dist[root] = 0;
+	bfs.push(root);
+	while (!bfs.empty()) {
+		int vertex = bfs.front();
+		bfs.pop();
+		downstream(graph, vertex, &neis);
+		for (int n = 0; n < igraph_vector_size(&neis); n++) {
+			int neighbour = VECTOR(neis)[n];
+			if (_dist[neighbour] == UINT_MAX) {
+				_dist[neighbour] = _dist[vertex] + 1;
+				_parent[neighbour] = vertex;
+				bfs.push(neighbour);
+			}
+		}
+	}
+	igraph_vector_destroy(&neis);
+}
+
+void TMSPTree::removeEdge(const igraph_t *graph, int from, int to, set<int> &rerouted) {
+	typedef pair<unsigned int, int> dist_vertex;
+	unsigned int no_vertices = _parent.size();
+	igraph_vector_t neis;
+	vector<bool> affected(no_vertices, false);
+	vector<int> affected_list;
+	vector<vector<int> > children(no_vertices);
+	priority_queue<dist_vertex, vector<dist_vertex>, greater<dist_vertex> > heap;
+	/*the edge lies on the tree only if it links a vertex to its tree parent, otherwise no distance changes*/
+	int child = _to_root ? from : to;
+	int tree_parent = _to_root ? to : from;
+	if (!valid() || _parent[child] != tree_parent) {
+		return;
+	}
+	/*the affected vertices are the subtree hanging below the removed edge*/
+	for (unsigned int v = 0; v < no_vertices; v++) {
+		if (_parent[v] >= 0) {
+			children[_parent[v]].push_back(v);
+		}
+	}
+	affected_list.push_back(child);
+	affected[child] = true;
+	for (unsigned int i = 0; i < affected_list.size(); i++) {
+		vector<int> &c = children[affected_list[i]];
+		for (unsigned int j = 0; j < c.size(); j++) {
+			affected[c[j]] = true;
+			affected_list.push_back(c[j]);
+		}
+	}
+	for (unsigned int i = 0; i < affected_list.size(); i++) {
+		_dist[affected_list[i]] = UINT_MAX;
+		_parent[affected_list[i]] = -1;
+	}
+	/*seed every affected vertex from its best unaffected neighbour*/
+	igraph_vector_init(&neis, 0);
+	for (unsigned int i = 0; i < affected_list.size(); i++) {
+		int vertex = affected_list[i];
+		upstream(graph, vertex, &neis);
+		for (int n = 0; n < igraph_vector_size(&neis); n++) {
+			int neighbour = VECTOR(neis)[n];
+			if (!affected[neighbour] && _dist[neighbour] != UINT_MAX && _dist[neighbour] + 1 < _dist[vertex]) {
+				_dist[vertex] = _dist[neighbour] + 1;
+				_parent[vertex] = neighbour;
+			}
+		}
+		if (_dist[vertex] != UINT_MAX) {
+			heap.push(dist_vertex(_dist[vertex], vertex));
+		}
+		rerouted.insert(vertex);
+	}
+	/*settle the affected vertices, relaxing edges inside the affected set only*/
+	while (!heap.empty()) {
+		dist_vertex top = heap.top();
+		heap.pop();
+		if (top.first != _dist[top.second]) {
+			continue;
+		}
+		downstream(graph, top.second, &neis);
+		for (int n = 0; n < igraph_vector_size(&neis); n++) {
+			int neighbour = VECTOR(neis)[n];
+			if (affected[neighbour] && top.first + 1 < _dist[neighbour]) {
+				_dist[neighbour] = top.first + 1;
+				_parent[neighbour] = top.second;
+				heap.push(dist_vertex(_dist[neighbour], neighbour));
+			}
+		}
+	}
+	igraph_vector_destroy(&neis);
+}
+
+void TMSPTree::changedPaths(const TMSPTree &previous, set<int> &rerouted) const {
+	unsigned int no_vertices = _parent.size();
+	/*0: not checked yet, 1: same path as before, 2: path changed*/
+	vector<char> state(no_vertices, 0);
+	vector<int> chain;
+	bool same_tree = previous.valid() && previous._root == _root && previous._to_root == _to_root &&
+			previous._parent.size() == no_vertices;
+	for (unsigned int v = 0; v < no_vertices; v++) {
+		int vertex = v;
+		/*a path is unchanged if neither the vertex nor any vertex above it got a new parent*/
+		while (state[vertex] == 0) {
+			if (!same_tree || previous._parent[vertex] != _parent[vertex] || previous.reachable(vertex) != reachable(vertex)) {
+				state[vertex] = 2;
+			}
+			else if (_parent[vertex] < 0) {
+				state[vertex] = 1;
+			}
+			else {
+				chain.push_back(vertex);
+				vertex = _parent[vertex];
+			}
+		}
+		while (!chain.empty()) {
+			state[chain.back()] = state[vertex];
+			chain.pop_back();
+		}
+		if (state[v] == 2) {
+			rerouted.insert(v);
+		}
+	}
+}
+
+int TMSPTree::parent(int vertex) const {
+	return _parent[vertex];
+}
+
+bool TMSPTree::reachable(int vertex) const {
+	return _dist[vertex] != UINT_MAX;
+}
+
+bool TMSPTree::valid() const {
+	return _root >= 0;
+}
+
+int TMSPTree::root() const {
+	return _root;
+}
+
+bool TMSPTree::toRoot() const {
+	return _to_root;
+}
+
+void TMSPTree::downstream(const igraph_t *graph, int vertex, igraph_vector_t *neis) {
+	igraph_neighbors(graph, neis, vertex, _to_root ? IGRAPH_IN : IGRAPH_OUT);
+}
+
+void TMSPTree::upstream(const igraph_t *graph, int vertex, igraph_vector_t *neis) {
+	igraph_neighbors(graph, neis, vertex, _to_root ? IGRAPH_OUT : IGRAPH_IN);
+}
@@ -0,0 +1,91 @@
+/*
+ * This file is part of Blackadder.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+#ifndef TM_SPTREE_HH
+#define TM_SPTREE_HH
+
+#include <set>
+#include <vector>
+#include <igraph/igraph.h>
+// igraph_version.hpp should be remade using make clean && make igraph_version.hpp
+// if igraph major or minor version changes
+#include "igraph_version.hpp"
+
+using namespace std;
+
+/**@brief (Topology Manager) a hop-count shortest path tree that is repaired incrementally when links fail.
+ *
+ * The tree is either rooted at a source (paths from the root to every vertex, following out-edges) or
+ * at a sink (paths from every vertex to the root, following in-edges). When an edge is removed only the
+ * vertices below it in the tree are recomputed (Ramalingam-Reps for unit weights): their distances are
+ * seeded from the unaffected neighbours and settled with a Dijkstra restricted to the affected set.
+ */
+class TMSPTree {
+public:
+	/**@brief Constructor: creates an empty (invalid) tree
+	 */
+	TMSPTree();
+	/**@brief builds the tree from scratch with a breadth first search
+	 *
+	 * @param graph the igraph graph
+	 * @param root the igraph vertex id of the root
+	 * @param to_root false for paths from the root to all vertices, true for paths from all vertices to the root
+	 */
+	void build(const igraph_t *graph, int root, bool to_root);
+	/**@brief repairs the tree after the edge from -> to has been deleted from the graph
+	 *
+	 * @param graph the igraph graph, already without the edge
+	 * @param from the igraph vertex id of the tail of the removed edge
+	 * @param to the igraph vertex id of the head of the removed edge
+	 * @param rerouted the vertices whose path used the removed edge are added to this set (unreachable ones included)
+	 */
+	void removeEdge(const igraph_t *graph, int from, int to, set<int> &rerouted);
+	/**@brief finds the vertices whose tree path differs from their path in a previous version of the tree
+	 *
+	 * @param previous the tree before it was rebuilt
+	 * @param rerouted the vertices whose path changed are added to this set (vertices that became reachable or unreachable included)
+	 */
+	void changedPaths(const TMSPTree &previous, set<int> &rerouted) const;
+	/**@brief the neighbour of vertex on its tree path towards the root (the predecessor in a source tree, the next hop in a sink tree)
+	 *
+	 * @return -1 for the root and for unreachable vertices
+	 */
+	int parent(int vertex) const;
+	/**@brief whether a path between the root and the vertex exists
+	 */
+	bool reachable(int vertex) const;
+	/**@brief whether the tree has been built
+	 */
+	bool valid() const;
+	/**@brief the root of the tree
+	 */
+	int root() const;
+	/**@brief true for a sink tree (paths towards the root)
+	 */
+	bool toRoot() const;
+private:
+	/**@brief the vertices following vertex on a path away from the root
+	 */
+	void downstream(const igraph_t *graph, int vertex, igraph_vector_t *neis);
+	/**@brief the vertices preceding vertex on a path away from the root
+	 */
+	void upstream(const igraph_t *graph, int vertex, igraph_vector_t *neis);
+	int _root;
+	bool _to_root;
+	vector<int> _parent;
+	vector<unsigned int> _dist;
+};
+
+#endif
@@ -0,0 +1,85 @@
+/*
+ * This file is part of Blackadder.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+/*
+ * Topology loading benchmark: times the igraph GraphML reader and the
+ * single pass loader of TMIgraph on the same file, then the RV/TM FID
+ * calculation the TM does right after loading, and checks that both
+ * loaders produced the same graph.
+ *
+ * Usage: tm_topobench <topology.graphml> [runs]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/time.h>
+#include "tm_igraph.hpp"
+
+static double now() {
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static bool sameLIDs(const vector<LIDWords> &a, const vector<LIDWords> &b) {
+	if (a.size() != b.size()) {
+		return false;
+	}
+	for (unsigned int i = 0; i < a.size(); i++) {
+		if (memcmp(a[i].w, b[i].w, sizeof(a[i].w)) != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char* argv[]) {
+	int runs = 1;
+	double igraph_time = 0, fast_time = 0, fids_time = 0;
+	bool same = true;
+	if (argc < 2) {
+		fprintf(stderr, "usage: tm_topobench <topology.graphml> [runs]\n");
+		exit(EXIT_FAILURE);
+	}
+	if (argc > 2) {
+		runs = atoi(argv[2]);
+	}
+	for (int r = 0; r < runs; r++) {
+		TMIgraph by_igraph, by_fast;
+		double start = now();
+		if (by_igraph.readTopologyIgraph(argv[1]) < 0) {
+			fprintf(stderr, "igraph could not read %s\n", argv[1]);
+			exit(EXIT_FAILURE);
+		}
+		igraph_time += now() - start;
+		start = now();
+		if (by_fast.readTopologyFast(argv[1]) < 0) {
+			fprintf(stderr, "the single pass loader could not read %s\n", argv[1]);
+			exit(EXIT_FAILURE);
+		}
+		fast_time += now() - start;
+		same = same && by_igraph.reverse_node_index == by_fast.reverse_node_index &&
+				sameLIDs(by_igraph.vertex_iLID_words, by_fast.vertex_iLID_words) &&
+				sameLIDs(by_igraph.edge_LID_words, by_fast.edge_LID_words);
+		start = now();
+		by_fast.calculateRVTMFIDs();
+		fids_time += now() - start;
+	}
+	fprintf(stderr, "%s: igraph reader %.3fs, single pass loader %.3fs (x%.1f), RV/TM FIDs %.3fs, %s\n",
+			argv[1], igraph_time / runs, fast_time / runs, igraph_time / fast_time, fids_time / runs,
+			same ? "same graph" : "GRAPHS DIFFER");
+	return same ? 0 : 1;
+}
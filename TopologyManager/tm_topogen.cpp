@@ -0,0 +1,169 @@
+/*
+ * This file is part of Blackadder.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+/*
+ * Synthetic topology generator for the TM: writes a GraphML file in the
+ * format of the deployment tool (NODEID/iLID per node, LID per directed
+ * edge, TM/RV/FID_LEN graph data) for a Waxman or a fat-tree graph.
+ *
+ * Usage: tm_topogen waxman <nodes> [alpha] [beta] [seed]
+ *        tm_topogen fattree <k> [seed]
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <utility>
+#include "blackadder_enums.hpp"
+
+using namespace std;
+
+typedef pair<int, int> Link;
+
+/*a random LID with a single bit set, as calculateLID does*/
+static string randomLID() {
+	string lid(FID_LEN * 8, '0');
+	lid[rand() % (FID_LEN * 8)] = '1';
+	return lid;
+}
+
+static string nodeLabel(int vertex) {
+	char label[16];
+	snprintf(label, sizeof(label), "%0*d", PURSUIT_ID_LEN, vertex + 1);
+	return string(label);
+}
+
+/*Waxman: nodes placed uniformly in the unit square, u-v linked with probability beta * exp(-d(u,v) / (alpha * L)).
+  Each node is first linked to a random earlier node so that the graph is connected.*/
+static void waxman(int nodes, double alpha, double beta, vector<Link> &links) {
+	vector<double> x(nodes), y(nodes);
+	double L = sqrt(2.0);
+	for (int i = 0; i < nodes; i++) {
+		x[i] = drand48();
+		y[i] = drand48();
+	}
+	for (int i = 1; i < nodes; i++) {
+		links.push_back(Link(rand() % i, i));
+	}
+	for (int i = 0; i < nodes; i++) {
+		for (int j = i + 1; j < nodes; j++) {
+			double d = sqrt((x[i] - x[j]) * (x[i] - x[j]) + (y[i] - y[j]) * (y[i] - y[j]));
+			if (drand48() < beta * exp(-d / (alpha * L))) {
+				links.push_back(Link(i, j));
+			}
+		}
+	}
+}
+
+/*k-ary fat-tree: (k/2)^2 core switches, k pods of k/2 aggregation and k/2 edge switches, k/2 hosts per edge switch*/
+static int fattree(int k, vector<Link> &links) {
+	int half = k / 2;
+	int core = half * half;
+	int pod_size = k + half * half;
+	for (int pod = 0; pod < k; pod++) {
+		int pod_base = core + pod * pod_size;
+		for (int a = 0; a < half; a++) {
+			int aggregation = pod_base + a;
+			for (int c = 0; c < half; c++) {
+				links.push_back(Link(a * half + c, aggregation));
+			}
+			for (int e = 0; e < half; e++) {
+				links.push_back(Link(aggregation, pod_base + half + e));
+			}
+		}
+		for (int e = 0; e < half; e++) {
+			for (int h = 0; h < half; h++) {
+				links.push_back(Link(pod_base + half + e, pod_base + k + e * half + h));
+			}
+		}
+	}
+	return core + k * pod_size;
+}
+
+static void usage() {
+	fprintf(stderr, "usage: tm_topogen waxman <nodes> [alpha] [beta] [seed]\n");
+	fprintf(stderr, "       tm_topogen fattree <k> [seed]\n");
+	exit(EXIT_FAILURE);
+}
+
+int main(int argc, char* argv[]) {
+	vector<Link> links;
+	int nodes;
+	long seed = 1;
+	if (argc < 3) {
+		usage();
+	}
+	if (strcmp(argv[1], "waxman") == 0) {
+		nodes = atoi(argv[2]);
+		double alpha = argc > 3 ? atof(argv[3]) : 0.15;
+		double beta = argc > 4 ? atof(argv[4]) : 0.2;
+		if (argc > 5) seed = atol(argv[5]);
+		srand(seed);
+		srand48(seed);
+		waxman(nodes, alpha, beta, links);
+	} else if (strcmp(argv[1], "fattree") == 0) {
+		int k = atoi(argv[2]);
+		if (k < 2 || k % 2 != 0) {
+			fprintf(stderr, "k must be even\n");
+			usage();
+		}
+		if (argc > 3) seed = atol(argv[3]);
+		srand(seed);
+		nodes = fattree(k, links);
+	} else {
+		usage();
+	}
+	if (nodes < 1) {
+		usage();
+	}
+	printf("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+	printf("<graphml xmlns=\"http://graphml.graphdrawing.org/xmlns\"\n");
+	printf("         xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\"\n");
+	printf("         xsi:schemaLocation=\"http://graphml.graphdrawing.org/xmlns\n");
+	printf("         http://graphml.graphdrawing.org/xmlns/1.0/graphml.xsd\">\n");
+	printf("  <key id=\"FID_LEN\" for=\"graph\" attr.name=\"FID_LEN\" attr.type=\"double\"/>\n");
+	printf("  <key id=\"TM\" for=\"graph\" attr.name=\"TM\" attr.type=\"string\"/>\n");
+	printf("  <key id=\"RV\" for=\"graph\" attr.name=\"RV\" attr.type=\"string\"/>\n");
+	printf("  <key id=\"TM_MODE\" for=\"graph\" attr.name=\"TM_MODE\" attr.type=\"string\"/>\n");
+	printf("  <key id=\"NODEID\" for=\"node\" attr.name=\"NODEID\" attr.type=\"string\"/>\n");
+	printf("  <key id=\"iLID\" for=\"node\" attr.name=\"iLID\" attr.type=\"string\"/>\n");
+	printf("  <key id=\"LID\" for=\"edge\" attr.name=\"LID\" attr.type=\"string\"/>\n");
+	printf("  <graph id=\"G\" edgedefault=\"directed\">\n");
+	printf("    <data key=\"FID_LEN\">%d</data>\n", FID_LEN);
+	printf("    <data key=\"TM\">%s</data>\n", nodeLabel(0).c_str());
+	printf("    <data key=\"RV\">%s</data>\n", nodeLabel(0).c_str());
+	printf("    <data key=\"TM_MODE\">user</data>\n");
+	for (int i = 0; i < nodes; i++) {
+		printf("    <node id=\"n%d\">\n", i);
+		printf("      <data key=\"NODEID\">%s</data>\n", nodeLabel(i).c_str());
+		printf("      <data key=\"iLID\">%s</data>\n", randomLID().c_str());
+		printf("    </node>\n");
+	}
+	/*every link is a pair of directed edges*/
+	for (unsigned int i = 0; i < links.size(); i++) {
+		printf("    <edge source=\"n%d\" target=\"n%d\">\n", links[i].first, links[i].second);
+		printf("      <data key=\"LID\">%s</data>\n", randomLID().c_str());
+		printf("    </edge>\n");
+		printf("    <edge source=\"n%d\" target=\"n%d\">\n", links[i].second, links[i].first);
+		printf("      <data key=\"LID\">%s</data>\n", randomLID().c_str());
+		printf("    </edge>\n");
+	}
+	printf("  </graph>\n");
+	printf("</graphml>\n");
+	return 0;
+}
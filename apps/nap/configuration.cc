@@ -31,9 +31,11 @@ Configuration::Configuration()
 	_bufferCleanerInterval = 10;// seconds
 	_cNap = true;
 	_hostBasedNap = false;
+	_httpCoalescingWindow = 1000; // ms
 	_httpHandler = true;
 	_httpProxyPort = 3127; // port
 	_icnGateway = false;
+	_icnWorkers = 1;
 	_ltpInitialCredit = 10; // segments, not bytes
 	_ltpRttListSize = 10; // Default
 	_ltpRttMultiplier = 2;
@@ -127,6 +129,11 @@ uint32_t Configuration::icnHeaderLength()
 	return 20;//FIXME obtain the exact number (through MAPI maybe?)
 }
 
+uint32_t Configuration::icnWorkers()
+{
+	return _icnWorkers;
+}
+
 IpAddress Configuration::endpointIpAddress()
 {
 	return _endpointIpAddress;
@@ -161,6 +168,11 @@ bool Configuration::httpHandler()
 	return _httpHandler;
 }
 
+uint32_t Configuration::httpCoalescingWindow()
+{
+	return _httpCoalescingWindow;
+}
+
 uint16_t Configuration::httpProxyPort()
 {
 	return _httpProxyPort;
@@ -349,6 +361,13 @@ bool Configuration::parse(string file)
 		{
 			LOG4CXX_TRACE(logger, "HTTP proxy port set to " << _httpProxyPort);
 		}
+		// HTTP request coalescing window
+		if (_httpHandler && napConfig.lookupValue("httpCoalescingWindow",
+				_httpCoalescingWindow))
+		{
+			LOG4CXX_TRACE(logger, "HTTP request coalescing window set to "
+					<< _httpCoalescingWindow << "ms");
+		}
 		// TCP socket buffer sizes
 		if (napConfig.lookupValue("tcpClientSocketBufferSize",
 				_tcpClientSocketBufferSize))
@@ -450,6 +469,17 @@ bool Configuration::parse(string file)
 			LOG4CXX_TRACE(logger, "Traffic control drop rate set to "
 					<< (float)1 / _tcDropRate);
 		}
+		// ICN workers
+		if (napConfig.lookupValue("icnWorkers", _icnWorkers))
+		{
+			if (_icnWorkers < 1)
+			{
+				LOG4CXX_WARN(logger, "'icnWorkers' cannot be smaller than 1");
+				_icnWorkers = 1;
+			}
+			LOG4CXX_TRACE(logger, "Number of ICN worker threads set to "
+					<< _icnWorkers);
+		}
 		// MOLY interface
 		if (napConfig.lookupValue("molyInterval", _molyInterval))
 		{
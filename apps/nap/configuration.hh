@@ -104,6 +104,13 @@ namespace configuration {
 		 * endpoints serving them
 		 */
 		list<pair<IcnId, pair<IpAddress, uint16_t>>> fqdns();
+		/*!
+		 * \brief Obtain the time window in which identical HTTP GET requests
+		 * share one upstream fetch
+		 *
+		 * \return The coalescing window in milliseconds (0 = disabled)
+		 */
+		uint32_t httpCoalescingWindow();
 		/*!
 		 * \brief Obtain if HTTP handler is supposed to be turned off
 		 *
@@ -159,6 +166,12 @@ namespace configuration {
 		 * \return The ICN header length
 		 */
 		uint32_t icnHeaderLength();
+		/*!
+		 * \brief Obtain the number of threads handling the BA API events
+		 *
+		 * \return The number of ICN worker threads
+		 */
+		uint32_t icnWorkers();
 		/*!
 		 * \brief Initial LTP credit
 		 *
@@ -260,12 +273,16 @@ namespace configuration {
 		acting in */
 		IpAddress _endpointIpAddress; /*!< If host-based deployment configured,
 		this variable holds the IP endpoint's IP address */
+		uint32_t _httpCoalescingWindow;/*!< Time window in ms in which
+		identical HTTP GET requests are served by one upstream fetch */
 		bool _httpHandler;/*!< Boolean to turn off HTTP handler */
 		uint32_t _httpProxyPort; /*!< The HTTP proxy port the NAP is listening
 		for new	incoming TCP connections. Default: 3127 */
 		bool _icnGateway; /*!< Is this NAP running as an ICN GW */
 		RoutingPrefix _icnGatewayRoutingPrefix;/*!< Routing prefix of the ICN GW
 		if set */
+		uint32_t _icnWorkers;/*!< The number of threads handling the BA API
+		events */
 		bool _hostBasedNap; /*!< Is this NAP configured as in host-based
 		scenario */
 		list<pair<IcnId, pair<IpAddress, uint16_t>>> _fqdns; /*!< Holding all
@@ -0,0 +1,298 @@
+/*
+ * httpcoalescingbench.cc
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Loopback benchmark of the sNAP's HTTP request coalescing (it does not need
+ * Blackadder). A local HTTP server counts the requests it receives (upstream
+ * hits) and answers them after a given delay. In every round a number of
+ * clients (standing in for cNAPs) send the same GET request for the same rCID
+ * at the same time. Without coalescing each request is fetched from the server
+ * by its own TCP client, as the sNAP used to do. With coalescing each request
+ * is first handed to Http::coalesceRequest: only the requests it does not
+ * coalesce are fetched, and Http::completeRequests is called once the first
+ * response packet has arrived, as Http::handleResponse does. Handing the
+ * response to all clients waiting for it (the CMC group which
+ * Http::handleResponse publishes to) requires Blackadder and is modelled by a
+ * condition variable. The coalescing window is the one of the default
+ * configuration.
+ *
+ * Before the rounds, the bench checks that Http::coalesceRequest never
+ * coalesces requests with a Range, Authorization or Cookie header field or
+ * with Cache-Control: no-cache.
+ *
+ * Usage: httpcoalescingbench [rounds] [clients] [server delay in ms]
+ */
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <configuration.hh>
+#include <icnpublisher.hh>
+#include <monitoring/statistics.hh>
+#include <namespaces/http.hh>
+#include <transport/transport.hh>
+
+using namespace std;
+
+unsigned int rounds = 50;
+unsigned int clients = 16;
+unsigned int serverDelay = 20;
+
+uint16_t serverPort = 0;
+atomic<unsigned int> upstreamHits(0);
+atomic<unsigned int> responses(0);
+
+namespaces::http::Http *http;
+
+/*!
+ * \brief The response of a round which is handed to all clients waiting
+ */
+struct round_t
+{
+	std::mutex responseMutex;
+	condition_variable responded;
+	bool response;
+};
+
+void serveConnection(int socketFd)
+{
+	char buffer[4096];
+	string request;
+	ssize_t length;
+	while (request.find("\r\n\r\n") == string::npos
+			&& (length = recv(socketFd, buffer, sizeof(buffer), 0)) > 0)
+	{
+		request.append(buffer, length);
+	}
+	upstreamHits++;
+	this_thread::sleep_for(chrono::milliseconds(serverDelay));
+	string body(1024, 'x');
+	string response = "HTTP/1.1 200 OK\r\nContent-Length: "
+			+ to_string(body.length()) + "\r\nConnection: close\r\n\r\n" + body;
+	send(socketFd, response.data(), response.length(), MSG_NOSIGNAL);
+	close(socketFd);
+}
+
+void server(int listenFd)
+{
+	int socketFd;
+	while ((socketFd = accept(listenFd, NULL, NULL)) >= 0)
+	{
+		thread(serveConnection, socketFd).detach();
+	}
+}
+
+/*!
+ * \brief Fetch the request from the server (TcpClient)
+ *
+ * \return Boolean indicating if the response has been received
+ */
+bool fetch(string &request)
+{
+	char buffer[4096];
+	struct sockaddr_in address;
+	int socketFd = socket(AF_INET, SOCK_STREAM, 0);
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port = htons(serverPort);
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (connect(socketFd, (struct sockaddr *)&address, sizeof(address)) < 0)
+	{
+		close(socketFd);
+		return false;
+	}
+	send(socketFd, request.data(), request.length(), MSG_NOSIGNAL);
+	bool received = recv(socketFd, buffer, sizeof(buffer), 0) > 0;
+	while (recv(socketFd, buffer, sizeof(buffer), 0) > 0);
+	close(socketFd);
+	return received;
+}
+
+/*!
+ * \brief Hand a request to Http::coalesceRequest
+ */
+bool coalesceRequest(IcnId &rCId, string &request)
+{
+	uint16_t requestSize = request.length();
+	return http->coalesceRequest(rCId, (uint8_t *)&request[0], requestSize);
+}
+
+/*!
+ * \brief Check which requests Http::coalesceRequest coalesces
+ *
+ * \return The number of requests which have not been handled as expected
+ */
+unsigned int checkCoalescing()
+{
+	const char *fields[] = {"Range: bytes=0-99", "Authorization: Basic YQ==",
+			"Cookie: session=1", "Cache-Control: no-cache"};
+	unsigned int wrong = 0;
+	IcnId rCId("point.example", "/check");
+	string request = "GET /check HTTP/1.1\r\nHost: point.example\r\n\r\n";
+	// the first request is fetched, an identical one is coalesced
+	if (coalesceRequest(rCId, request) || !coalesceRequest(rCId, request))
+	{
+		wrong++;
+	}
+	for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++)
+	{
+		string field = "GET /check HTTP/1.1\r\nHost: point.example\r\n"
+				+ string(fields[i]) + "\r\n\r\n";
+		// neither coalesced on the fetch in flight nor recorded as in flight
+		if (coalesceRequest(rCId, field) || coalesceRequest(rCId, field))
+		{
+			cerr << "Request with \"" << fields[i] << "\" coalesced" << endl;
+			wrong++;
+		}
+	}
+	// a request after the first response packet is fetched again
+	http->completeRequests(rCId);
+	if (coalesceRequest(rCId, request))
+	{
+		wrong++;
+	}
+	http->completeRequests(rCId);
+	return wrong;
+}
+
+void client(round_t &round, unsigned int r, bool coalesce)
+{
+	IcnId rCId("point.example", "/round" + to_string(r));
+	string request = "GET /round" + to_string(r) + " HTTP/1.1\r\n"
+			"Host: point.example\r\n\r\n";
+	if (coalesce && coalesceRequest(rCId, request))
+	{
+		// Wait for the response of the fetch in flight (CMC group)
+		unique_lock<mutex> lock(round.responseMutex);
+		while (!round.response)
+		{
+			round.responded.wait(lock);
+		}
+		responses++;
+		return;
+	}
+	if (!fetch(request))
+	{
+		return;
+	}
+	if (coalesce)
+	{
+		// First response packet received (Http::handleResponse)
+		http->completeRequests(rCId);
+		lock_guard<mutex> lock(round.responseMutex);
+		round.response = true;
+		round.responded.notify_all();
+	}
+	responses++;
+}
+
+/*!
+ * \brief Run all rounds
+ *
+ * \return The number of seconds it took
+ */
+double run(bool coalesce)
+{
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	upstreamHits = 0;
+	responses = 0;
+	for (unsigned int r = 0; r < rounds; r++)
+	{
+		round_t round;
+		vector<thread> threads;
+		round.response = false;
+		for (unsigned int c = 0; c < clients; c++)
+		{
+			threads.push_back(thread(client, ref(round), r, coalesce));
+		}
+		for (auto it = threads.begin(); it != threads.end(); it++)
+		{
+			it->join();
+		}
+	}
+	return chrono::duration<double>(chrono::steady_clock::now() - start)
+			.count();
+}
+
+int main(int argc, char *argv[])
+{
+	struct sockaddr_in address;
+	socklen_t addressLength = sizeof(address);
+	double seconds;
+	if (argc > 1)
+	{
+		rounds = atoi(argv[1]);
+	}
+	if (argc > 2)
+	{
+		clients = atoi(argv[2]);
+	}
+	if (argc > 3)
+	{
+		serverDelay = atoi(argv[3]);
+	}
+	int listenFd = socket(AF_INET, SOCK_STREAM, 0);
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (bind(listenFd, (struct sockaddr *)&address, sizeof(address)) < 0
+			|| listen(listenFd, 1024) < 0
+			|| getsockname(listenFd, (struct sockaddr *)&address,
+					&addressLength) < 0)
+	{
+		cerr << "Local HTTP server could not be started: " << strerror(errno)
+				<< endl;
+		return EXIT_FAILURE;
+	}
+	serverPort = ntohs(address.sin_port);
+	thread(server, listenFd).detach();
+	Configuration configuration;
+	Statistics statistics;
+	IcnPublisher icnPublisher(NULL);
+	Transport transport(NULL, configuration, icnPublisher, statistics);
+	http = new namespaces::http::Http(NULL, icnPublisher, configuration,
+			transport, statistics);
+	if (checkCoalescing() > 0)
+	{
+		cerr << "HTTP requests have not been coalesced as expected" << endl;
+		return EXIT_FAILURE;
+	}
+	cout << rounds << " rounds of " << clients << " identical GET requests, "
+			<< serverDelay << "ms server delay" << endl;
+	seconds = run(false);
+	cout << "no coalescing: " << upstreamHits << " upstream hits, "
+			<< responses << " responses in " << seconds << "s" << endl;
+	unsigned int hits = upstreamHits;
+	seconds = run(true);
+	cout << "coalescing:    " << upstreamHits << " upstream hits, "
+			<< responses << " responses in " << seconds << "s ("
+			<< (double)hits / upstreamHits << "x fewer hits)" << endl;
+	return responses == rounds * clients ? EXIT_SUCCESS : EXIT_FAILURE;
+}
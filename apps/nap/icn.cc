@@ -19,17 +19,14 @@
  * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <mutex>
-
 #include <icn.hh>
+#include <icndispatcher.hh>
 #include <icnproxythreadcleaner.hh>
-#include <proxies/http/tcpclient.hh>
 
 using namespace icn;
 using namespace log4cxx;
 using namespace namespaces::ip;
 using namespace namespaces::http;
-using namespace proxies::http::tcpclient;
 using namespace std;
 using namespace transport::lightweight;
 using namespace transport::unreliable;
@@ -41,203 +38,228 @@ Icn::Icn(Blackadder *icnCore, Configuration &configuration,
 	: _icnCore(icnCore),
 	  _configuration(configuration),
 	  _namespaces(namespaces),
-	  _transport(transport)
+	  _transport(transport),
+	  _tcpClients(configuration.icnWorkers(),
+			  TcpClient(configuration, namespaces))
 {}
 
 Icn::~Icn(){}
 
 void Icn::operator ()()
 {
-	IcnId icnId;
 	IcnId rCId;
-	string icnIdStr;
 	string rCIdStr;
-	uint16_t dataLength = 0;
-	uint8_t *retrievedPacket = (uint8_t *)malloc(65535);
-	uint16_t retrievedPacketSize = 0;
-	std::mutex tcpClientThreadsMutex;
-	vector<std::thread> tcpClientThreads;
-	TcpClient tcpClient(_configuration, _namespaces);//, tcpClientMutex);
 	LOG4CXX_DEBUG(logger, "ICN listener thread started");
 
 	//starting TCP client thread cleaner (HTTP proxy)
-	IcnProxyThreadCleaner icnProxyThreadCleaner(tcpClientThreads,
-				tcpClientThreadsMutex);
+	IcnProxyThreadCleaner icnProxyThreadCleaner(_tcpClientThreads,
+				_tcpClientThreadsMutex);
 	std::thread proxyCleanerThread = std::thread(icnProxyThreadCleaner);
+	// starting the workers handling the BA API events
+	IcnDispatcher icnDispatcher(_tcpClients.size(),
+			[this](Event *event, unsigned int worker)
+			{
+				_handleEvent(event, worker);
+			});
 
 	while (true)
 	{
-		Event event;
-		_icnCore->getEvent(event);
-		icnIdStr = chararray_to_hex(event.id);
-		icnId = icnIdStr;
+		Event *event = new Event;
+		_icnCore->getEvent(*event);
 
-		switch (event.type)
-		{
-		/*
-		 * Scope published
-		 */
-		case SCOPE_PUBLISHED:
-			LOG4CXX_DEBUG(logger, "SCOPE_PUBLISHED received for ICN ID "
-					<< icnId.print());
-			_namespaces.subscribeScope(icnId);
-			break;
-		/*
-		 * Scope unpublished
-		 */
-		case SCOPE_UNPUBLISHED:
-			LOG4CXX_DEBUG(logger, "SCOPE_UNPUBLISHED received for ICN ID "
-					<< icnId.print());
-			break;
-		/*
-		 * Start publish
-		 */
-		case START_PUBLISH:
-		{
-			LOG4CXX_DEBUG(logger, "START_PUBLISH received for CID "
-					<< icnId.print());
-			_namespaces.forwarding(icnId, true);
-			_namespaces.publishFromBuffer(icnId);
-			break;
-		}
-		/*
-		 * Start publish iSub
-		 */
-		case START_PUBLISH_iSUB:
-		{
-			NodeId nodeId = event.id;
-			LOG4CXX_DEBUG(logger, "START_PUBLISH_iSUB received for NID "
-					<< nodeId.uint());
-			_namespaces.forwarding(nodeId, true);
-			//_namespaces.publishFromBuffer(nodeId);//should be always empty
-			break;
-		}
-		/*
-		 * Stop publish
-		 */
-		case STOP_PUBLISH:
+		if (event->type == PUBLISHED_DATA_iSUB)
 		{
-			LOG4CXX_DEBUG(logger, "STOP_PUBLISH received for CID "
-					<< icnId.print());
-			_namespaces.forwarding(icnId, false);
-			break;
+			rCIdStr = chararray_to_hex(event->isubID);
+			rCId = rCIdStr;
+			// add NID > rCID look up to HTTP handler so when START_PUBLISH_iSUB
+			// arrives the corresponding rCID can be looked up. This is done
+			// here so that it cannot overtake the START_PUBLISH_iSUB event
+			_namespaces.Http::addReversNidTorCIdLookUp(event->nodeId, rCId);
 		}
-		//FIXME No STOP_PUBLISH_iSUB???
-		/*
-		 * Pause publish
-		 */
-		case PAUSE_PUBLISH:
-			_namespaces.forwarding(icnId, false);
-			break;
-		/*
-		 * Published data
-		 */
-		case PUBLISHED_DATA:
-		{
-			dataLength = event.data_len;
-			uint16_t sessionKey = 0;
-			LOG4CXX_TRACE(logger, "PUBLISHED_DATA of length " << event.data_len
-					<< " received under (r)CID " << icnId.print());
-			TpState tpState = _transport.handle(icnId, event.data, dataLength,
-				sessionKey);
 
-			if (tpState == TP_STATE_ALL_FRAGMENTS_RECEIVED)
-			{
-				bzero(retrievedPacket, 65535);
-				string nodeId = _configuration.nodeId().str();
-				// If packet could be retrieve, send it
-				if (_transport.retrievePacket(icnId, nodeId,
-						sessionKey, retrievedPacket, retrievedPacketSize))
-				{
-					_namespaces.sendToEndpoint(icnId,
-							retrievedPacket, retrievedPacketSize);
-				}
-				else
-				{
-					LOG4CXX_WARN(logger, "Packet could not be retrieved");
-				}
-			}
-			else if (tpState == TP_STATE_SESSION_ENDED)
+		// Control events go to the worker of their CID too, so that they are
+		// handled in order with the published data of that CID
+		icnDispatcher.dispatch(event);
+	}
+}
+
+void Icn::_handleEvent(Event *event, unsigned int worker)
+{
+	IcnId icnId;
+	string icnIdStr = chararray_to_hex(event->id);
+	icnId = icnIdStr;
+	uint8_t *retrievedPacket = NULL;
+	uint16_t retrievedPacketSize = 0;
+	uint16_t dataLength = event->data_len;
+
+	switch (event->type)
+	{
+	/*
+	 * Published data
+	 */
+	case PUBLISHED_DATA:
+	{
+		uint16_t sessionKey = 0;
+		LOG4CXX_TRACE(logger, "PUBLISHED_DATA of length " << event->data_len
+				<< " received under (r)CID " << icnId.print());
+		TpState tpState = _transport.handle(icnId, event->data, dataLength,
+			sessionKey);
+
+		if (tpState == TP_STATE_ALL_FRAGMENTS_RECEIVED)
+		{
+			string nodeId = _configuration.nodeId().str();
+			// If packet could be retrieve, send it
+			if (_transport.retrievePacket(icnId, nodeId,
+					sessionKey, retrievedPacket, retrievedPacketSize))
 			{
-				_namespaces.endOfSession(icnId, sessionKey);
+				_namespaces.sendToEndpoint(icnId,
+						retrievedPacket, retrievedPacketSize);
+				free(retrievedPacket);
 			}
-			else if (tpState == TP_STATE_NO_TRANSPORT_PROTOCOL_USED)
+			else
 			{
-				_namespaces.handlePublishedData(icnId, event.data,
-						event.data_len);
+				LOG4CXX_WARN(logger, "Packet could not be retrieved");
 			}
-			break;
 		}
-		/*
-		 * Published data iSub for HTTP-over-ICN namespace (requests)
-		 */
-		case PUBLISHED_DATA_iSUB:
+		else if (tpState == TP_STATE_SESSION_ENDED)
 		{
-			rCIdStr = chararray_to_hex(event.isubID);
-			rCId = rCIdStr;
-			dataLength = event.data_len;
-			uint16_t sessionKey;
-			LOG4CXX_TRACE(logger, "PUBLISHED_DATA_iSUB received for CID "
-						<< icnId.print() << " and rCID " << rCId.print()
-						<< " of length " << event.data_len);
-			// add NID > rCID look up to HTTP handler so when START_PUBLISH_iSUB
-			// arrives the corresponding rCID can be looked up
-			_namespaces.Http::addReversNidTorCIdLookUp(event.nodeId, rCId);
+			_namespaces.endOfSession(icnId, sessionKey);
+		}
+		else if (tpState == TP_STATE_NO_TRANSPORT_PROTOCOL_USED)
+		{
+			_namespaces.handlePublishedData(icnId, event->data,
+					event->data_len);
+		}
+		break;
+	}
+	/*
+	 * Published data iSub for HTTP-over-ICN namespace (requests)
+	 */
+	case PUBLISHED_DATA_iSUB:
+	{
+		IcnId rCId;
+		string rCIdStr = chararray_to_hex(event->isubID);
+		rCId = rCIdStr;
+		uint16_t sessionKey;
+		LOG4CXX_TRACE(logger, "PUBLISHED_DATA_iSUB received for CID "
+					<< icnId.print() << " and rCID " << rCId.print()
+					<< " of length " << event->data_len);
+		// handle received publication
+		if (_transport.handle(icnId, rCId, event->nodeId, event->data,
+				dataLength, sessionKey)
+				== TP_STATE_ALL_FRAGMENTS_RECEIVED)
+		{
+			if (!_transport.retrievePacket(rCId, event->nodeId,
+					sessionKey, retrievedPacket, retrievedPacketSize))
+			{//packet retrieval failed. Break here
+				LOG4CXX_TRACE(logger, "HTTP request packet retrieval failed"
+						"for CID " << icnId.print() << ", rCID "
+						<< rCId.print() << " and NID " << event->nodeId);
+				break;
+			}
 
-			// handle received publication
-			if (_transport.handle(icnId, rCId, event.nodeId, event.data,
-					dataLength, sessionKey)
-					== TP_STATE_ALL_FRAGMENTS_RECEIVED)
+			// switch over root scope to know which proxy should be called
+			switch (icnId.rootNamespace())
 			{
-				bzero(retrievedPacket, 65535);
-
-				if (!_transport.retrievePacket(rCId, event.nodeId,
-						sessionKey, retrievedPacket, retrievedPacketSize))
-				{//packet retrieval failed. Break here
-					LOG4CXX_TRACE(logger, "HTTP request packet retrieval failed"
-							"for CID " << icnId.print() << ", rCID "
-							<< rCId.print() << " and NID " << event.nodeId);
-					break;
-				}
-
-				// switch over root scope to know which proxy should be called
-				switch (icnId.rootNamespace())
-				{
-				case NAMESPACE_HTTP:
+			case NAMESPACE_HTTP:
+			{
+				// Response of an identical request in flight is multicast
+				if (_namespaces.Http::coalesceRequest(rCId, retrievedPacket,
+						retrievedPacketSize))
 				{
-					tcpClient.preparePacketToBeSent(icnId, rCId, sessionKey,
-							event.nodeId, retrievedPacket, retrievedPacketSize);
-					//start TCP client thread
-					tcpClientThreadsMutex.lock();
-					tcpClientThreads.push_back(std::thread(tcpClient));
-					tcpClientThreadsMutex.unlock();
-					// TODO clean up old thread entries
-					break;
-				}
-				case NAMESPACE_COAP://example entry point for other proxies
+					LOG4CXX_TRACE(logger, "HTTP request from NID "
+							<< event->nodeId << " for rCID " << rCId.print()
+							<< " served by the fetch already in flight");
 					break;
 				}
+				_tcpClients[worker].preparePacketToBeSent(icnId, rCId,
+						sessionKey, event->nodeId, retrievedPacket,
+						retrievedPacketSize);
+				//start TCP client thread
+				_tcpClientThreadsMutex.lock();
+				_tcpClientThreads.push_back(std::thread(_tcpClients[worker]));
+				_tcpClientThreadsMutex.unlock();
+				// TODO clean up old thread entries
+				break;
 			}
-			break;
-		}
-		/*
-		 * Re-publish
-		 */
-		case RE_PUBLISH:
-			LOG4CXX_TRACE(logger, "RE_PUBLISH received for CID "
-						<< icnId.print());
-			break;
-		/*
-		 * Resume publish
-		 */
-		case RESUME_PUBLISH:
-			LOG4CXX_DEBUG(logger, "RESUME_PUBLISH received for CID "
-						<< icnId.print());
-			break;
-		default:
-			LOG4CXX_WARN(logger, "Unknown BA API event type received.");
+			case NAMESPACE_COAP://example entry point for other proxies
+				break;
+			}
+			free(retrievedPacket);
 		}
+		break;
 	}
-
-	free(retrievedPacket);//clean up memory
+	/*
+	 * Scope published
+	 */
+	case SCOPE_PUBLISHED:
+		LOG4CXX_DEBUG(logger, "SCOPE_PUBLISHED received for ICN ID "
+				<< icnId.print());
+		_namespaces.subscribeScope(icnId);
+		break;
+	/*
+	 * Scope unpublished
+	 */
+	case SCOPE_UNPUBLISHED:
+		LOG4CXX_DEBUG(logger, "SCOPE_UNPUBLISHED received for ICN ID "
+				<< icnId.print());
+		break;
+	/*
+	 * Start publish
+	 */
+	case START_PUBLISH:
+	{
+		LOG4CXX_DEBUG(logger, "START_PUBLISH received for CID "
+				<< icnId.print());
+		_namespaces.forwarding(icnId, true);
+		_namespaces.publishFromBuffer(icnId);
+		break;
+	}
+	/*
+	 * Start publish iSub
+	 */
+	case START_PUBLISH_iSUB:
+	{
+		NodeId nodeId = event->id;
+		LOG4CXX_DEBUG(logger, "START_PUBLISH_iSUB received for NID "
+				<< nodeId.uint());
+		_namespaces.forwarding(nodeId, true);
+		//_namespaces.publishFromBuffer(nodeId);//should be always empty
+		break;
+	}
+	/*
+	 * Stop publish
+	 */
+	case STOP_PUBLISH:
+	{
+		LOG4CXX_DEBUG(logger, "STOP_PUBLISH received for CID "
+				<< icnId.print());
+		_namespaces.forwarding(icnId, false);
+		break;
+	}
+	//FIXME No STOP_PUBLISH_iSUB???
+	/*
+	 * Pause publish
+	 */
+	case PAUSE_PUBLISH:
+		_namespaces.forwarding(icnId, false);
+		break;
+	/*
+	 * Re-publish
+	 */
+	case RE_PUBLISH:
+		LOG4CXX_TRACE(logger, "RE_PUBLISH received for CID "
+					<< icnId.print());
+		break;
+	/*
+	 * Resume publish
+	 */
+	case RESUME_PUBLISH:
+		LOG4CXX_DEBUG(logger, "RESUME_PUBLISH received for CID "
+					<< icnId.print());
+		break;
+	default:
+		LOG4CXX_WARN(logger, "Unknown BA API event type received.");
+	}
+	delete event;
 }
@@ -24,11 +24,14 @@
 
 #include <blackadder.hpp>
 #include <log4cxx/logger.h>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 #include <configuration.hh>
 #include <enumerations.hh>
 #include <namespaces/namespaces.hh>
+#include <proxies/http/tcpclient.hh>
 #include <transport/transport.hh>
 #include <types/icnid.hh>
 
@@ -36,12 +39,28 @@
 #include "dmalloc.h"
 #endif
 
+using namespace proxies::http::tcpclient;
 using namespace transport;
 
 namespace icn
 {
 /*!
  * \brief Implementation of the ICN handler
+ *
+ * The functor receives all BA API events and hands them over to the ICN
+ * dispatcher, whose worker threads handle them. Control events (e.g.
+ * START_PUBLISH or STOP_PUBLISH) go to the same worker as the published data of
+ * their CID, so a CID's events are handled in the order they were received.
+ * START_PUBLISH_iSUB carries a NID instead of a CID. It only follows the
+ * publications the NAP made to that NID, i.e. after the request from that NID
+ * had been handled.
+ *
+ * With more than one worker the namespace handlers (Ip, Http and DnsLocal) are
+ * called concurrently. They keep all their state, including the map iterators
+ * they hold as members, under their own mutexes and never call into another
+ * namespace while holding one. The transport and the ICN publisher they call
+ * with a mutex held only take mutexes of their own. As the class holds a mutex
+ * it must be run in a thread with std::ref
  */
 class Icn
 {
@@ -65,6 +84,17 @@ private:
 	Configuration &_configuration; /*!< Reference to Configuration class */
 	Namespaces &_namespaces; /*!< Reference to ICN Namespaces */
 	Transport &_transport; /*!< Reference to Transport classes */
+	vector<TcpClient> _tcpClients;/*!< One copy of the TCP client per ICN
+	worker. The copies share the TCP sessions towards the servers */
+	vector<std::thread> _tcpClientThreads;/*!< TCP client threads */
+	std::mutex _tcpClientThreadsMutex;/*!< Mutex for _tcpClientThreads */
+	/*!
+	 * \brief Handle a BA API event (called by the ICN dispatcher workers)
+	 *
+	 * \param event Pointer to the event which is deleted afterwards
+	 * \param worker The index of the worker calling this method
+	 */
+	void _handleEvent(Event *event, unsigned int worker);
 };
 
 } /* namespace icn */
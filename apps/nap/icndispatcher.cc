@@ -0,0 +1,141 @@
+/*
+ * icndispatcher.cc
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "icndispatcher.hh"
+
+using namespace icn;
+using namespace log4cxx;
+
+LoggerPtr IcnDispatcher::logger(Logger::getLogger("icn"));
+
+IcnDispatcher::IcnDispatcher(unsigned int workers,
+		function<void (Event *, unsigned int)> handler)
+	: _handler(handler)
+{
+	if (workers == 0)
+	{
+		workers = 1;
+	}
+	for (unsigned int i = 0; i < workers; i++)
+	{
+		IcnDispatcherQueue *queue = new IcnDispatcherQueue;
+		queue->stopped = false;
+		_queues.push_back(queue);
+	}
+	for (unsigned int i = 0; i < workers; i++)
+	{
+		_workers.push_back(std::thread(&IcnDispatcher::_work, this, i));
+	}
+	LOG4CXX_DEBUG(logger, "ICN dispatcher started with " << workers
+			<< " worker(s)");
+}
+
+IcnDispatcher::~IcnDispatcher()
+{
+	stop();
+	for (auto it = _queues.begin(); it != _queues.end(); it++)
+	{
+		while (!(*it)->events.empty())
+		{
+			delete (*it)->events.front();
+			(*it)->events.pop_front();
+		}
+		delete *it;
+	}
+}
+
+void IcnDispatcher::dispatch(Event *event)
+{
+	// PUBLISHED_DATA_iSUB events of an FQDN are spread by their rCID
+	const string &flowId = event->isubID.empty() ? event->id : event->isubID;
+	Fnv64_t hash = fnv1a_64((const unsigned char *)flowId.data(),
+			flowId.length());
+	IcnDispatcherQueue *queue = _queues[hash % _queues.size()];
+	std::unique_lock<std::mutex> lock(queue->mutex);
+	while (queue->events.size() >= ICN_DISPATCHER_QUEUE_SIZE
+			&& !queue->stopped)
+	{
+		queue->notFull.wait(lock);
+	}
+	if (queue->stopped)
+	{
+		lock.unlock();
+		LOG4CXX_TRACE(logger, "ICN dispatcher stopped. Event dropped");
+		delete event;
+		return;
+	}
+	queue->events.push_back(event);
+	// Only the first event wakes up the worker, it takes all queued events
+	if (queue->events.size() == 1)
+	{
+		queue->notEmpty.notify_one();
+	}
+}
+
+void IcnDispatcher::stop()
+{
+	for (auto it = _queues.begin(); it != _queues.end(); it++)
+	{
+		std::lock_guard<std::mutex> lock((*it)->mutex);
+		(*it)->stopped = true;
+		(*it)->notEmpty.notify_one();
+		(*it)->notFull.notify_all();
+	}
+	for (auto it = _workers.begin(); it != _workers.end(); it++)
+	{
+		if (it->joinable())
+		{
+			it->join();
+		}
+	}
+}
+
+unsigned int IcnDispatcher::workers()
+{
+	return _queues.size();
+}
+
+void IcnDispatcher::_work(unsigned int index)
+{
+	IcnDispatcherQueue *queue = _queues[index];
+	deque<Event *> events;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(queue->mutex);
+			while (queue->events.empty() && !queue->stopped)
+			{
+				queue->notEmpty.wait(lock);
+			}
+			if (queue->events.empty())
+			{// stopped and drained
+				break;
+			}
+			// Take all queued events at once so that the receiver only
+			// contends for the lock once per batch
+			events.swap(queue->events);
+			queue->notFull.notify_all();
+		}
+		while (!events.empty())
+		{
+			_handler(events.front(), index);
+			events.pop_front();
+		}
+	}
+	LOG4CXX_DEBUG(logger, "ICN dispatcher worker " << index << " stopped");
+}
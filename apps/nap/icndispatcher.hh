@@ -0,0 +1,115 @@
+/*
+ * icndispatcher.hh
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NAP_ICNDISPATCHER_HH_
+#define NAP_ICNDISPATCHER_HH_
+
+#include <blackadder.hpp>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <log4cxx/logger.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef DMALLOC
+#include "dmalloc.h"
+#endif
+
+#define ICN_DISPATCHER_QUEUE_SIZE 1024
+
+using namespace std;
+
+namespace icn
+{
+/*!
+ * \brief The bounded queue of an ICN dispatcher worker
+ */
+struct IcnDispatcherQueue
+{
+	std::mutex mutex;/*!< Mutex for all members below */
+	std::condition_variable notEmpty;/*!< Signalled when events are queued */
+	std::condition_variable notFull;/*!< Signalled when the worker took the
+	queued events */
+	deque<Event *> events;/*!< The queued events */
+	bool stopped;/*!< stop() has been called */
+};
+/*!
+ * \brief Dispatcher of BA API events onto a number of worker threads
+ *
+ * Events are hashed by their ICN ID (the rCID for PUBLISHED_DATA_iSUB) onto
+ * the workers, so that all events of a CID (or rCID) are handled in the order
+ * they were received by the same worker while the events of unrelated flows
+ * are handled in parallel. Each worker has a queue of up to
+ * ICN_DISPATCHER_QUEUE_SIZE events. dispatch() blocks if the queue of the
+ * worker is full, which pushes back onto the ICN core.
+ */
+class IcnDispatcher
+{
+	static log4cxx::LoggerPtr logger;
+public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * Starts the worker threads.
+	 *
+	 * \param workers The number of worker threads (at least 1)
+	 * \param handler The method the workers call for each event. The handler
+	 * takes the ownership of the event and the index of the worker calling it
+	 */
+	IcnDispatcher(unsigned int workers,
+			function<void (Event *, unsigned int)> handler);
+	/*!
+	 * \brief Destructor
+	 *
+	 * Stops the workers (if not done yet) and deletes all events which have
+	 * not been handled
+	 */
+	~IcnDispatcher();
+	/*!
+	 * \brief Queue an event for the worker its ICN ID hashes onto
+	 *
+	 * \param event Pointer to the event. The dispatcher takes the ownership
+	 */
+	void dispatch(Event *event);
+	/*!
+	 * \brief Stop the workers once they have handled all queued events
+	 */
+	void stop();
+	/*!
+	 * \brief Obtain the number of worker threads
+	 *
+	 * \return The number of workers
+	 */
+	unsigned int workers();
+private:
+	function<void (Event *, unsigned int)> _handler;/*!< The event handler */
+	vector<IcnDispatcherQueue *> _queues;/*!< One queue per worker */
+	vector<std::thread> _workers;/*!< The worker threads */
+	/*!
+	 * \brief The loop of a worker thread
+	 *
+	 * \param index The index of the worker
+	 */
+	void _work(unsigned int index);
+};
+
+} /* namespace icn */
+
+#endif /* NAP_ICNDISPATCHER_HH_ */
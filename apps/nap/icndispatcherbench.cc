@@ -0,0 +1,175 @@
+/*
+ * icndispatcherbench.cc
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Loopback benchmark of the ICN dispatcher (it does not need Blackadder). A
+ * fake event source creates PUBLISHED_DATA events for a number of flows (CIDs)
+ * the way Icn::operator() receives them, and the handler hashes every payload
+ * a few times to stand in for the transport and the namespaces. The events are
+ * first handled inline by the source thread (as the NAP used to do) and then
+ * through the ICN dispatcher with 1, 2, 4, ... workers. The handler also
+ * checks that the events of each flow arrive in order.
+ *
+ * Usage: icndispatcherbench [max workers] [events] [flows] [payload size]
+ * [hash rounds]
+ */
+
+#include <blackadder.hpp>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include <icndispatcher.hh>
+
+using namespace icn;
+using namespace std;
+
+unsigned int maxWorkers = 8;
+unsigned int events = 1000000;
+unsigned int flows = 256;
+unsigned int payloadSize = 1400;
+unsigned int hashRounds = 4;
+
+vector<uint32_t> lastSequence;/*!< Only the worker of a flow touches its
+entry */
+unsigned long long outOfOrder = 0;
+unsigned long long checksum = 0;
+
+/*!
+ * \brief The CID of a flow (2 fragments, the flow index in the last 4 bytes)
+ */
+string flowId(uint32_t flow)
+{
+	string id(2 * PURSUIT_ID_LEN, '\0');
+	id[0] = 0x02;
+	memcpy(&id[2 * PURSUIT_ID_LEN - sizeof(flow)], &flow, sizeof(flow));
+	return id;
+}
+
+Event *fakeEvent(vector<string> &ids, uint32_t flow, uint32_t sequence)
+{
+	Event *event = new Event;
+	event->type = PUBLISHED_DATA;
+	event->id = ids[flow];
+	event->buffer = malloc(payloadSize);
+	event->data = event->buffer;
+	event->data_len = payloadSize;
+	memcpy(event->data, &sequence, sizeof(sequence));
+	memset((uint8_t *)event->data + sizeof(sequence), (uint8_t)flow,
+			payloadSize - sizeof(sequence));
+	return event;
+}
+
+void handle(Event *event, unsigned int worker)
+{
+	uint32_t flow;
+	uint32_t sequence;
+	Fnv64_t hash = 0;
+	memcpy(&flow, &event->id[2 * PURSUIT_ID_LEN - sizeof(flow)], sizeof(flow));
+	memcpy(&sequence, event->data, sizeof(sequence));
+	if (sequence != lastSequence[flow] + 1)
+	{
+		__sync_fetch_and_add(&outOfOrder, 1);
+	}
+	lastSequence[flow] = sequence;
+	for (unsigned int i = 0; i < hashRounds; i++)
+	{
+		hash += fnv1a_64((const unsigned char *)event->data, event->data_len);
+	}
+	__sync_fetch_and_add(&checksum, hash);
+	delete event;
+}
+
+/*!
+ * \brief Run the fake event source
+ *
+ * \param workers The number of workers or 0 to handle the events inline
+ *
+ * \return The number of events per second
+ */
+double run(vector<string> &ids, unsigned int workers)
+{
+	vector<uint32_t> sequences(flows, 0);
+	chrono::steady_clock::time_point start;
+	lastSequence.assign(flows, 0);
+	start = chrono::steady_clock::now();
+	if (workers == 0)
+	{
+		for (unsigned int i = 0; i < events; i++)
+		{
+			uint32_t flow = i % flows;
+			handle(fakeEvent(ids, flow, ++sequences[flow]), 0);
+		}
+	}
+	else
+	{
+		IcnDispatcher icnDispatcher(workers, handle);
+		for (unsigned int i = 0; i < events; i++)
+		{
+			uint32_t flow = i % flows;
+			icnDispatcher.dispatch(fakeEvent(ids, flow, ++sequences[flow]));
+		}
+		icnDispatcher.stop();
+	}
+	return events / chrono::duration<double>(chrono::steady_clock::now()
+			- start).count();
+}
+
+int main(int argc, char *argv[])
+{
+	vector<string> ids;
+	if (argc > 1)
+	{
+		maxWorkers = atoi(argv[1]);
+	}
+	if (argc > 2)
+	{
+		events = atoi(argv[2]);
+	}
+	if (argc > 3)
+	{
+		flows = atoi(argv[3]);
+	}
+	if (argc > 4)
+	{
+		payloadSize = atoi(argv[4]);
+	}
+	if (argc > 5)
+	{
+		hashRounds = atoi(argv[5]);
+	}
+	if (payloadSize < sizeof(uint32_t))
+	{
+		payloadSize = sizeof(uint32_t);
+	}
+	for (uint32_t flow = 0; flow < flows; flow++)
+	{
+		ids.push_back(flowId(flow));
+	}
+	cout << events << " events, " << flows << " flows, " << payloadSize
+			<< " bytes, " << hashRounds << " hash rounds, "
+			<< thread::hardware_concurrency() << " CPUs" << endl;
+	cout << "inline:       " << run(ids, 0) << " events/s" << endl;
+	for (unsigned int workers = 1; workers <= maxWorkers; workers *= 2)
+	{
+		cout << workers << " worker(s): " << run(ids, workers) << " events/s"
+				<< endl;
+	}
+	cout << outOfOrder << " events out of order" << endl;
+	return outOfOrder == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,353 @@
+/*
+ * icnpublisher.cc
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <thread>
+
+#include "icnpublisher.hh"
+
+using namespace icn;
+using namespace log4cxx;
+
+LoggerPtr IcnPublisher::logger(Logger::getLogger("icn"));
+
+IcnPublisher::IcnPublisher(Blackadder *icnCore, uint32_t queueSize)
+	: _icnCore(icnCore)
+{
+	_stub.next.store(NULL);
+	_head.store(&_stub);
+	_tail = &_stub;
+	_sleeping.store(false);
+	_stopped.store(false);
+	sem_init(&_wakeUp, 0, 0);
+	sem_init(&_slots, 0, queueSize);
+}
+
+IcnPublisher::~IcnPublisher()
+{
+	IcnPublisherRequest *request;
+	while ((request = _pop()) != NULL)
+	{
+		_delete(request);
+	}
+	sem_destroy(&_wakeUp);
+	sem_destroy(&_slots);
+}
+
+void IcnPublisher::operator()()
+{
+	IcnPublisherRequest *batch[PUBLISH_BATCH_SIZE];
+	IcnPublisherRequest *request;
+	unsigned int batchSize = 0;
+	LOG4CXX_DEBUG(logger, "ICN publisher thread started");
+	while (true)
+	{
+		request = _pop();
+		if (request != NULL)
+		{
+			if (request->type == ICN_PUBLISHER_DATA)
+			{
+				batch[batchSize++] = request;
+				if (batchSize == PUBLISH_BATCH_SIZE)
+				{
+					_sendBatch(batch, batchSize);
+					batchSize = 0;
+				}
+			}
+			else
+			{
+				// Keep the order: the batch collected so far goes first
+				if (batchSize > 0)
+				{
+					_sendBatch(batch, batchSize);
+					batchSize = 0;
+				}
+				_send(request);
+			}
+			continue;
+		}
+		// Nothing left to pop (for now). Send what has been collected
+		if (batchSize > 0)
+		{
+			_sendBatch(batch, batchSize);
+			batchSize = 0;
+			continue;
+		}
+		if (_stopped.load() && _empty())
+		{
+			break;
+		}
+		// Tell the producers to wake up the sender, then check again so that
+		// a request queued in between is not missed
+		_sleeping.store(true);
+		if (_empty())
+		{
+			if (!_stopped.load())
+			{
+				sem_wait(&_wakeUp);
+			}
+		}
+		else
+		{// A producer is in the middle of appending a request
+			std::this_thread::yield();
+		}
+		_sleeping.store(false);
+	}
+	LOG4CXX_DEBUG(logger, "ICN publisher thread stopped");
+}
+
+void IcnPublisher::publishData(const string &icnId, void *data,
+		uint32_t dataSize)
+{
+	_push(_request(ICN_PUBLISHER_DATA, icnId, data, dataSize));
+}
+
+void IcnPublisher::publishData(const string &icnId, list<string> &nodeIds,
+		void *data, uint32_t dataSize)
+{
+	IcnPublisherRequest *request = _request(ICN_PUBLISHER_DATA_NIDS, icnId,
+			data, dataSize);
+	request->nodeIds = nodeIds;
+	_push(request);
+}
+
+void IcnPublisher::publishDataiSub(const string &icnId,
+		const string &isubIcnId, void *data, uint32_t dataSize)
+{
+	IcnPublisherRequest *request = _request(ICN_PUBLISHER_DATA_ISUB, icnId,
+			data, dataSize);
+	request->isubIcnId = isubIcnId;
+	_push(request);
+}
+
+void IcnPublisher::publishScope(const string &icnId,
+		const string &prefixIcnId)
+{
+	_control(ICN_PUBLISHER_PUBLISH_SCOPE, icnId, prefixIcnId);
+}
+
+void IcnPublisher::publishInfo(const string &icnId, const string &prefixIcnId)
+{
+	_control(ICN_PUBLISHER_PUBLISH_INFO, icnId, prefixIcnId);
+}
+
+void IcnPublisher::unpublishInfo(const string &icnId,
+		const string &prefixIcnId)
+{
+	_control(ICN_PUBLISHER_UNPUBLISH_INFO, icnId, prefixIcnId);
+}
+
+void IcnPublisher::subscribeScope(const string &icnId,
+		const string &prefixIcnId)
+{
+	_control(ICN_PUBLISHER_SUBSCRIBE_SCOPE, icnId, prefixIcnId);
+}
+
+void IcnPublisher::subscribeInfo(const string &icnId,
+		const string &prefixIcnId)
+{
+	_control(ICN_PUBLISHER_SUBSCRIBE_INFO, icnId, prefixIcnId);
+}
+
+void IcnPublisher::unsubscribeScope(const string &icnId,
+		const string &prefixIcnId)
+{
+	_control(ICN_PUBLISHER_UNSUBSCRIBE_SCOPE, icnId, prefixIcnId);
+}
+
+void IcnPublisher::unsubscribeInfo(const string &icnId,
+		const string &prefixIcnId)
+{
+	_control(ICN_PUBLISHER_UNSUBSCRIBE_INFO, icnId, prefixIcnId);
+}
+
+void IcnPublisher::stop()
+{
+	_stopped.store(true);
+	sem_post(&_wakeUp);
+}
+
+void IcnPublisher::_push(IcnPublisherRequest *request)
+{
+	IcnPublisherRequest *previous;
+	request->next.store(NULL, memory_order_relaxed);
+	previous = _head.exchange(request);
+	previous->next.store(request, memory_order_release);
+	if (_sleeping.load())
+	{
+		sem_post(&_wakeUp);
+	}
+}
+
+IcnPublisherRequest *IcnPublisher::_pop()
+{
+	IcnPublisherRequest *tail = _tail;
+	IcnPublisherRequest *next = tail->next.load(memory_order_acquire);
+	if (tail == &_stub)
+	{
+		if (next == NULL)
+		{
+			return NULL;
+		}
+		_tail = next;
+		tail = next;
+		next = next->next.load(memory_order_acquire);
+	}
+	if (next != NULL)
+	{
+		_tail = next;
+		return tail;
+	}
+	if (tail != _head.load())
+	{// A producer has not linked its request yet
+		return NULL;
+	}
+	// tail is the last request: put the stub behind it so it can be returned
+	_push(&_stub);
+	next = tail->next.load(memory_order_acquire);
+	if (next != NULL)
+	{
+		_tail = next;
+		return tail;
+	}
+	return NULL;
+}
+
+bool IcnPublisher::_empty()
+{
+	return (_tail == &_stub) && (_head.load() == &_stub);
+}
+
+IcnPublisherRequest *IcnPublisher::_request(uint8_t type, const string &icnId,
+		void *data, uint32_t dataSize)
+{
+	IcnPublisherRequest *request;
+	// Wait for a slot before copying the data, so that a full queue bounds the
+	// memory too
+	if (sem_trywait(&_slots) != 0)
+	{
+		LOG4CXX_TRACE(logger, "ICN publisher queue full, waiting for the "
+				"sender");
+		while (sem_wait(&_slots) != 0 && errno == EINTR);
+	}
+	request = new IcnPublisherRequest;
+	request->type = type;
+	request->icnId = icnId;
+	request->data = NULL;
+	if (dataSize > 0)
+	{
+		request->data = (uint8_t *)malloc(dataSize);
+		memcpy(request->data, data, dataSize);
+	}
+	request->dataSize = dataSize;
+	return request;
+}
+
+void IcnPublisher::_control(uint8_t type, const string &icnId,
+		const string &prefixIcnId)
+{
+	IcnPublisherRequest *request = _request(type, icnId, NULL, 0);
+	request->prefixIcnId = prefixIcnId;
+	_push(request);
+}
+
+void IcnPublisher::_delete(IcnPublisherRequest *request)
+{
+	free(request->data);
+	delete request;
+	sem_post(&_slots);
+}
+
+void IcnPublisher::_sendBatch(IcnPublisherRequest **requests,
+		unsigned int count)
+{
+	PublishRequest publishRequests[PUBLISH_BATCH_SIZE];
+	int sent;
+	unsigned int skipped;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		publishRequests[i].id = &requests[i]->icnId;
+		publishRequests[i].strategy = DOMAIN_LOCAL;
+		publishRequests[i].str_opt = NULL;
+		publishRequests[i].str_opt_len = 0;
+		publishRequests[i].data = requests[i]->data;
+		publishRequests[i].data_len = requests[i]->dataSize;
+	}
+	sent = _icnCore->publish_data_batch(publishRequests, count, &skipped);
+	if (skipped > 0)
+	{
+		LOG4CXX_WARN(logger, skipped << " publications of a batch have an invalid "
+				"ICN ID and were not sent to the ICN core");
+	}
+	if (sent + skipped < count)
+	{
+		LOG4CXX_WARN(logger, "Only " << sent << " of " << count
+				<< " publications of a batch could be sent to the ICN core");
+	}
+	for (unsigned int i = 0; i < count; i++)
+	{
+		_delete(requests[i]);
+	}
+}
+
+void IcnPublisher::_send(IcnPublisherRequest *request)
+{
+	switch (request->type)
+	{
+	case ICN_PUBLISHER_DATA_NIDS:
+		_icnCore->publish_data(request->icnId, DOMAIN_LOCAL, NULL, 0,
+				request->nodeIds, request->data, request->dataSize);
+		break;
+	case ICN_PUBLISHER_DATA_ISUB:
+		_icnCore->publish_data_isub(request->icnId, DOMAIN_LOCAL, NULL, 0,
+				request->isubIcnId, request->data, request->dataSize);
+		break;
+	case ICN_PUBLISHER_PUBLISH_SCOPE:
+		_icnCore->publish_scope(request->icnId, request->prefixIcnId,
+				DOMAIN_LOCAL, NULL, 0);
+		break;
+	case ICN_PUBLISHER_PUBLISH_INFO:
+		_icnCore->publish_info(request->icnId, request->prefixIcnId,
+				DOMAIN_LOCAL, NULL, 0);
+		break;
+	case ICN_PUBLISHER_UNPUBLISH_INFO:
+		_icnCore->unpublish_info(request->icnId, request->prefixIcnId,
+				DOMAIN_LOCAL, NULL, 0);
+		break;
+	case ICN_PUBLISHER_SUBSCRIBE_SCOPE:
+		_icnCore->subscribe_scope(request->icnId, request->prefixIcnId,
+				DOMAIN_LOCAL, NULL, 0);
+		break;
+	case ICN_PUBLISHER_SUBSCRIBE_INFO:
+		_icnCore->subscribe_info(request->icnId, request->prefixIcnId,
+				DOMAIN_LOCAL, NULL, 0);
+		break;
+	case ICN_PUBLISHER_UNSUBSCRIBE_SCOPE:
+		_icnCore->unsubscribe_scope(request->icnId, request->prefixIcnId,
+				DOMAIN_LOCAL, NULL, 0);
+		break;
+	case ICN_PUBLISHER_UNSUBSCRIBE_INFO:
+		_icnCore->unsubscribe_info(request->icnId, request->prefixIcnId,
+				DOMAIN_LOCAL, NULL, 0);
+		break;
+	default:
+		_icnCore->publish_data(request->icnId, DOMAIN_LOCAL, NULL, 0,
+				request->data, request->dataSize);
+	}
+	_delete(request);
+}
@@ -0,0 +1,250 @@
+/*
+ * icnpublisher.hh
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NAP_ICNPUBLISHER_HH_
+#define NAP_ICNPUBLISHER_HH_
+
+#include <atomic>
+#include <blackadder.hpp>
+#include <list>
+#include <log4cxx/logger.h>
+#include <semaphore.h>
+#include <string>
+
+#ifdef DMALLOC
+#include "dmalloc.h"
+#endif
+
+using namespace std;
+
+/*!
+ * \brief The default number of requests the ICN publisher queues at most
+ */
+#define ICN_PUBLISHER_QUEUE_SIZE 65536
+
+namespace icn
+{
+/*!
+ * \brief The types of the requests queued in the ICN publisher
+ */
+enum IcnPublisherRequestTypes
+{
+	ICN_PUBLISHER_DATA,/*!< publish_data */
+	ICN_PUBLISHER_DATA_NIDS,/*!< publish_data to a list of NIDs */
+	ICN_PUBLISHER_DATA_ISUB,/*!< publish_data_isub */
+	ICN_PUBLISHER_PUBLISH_SCOPE,/*!< publish_scope */
+	ICN_PUBLISHER_PUBLISH_INFO,/*!< publish_info */
+	ICN_PUBLISHER_UNPUBLISH_INFO,/*!< unpublish_info */
+	ICN_PUBLISHER_SUBSCRIBE_SCOPE,/*!< subscribe_scope */
+	ICN_PUBLISHER_SUBSCRIBE_INFO,/*!< subscribe_info */
+	ICN_PUBLISHER_UNSUBSCRIBE_SCOPE,/*!< unsubscribe_scope */
+	ICN_PUBLISHER_UNSUBSCRIBE_INFO/*!< unsubscribe_info */
+};
+/*!
+ * \brief A request queued in the ICN publisher
+ */
+struct IcnPublisherRequest
+{
+	atomic<IcnPublisherRequest *> next;/*!< Next request in the queue */
+	uint8_t type;/*!< The request type (IcnPublisherRequestTypes) */
+	string icnId;/*!< The binary ICN ID to publish under */
+	string isubIcnId;/*!< The binary iSub ICN ID (ICN_PUBLISHER_DATA_ISUB) */
+	string prefixIcnId;/*!< The binary prefix ID (control requests) */
+	list<string> nodeIds;/*!< The NIDs (ICN_PUBLISHER_DATA_NIDS) */
+	uint8_t *data;/*!< Copy of the data to be published (NULL for control
+	requests) */
+	uint32_t dataSize;/*!< Length of data */
+};
+/*!
+ * \brief Publisher of all data-plane publications to the ICN core
+ *
+ * All NAP threads used to call the Blackadder API under a single shared mutex.
+ * Instead, they now append their publications to a lock-free multi-producer
+ * single-consumer queue, and a single sender thread (this class' functor)
+ * drains it. Consecutive ICN_PUBLISHER_DATA requests are sent in batches of up
+ * to PUBLISH_BATCH_SIZE with Blackadder::publish_data_batch.
+ *
+ * The control calls (scope and information item (un)publications and
+ * (un)subscriptions) go through the same queue, so all requests of a thread are
+ * sent in the order they were made, e.g. an unpublish_info never overtakes the
+ * data published before it.
+ *
+ * The queue holds at most a given number of requests. A thread queueing a
+ * request while it is full blocks until the sender has sent one, as it used to
+ * block on the mutex while another thread was publishing.
+ */
+class IcnPublisher
+{
+	static log4cxx::LoggerPtr logger;
+public:
+	/*!
+	 * \brief Constructor
+	 *
+	 * \param icnCore Pointer to the Blackadder instance
+	 * \param queueSize The number of requests the queue holds at most
+	 */
+	IcnPublisher(Blackadder *icnCore,
+			uint32_t queueSize = ICN_PUBLISHER_QUEUE_SIZE);
+	/*!
+	 * \brief Destructor
+	 */
+	~IcnPublisher();
+	/*!
+	 * \brief Functor to run the sender in a thread
+	 */
+	void operator()();
+	/*!
+	 * \brief Queue a publish_data request (DOMAIN_LOCAL)
+	 *
+	 * The data is copied, so the caller can free it right after this method
+	 * returns.
+	 *
+	 * \param icnId The binary ICN ID
+	 * \param data Pointer to the data
+	 * \param dataSize Length of the data
+	 */
+	void publishData(const string &icnId, void *data, uint32_t dataSize);
+	/*!
+	 * \brief Queue a publish_data request to a list of NIDs (DOMAIN_LOCAL)
+	 *
+	 * \param icnId The binary ICN ID
+	 * \param nodeIds The list of NIDs
+	 * \param data Pointer to the data
+	 * \param dataSize Length of the data
+	 */
+	void publishData(const string &icnId, list<string> &nodeIds, void *data,
+			uint32_t dataSize);
+	/*!
+	 * \brief Queue a publish_data_isub request (DOMAIN_LOCAL)
+	 *
+	 * \param icnId The binary ICN ID
+	 * \param isubIcnId The binary iSub ICN ID
+	 * \param data Pointer to the data
+	 * \param dataSize Length of the data
+	 */
+	void publishDataiSub(const string &icnId, const string &isubIcnId,
+			void *data, uint32_t dataSize);
+	/*!
+	 * \brief Queue a publish_scope request (DOMAIN_LOCAL)
+	 *
+	 * \param icnId The binary scope ID
+	 * \param prefixIcnId The binary ID of the father scope
+	 */
+	void publishScope(const string &icnId, const string &prefixIcnId);
+	/*!
+	 * \brief Queue a publish_info request (DOMAIN_LOCAL)
+	 *
+	 * \param icnId The binary information item ID
+	 * \param prefixIcnId The binary ID of the father scope
+	 */
+	void publishInfo(const string &icnId, const string &prefixIcnId);
+	/*!
+	 * \brief Queue an unpublish_info request (DOMAIN_LOCAL)
+	 *
+	 * \param icnId The binary information item ID
+	 * \param prefixIcnId The binary ID of the father scope
+	 */
+	void unpublishInfo(const string &icnId, const string &prefixIcnId);
+	/*!
+	 * \brief Queue a subscribe_scope request (DOMAIN_LOCAL)
+	 *
+	 * \param icnId The binary scope ID
+	 * \param prefixIcnId The binary ID of the father scope
+	 */
+	void subscribeScope(const string &icnId, const string &prefixIcnId);
+	/*!
+	 * \brief Queue a subscribe_info request (DOMAIN_LOCAL)
+	 *
+	 * \param icnId The binary information item ID
+	 * \param prefixIcnId The binary ID of the father scope
+	 */
+	void subscribeInfo(const string &icnId, const string &prefixIcnId);
+	/*!
+	 * \brief Queue an unsubscribe_scope request (DOMAIN_LOCAL)
+	 *
+	 * \param icnId The binary scope ID
+	 * \param prefixIcnId The binary ID of the father scope
+	 */
+	void unsubscribeScope(const string &icnId, const string &prefixIcnId);
+	/*!
+	 * \brief Queue an unsubscribe_info request (DOMAIN_LOCAL)
+	 *
+	 * \param icnId The binary information item ID
+	 * \param prefixIcnId The binary ID of the father scope
+	 */
+	void unsubscribeInfo(const string &icnId, const string &prefixIcnId);
+	/*!
+	 * \brief Stop the sender once the queue has been drained
+	 *
+	 * Join the thread running the sender to wait until all requests queued
+	 * before have been sent.
+	 */
+	void stop();
+private:
+	Blackadder *_icnCore;/*!< Pointer to Blackadder instance */
+	atomic<IcnPublisherRequest *> _head;/*!< Last request queued (producers) */
+	IcnPublisherRequest *_tail;/*!< Next request to be sent (sender) */
+	IcnPublisherRequest _stub;/*!< Stub request of the intrusive queue */
+	atomic<bool> _sleeping;/*!< The sender found the queue empty */
+	atomic<bool> _stopped;/*!< stop() has been called */
+	sem_t _wakeUp;/*!< Wakes up the sender */
+	sem_t _slots;/*!< The number of requests that can still be queued */
+	/*!
+	 * \brief Append a request to the queue and wake up the sender if needed
+	 */
+	void _push(IcnPublisherRequest *request);
+	/*!
+	 * \brief Remove the oldest request from the queue (sender only)
+	 *
+	 * \return The request or NULL if the queue is empty (or a producer is
+	 * in the middle of appending the only request)
+	 */
+	IcnPublisherRequest *_pop();
+	/*!
+	 * \brief Check whether the queue is empty (sender only)
+	 */
+	bool _empty();
+	/*!
+	 * \brief Create a request with a copy of the data
+	 *
+	 * Blocks until the queue has room for the request.
+	 */
+	IcnPublisherRequest *_request(uint8_t type, const string &icnId,
+			void *data, uint32_t dataSize);
+	/*!
+	 * \brief Queue a control request
+	 */
+	void _control(uint8_t type, const string &icnId,
+			const string &prefixIcnId);
+	/*!
+	 * \brief Delete a request and give its slot in the queue back
+	 */
+	void _delete(IcnPublisherRequest *request);
+	/*!
+	 * \brief Send and delete a batch of ICN_PUBLISHER_DATA requests
+	 */
+	void _sendBatch(IcnPublisherRequest **requests, unsigned int count);
+	/*!
+	 * \brief Send and delete any other request, control requests included
+	 */
+	void _send(IcnPublisherRequest *request);
+};
+
+} /* namespace icn */
+
+#endif /* NAP_ICNPUBLISHER_HH_ */
@@ -0,0 +1,151 @@
+/*
+ * icnpublisherbench.cc
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Contention benchmark of the NAP's access to the ICN core (requires a running
+ * Blackadder). A number of threads publish packets of a given size, first the
+ * way the NAP used to do it (publish_data under one shared mutex) and then
+ * through the IcnPublisher. The IcnPublisher run is only over once its sender
+ * thread has drained the queue, so both rates are publications handed to the
+ * ICN core per second.
+ *
+ * Usage: icnpublisherbench [threads] [publications per thread] [packet size]
+ * [0 (user space) | 1 (kernel)]
+ */
+
+#include <blackadder.hpp>
+#include <boost/thread/mutex.hpp>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <icnpublisher.hh>
+
+using namespace icn;
+using namespace std;
+
+unsigned int threads = 8;
+unsigned int publications = 100000;
+unsigned int packetSize = 1400;
+
+/*!
+ * \brief The ID of the information item a thread publishes under
+ */
+string icnId(unsigned int thread)
+{
+	string id(2 * PURSUIT_ID_LEN, '\0');
+	id[0] = 0x0b;
+	id[2 * PURSUIT_ID_LEN - 1] = (char)thread;
+	return id;
+}
+
+void mutexPublisher(Blackadder *icnCore, boost::mutex &icnCoreMutex,
+		unsigned int thread)
+{
+	string id = icnId(thread);
+	uint8_t *packet = (uint8_t *)malloc(packetSize);
+	memset(packet, thread, packetSize);
+	for (unsigned int i = 0; i < publications; i++)
+	{
+		icnCoreMutex.lock();
+		icnCore->publish_data(id, DOMAIN_LOCAL, NULL, 0, packet, packetSize);
+		icnCoreMutex.unlock();
+	}
+	free(packet);
+}
+
+void queuePublisher(IcnPublisher &icnPublisher, unsigned int thread)
+{
+	string id = icnId(thread);
+	uint8_t *packet = (uint8_t *)malloc(packetSize);
+	memset(packet, thread, packetSize);
+	for (unsigned int i = 0; i < publications; i++)
+	{
+		icnPublisher.publishData(id, packet, packetSize);
+	}
+	free(packet);
+}
+
+double elapsed(chrono::steady_clock::time_point start)
+{
+	return chrono::duration<double>(chrono::steady_clock::now() - start)
+			.count();
+}
+
+int main(int argc, char *argv[])
+{
+	bool userSpace = true;
+	vector<thread> publishers;
+	chrono::steady_clock::time_point start;
+	double seconds;
+	if (argc > 1)
+	{
+		threads = atoi(argv[1]);
+	}
+	if (argc > 2)
+	{
+		publications = atoi(argv[2]);
+	}
+	if (argc > 3)
+	{
+		packetSize = atoi(argv[3]);
+	}
+	if (argc > 4)
+	{
+		userSpace = (atoi(argv[4]) == 0);
+	}
+	Blackadder *icnCore = Blackadder::Instance(userSpace);
+	double total = (double)threads * publications;
+	// Shared mutex
+	boost::mutex icnCoreMutex;
+	start = chrono::steady_clock::now();
+	for (unsigned int t = 0; t < threads; t++)
+	{
+		publishers.push_back(thread(mutexPublisher, icnCore,
+				ref(icnCoreMutex), t));
+	}
+	for (auto it = publishers.begin(); it != publishers.end(); it++)
+	{
+		it->join();
+	}
+	seconds = elapsed(start);
+	cout << "shared mutex:  " << threads << " threads, " << total / seconds
+			<< " publications/s" << endl;
+	publishers.clear();
+	// IcnPublisher
+	IcnPublisher icnPublisher(icnCore);
+	start = chrono::steady_clock::now();
+	thread sender(ref(icnPublisher));
+	for (unsigned int t = 0; t < threads; t++)
+	{
+		publishers.push_back(thread(queuePublisher, ref(icnPublisher), t));
+	}
+	for (auto it = publishers.begin(); it != publishers.end(); it++)
+	{
+		it->join();
+	}
+	icnPublisher.stop();
+	sender.join();
+	seconds = elapsed(start);
+	cout << "IcnPublisher:  " << threads << " threads, " << total / seconds
+			<< " publications/s" << endl;
+	icnCore->disconnect();
+	delete icnCore;
+	return EXIT_SUCCESS;
+}
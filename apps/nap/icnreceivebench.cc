@@ -0,0 +1,225 @@
+/*
+ * icnreceivebench.cc
+ *
+ * This file is part of Blackadder.
+ *
+ * Blackadder is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * Blackadder is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Blackadder.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Micro-benchmark of the last step of the NAP's receive path (it does not need
+ * Blackadder): the LTP data fragments of an HTTP response are handed to
+ * Lightweight::handle, which buffers them, and the packet is then retrieved
+ * with Lightweight::retrievePacket, the same code the ICN workers run. This is
+ * done twice:
+ * - as the workers do it now: the packet handed over by retrievePacket is sent
+ * off and freed
+ * - as Icn::operator() used to do it: on top of that a 64kB buffer is cleared
+ * and the packet is copied into it, as retrievePacket used to copy the
+ * fragments into that buffer. This is exactly the former work for a packet of
+ * a single fragment and one malloc'ed copy more than it for several fragments
+ * The payloads are summed up as a stand-in for sending the packet off.
+ *
+ * Usage: icnreceivebench [packets] [packet size] [fragment size]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdint.h>
+#include <strings.h>
+#include <vector>
+
+#include <configuration.hh>
+#include <icnpublisher.hh>
+#include <monitoring/statistics.hh>
+#include <transport/lightweight.hh>
+
+using namespace std;
+using namespace transport::lightweight;
+
+unsigned int packets = 1000000;
+unsigned int packetSize = 1400;
+unsigned int fragmentSize = 1300;
+
+unsigned long long checksum = 0;
+
+/*!
+ * \brief Lightweight with public access to its receive path
+ *
+ * The LTP handler is only reachable through its (protected) methods the
+ * Transport class uses. No CTRL message is handled, so neither Blackadder nor
+ * the CMC maps of the HTTP handler are needed.
+ */
+class LightweightBench: public Lightweight
+{
+public:
+	LightweightBench(Configuration &configuration, IcnPublisher &icnPublisher,
+			Statistics &statistics)
+		: Lightweight(NULL, configuration, icnPublisher, statistics)
+	{}
+	using Lightweight::handle;
+	using Lightweight::retrievePacket;
+};
+
+/*!
+ * \brief Create the LTP data fragments of a packet
+ *
+ * The header fields are written the way Lightweight::publish does it.
+ */
+void createFragments(vector<vector<uint8_t>> &fragments, uint8_t *payload,
+		uint16_t sessionKey)
+{
+	ltp_hdr_data_t ltpHeader;
+	ltpHeader.messageType = LTP_DATA;
+	ltpHeader.sessionKey = sessionKey;
+	ltpHeader.sequenceNumber = 0;
+	for (unsigned int offset = 0; offset < packetSize; offset += fragmentSize)
+	{
+		vector<uint8_t> fragment;
+		ltpHeader.sequenceNumber++;
+		ltpHeader.payloadLength = min(fragmentSize, packetSize - offset);
+		fragment.insert(fragment.end(), (uint8_t *)&ltpHeader.messageType,
+				(uint8_t *)&ltpHeader.messageType
+				+ sizeof(ltpHeader.messageType));
+		fragment.insert(fragment.end(), (uint8_t *)&ltpHeader.ripd,
+				(uint8_t *)&ltpHeader.ripd + sizeof(ltpHeader.ripd));
+		fragment.insert(fragment.end(), (uint8_t *)&ltpHeader.sessionKey,
+				(uint8_t *)&ltpHeader.sessionKey
+				+ sizeof(ltpHeader.sessionKey));
+		fragment.insert(fragment.end(), (uint8_t *)&ltpHeader.sequenceNumber,
+				(uint8_t *)&ltpHeader.sequenceNumber
+				+ sizeof(ltpHeader.sequenceNumber));
+		fragment.insert(fragment.end(), (uint8_t *)&ltpHeader.payloadLength,
+				(uint8_t *)&ltpHeader.payloadLength
+				+ sizeof(ltpHeader.payloadLength));
+		fragment.insert(fragment.end(), payload + offset,
+				payload + offset + ltpHeader.payloadLength);
+		fragments.push_back(fragment);
+	}
+}
+
+void sendOff(uint8_t *packet, uint16_t size)
+{
+	checksum += packet[0] + packet[size - 1];
+}
+
+/*!
+ * \brief Hand the fragments of a packet to LTP and retrieve the packet
+ *
+ * \param retrievedPacket The 64kB buffer to clear and copy the packet into or
+ * NULL to send off the packet retrievePacket hands over
+ *
+ * \return The size of the retrieved packet or 0 if it could not be retrieved
+ */
+uint16_t receive(LightweightBench &lightweight,
+		vector<vector<uint8_t>> &fragments, IcnId &rCId, string &nodeId,
+		uint16_t sessionKey, uint8_t *retrievedPacket)
+{
+	uint8_t *packet;
+	uint16_t size;
+	for (auto it = fragments.begin(); it != fragments.end(); it++)
+	{
+		lightweight.handle(rCId, it->data(), sessionKey);
+	}
+	if (!lightweight.retrievePacket(rCId, nodeId, sessionKey, packet, size))
+	{
+		return 0;
+	}
+	if (retrievedPacket != NULL)
+	{
+		bzero(retrievedPacket, 65535);
+		memcpy(retrievedPacket, packet, size);
+		free(packet);
+		sendOff(retrievedPacket, size);
+	}
+	else
+	{
+		sendOff(packet, size);
+		free(packet);
+	}
+	return size;
+}
+
+int main(int argc, char *argv[])
+{
+	vector<vector<uint8_t>> fragments;
+	chrono::steady_clock::time_point start;
+	double cleared, sized;
+	uint16_t sessionKey = 1;
+	if (argc > 1)
+	{
+		packets = atoi(argv[1]);
+	}
+	if (argc > 2)
+	{
+		packetSize = atoi(argv[2]);
+	}
+	if (argc > 3)
+	{
+		fragmentSize = atoi(argv[3]);
+	}
+	if (packetSize == 0 || packetSize > 65535 || fragmentSize == 0)
+	{
+		cerr << "Packet size must be within 1 - 65535 octets and the fragment "
+				"size larger than 0" << endl;
+		return EXIT_FAILURE;
+	}
+	Configuration configuration;
+	Statistics statistics;
+	IcnPublisher icnPublisher(NULL);
+	LightweightBench lightweight(configuration, icnPublisher, statistics);
+	IcnId rCId("bench.point", "/icnreceivebench");
+	string nodeId = configuration.nodeId().str();
+	uint8_t *payload = (uint8_t *)malloc(packetSize);
+	uint8_t *retrievedPacket = (uint8_t *)malloc(65535);
+	for (unsigned int i = 0; i < packetSize; i++)
+	{
+		payload[i] = i;
+	}
+	createFragments(fragments, payload, sessionKey);
+	// the packet LTP reassembles must be the one that was fragmented
+	if (receive(lightweight, fragments, rCId, nodeId, sessionKey,
+			retrievedPacket) != packetSize
+			|| memcmp(retrievedPacket, payload, packetSize) != 0)
+	{
+		cerr << "The retrieved packet differs from the one sent" << endl;
+		return EXIT_FAILURE;
+	}
+	start = chrono::steady_clock::now();
+	for (unsigned int i = 0; i < packets; i++)
+	{
+		receive(lightweight, fragments, rCId, nodeId, sessionKey,
+				retrievedPacket);
+	}
+	cleared = chrono::duration<double>(chrono::steady_clock::now() - start)
+			.count();
+	start = chrono::steady_clock::now();
+	for (unsigned int i = 0; i < packets; i++)
+	{
+		receive(lightweight, fragments, rCId, nodeId, sessionKey, NULL);
+	}
+	sized = chrono::duration<double>(chrono::steady_clock::now() - start)
+			.count();
+	cout << packets << " packets of " << packetSize << " octets in "
+			<< fragments.size() << " fragment(s)" << endl;
+	cout << "cleared 64kB buffer: " << packets / cleared << " packets/s"
+			<< endl;
+	cout << "sized buffer:        " << packets / sized << " packets/s ("
+			<< cleared / sized << "x)" << endl;
+	cout << "checksum " << checksum << endl;
+	free(payload);
+	free(retrievedPacket);
+	return EXIT_SUCCESS;
+}
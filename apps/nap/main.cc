@@ -41,6 +41,7 @@
 #include <enumerations.hh>
 #include <demux/demux.hh>
 #include <icn.hh>
+#include <icnpublisher.hh>
 #include <ipsocket.hh>
 #include <namespaces/namespaces.hh>
 #include <proxies/http/httpproxy.hh>
@@ -86,6 +87,8 @@ void quitproc(int sig);
 void shutdown();
 
 Blackadder *icnCore;
+IcnPublisher *icnPublisherPointer;
+std::thread *icnPublisherThreadPointer;
 Namespaces *namespacesPointer;
 //HttpProxy *httpProxyPointer;
 Configuration *configurationPointer;
@@ -164,17 +167,21 @@ int main(int ac, char* av[]) {
 	// Connecting to ICN core
 	icnCore = Blackadder::Instance(baUserSpace);
 	// Create TCP client instance
-	boost::mutex icnCoreMutex;/*!< Shared mutex to avoid parallel calling of BA API */
-	Transport transport(icnCore, configuration, icnCoreMutex, statistics);
+	// Start the ICN publisher all data-plane publications are sent through
+	IcnPublisher icnPublisher(icnCore);
+	icnPublisherPointer = &icnPublisher;
+	std::thread icnPublisherThread(std::ref(icnPublisher));
+	icnPublisherThreadPointer = &icnPublisherThread;
+	Transport transport(icnCore, configuration, icnPublisher, statistics);
 	// Instantiate all namespace classes
-	Namespaces namespaces(icnCore, icnCoreMutex, configuration, transport,
+	Namespaces namespaces(icnCore, icnPublisher, configuration, transport,
 			statistics);
 	namespacesPointer = &namespaces;
 	// Initialise the ICN namespaces (subscribing to respective scopes, etc)
 	namespaces.initialise();
 	// Start ICN handler
 	Icn icn(icnCore, configuration, namespaces, transport);
-	mainThreads.push_back(std::thread(icn));
+	mainThreads.push_back(std::thread(std::ref(icn)));
 	// Start demux
 	LOG4CXX_DEBUG(logger, "Starting Demux thread");
 	Demux demux(namespaces, configuration, statistics);
@@ -261,6 +268,11 @@ void shutdown()
 		}
 	}
 
+	// The unsubscriptions of the namespaces are queued too, so wait until the
+	// ICN publisher has sent them before disconnecting
+	icnPublisherPointer->stop();
+	icnPublisherThreadPointer->join();
+
 	for (auto it = mainThreads.begin(); it != mainThreads.end(); it++)
 	{
 		it->detach();
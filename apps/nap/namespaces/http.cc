@@ -30,9 +30,11 @@ using namespace namespaces::http;
 
 LoggerPtr Http::logger(Logger::getLogger("namespaces.http"));
 
-Http::Http(Blackadder *icnCore, Configuration &configuration,
-		Transport &transport, Statistics &statistics)
+Http::Http(Blackadder *icnCore, IcnPublisher &icnPublisher,
+		Configuration &configuration, Transport &transport,
+		Statistics &statistics)
 	: _icnCore(icnCore),
+	  _icnPublisher(icnPublisher),
 	  _configuration(configuration),
 	  _transport(transport),
 	  _statistics(statistics)
@@ -83,6 +85,91 @@ void Http::addReversNidTorCIdLookUp(string &nodeId, IcnId &rCId)
 	_reverseNidTorCIdLookUpMutex.unlock();
 }
 
+bool Http::coalesceRequest(IcnId &rCId, uint8_t *packet, uint16_t &packetSize)
+{
+	uint16_t requestLineLength = 0;
+	uint32_t coalescingWindow = _configuration.httpCoalescingWindow();
+	std::chrono::steady_clock::time_point now;
+	if (coalescingWindow == 0 || packetSize < 4
+			|| memcmp(packet, "GET ", 4) != 0)
+	{
+		return false;
+	}
+	if (!_coalescable(packet, packetSize))
+	{
+		LOG4CXX_TRACE(logger, "HTTP GET request for rCID " << rCId.print()
+				<< " depends on its header fields. Request not coalesced");
+		return false;
+	}
+	// Request line (method, resource and HTTP version) up to the first CRLF
+	while ((requestLineLength + 1) < packetSize
+			&& !(packet[requestLineLength] == '\r'
+					&& packet[requestLineLength + 1] == '\n'))
+	{
+		requestLineLength++;
+	}
+	Fnv64_t requestLine = fnv1a_64(packet, requestLineLength);
+	now = std::chrono::steady_clock::now();
+	_inFlightRequestsMutex.lock();
+	_inFlightRequestsIt = _inFlightRequests.find(rCId.uint());
+	if (_inFlightRequestsIt != _inFlightRequests.end())
+	{
+		map<Fnv64_t, std::chrono::steady_clock::time_point>::iterator
+				requestLineIt;
+		requestLineIt = _inFlightRequestsIt->second.find(requestLine);
+		if (requestLineIt != _inFlightRequestsIt->second.end()
+				&& std::chrono::duration_cast<std::chrono::milliseconds>(
+						now - requestLineIt->second).count()
+						< coalescingWindow)
+		{
+			_inFlightRequestsMutex.unlock();
+			LOG4CXX_TRACE(logger, "Identical HTTP GET request already in flight "
+					"for rCID " << rCId.print() << ". Request coalesced");
+			return true;
+		}
+	}
+	/* Remove fetches which never got a response (e.g. server not reachable).
+	 * The map only holds fetches in flight, so it is kept small
+	 */
+	_inFlightRequestsIt = _inFlightRequests.begin();
+	while (_inFlightRequestsIt != _inFlightRequests.end())
+	{
+		map<Fnv64_t, std::chrono::steady_clock::time_point>::iterator
+				requestLineIt;
+		requestLineIt = _inFlightRequestsIt->second.begin();
+		while (requestLineIt != _inFlightRequestsIt->second.end())
+		{
+			if (std::chrono::duration_cast<std::chrono::milliseconds>(
+					now - requestLineIt->second).count() >= coalescingWindow)
+			{
+				_inFlightRequestsIt->second.erase(requestLineIt++);
+			}
+			else
+			{
+				requestLineIt++;
+			}
+		}
+		if (_inFlightRequestsIt->second.empty())
+		{
+			_inFlightRequests.erase(_inFlightRequestsIt++);
+		}
+		else
+		{
+			_inFlightRequestsIt++;
+		}
+	}
+	_inFlightRequests[rCId.uint()][requestLine] = now;
+	_inFlightRequestsMutex.unlock();
+	return false;
+}
+
+void Http::completeRequests(IcnId &rCId)
+{
+	_inFlightRequestsMutex.lock();
+	_inFlightRequests.erase(rCId.uint());
+	_inFlightRequestsMutex.unlock();
+}
+
 void Http::deleteSessionKey(uint16_t &sessionKey)
 {
 	//map<RIPD,   list<Session keys
@@ -314,8 +401,8 @@ void Http::handleDnsLocal(uint32_t &fqdn)
 	_cIdsIt->second.forwarding(false);
 	LOG4CXX_TRACE(logger, "Forwarding state set to false for CID "
 			<< _cIdsIt->second.print());
-	_icnCore->unpublish_info(_cIdsIt->second.binId(),
-			_cIdsIt->second.binPrefixId(), DOMAIN_LOCAL, NULL, 0);
+	_icnPublisher.unpublishInfo(_cIdsIt->second.binId(),
+			_cIdsIt->second.binPrefixId());
 	LOG4CXX_TRACE(logger, "Unsubscribed from CID " << _cIdsIt->second.print());
 	_mutexIcnIds.unlock();
 }
@@ -340,8 +427,7 @@ void Http::handleRequest(string &fqdn, string &resource,
 		LOG4CXX_DEBUG(logger, "New CID " << cId.print() << " added to "
 				"local database");
 		_bufferRequest(cId, rCId, sessionKey, httpMethod, packet, packetSize);
-		_icnCore->publish_scope(cId.binRootScopeId(),
-				cId.binEmpty(), DOMAIN_LOCAL, NULL, 0);
+		_icnPublisher.publishScope(cId.binRootScopeId(), cId.binEmpty());
 		LOG4CXX_DEBUG(logger, "Root scope " << cId.rootScopeId()
 				<< " published to domain local RV");
 		/* iterate over the number of scope levels and publish them to the RV.
@@ -349,8 +435,8 @@ void Http::handleRequest(string &fqdn, string &resource,
 		 */
 		for (size_t i = 2; i < cId.length() / 16; i++)
 		{
-			_icnCore->publish_scope(cId.binScopeId(i),
-					cId.binScopePath(i - 1), DOMAIN_LOCAL, NULL, 0);
+			_icnPublisher.publishScope(cId.binScopeId(i),
+					cId.binScopePath(i - 1));
 			LOG4CXX_DEBUG(logger, "Scope ID " << cId.scopeId(i)
 					<< " published under scope path "
 					<< cId.printScopePath(i - 1) << " to domain local "
@@ -358,16 +444,14 @@ void Http::handleRequest(string &fqdn, string &resource,
 		}
 		LOG4CXX_DEBUG(logger, "Advertised " << cId.id() << " under scope path "
 				<< cId.printPrefixId());
-		_icnCore->publish_info(cId.binId(), cId.binPrefixId(), DOMAIN_LOCAL,
-				NULL, 0);
+		_icnPublisher.publishInfo(cId.binId(), cId.binPrefixId());
 		return;
 	}
 	// Advertise availability if forwarding rule set to disabled
 	if (!(*_cIdsIt).second.forwarding())
 	{
 		_mutexIcnIds.unlock();
-		_icnCore->publish_info(cId.binId(), cId.binPrefixId(), DOMAIN_LOCAL,
-				NULL, 0);
+		_icnPublisher.publishInfo(cId.binId(), cId.binPrefixId());
 		LOG4CXX_DEBUG(logger, "Advertised " << cId.id() << " again "
 				"under scope path " << cId.printPrefixId());
 		_bufferRequest(cId, rCId, sessionKey, httpMethod, packet, packetSize);
@@ -384,6 +468,14 @@ bool Http::handleResponse(IcnId &rCId, uint16_t &sessionKey, bool &firstPacket,
 {
 	uint8_t attempts = ENIGMA;
 	list<NodeId> cmcGroup;
+	/* Requests arriving from now on must trigger a new fetch. Coalesced
+	 * requests are already ready in the potential CMC group which is looked up
+	 * below
+	 */
+	if (firstPacket)
+	{
+		completeRequests(rCId);
+	}
 	while (cmcGroup.empty())
 	{
 		cmcGroup.clear();
@@ -501,8 +593,7 @@ void Http::initialise()
 	list<pair<IcnId, pair<IpAddress, uint16_t>>> fqdns = _configuration.fqdns();
 	list<pair<IcnId, pair<IpAddress, uint16_t>>>::iterator fqdnsIt;
 	IcnId cid("video.point");//Dummy CID to publish root scope
-	_icnCore->publish_scope(cid.binRootScopeId(), cid.binEmpty(), DOMAIN_LOCAL,
-			NULL, 0);
+	_icnPublisher.publishScope(cid.binRootScopeId(), cid.binEmpty());
 	LOG4CXX_DEBUG(logger, "Publish HTTP root scope to domain local RV");
 	for (fqdnsIt = fqdns.begin(); fqdnsIt != fqdns.end(); fqdnsIt++)
 	{
@@ -745,8 +836,7 @@ void Http::sendToEndpoint(IcnId &rCid, uint8_t *packet, uint16_t &packetSize)
 
 void Http::subscribeToFqdn(IcnId &cid)
 {
-	_icnCore->subscribe_info(cid.binId(), cid.binPrefixId(), DOMAIN_LOCAL, NULL,
-			0);
+	_icnPublisher.subscribeInfo(cid.binId(), cid.binPrefixId());
 	LOG4CXX_DEBUG(logger, "Subscribed to " << cid.print() << " ("
 			<< cid.printFqdn() << ")");
 }
@@ -765,8 +855,7 @@ void Http::uninitialise()
 
 void Http::unsubscribeFromFqdn(IcnId &cid)
 {
-	_icnCore->unsubscribe_info(cid.binId(), cid.binPrefixId(), DOMAIN_LOCAL,
-			NULL, 0);
+	_icnPublisher.unsubscribeInfo(cid.binId(), cid.binPrefixId());
 	LOG4CXX_DEBUG(logger, "Unsubscribed from " << cid.print());
 }
 
@@ -1056,6 +1145,58 @@ bool Http::_forwardingEnabled(uint32_t nodeId)
 	return false;
 }
 
+bool Http::_coalescable(uint8_t *packet, uint16_t &packetSize)
+{
+	const char *fields[] = {"Range:", "Authorization:", "Cookie:"};
+	const char *noCache = "no-cache";
+	uint32_t lineStart = 0;
+	uint32_t lineEnd = 0;
+	bool requestLine = true;
+	// Header fields follow the request line, one per line, up to an empty line
+	while (lineStart < packetSize)
+	{
+		while ((lineEnd + 1) < packetSize && !(packet[lineEnd] == '\r'
+				&& packet[lineEnd + 1] == '\n'))
+		{
+			lineEnd++;
+		}
+		if ((lineEnd + 1) >= packetSize)
+		{
+			lineEnd = packetSize;
+		}
+		if (lineEnd == lineStart)
+		{
+			break;
+		}
+		string field((char *)packet + lineStart, lineEnd - lineStart);
+		for (size_t i = 0; !requestLine
+				&& i < sizeof(fields) / sizeof(fields[0]); i++)
+		{
+			if (strncasecmp(field.c_str(), fields[i], strlen(fields[i])) == 0)
+			{
+				return false;
+			}
+		}
+		if (!requestLine
+				&& (strncasecmp(field.c_str(), "Cache-Control:", 14) == 0
+						|| strncasecmp(field.c_str(), "Pragma:", 7) == 0))
+		{
+			for (size_t i = 0; i + strlen(noCache) <= field.length(); i++)
+			{
+				if (strncasecmp(field.c_str() + i, noCache, strlen(noCache))
+						== 0)
+				{
+					return false;
+				}
+			}
+		}
+		requestLine = false;
+		lineStart = lineEnd + 2;
+		lineEnd = lineStart;
+	}
+	return true;
+}
+
 bool Http::_getCmcGroup(IcnId &rCid, uint16_t &sessionKey, bool firstPacket,
 		list<NodeId> &nodeIds)
 {
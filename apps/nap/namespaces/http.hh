@@ -30,6 +30,7 @@
 #include <map>
 
 #include <configuration.hh>
+#include <icnpublisher.hh>
 #include <monitoring/statistics.hh>
 #include <namespaces/httptypedef.hh>
 #include <namespaces/buffercleaners/httpbuffercleaner.hh>
@@ -60,11 +61,14 @@ public:
 	 * \brief Constructor
 	 *
 	 * \param icnCore Pointer to Blackadder API
+	 * \param icnPublisher Reference to the ICN publisher all BA API calls go
+	 * through
 	 * \param configuration Reference to configuration class
 	 * \param transport Reference to transport class
 	 */
-	Http(Blackadder *icnCore, Configuration &configuration,
-			Transport &transport, Statistics &statistics);
+	Http(Blackadder *icnCore, IcnPublisher &icnPublisher,
+			Configuration &configuration, Transport &transport,
+			Statistics &statistics);
 	/*!
 	 * \brief Destructor
 	 */
@@ -92,6 +96,38 @@ public:
 	 * \param sessionKey The session key which identified a particular CMC group
 	 */
 	void closeCmcGroup(IcnId &rCid, uint16_t &sessionKey);
+	/*!
+	 * \brief Check if an HTTP request can be served by an upstream fetch which
+	 * is already in flight
+	 *
+	 * Only GET requests are coalesced. Requests whose response depends on more
+	 * than their request line (Range, Authorization, Cookie) or which must not
+	 * be served from a shared response (Cache-Control or Pragma: no-cache) are
+	 * always sent to the server and never recorded. Two requests are identical
+	 * if they have the same rCID and request line. The NID of a coalesced
+	 * request is already part of the potential CMC group for the rCID and
+	 * receives the response of the pending fetch once the CMC group is formed
+	 * for its first packet. If no identical request has been sent to the
+	 * server within the configured coalescing window, the request is recorded
+	 * as in flight.
+	 *
+	 * \param rCId The rCID of the HTTP request
+	 * \param packet Pointer to the HTTP request
+	 * \param packetSize Length of the HTTP request
+	 *
+	 * \return Boolean indicating if the request has been coalesced and must not
+	 * be sent to the server
+	 */
+	bool coalesceRequest(IcnId &rCId, uint8_t *packet, uint16_t &packetSize);
+	/*!
+	 * \brief Remove the HTTP requests in flight for an rCID
+	 *
+	 * Called once the first response packet for the rCID has been received.
+	 * Requests arriving afterwards trigger a new upstream fetch.
+	 *
+	 * \param rCId The rCID of the HTTP response
+	 */
+	void completeRequests(IcnId &rCId);
 	/*!
 	 * \brief Delete the session key entry for possible future communications
 	 * with TCP server instances
@@ -222,6 +258,7 @@ protected:
 	void unsubscribeFromFqdn(IcnId &cid);
 private:
 	Blackadder *_icnCore; /*!< Pointer to Blackadder instance */
+	IcnPublisher &_icnPublisher; /*!< Reference to the ICN publisher */
 	Configuration &_configuration; /*!< Reference to configuration */
 	Transport &_transport;/*!< Reference to transport class */
 	Statistics &_statistics; /*<! Refernce to statistics class*/
@@ -235,6 +272,11 @@ private:
 	map<uint32_t, bool>::iterator _nIdsIt; /*!< Iterator for _nIds map*/
 	boost::mutex _nIdsMutex; /*!< Mutex for _nIds */
 	boost::mutex _mutexIcnIds;
+	in_flight_requests_t _inFlightRequests;/*!< HTTP GET requests which have
+	been sent to the server and await the first response packet */
+	in_flight_requests_t::iterator _inFlightRequestsIt;/*!< Iterator for
+	_inFlightRequests map */
+	boost::mutex _inFlightRequestsMutex;/*!< mutex for _inFlightRequests map */
 	map<uint32_t, map<uint32_t, list<uint16_t>>> _ipEndpointSessions;/*!<
 	map<rCID, map<0, list<sessionKey>>> where the session key is the socket
 	FD of TCP server instances*/
@@ -333,6 +375,16 @@ private:
 	 * \return A list of rCIDs
 	 */
 	list<uint32_t> _getrCids(NodeId &nodeId);
+	/*!
+	 * \brief Check if the header fields of an HTTP request allow to serve it
+	 * with the response to an identical request line
+	 *
+	 * \param packet Pointer to the HTTP request
+	 * \param packetSize Length of the HTTP request
+	 *
+	 * \return Boolean indicating if the request can be coalesced
+	 */
+	bool _coalescable(uint8_t *packet, uint16_t &packetSize);
 	/*!
 	 * \brief Obtain the list of NIDs in a locked CMC group
 	 *
@@ -22,6 +22,8 @@
 #ifndef NAP_NAMESPACES_HTTPTYPEDEF_HH_
 #define NAP_NAMESPACES_HTTPTYPEDEF_HH_
 
+#include <ba_fnv.hpp>
+#include <chrono>
 #include <stack>
 
 #include <enumerations.hh>
@@ -63,6 +65,10 @@ typedef map<uint32_t, map<uint32_t, map<uint16_t, list<NodeId>>>>
 typedef map<uint32_t, map<uint32_t, map<uint32_t, bool>>> potential_cmc_groups_t
 		; /*!< map<rCId, map<0, map<NID, bool>>>> */
 
+typedef map<uint32_t, map<Fnv64_t, std::chrono::steady_clock::time_point>>
+		in_flight_requests_t ; /*!< map<rCID, map<hashed request line,
+		Monotonic timestamp of upstream fetch>> */
+
 typedef map<uint32_t, map<uint32_t, request_packet_t>> packet_buffer_requests_t
 		; /*!< map<cId, map<rCId, Packet Struct>> */
 
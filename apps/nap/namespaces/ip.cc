@@ -28,8 +28,10 @@ using namespace log4cxx;
 
 LoggerPtr Ip::logger(Logger::getLogger("namespaces.ip"));
 
-Ip::Ip(Blackadder *icnCore, Configuration &configuration, Transport &transport)
+Ip::Ip(Blackadder *icnCore, IcnPublisher &icnPublisher,
+		Configuration &configuration, Transport &transport)
 	: _icnCore(icnCore),
+	  _icnPublisher(icnPublisher),
 	  _configuration(configuration),
 	  _transport(transport)
 {
@@ -68,8 +70,7 @@ void Ip::handle(IpAddress &destinationIpAddress, uint8_t *packet,
 		// / NAMEPSPACE_IP / HASH_ROUTING_PREFIX
 		LOG4CXX_DEBUG(logger, "Advertising information item " << cid.id()
 				<< " under father scope " << cid.printPrefixId());
-		_icnCore->publish_info(cid.binId(), cid.binPrefixId(), DOMAIN_LOCAL,
-				NULL, 0);
+		_icnPublisher.publishInfo(cid.binId(), cid.binPrefixId());
 		return;
 	}
 	// If known, check if the IP packet has to be hold back (pause)
@@ -80,8 +81,7 @@ void Ip::handle(IpAddress &destinationIpAddress, uint8_t *packet,
 		LOG4CXX_DEBUG(logger, "Forwarding state of CID " << cid.print()
 				<< " disabled. Re-advertising information item " << cid.id()
 				<< " under father scope " << cid.printPrefixId());
-		_icnCore->publish_info(cid.binId(), cid.binPrefixId(), DOMAIN_LOCAL,
-				NULL, 0);
+		_icnPublisher.publishInfo(cid.binId(), cid.binPrefixId());
 		return;
 	}
 	_mutexIcnIds.unlock();
@@ -92,8 +92,7 @@ void Ip::subscribeInfo(IcnId &icnId)
 {
 	_mutexIcnIds.lock();
 	_icnId(icnId);
-	_icnCore->subscribe_info(icnId.binId(), icnId.binPrefixId(), DOMAIN_LOCAL,
-			NULL, 0);
+	_icnPublisher.subscribeInfo(icnId.binId(), icnId.binPrefixId());
 	LOG4CXX_DEBUG(logger, "Subscription to CID " << icnId.print() << " issued");
 	_mutexIcnIds.unlock();
 }
@@ -142,26 +141,23 @@ void Ip::initialise()
 		icnId = ii;
 	}
 	// Publishing root scope to RV
-	_icnCore->publish_scope(icnId.binRootScopeId(), icnId.binEmpty(),
-			DOMAIN_LOCAL, NULL, 0);
+	_icnPublisher.publishScope(icnId.binRootScopeId(), icnId.binEmpty());
 	LOG4CXX_DEBUG(logger, "Root scope ID " << icnId.rootScopeId()
 			<< " published to RV");
 	// Publishing prefix under root scope
-	_icnCore->publish_scope(icnId.binScopeId(2), icnId.binScopePath(1),
-			DOMAIN_LOCAL, NULL, 0);
+	_icnPublisher.publishScope(icnId.binScopeId(2), icnId.binScopePath(1));
 	LOG4CXX_DEBUG(logger, "Routing prefix scope ID " << icnId.scopeId(2)
 			<< " published under father scope " << icnId.scopePath(1));
 	// If host-based NAP, publish IP scope level too
 	if (_configuration.hostBasedNap())
 	{
-		_icnCore->publish_scope(icnId.binScopeId(3), icnId.binScopePath(2),
-				DOMAIN_LOCAL, NULL, 0);
+		_icnPublisher.publishScope(icnId.binScopeId(3),
+				icnId.binScopePath(2));
 		LOG4CXX_DEBUG(logger, "IP address scope ID " << icnId.scopeId(3)
 					<< " published under father scope " << icnId.scopePath(2)
 					<< "for IP namespace");
 	}
-	_icnCore->subscribe_scope(icnId.binId(), icnId.binPrefixId(), DOMAIN_LOCAL,
-			NULL, 0);
+	_icnPublisher.subscribeScope(icnId.binId(), icnId.binPrefixId());
 	LOG4CXX_DEBUG(logger, "Subscribed to scope path " << icnId.print());
 	_mutexIcnIds.lock();
 	_icnIds.insert(pair<uint32_t, IcnId>(icnId.uint(), icnId));
@@ -190,8 +186,7 @@ void Ip::subscribeScope(IcnId &icnId)
 {
 	_mutexIcnIds.lock();
 	_icnId(icnId);
-	_icnCore->subscribe_scope(icnId.binId(), icnId.binPrefixId(), DOMAIN_LOCAL,
-			NULL, 0);
+	_icnPublisher.subscribeScope(icnId.binId(), icnId.binPrefixId());
 	LOG4CXX_DEBUG(logger, "Subscription to CID " << icnId.print() << " issued");
 	_mutexIcnIds.unlock();
 }
@@ -203,16 +198,14 @@ void Ip::uninitialise()
 		// Creating CID for /IP/RoutingPrefix/IpAddress
 		IcnId icnId(_configuration.hostRoutingPrefix(),
 				_configuration.endpointIpAddress());
-		_icnCore->unsubscribe_info(icnId.binId(), icnId.binPrefixId(),
-				DOMAIN_LOCAL, NULL, 0);
+		_icnPublisher.unsubscribeInfo(icnId.binId(), icnId.binPrefixId());
 		LOG4CXX_DEBUG(logger, "Unsubscribed from ID " << icnId.id()
 				<< " published under father scope " << icnId.printPrefixId());
 	}
 	else
 	{
 		IcnId icnId(_configuration.hostRoutingPrefix());
-		_icnCore->unsubscribe_scope(icnId.binId(), icnId.binPrefixId(),
-				DOMAIN_LOCAL, NULL, 0);
+		_icnPublisher.unsubscribeScope(icnId.binId(), icnId.binPrefixId());
 		LOG4CXX_DEBUG(logger, "Unsubscribed from scope " << icnId.id()
 				<< " under father scope " << icnId.printPrefixId());
 	}
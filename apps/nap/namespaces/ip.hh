@@ -29,6 +29,7 @@
 #include <map>
 
 #include <configuration.hh>
+#include <icnpublisher.hh>
 #include <transport/transport.hh>
 #include <types/icnid.hh>
 #include <types/routingprefix.hh>
@@ -57,8 +58,8 @@ public:
 	/*!
 	 * \brief Constructor
 	 */
-	Ip(Blackadder *icnCore, Configuration &configuration,
-			Transport &transport);
+	Ip(Blackadder *icnCore, IcnPublisher &icnPublisher,
+			Configuration &configuration, Transport &transport);
 	/*!
 	 * \brief Destructor
 	 */
@@ -134,6 +135,7 @@ protected:
 	void uninitialise();
 private:
 	Blackadder *_icnCore;/*!< Pointer to Blackadder instance */
+	IcnPublisher &_icnPublisher;/*!< Reference to the ICN publisher */
 	Configuration &_configuration;/*!< Reference to Configuration class */
 	Transport &_transport;/*!< Reference to Transport class */
 	map<uint32_t, RoutingPrefix> *_routingPrefixes;
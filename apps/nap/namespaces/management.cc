@@ -23,9 +23,9 @@
 
 using namespace namespaces::management;
 
-Management::Management(Blackadder *icnCore, boost::mutex &icnCoreMutex,
+Management::Management(Blackadder *icnCore, IcnPublisher &icnPublisher,
 		Configuration &configuration)
-	: DnsLocal(icnCore, icnCoreMutex, configuration)
+	: DnsLocal(icnCore, icnPublisher, configuration)
 {}
 
 Management::~Management() {}
@@ -48,11 +48,11 @@ public:
 	 * \brief Constructor
 	 *
 	 * \param icnCore Pointer to Blackadder instance
-	 * \param icnCoreMutex Reference to mutex for transaction safe BA API
+	 * \param icnPublisher Reference to the ICN publisher for BA API data-plane
 	 * write operations
 	 * \param configuration Reference to the configuration class
 	 */
-	Management(Blackadder *icnCore, boost::mutex &icnCoreMutex,
+	Management(Blackadder *icnCore, IcnPublisher &icnPublisher,
 			Configuration &configuration);
 	/*!
 	 * \brief Destructor
@@ -26,24 +26,21 @@ using namespace namespaces::management::dnslocal;
 
 LoggerPtr DnsLocal::logger(Logger::getLogger("namespaces.management.dnslocal"));
 
-DnsLocal::DnsLocal(Blackadder *icnCore, boost::mutex &icnCoreMutex,
+DnsLocal::DnsLocal(Blackadder *icnCore, IcnPublisher &icnPublisher,
 		Configuration &configuration)
 	: _icnCore(icnCore),
-	  _icnCoreMutex(icnCoreMutex),
+	  _icnPublisher(icnPublisher),
 	  _configuration(configuration)
 {
 	IcnId cid(NAMESPACE_MANAGEMENT, MANAGEMENT_II_DNS_LOCAL);
 	_cid = cid;
-	_icnCoreMutex.lock();
-	_icnCore->publish_scope(cid.binRootScopeId(), cid.binEmpty(), DOMAIN_LOCAL,
-			NULL, 0);
+	_icnPublisher.publishScope(cid.binRootScopeId(), cid.binEmpty());
 	LOG4CXX_DEBUG(logger, "Management root namespace scope ID "
 			<< cid.rootNamespace() << " published");
 	// As a cNAP subscribe to DNSlocal info item
 	if (_configuration.cNap())
 	{
-		_icnCore->subscribe_info(cid.binId(), cid.binPrefixId(), DOMAIN_LOCAL,
-				NULL, 0);
+		_icnPublisher.subscribeInfo(cid.binId(), cid.binPrefixId());
 		LOG4CXX_DEBUG(logger, "Subscribed to DNS local information item "
 				<< cid.print());
 	}
@@ -51,12 +48,10 @@ DnsLocal::DnsLocal(Blackadder *icnCore, boost::mutex &icnCoreMutex,
 	// information
 	else
 	{
-		_icnCore->publish_info(cid.binId(), cid.binPrefixId(), DOMAIN_LOCAL,
-				NULL, 0);
+		_icnPublisher.publishInfo(cid.binId(), cid.binPrefixId());
 		LOG4CXX_DEBUG(logger, "Advertised DNSlocal information item "
 						<< cid.print());
 	}
-	_icnCoreMutex.unlock();
 }
 
 DnsLocal::~DnsLocal()
@@ -69,10 +64,8 @@ void DnsLocal::announce(IcnId &cid)
 	uint32_t fqdn = cid.uintId();
 	uint8_t *packet = (uint8_t *)malloc(sizeof(fqdn));
 	memcpy(packet, &fqdn, sizeof(fqdn));
-	_icnCoreMutex.lock();
-	_icnCore->publish_data(_cid.binIcnId(), DOMAIN_LOCAL, NULL, 0, packet,
+	_icnPublisher.publishData(_cid.binIcnId(), packet,
 			sizeof(cid.uintId()));
-	_icnCoreMutex.unlock();
 	LOG4CXX_TRACE(logger, "DNSlocal announcement published to " << _cid.print()
 			<< " for hashed FQDN " << cid.uintId());
 	free(packet);
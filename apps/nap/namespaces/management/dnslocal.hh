@@ -23,10 +23,10 @@
 #define NAP_NAMESPACES_MANAGEMENT_DNSLOCAL_HH_
 
 #include <blackadder.hpp>
-#include <boost/thread/mutex.hpp>
 #include <log4cxx/logger.h>
 
 #include <configuration.hh>
+#include <icnpublisher.hh>
 #include <types/icnid.hh>
 
 #ifdef DMALLOC
@@ -34,6 +34,7 @@
 #endif
 
 using namespace configuration;
+using namespace icn;
 using namespace log4cxx;
 
 namespace namespaces {
@@ -58,8 +59,8 @@ public:
 	 * receive triggers about flushing FIDs stored in the local ICN core by re-
 	 * publishing the HTTP CIDs
 	 */
-	DnsLocal(Blackadder *icnCore, boost::mutex &icnCoreMutex, Configuration
-			&configuration);
+	DnsLocal(Blackadder *icnCore, IcnPublisher &icnPublisher,
+			Configuration &configuration);
 	/*!
 	 * \brief Destructor
 	 */
@@ -74,8 +75,7 @@ protected:
 	void announce(IcnId &cid);
 private:
 	Blackadder *_icnCore; /*!< Pointer to Blackadder instance */
-	boost::mutex &_icnCoreMutex;/*!< Mutex to lock writing operations on the
-	Blackadder API */
+	IcnPublisher &_icnPublisher;/*!< Reference to the ICN publisher */
 	Configuration &_configuration;/*!< Reference to the Configuration class */
 	IcnId _cid;/*!< The CID under which DNS local announcement are made */
 };
@@ -21,12 +21,12 @@
 
 #include "namespaces.hh"
 
-Namespaces::Namespaces(Blackadder *icnCore, boost::mutex &icnCoreMutex,
+Namespaces::Namespaces(Blackadder *icnCore, IcnPublisher &icnPublisher,
 		Configuration &configuration, Transport &transport,
 		Statistics &statistics)
-	: Ip(icnCore, configuration, transport),
-	  Http(icnCore, configuration, transport, statistics),
-	  Management(icnCore, icnCoreMutex, configuration)
+	: Ip(icnCore, icnPublisher, configuration, transport),
+	  Http(icnCore, icnPublisher, configuration, transport, statistics),
+	  Management(icnCore, icnPublisher, configuration)
 {}
 
 void Namespaces::endOfSession(IcnId &cid, uint16_t &sessionKey)
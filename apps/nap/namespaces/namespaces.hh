@@ -49,7 +49,7 @@ public:
 	/*!
 	 * \brief Constructor
 	 */
-	Namespaces(Blackadder *icnCore, boost::mutex &icnCoreMutex,
+	Namespaces(Blackadder *icnCore, IcnPublisher &icnPublisher,
 			Configuration &configuration, Transport &transport,
 			Statistics &statistics);
 	/*!
@@ -36,11 +36,11 @@ using namespace transport::lightweight;
 LoggerPtr Lightweight::logger(Logger::getLogger("transport.lightweight"));
 
 Lightweight::Lightweight(Blackadder *icnCore, Configuration &configuration,
-		boost::mutex &icnCoreMutex, Statistics &statistics)
+		IcnPublisher &icnPublisher, Statistics &statistics)
 	: TrafficControl(configuration),
 	  _icnCore(icnCore),
 	  _configuration(configuration),
-	  _icnCoreMutex(icnCoreMutex),
+	  _icnPublisher(icnPublisher),
 	  _statistics(statistics)
 {
 	_knownNIds = NULL;// will be set in initialise() method
@@ -397,7 +397,7 @@ void Lightweight::publishFromBuffer(IcnId &cId, IcnId &rCId,
 			data, dataSize);
 	// Starting timer in a thread and go back to the ICN handler
 	LightweightTimeout ltpTimeout(cId, rCId, sessionKey,
-			ltpHeader.sequenceNumber, _icnCore, _icnCoreMutex, _rtt(),
+			ltpHeader.sequenceNumber, _icnCore, _icnPublisher, _rtt(),
 			(void *)&_proxyPacketBuffer, _proxyPacketBufferMutex,
 			(void *)&_windowEndedRequests, _windowEndedRequestsMutex);
 	_timeoutThreads.create_thread(ltpTimeout);
@@ -454,7 +454,7 @@ TpState Lightweight::handle(IcnId &cId, IcnId &rCId, string &nodeIdStr,
 }
 
 bool Lightweight::retrievePacket(IcnId &rCId, string &nodeIdStr,
-		uint16_t &sessionKey, uint8_t *packet, uint16_t &packetSize)
+		uint16_t &sessionKey, uint8_t *&packet, uint16_t &packetSize)
 {
 	NodeId nodeId = nodeIdStr;
 	// map<SeqNum,PACKET>>>
@@ -512,15 +512,26 @@ bool Lightweight::retrievePacket(IcnId &rCId, string &nodeIdStr,
 	{
 		packetSize += sequenceMapIt->second.second;
 	}
+	// a single fragment is the packet: hand it over as it is
+	if (sessionKeyMapIt->second.size() == 1)
+	{
+		packet = sessionKeyMapIt->second.begin()->second.first;
+	}
 	// now reassemble the packets
-	uint16_t offset = 0;
-	for (sequenceMapIt = sessionKeyMapIt->second.begin();
-			sequenceMapIt != sessionKeyMapIt->second.end(); sequenceMapIt++)
+	else
 	{
-		memcpy(packet + offset, sequenceMapIt->second.first,
-				sequenceMapIt->second.second);
-		offset += sequenceMapIt->second.second;// add size of current fragment
-		free(sequenceMapIt->second.first);// free up the memory
+		packet = (uint8_t *)malloc(packetSize);
+		uint16_t offset = 0;
+		for (sequenceMapIt = sessionKeyMapIt->second.begin();
+				sequenceMapIt != sessionKeyMapIt->second.end();
+				sequenceMapIt++)
+		{
+			memcpy(packet + offset, sequenceMapIt->second.first,
+					sequenceMapIt->second.second);
+			// add size of current fragment
+			offset += sequenceMapIt->second.second;
+			free(sequenceMapIt->second.first);// free up the memory
+		}
 	}
 	LOG4CXX_TRACE(logger, "Packet of length " << packetSize << " retrieved from"
 			" ICN packet buffer");
@@ -2886,10 +2897,8 @@ void Lightweight::_publishData(IcnId &rCId, ltp_hdr_ctrl_we_t &ltpHeaderCtrlWe,
 		// Check if TC drop rate should be applied
 		if (!TrafficControl::handle())
 		{
-			_icnCoreMutex.lock();
-			_icnCore->publish_data(rCId.binIcnId(), DOMAIN_LOCAL, NULL, 0,
-					nodeIdsStr, packet, packetSize);
-			_icnCoreMutex.unlock();
+			_icnPublisher.publishData(rCId.binIcnId(), nodeIdsStr, packet,
+					packetSize);
 		}
 		sentBytes += (fragmentSize - pad);// remove padding bits
 		LOG4CXX_TRACE(logger, packetSize << " bytes published to "
@@ -2987,10 +2996,8 @@ uint16_t Lightweight::_publishData(IcnId &cId, IcnId &rCId,
 		// Check if TC drop rate should be applied
 		if (!TrafficControl::handle())
 		{
-			_icnCoreMutex.lock();
-			_icnCore->publish_data_isub(cId.binIcnId(), DOMAIN_LOCAL, NULL, 0,
-					rCId.binIcnId(), packet, packetSize);
-			_icnCoreMutex.unlock();
+			_icnPublisher.publishDataiSub(cId.binIcnId(), rCId.binIcnId(),
+					packet, packetSize);
 		}
 		sentBytes += (fragmentSize - pad);// remove padding bits
 		credit--;// decrement credit by one
@@ -3071,10 +3078,8 @@ void Lightweight::_publishDataRange(IcnId &rCid,
 		}
 		if (!TrafficControl::handle())
 		{
-			_icnCoreMutex.lock();
-			_icnCore->publish_data(rCid.binIcnId(), DOMAIN_LOCAL, NULL, 0,
-					nodeIds, snIt->second.first, snIt->second.second);
-			_icnCoreMutex.unlock();
+			_icnPublisher.publishData(rCid.binIcnId(), nodeIds,
+					snIt->second.first, snIt->second.second);
 		}
 		LOG4CXX_TRACE(logger, "Packet of total length " << snIt->second.second
 				<< " with Sequence " << sequence << " re-published under rCID "
@@ -3144,10 +3149,8 @@ void Lightweight::_publishDataRange(IcnId &rCid, uint16_t &sessionKey,
 		}
 		if (!TrafficControl::handle())
 		{
-			_icnCoreMutex.lock();
-			_icnCore->publish_data(rCid.binIcnId(), DOMAIN_LOCAL, NULL, 0,
-					nodeIds, snIt->second.first, snIt->second.second);
-			_icnCoreMutex.unlock();
+			_icnPublisher.publishData(rCid.binIcnId(), nodeIds,
+					snIt->second.first, snIt->second.second);
 		}
 		LOG4CXX_TRACE(logger, "Packet of total length " << snIt->second.second
 				<< " with Sequence " << sequence << " re-published under rCID "
@@ -3189,10 +3192,8 @@ void Lightweight::_publishSessionEnd(IcnId &rCid, list<NodeId> &nodeIds,
 		nodeIdsStr.push_back(it->str());
 		nodeIdsOss << it->uint() << " ";
 	}
-	_icnCoreMutex.lock();
-	_icnCore->publish_data(rCid.binIcnId(), DOMAIN_LOCAL, NULL, 0, nodeIdsStr,
+	_icnPublisher.publishData(rCid.binIcnId(), nodeIdsStr,
 			packet, packetSize);
-	_icnCoreMutex.unlock();
 	LOG4CXX_TRACE(logger, "CTRL-SE published to " << nodeIds.size() << " NIDs "
 			"under rCID " << rCid.print() << " > SK "
 			<< ltpHeaderCtrlSe.sessionKey << ": " << nodeIdsOss.str());
@@ -3225,10 +3226,8 @@ void Lightweight::_publishSessionEnded(IcnId &cid, IcnId &rCid,
 	// [4] SK
 	memcpy(data + offset, &ltpHdrCtrlSed.sessionKey,
 			sizeof(ltpHdrCtrlSed.sessionKey));
-	_icnCoreMutex.lock();
-	_icnCore->publish_data_isub(cid.binIcnId(), DOMAIN_LOCAL, NULL, 0,
-				rCid.binIcnId(), data, dataSize);
-	_icnCoreMutex.unlock();
+	_icnPublisher.publishDataiSub(cid.binIcnId(), rCid.binIcnId(), data,
+			dataSize);
 	LOG4CXX_TRACE(logger, "CTRL-SED published to CID " << cid.print() << " for "
 			"rCID "	<< rCid.print() << " > SK "
 			<< sessionKey);
@@ -3273,10 +3272,8 @@ void Lightweight::_publishNegativeAcknowledgement(IcnId &rCid, NodeId &nodeId,
 			sizeof(ltpHeaderControlNack.end));
 	list<string> nodeIds;
 	nodeIds.push_back(nodeId.str());
-	_icnCoreMutex.lock();
-	_icnCore->publish_data(rCid.binIcnId(), DOMAIN_LOCAL, NULL, 0, nodeIds,
+	_icnPublisher.publishData(rCid.binIcnId(), nodeIds,
 			packet, sizeof(ltp_hdr_ctrl_nack_t));
-	_icnCoreMutex.unlock();
 	LOG4CXX_TRACE(logger, "CTRL-NACK for Sequence range "
 			<< firstMissingSequence << " - " << lastMissingSequence
 			<< " published to rCID " << rCid.print() << " > NID "
@@ -3320,10 +3317,8 @@ void Lightweight::_publishNegativeAcknowledgement(IcnId &cid, IcnId &rCid,
 	// [6] End sequence number
 	memcpy(packet + offset, &ltpHeaderControlNack.end,
 			sizeof(ltpHeaderControlNack.end));
-	_icnCoreMutex.lock();
-	_icnCore->publish_data_isub(cid.binIcnId(), DOMAIN_LOCAL, NULL, 0,
-				rCid.binIcnId(), packet, sizeof(ltp_hdr_ctrl_nack_t));
-	_icnCoreMutex.unlock();
+	_icnPublisher.publishDataiSub(cid.binIcnId(), rCid.binIcnId(), packet,
+			sizeof(ltp_hdr_ctrl_nack_t));
 	LOG4CXX_TRACE(logger, "CTRL-NACK for Sequence range "
 			<< firstMissingSequence << " - " << lastMissingSequence
 			<< " published to CID " << cid.print() << " for rCID "
@@ -3367,10 +3362,7 @@ void Lightweight::_publishWindowEnd(IcnId &rCId, list<NodeId> &nodeIds,
 				+ sizeof(ltpHeader.controlType) + sizeof(ltpHeader.ripd)
 				+ sizeof(ltpHeader.sessionKey), &ltpHeader.sequenceNumber,
 				sizeof(ltpHeader.sequenceNumber));
-	_icnCoreMutex.lock();
-	_icnCore->publish_data(rCId.binIcnId(), DOMAIN_LOCAL, NULL, 0,
-			nodeIdsStr, packet, packetSize);
-	_icnCoreMutex.unlock();
+	_icnPublisher.publishData(rCId.binIcnId(), nodeIdsStr, packet, packetSize);
 	LOG4CXX_TRACE(logger, "LTP CTRL-WE published under " << rCId.print()
 			<< " > SK " << ltpHeader.sessionKey << " > Sequence "
 			<< ltpHeader.sequenceNumber);
@@ -3410,10 +3402,8 @@ void Lightweight::_publishWindowEnd(IcnId &cId, IcnId &rCId,
 				+ sizeof(ltpHeader.controlType) + sizeof(ltpHeader.ripd)
 				+ sizeof(ltpHeader.sessionKey), &ltpHeader.sequenceNumber,
 				sizeof(ltpHeader.sequenceNumber));
-	_icnCoreMutex.lock();
-	_icnCore->publish_data_isub(cId.binIcnId(), DOMAIN_LOCAL, NULL, 0,
-			rCId.binIcnId(), packet, packetSize);
-	_icnCoreMutex.unlock();
+	_icnPublisher.publishDataiSub(cId.binIcnId(), rCId.binIcnId(), packet,
+			packetSize);
 	LOG4CXX_TRACE(logger, "LTP CTRL-WE published under " << cId.print()
 			<< " > SK " << ltpHeader.sessionKey << " > Sequence "
 			<< sequenceNumber);
@@ -3443,10 +3433,8 @@ void Lightweight::_publishWindowEnded(IcnId &cid, IcnId &rCid,
 	// [4] Session key
 	memcpy(packet + offset, &ltpHeaderCtrlWed.sessionKey,
 			sizeof(ltpHeaderCtrlWed.sessionKey));
-	_icnCoreMutex.lock();
-	_icnCore->publish_data_isub(cid.binIcnId(), DOMAIN_LOCAL, NULL, 0,
-			rCid.binIcnId(), packet, sizeof(ltp_hdr_ctrl_wed_t));
-	_icnCoreMutex.unlock();
+	_icnPublisher.publishDataiSub(cid.binIcnId(), rCid.binIcnId(), packet,
+			sizeof(ltp_hdr_ctrl_wed_t));
 	LOG4CXX_TRACE(logger, "LTP CTRL-WED published under CID "
 			<< cid.print() << " with rCID " << rCid.print() << " > SK "
 			<< ltpHeaderCtrlWed.sessionKey);
@@ -3483,10 +3471,8 @@ void Lightweight::_publishWindowEnded(IcnId &rCId, NodeId &nodeId,
 			+ sizeof(ltpHeader.controlType) + sizeof(ltpHeader.ripd),
 			&ltpHeader.sessionKey, sizeof(ltpHeader.sessionKey));
 	nodeIdList.push_back(nodeId.str());
-	_icnCoreMutex.lock();
-	_icnCore->publish_data(rCId.binIcnId(), DOMAIN_LOCAL, NULL, 0,
-			nodeIdList, packet, sizeof(ltp_hdr_ctrl_wed_t));
-	_icnCoreMutex.unlock();
+	_icnPublisher.publishData(rCId.binIcnId(), nodeIdList, packet,
+			sizeof(ltp_hdr_ctrl_wed_t));
 	LOG4CXX_TRACE(logger, "LTP CTRL-WED published to NID " << nodeId.uint()
 			<< " under rCID " << rCId.print() << " > SK "
 			<< ltpHeader.sessionKey);
@@ -3537,10 +3523,8 @@ void Lightweight::_publishWindowUpdate(IcnId &rCid, uint16_t &sessionKey,
 	memcpy(packet + sizeof(ltpHeader.messageType)
 			+ sizeof(ltpHeader.controlType) + sizeof(ltpHeader.ripd),
 			&ltpHeader.sessionKey, sizeof(ltpHeader.sessionKey));
-	_icnCoreMutex.lock();
-	_icnCore->publish_data(rCid.binIcnId(), DOMAIN_LOCAL, NULL, 0, nodeIdsStr,
+	_icnPublisher.publishData(rCid.binIcnId(), nodeIdsStr,
 			packet, sizeof(ltp_hdr_ctrl_wed_t));
-	_icnCoreMutex.unlock();
 	LOG4CXX_TRACE(logger, "LTP CTRL-WU published under rCID "
 			<< rCid.print() << " > SK "
 			<< sessionKey << " to " << nodeIds.size() << " NID(s): "
@@ -3568,10 +3552,8 @@ void Lightweight::_publishWindowUpdated(IcnId &cid, IcnId &rCid,
 	// [4] Session key
 	memcpy(packet + offset, &ltpHeaderControlWud.sessionKey,
 			sizeof(ltpHeaderControlWud.sessionKey));
-	_icnCoreMutex.lock();
-	_icnCore->publish_data_isub(cid.binIcnId(), DOMAIN_LOCAL, NULL, 0,
-			rCid.binIcnId(), packet, sizeof(ltp_hdr_ctrl_wud_t));
-	_icnCoreMutex.unlock();
+	_icnPublisher.publishDataiSub(cid.binIcnId(), rCid.binIcnId(), packet,
+			sizeof(ltp_hdr_ctrl_wud_t));
 	LOG4CXX_TRACE(logger, "LTP CTRL-WUD published under CID "
 			<< cid.print() << " with rCID " << rCid.print() << " > 0 "
 			<< ltpHeaderControlWud.ripd << " > SK "
@@ -30,6 +30,7 @@
 
 #include <configuration.hh>
 #include <enumerations.hh>
+#include <icnpublisher.hh>
 #include <monitoring/statistics.hh>
 #include <trafficcontrol/trafficcontrol.hh>
 #include <transport/lightweighttimeout.hh>
@@ -44,6 +45,7 @@
 #define MAX_PAYLOAD_LENGTH 65535
 
 using namespace configuration;
+using namespace icn;
 using namespace log4cxx;
 using namespace monitoring::statistics;
 using namespace trafficcontrol;
@@ -65,7 +67,7 @@ public:
 	 * \brief Constructor
 	 */
 	Lightweight(Blackadder *icnCore, Configuration &configuration,
-			boost::mutex &icnCoreMutex, Statistics &statistics);
+			IcnPublisher &icnPublisher, Statistics &statistics);
 	/*!
 	 * \brief Destructor
 	 */
@@ -174,8 +176,9 @@ protected:
 	 * \brief Retrieve a packet from _icnPacketBuffer map
 	 *
 	 * In order to call this method handle() must have returned
-	 * TP_STATE_ALL_FRAGMENTS_RECEIVED. Note that when calling this method the
-	 * packet pointer must point to already allocated memory.
+	 * TP_STATE_ALL_FRAGMENTS_RECEIVED. The packet is handed over in memory
+	 * allocated for its exact size (the buffered fragment itself if the packet
+	 * consists of a single fragment), which the caller must free.
 	 *
 	 * \param rCId The rCID for which the packet should be retrieved from the
 	 * buffer
@@ -183,18 +186,18 @@ protected:
 	 * the buffer
 	 * \param sessionKey The SK for which the packet should be retrieved from
 	 * the buffer
-	 * \param packet Pointer to the memory to which the packet will be copied
+	 * \param packet Reference to the pointer which is set to the packet
 	 * \param packetSize The number of octets representing the packet size
 	 *
 	 * \return boolean indicating if the packet has been successfully retrieved
 	 * from ICN buffer
 	 */
 	bool retrievePacket(IcnId &rCId, string &nodeIdStr, uint16_t &sessionKey,
-			uint8_t *packet, uint16_t &packetSize);
+			uint8_t *&packet, uint16_t &packetSize);
 private:
 	Blackadder *_icnCore;/*!< Pointer to the Blackadder instance */
 	Configuration &_configuration;
-	boost::mutex &_icnCoreMutex;/*!< Reference to ICN core mutex */
+	IcnPublisher &_icnPublisher;/*!< Reference to the ICN publisher */
 	Statistics &_statistics;/*!< Reference to the Statistics class*/
 	map<uint32_t, IcnId> _cIdReverseLookUp;/*!< map<rCID, cId> When	LTP CTRL
 	arrives from sNAP (underrCID) the CID (FQDN) is required for potential
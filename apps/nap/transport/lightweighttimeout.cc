@@ -27,13 +27,13 @@ LoggerPtr LightweightTimeout::logger(Logger::getLogger("transport.lightweight"))
 
 LightweightTimeout::LightweightTimeout(IcnId cId, IcnId rCId,
 		uint16_t sessionKey, uint16_t sequenceNumber, Blackadder *icnCore,
-		boost::mutex &icnCoreMutex, uint16_t rtt, void *proxyPacketBuffer,
+		IcnPublisher &icnPublisher, uint16_t rtt, void *proxyPacketBuffer,
 		boost::mutex &proxyPacketBufferMutex, void *windowEnded,
 		boost::mutex &windowEndedMutex)
 	: _cId(cId),
 	  _rCId(rCId),
 	  _icnCore(icnCore),
-	  _icnCoreMutex(icnCoreMutex),
+	  _icnPublisher(icnPublisher),
 	  _rtt(rtt),
 	  _proxyPacketBufferMutex(proxyPacketBufferMutex),
 	  _windowEndedMutex(windowEndedMutex)
@@ -218,10 +218,8 @@ void LightweightTimeout::_rePublishWindowEnd()
 			+ sizeof(ltpHeader.controlType) + sizeof(ltpHeader.ripd)
 			+ sizeof(ltpHeader.sessionKey), &ltpHeader.sequenceNumber,
 			sizeof(ltpHeader.sequenceNumber));
-	_icnCoreMutex.lock();
-	_icnCore->publish_data_isub(_cId.binIcnId(), DOMAIN_LOCAL, NULL, 0,
-			_rCId.binIcnId(), packet, packetSize);
-	_icnCoreMutex.unlock();
+	_icnPublisher.publishDataiSub(_cId.binIcnId(), _rCId.binIcnId(), packet,
+			packetSize);
 	LOG4CXX_TRACE(logger, "LTP Window End CTRL published under " << _cId.print()
 			<< ", Sequence " << ltpHeader.sequenceNumber);
 	free(packet);
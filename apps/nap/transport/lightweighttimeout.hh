@@ -29,6 +29,7 @@
 
 #include <configuration.hh>
 #include <enumerations.hh>
+#include <icnpublisher.hh>
 #include <types/icnid.hh>
 #include <transport/lightweighttypedef.hh>
 #include <types/nodeid.hh>
@@ -38,6 +39,7 @@
 #endif
 
 using namespace configuration;
+using namespace icn;
 using namespace log4cxx;
 using namespace std;
 
@@ -64,7 +66,8 @@ public:
 	 */
 	LightweightTimeout(IcnId cId, IcnId rCId, uint16_t sessionKey,
 			uint16_t sequenceNumber, Blackadder *icnCore,
-			boost::mutex &icnCoreMutex, uint16_t rtt, void *proxyPacketBuffer,
+			IcnPublisher &icnPublisher, uint16_t rtt,
+			void *proxyPacketBuffer,
 			boost::mutex &proxyPacketBufferMutex, void *windowEnded,
 			boost::mutex &windowEndedMutex);
 	/*!
@@ -81,7 +84,7 @@ private:
 	ltp_hdr_data_t _ltpHeaderData;
 	NodeId _nodeId;
 	Blackadder *_icnCore;
-	boost::mutex &_icnCoreMutex;
+	IcnPublisher &_icnPublisher;/*!< Reference to the ICN publisher */
 	uint16_t _rtt;
 	proxy_packet_buffer_t *_proxyPacketBuffer; /*!< Pointer to proxy packet
 	buffer */
@@ -22,9 +22,9 @@
 #include "transport.hh"
 
 Transport::Transport(Blackadder *icnCore, Configuration &configuration,
-		boost::mutex &icnCoreMutex, Statistics &statistics)
-	: Lightweight(icnCore, configuration, icnCoreMutex, statistics),
-	  Unreliable(icnCore, configuration, icnCoreMutex)
+		IcnPublisher &icnPublisher, Statistics &statistics)
+	: Lightweight(icnCore, configuration, icnPublisher, statistics),
+	  Unreliable(icnCore, configuration, icnPublisher)
 {
 	_tpState = TP_STATE_NO_ACTION_REQUIRED;
 }
@@ -66,7 +66,7 @@ TpState Transport::handle(IcnId &cId, IcnId &rCId, string &nodeId, void *packet,
 }
 
 bool Transport::retrievePacket(IcnId &rCId, string &nodeId,
-		uint16_t &sessionKey, uint8_t *packet, uint16_t &packetSize)
+		uint16_t &sessionKey, uint8_t *&packet, uint16_t &packetSize)
 {
 	switch (rCId.rootNamespace())
 	{
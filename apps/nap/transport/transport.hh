@@ -23,9 +23,9 @@
 #define NAP_TRANSPORT_HH_
 
 #include <blackadder.hpp>
-#include <boost/thread/mutex.hpp>
 
 #include <configuration.hh>
+#include <icnpublisher.hh>
 #include <monitoring/statistics.hh>
 #include <transport/lightweight.hh>
 #include <transport/unreliable.hh>
@@ -35,6 +35,7 @@
 #endif
 
 using namespace configuration;
+using namespace icn;
 using namespace monitoring::statistics;
 using namespace std;
 using namespace transport::lightweight;
@@ -53,7 +54,7 @@ public:
 	 * \brief Constructor
 	 */
 	Transport(Blackadder *icnCore, Configuration &configuration,
-			boost::mutex &icnCoreMutex, Statistics &statistics);
+			IcnPublisher &icnPublisher, Statistics &statistics);
 	/*!
 	 * \brief Handle an incoming PUBLISH_DATA events
 	 *
@@ -93,10 +94,13 @@ public:
 	 * At the moment this is only meant for LTP (HTTP-over-ICN). The UTP does
 	 * not require any additional input and can directly send off IP traffic.
 	 *
+	 * The packet is handed over in memory allocated for its exact size which
+	 * the caller must free.
+	 *
 	 * TODO params
 	 */
 	bool retrievePacket(IcnId &rCId, string &nodeId, uint16_t &sessionKey,
-			uint8_t *packet, uint16_t &packetSize);
+			uint8_t *&packet, uint16_t &packetSize);
 private:
 	TpState _tpState;
 };
@@ -26,10 +26,10 @@ using namespace transport::unreliable;
 LoggerPtr Unreliable::logger(Logger::getLogger("transport.unreliable"));
 
 Unreliable::Unreliable(Blackadder *icnCore, Configuration &configuration,
-		boost::mutex &icnCoreMutex)
+		IcnPublisher &icnPublisher)
 	: _icnCore(icnCore),
 	  _configuration(configuration),
-	  _icnCoreMutex(icnCoreMutex)
+	  _icnPublisher(icnPublisher)
 {
 	_ipSocket = new IpSocket(_configuration);
 }
@@ -70,10 +70,8 @@ void Unreliable::publish(IcnId &icnId, uint8_t *data, uint16_t &dataSize)
 					header.payloadLength);
 			memcpy(packet, &header, sizeof(utp_header_t));
 			memcpy(packet + sizeof(utp_header_t), data, header.payloadLength);
-			_icnCoreMutex.lock();
-			_icnCore->publish_data(icnId.binIcnId(), DOMAIN_LOCAL, NULL, 0,
-					packet,	sizeof(utp_header_t) + header.payloadLength);
-			_icnCoreMutex.unlock();
+			_icnPublisher.publishData(icnId.binIcnId(), packet,
+					sizeof(utp_header_t) + header.payloadLength);
 			bytesSent += header.payloadLength;
 			data += header.payloadLength;
 			LOG4CXX_TRACE(logger, "Fragment of length "
@@ -101,10 +99,8 @@ void Unreliable::publish(IcnId &icnId, uint8_t *data, uint16_t &dataSize)
 				<< ", sequence " << (uint16_t)header.sequence << ") of "
 				<< sizeof(utp_header_t) << " bytes published using CID "
 				<< icnId.print());
-		_icnCoreMutex.lock();
-		_icnCore->publish_data(icnId.binIcnId(), DOMAIN_LOCAL, NULL, 0, packet,
+		_icnPublisher.publishData(icnId.binIcnId(), packet,
 				header.payloadLength + sizeof(utp_header_t));
-		_icnCoreMutex.unlock();
 		free(packet);
 	}
 }
@@ -29,6 +29,7 @@
 
 #include <configuration.hh>
 #include <enumerations.hh>
+#include <icnpublisher.hh>
 #include <ipsocket.hh>
 #include <transport/unreliabletypedef.hh>
 #include <types/icnid.hh>
@@ -38,6 +39,7 @@
 #endif
 
 using namespace configuration;
+using namespace icn;
 using namespace ipsocket;
 using namespace log4cxx;
 
@@ -59,7 +61,7 @@ namespace transport
 			 * \brief Constructor
 			 */
 			Unreliable(Blackadder *icnCore, Configuration &configuration,
-					boost::mutex &icnCoreMutex);
+					IcnPublisher &icnPublisher);
 			/*!
 			 * \brief Destructor
 			 */
@@ -85,7 +87,7 @@ namespace transport
 		private:
 			Blackadder *_icnCore; /*!< Pointer to the Blackadder instance */
 			Configuration &_configuration;
-			boost::mutex &_icnCoreMutex;/*!< Reference to ICN core mutex */
+			IcnPublisher &_icnPublisher;/*!< Reference to the ICN publisher */
 			IpSocket *_ipSocket;
 			reassembly_packet_buffer_t _reassemblyBuffer; /*!< Buffer for
 			incoming UTP chunks in order to reassemble the actual IP packet */
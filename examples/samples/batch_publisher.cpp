@@ -0,0 +1,134 @@
+/*
+ * This file is part of Blackadder.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+/*
+ * Publishes the fragments of a large object (150000 fragments of 1420 bytes
+ * by default, as algid_publisher) three times, once START_PUBLISH is received
+ * (run subscriber on the same or another node): with one publish_data call per
+ * fragment, with publish_data_batch and PublishRequest descriptors, and with
+ * publish_data_batch and a precomputed PublishHeader. It prints the time and
+ * throughput of each. Usage: batch_publisher [0 (user space) | 1 (kernel)] [fragments]
+ */
+
+#include <blackadder.hpp>
+#include <signal.h>
+#include <sys/time.h>
+
+Blackadder *ba;
+int number_of_fragments = 150000;
+unsigned int fragment_size = 1420;
+char *payload;
+
+void sigfun(int sig) {
+    (void) signal(SIGINT, SIG_DFL);
+    ba->disconnect();
+    free(payload);
+    delete ba;
+    exit(0);
+}
+
+double now() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+void report(const char *method, double elapsed, int published) {
+    cout << method << ": " << published << " fragments in " << elapsed << " s, " << published / elapsed << " fragments/s, "
+            << published * (double) fragment_size * 8 / elapsed / 1e6 << " Mbps" << endl;
+}
+
+void publish_fragments(const string &id) {
+    double start;
+    int published;
+    /*one system call per fragment*/
+    start = now();
+    for (int i = 0; i < number_of_fragments; i++) {
+        ba->publish_data(id, DOMAIN_LOCAL, NULL, 0, payload, fragment_size);
+    }
+    report("publish_data", now() - start, number_of_fragments);
+    /*PUBLISH_BATCH_SIZE fragments per system call*/
+    PublishRequest requests[PUBLISH_BATCH_SIZE];
+    for (int j = 0; j < PUBLISH_BATCH_SIZE; j++) {
+        requests[j].id = &id;
+        requests[j].strategy = DOMAIN_LOCAL;
+        requests[j].str_opt = NULL;
+        requests[j].str_opt_len = 0;
+        requests[j].data = payload;
+        requests[j].data_len = fragment_size;
+    }
+    start = now();
+    published = 0;
+    for (int i = 0; i < number_of_fragments; i += PUBLISH_BATCH_SIZE) {
+        int count = (number_of_fragments - i < PUBLISH_BATCH_SIZE) ? number_of_fragments - i : PUBLISH_BATCH_SIZE;
+        published += ba->publish_data_batch(requests, count);
+    }
+    report("publish_data_batch", now() - start, published);
+    /*PUBLISH_BATCH_SIZE fragments per system call, with the same header iovec*/
+    PublishHeader header(id, DOMAIN_LOCAL, NULL, 0);
+    void *data[PUBLISH_BATCH_SIZE];
+    unsigned int data_len[PUBLISH_BATCH_SIZE];
+    for (int j = 0; j < PUBLISH_BATCH_SIZE; j++) {
+        data[j] = payload;
+        data_len[j] = fragment_size;
+    }
+    start = now();
+    published = 0;
+    for (int i = 0; i < number_of_fragments; i += PUBLISH_BATCH_SIZE) {
+        int count = (number_of_fragments - i < PUBLISH_BATCH_SIZE) ? number_of_fragments - i : PUBLISH_BATCH_SIZE;
+        published += ba->publish_data_batch(header, data, data_len, count);
+    }
+    report("publish_data_batch (PublishHeader)", now() - start, published);
+}
+
+int main(int argc, char* argv[]) {
+    (void) signal(SIGINT, sigfun);
+    if (argc > 1) {
+        int user_or_kernel = atoi(argv[1]);
+        if (user_or_kernel == 0) {
+            ba = Blackadder::Instance(true);
+        } else {
+            ba = Blackadder::Instance(false);
+        }
+    } else {
+        /*By Default I assume blackadder is running in user space*/
+        ba = Blackadder::Instance(true);
+    }
+    if (argc > 2) {
+        number_of_fragments = atoi(argv[2]);
+    }
+    payload = (char *) malloc(fragment_size);
+    memset(payload, 'A', fragment_size);
+    cout << "Process ID: " << getpid() << endl;
+    string id = "0000000000000000";
+    string prefix_id;
+    string bin_id = hex_to_chararray(id);
+    string bin_prefix_id = hex_to_chararray(prefix_id);
+    ba->publish_scope(bin_id, bin_prefix_id, DOMAIN_LOCAL, NULL, 0);
+
+    prefix_id = "0000000000000000";
+    id = "0111111111111111";
+    bin_id = hex_to_chararray(id);
+    bin_prefix_id = hex_to_chararray(prefix_id);
+    ba->publish_info(bin_id, bin_prefix_id, DOMAIN_LOCAL, NULL, 0);
+    while (true) {
+        Event ev;
+        ba->getEvent(ev);
+        if (ev.type == START_PUBLISH) {
+            cout << "START_PUBLISH: " << chararray_to_hex(ev.id) << endl;
+            publish_fragments(ev.id);
+            break;
+        }
+    }
+    free(payload);
+    ba->disconnect();
+    delete ba;
+    return 0;
+}
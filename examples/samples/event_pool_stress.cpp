@@ -0,0 +1,193 @@
+/*
+ * This file is part of Blackadder.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+/*
+ * Stress test of the EventBufferPool the client libraries read Events into (it does not need Blackadder).
+ * Producer threads build Events of mixed sizes (from a few bytes to larger than the largest size class) in buffers of the pool,
+ * fill them with a pattern and pass them to consumer threads, which check the pattern, sometimes copy the Event and delete them.
+ * The test is run a few rounds: after each round no buffer may be in use, and the slabs may not exceed what the Events in flight
+ * (at most QUEUE_LIMIT per queue) can use, i.e. the buffers must be reused.
+ * Usage: event_pool_stress [threads] [events per producer] [rounds]
+ */
+
+#include <blackadder.hpp>
+#include <queue>
+
+/*the maximum number of Events in a queue, the producers wait for the consumer beyond that*/
+#define QUEUE_LIMIT 256
+
+int number_of_threads = 4;
+int events_per_producer = 200000;
+int rounds = 3;
+
+EventBufferPool *pool;
+unsigned long long corrupted = 0;
+
+/*a queue of Events from the producers to a consumer; a NULL Event tells the consumer to stop*/
+struct EventQueue {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    pthread_cond_t not_full;
+    queue<Event *> events;
+};
+EventQueue *queues;
+
+unsigned int event_size(unsigned int random) {
+    /*mostly small and MTU sized Events, some of the other classes and some too large for the slabs*/
+    switch (random % 16) {
+        case 0:
+            return 16384 + random % 49152;
+        case 1:
+            return 65536 + random % 65536;
+        case 2:
+        case 3:
+            return 2048 + random % 14336;
+        case 4:
+        case 5:
+        case 6:
+        case 7:
+            return 1 + random % 256;
+        default:
+            return 256 + random % 1792;
+    }
+}
+
+void *producer(void *arg) {
+    unsigned int seed = (unsigned int) (intptr_t) arg + 1;
+    for (int i = 0; i < events_per_producer; i++) {
+        unsigned int size = event_size(rand_r(&seed));
+        Event *ev = new Event();
+        /*the copy constructor copies the headers of a received Event too: leave room for them*/
+        ev->buffer = pool->acquire(size + 64);
+        if (ev->buffer == NULL) {
+            delete ev;
+            continue;
+        }
+        ev->pool = pool;
+        ev->data = ev->buffer;
+        ev->data_len = size;
+        memset(ev->buffer, (unsigned char) size, size);
+        EventQueue *q = &queues[rand_r(&seed) % number_of_threads];
+        pthread_mutex_lock(&q->mutex);
+        while (q->events.size() >= QUEUE_LIMIT) {
+            pthread_cond_wait(&q->not_full, &q->mutex);
+        }
+        q->events.push(ev);
+        pthread_cond_signal(&q->cond);
+        pthread_mutex_unlock(&q->mutex);
+    }
+    return NULL;
+}
+
+bool intact(Event *ev) {
+    for (unsigned int i = 0; i < ev->data_len; i++) {
+        if (((unsigned char *) ev->data)[i] != (unsigned char) ev->data_len) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void *consumer(void *arg) {
+    EventQueue *q = &queues[(intptr_t) arg];
+    Event *ev;
+    while (true) {
+        pthread_mutex_lock(&q->mutex);
+        while (q->events.empty()) {
+            pthread_cond_wait(&q->cond, &q->mutex);
+        }
+        ev = q->events.front();
+        q->events.pop();
+        pthread_cond_broadcast(&q->not_full);
+        pthread_mutex_unlock(&q->mutex);
+        if (ev == NULL) {
+            break;
+        }
+        if (!intact(ev)) {
+            __sync_fetch_and_add(&corrupted, 1);
+        }
+        if (ev->data_len % 7 == 0) {
+            /*the copy gets a buffer of the same pool*/
+            Event *copy = new Event(*ev);
+            if ((copy->pool != pool) || (memcmp(copy->buffer, ev->buffer, ev->data_len) != 0)) {
+                __sync_fetch_and_add(&corrupted, 1);
+            }
+            delete copy;
+        }
+        delete ev;
+    }
+    return NULL;
+}
+
+int main(int argc, char* argv[]) {
+    pthread_t *producers, *consumers;
+    size_t slab_limit;
+    bool failed = false;
+    if (argc > 1) {
+        number_of_threads = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        events_per_producer = atoi(argv[2]);
+    }
+    if (argc > 3) {
+        rounds = atoi(argv[3]);
+    }
+    pool = new EventBufferPool();
+    queues = new EventQueue[number_of_threads];
+    producers = new pthread_t[number_of_threads];
+    consumers = new pthread_t[number_of_threads];
+    for (int t = 0; t < number_of_threads; t++) {
+        pthread_mutex_init(&queues[t].mutex, NULL);
+        pthread_cond_init(&queues[t].cond, NULL);
+        pthread_cond_init(&queues[t].not_full, NULL);
+    }
+    /*every Event in flight (in a queue, or held by a producer or a consumer with its copy) in the largest class, and a partly used slab per class*/
+    slab_limit = (size_t) number_of_threads * (QUEUE_LIMIT + 3) * (65536 + 64) + EVENT_POOL_SIZE_CLASSES * EVENT_POOL_SLAB_SIZE;
+    for (int r = 0; r < rounds; r++) {
+        for (int t = 0; t < number_of_threads; t++) {
+            pthread_create(&consumers[t], NULL, consumer, (void *) (intptr_t) t);
+            pthread_create(&producers[t], NULL, producer, (void *) (intptr_t) t);
+        }
+        for (int t = 0; t < number_of_threads; t++) {
+            pthread_join(producers[t], NULL);
+        }
+        for (int t = 0; t < number_of_threads; t++) {
+            pthread_mutex_lock(&queues[t].mutex);
+            queues[t].events.push(NULL);
+            pthread_cond_signal(&queues[t].cond);
+            pthread_mutex_unlock(&queues[t].mutex);
+        }
+        for (int t = 0; t < number_of_threads; t++) {
+            pthread_join(consumers[t], NULL);
+        }
+        cout << "round " << r << ": " << pool->buffers_in_use() << " buffers in use, " << pool->slab_bytes() << " bytes of slabs, "
+                << corrupted << " corrupted Events" << endl;
+        if (pool->buffers_in_use() != 0) {
+            failed = true;
+        }
+        if (pool->slab_bytes() > slab_limit) {
+            failed = true;
+        }
+    }
+    /*an Event that outlives the owner's reference keeps the pool*/
+    Event *late = new Event();
+    late->buffer = pool->acquire(100);
+    late->pool = pool;
+    pool->unref();
+    delete late;
+    if (corrupted != 0) {
+        failed = true;
+    }
+    cout << (failed ? "FAILED" : "PASSED") << endl;
+    delete [] queues;
+    delete [] producers;
+    delete [] consumers;
+    return failed ? 1 : 0;
+}
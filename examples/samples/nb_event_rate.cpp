@@ -0,0 +1,170 @@
+/*
+ * This file is part of Blackadder.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+/*
+ * Measures how many Events per second NB_Blackadder passes to the callback with a given number of worker threads.
+ * A child process publishes a number of information items under a scope (with the blocking Blackadder library) and,
+ * for each START_PUBLISH, publishes the same number of fragments for that item. The parent process subscribes to the scope
+ * with NB_Blackadder and a callback that hashes every payload a few times (so that the callback is not free), counts the Events
+ * and checks that the fragments of each item arrive in order. The rate is printed every second.
+ * Usage: nb_event_rate [0 (user space) | 1 (kernel)] [workers] [items] [fragments per item] [hash rounds]
+ */
+
+#include <blackadder.hpp>
+#include <nb_blackadder.hpp>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+bool user_space = true;
+unsigned int workers = 1;
+int number_of_items = 64;
+int number_of_fragments = 10000;
+int hash_rounds = 10;
+unsigned int fragment_size = 1024;
+
+unsigned long long events = 0;
+unsigned long long out_of_order = 0;
+unsigned long long checksum = 0;
+/*the last sequence number received for each item: only the worker thread of the item touches its entry*/
+unsigned int *last_sequence;
+
+double now() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/*the item identifiers are a fragment with the item index in its last 4 bytes*/
+string item_id(int item) {
+    string id(PURSUIT_ID_LEN, '\0');
+    id[PURSUIT_ID_LEN - 4] = (char) (item >> 24);
+    id[PURSUIT_ID_LEN - 3] = (char) (item >> 16);
+    id[PURSUIT_ID_LEN - 2] = (char) (item >> 8);
+    id[PURSUIT_ID_LEN - 1] = (char) item;
+    return id;
+}
+
+int item_index(const string &id) {
+    const unsigned char *p = (const unsigned char *) id.data() + id.length() - 4;
+    return (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+void publisher(const string &scope_id) {
+    Blackadder *ba = Blackadder::Instance(user_space);
+    char *payload = (char *) malloc(fragment_size);
+    int started = 0;
+    memset(payload, 'A', fragment_size);
+    ba->publish_scope(scope_id, string(), DOMAIN_LOCAL, NULL, 0);
+    for (int i = 0; i < number_of_items; i++) {
+        ba->publish_info(item_id(i), scope_id, DOMAIN_LOCAL, NULL, 0);
+    }
+    while (started < number_of_items) {
+        Event ev;
+        ba->getEvent(ev);
+        if (ev.type == START_PUBLISH) {
+            started++;
+            for (int j = 1; j <= number_of_fragments; j++) {
+                /*the sequence number of the fragment*/
+                memcpy(payload, &j, sizeof (j));
+                ba->publish_data(ev.id, DOMAIN_LOCAL, NULL, 0, payload, fragment_size);
+            }
+        }
+    }
+    free(payload);
+    ba->disconnect();
+    delete ba;
+}
+
+void callback(Event *ev) {
+    if (ev->type == PUBLISHED_DATA) {
+        unsigned int sequence;
+        Fnv64_t hash = 0;
+        int item = item_index(ev->id);
+        memcpy(&sequence, ev->data, sizeof (sequence));
+        if ((item < number_of_items) && (sequence != last_sequence[item] + 1)) {
+            __sync_fetch_and_add(&out_of_order, 1);
+        }
+        if (item < number_of_items) {
+            last_sequence[item] = sequence;
+        }
+        for (int i = 0; i < hash_rounds; i++) {
+            hash += fnv1a_64((const unsigned char *) ev->data, ev->data_len);
+        }
+        __sync_fetch_and_add(&checksum, hash);
+        __sync_fetch_and_add(&events, 1);
+    }
+    delete ev;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        user_space = (atoi(argv[1]) == 0);
+    }
+    if (argc > 2) {
+        workers = atoi(argv[2]);
+    }
+    if (argc > 3) {
+        number_of_items = atoi(argv[3]);
+    }
+    if (argc > 4) {
+        number_of_fragments = atoi(argv[4]);
+    }
+    if (argc > 5) {
+        hash_rounds = atoi(argv[5]);
+    }
+    string scope_id = hex_to_chararray("0e0e0e0e0e0e0e0e");
+    unsigned long long expected = (unsigned long long) number_of_items * number_of_fragments;
+    last_sequence = (unsigned int *) calloc(number_of_items, sizeof (unsigned int));
+    /*fork before NB_Blackadder starts its threads*/
+    pid_t child = fork();
+    if (child == 0) {
+        /*give the subscriber time to subscribe*/
+        sleep(1);
+        publisher(scope_id);
+        return 0;
+    }
+    NB_Blackadder *nb_ba = NB_Blackadder::Instance(user_space, workers);
+    nb_ba->setCallback(callback);
+    nb_ba->subscribe_scope(scope_id, string(), DOMAIN_LOCAL, NULL, 0);
+    cout << "Process ID: " << getpid() << ", " << workers << " worker(s), expecting " << expected << " events" << endl;
+    double start = 0, last_active = 0, previous_time = now();
+    unsigned long long previous = 0, current;
+    int idle = 0;
+    while (true) {
+        sleep(1);
+        current = __sync_fetch_and_add(&events, 0);
+        double t = now();
+        if ((start == 0) && (current > 0)) {
+            start = previous_time;
+        }
+        cout << (current - previous) / (t - previous_time) << " events/s" << endl;
+        if (current == previous) {
+            idle++;
+        } else {
+            idle = 0;
+            last_active = t;
+        }
+        previous = current;
+        previous_time = t;
+        if ((current >= expected) || ((start != 0) && (idle == 3))) {
+            break;
+        }
+    }
+    if (start != 0) {
+        double elapsed = last_active - start;
+        cout << "received " << previous << " of " << expected << " events, " << out_of_order << " out of order, "
+                << previous / elapsed << " events/s on average (" << workers << " worker(s))" << endl;
+    }
+    waitpid(child, NULL, 0);
+    nb_ba->disconnect();
+    free(last_sequence);
+    delete nb_ba;
+    return 0;
+}
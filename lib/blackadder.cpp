@@ -21,6 +21,7 @@ Blackadder* Blackadder::m_pInstance = NULL;
 
 Blackadder::Blackadder(bool user_space) {
     int ret;
+    event_pool = new EventBufferPool();
 
     if (user_space) {
 #if HAVE_USE_NETLINK
@@ -126,6 +127,8 @@ Blackadder::~Blackadder() {
         close(kq);
 #endif
     }
+    /*Events still alive keep the pool until they are deleted*/
+    event_pool->unref();
 }
 
 Blackadder* Blackadder::Instance(bool user_space) {
@@ -418,6 +421,155 @@ void Blackadder::publish_data(const string&id, unsigned char strategy, void *str
             perror("Blackadder Library: Failed to publish data ");
         }
 }
+PublishHeader::PublishHeader(const string &id, unsigned char strategy, void *str_opt, unsigned int str_opt_len) {
+    if (id.length() % PURSUIT_ID_LEN != 0) {
+        cout << "Blackadder Library: Could not build the publication header - wrong ID size" << endl;
+    } else {
+        buffer += (char) PUBLISH_DATA;
+        buffer += (char) (id.length() / PURSUIT_ID_LEN);
+        buffer += id;
+        buffer += (char) strategy;
+        if (str_opt != NULL) {
+            buffer.append((const char *) str_opt, str_opt_len);
+        }
+    }
+}
+
+void Blackadder::publish_data(const PublishHeader &header, void *data, unsigned int data_len) {
+    publish_data_batch(header, &data, &data_len, 1);
+}
+
+int Blackadder::publish_data_batch(PublishRequest *requests, unsigned int count, unsigned int *skipped) {
+    unsigned char type = PUBLISH_DATA;
+    unsigned char id_len[PUBLISH_BATCH_SIZE];
+    struct nlmsghdr nlh[PUBLISH_BATCH_SIZE];
+    struct iovec iov[PUBLISH_BATCH_SIZE][7];
+    batch_msghdr msgs[PUBLISH_BATCH_SIZE];
+    unsigned int first = 0;
+    int published = 0;
+    if (skipped != NULL) {
+        *skipped = 0;
+    }
+    while (first < count) {
+        /*fill up to PUBLISH_BATCH_SIZE messages, the same way as publish_data*/
+        unsigned int m = 0;
+        for (; (first < count) && (m < PUBLISH_BATCH_SIZE); first++) {
+            PublishRequest *request = &requests[first];
+            if (request->id->length() % PURSUIT_ID_LEN != 0) {
+                cout << "Blackadder Library: Could not send  - wrong ID size" << endl;
+                if (skipped != NULL) {
+                    (*skipped)++;
+                }
+                continue;
+            }
+            id_len[m] = request->id->length() / PURSUIT_ID_LEN;
+            memset(&nlh[m], 0, sizeof (nlh[m]));
+            nlh[m].nlmsg_len = sizeof (struct nlmsghdr) + 1 /*type*/ + 1 /*for id length*/ + request->id->length() + sizeof (request->strategy) + request->data_len;
+            if (request->str_opt != NULL) {
+                nlh[m].nlmsg_len += request->str_opt_len;
+            }
+            nlh[m].nlmsg_pid = getpid();
+            nlh[m].nlmsg_flags = 1;
+            nlh[m].nlmsg_type = 0;
+            iov[m][0].iov_base = &nlh[m];
+            iov[m][0].iov_len = sizeof (nlh[m]);
+            iov[m][1].iov_base = &type;
+            iov[m][1].iov_len = sizeof (type);
+            iov[m][2].iov_base = &id_len[m];
+            iov[m][2].iov_len = sizeof (id_len[m]);
+            iov[m][3].iov_base = (void *) request->id->c_str();
+            iov[m][3].iov_len = request->id->length();
+            iov[m][4].iov_base = (void *) &request->strategy;
+            iov[m][4].iov_len = sizeof (request->strategy);
+            if (request->str_opt == NULL) {
+                iov[m][5].iov_base = request->data;
+                iov[m][5].iov_len = request->data_len;
+            } else {
+                iov[m][5].iov_base = request->str_opt;
+                iov[m][5].iov_len = request->str_opt_len;
+                iov[m][6].iov_base = request->data;
+                iov[m][6].iov_len = request->data_len;
+            }
+            memset(&msgs[m], 0, sizeof (msgs[m]));
+            msgs[m].msg_hdr.msg_name = (void *) &d_nladdr;
+            msgs[m].msg_hdr.msg_namelen = sizeof (d_nladdr);
+            msgs[m].msg_hdr.msg_iov = iov[m];
+            msgs[m].msg_hdr.msg_iovlen = (request->str_opt == NULL) ? 6 : 7;
+            m++;
+        }
+        int sent = send_batch(msgs, m);
+        published += sent;
+        if (sent < (int) m) {
+            break;
+        }
+    }
+    return published;
+}
+
+int Blackadder::publish_data_batch(const PublishHeader &header, void **data, unsigned int *data_len, unsigned int count) {
+    struct nlmsghdr nlh[PUBLISH_BATCH_SIZE];
+    struct iovec iov[PUBLISH_BATCH_SIZE][3];
+    batch_msghdr msgs[PUBLISH_BATCH_SIZE];
+    unsigned int first = 0;
+    int published = 0;
+    if (!header.valid()) {
+        cout << "Blackadder Library: Could not send  - invalid publication header" << endl;
+        return 0;
+    }
+    while (first < count) {
+        /*only the netlink header depends on the data, the service model header is the same iovec for all messages*/
+        unsigned int m = 0;
+        for (; (first < count) && (m < PUBLISH_BATCH_SIZE); first++, m++) {
+            memset(&nlh[m], 0, sizeof (nlh[m]));
+            nlh[m].nlmsg_len = sizeof (struct nlmsghdr) + header.buffer.length() + data_len[first];
+            nlh[m].nlmsg_pid = getpid();
+            nlh[m].nlmsg_flags = 1;
+            nlh[m].nlmsg_type = 0;
+            iov[m][0].iov_base = &nlh[m];
+            iov[m][0].iov_len = sizeof (nlh[m]);
+            iov[m][1].iov_base = (void *) header.buffer.data();
+            iov[m][1].iov_len = header.buffer.length();
+            iov[m][2].iov_base = data[first];
+            iov[m][2].iov_len = data_len[first];
+            memset(&msgs[m], 0, sizeof (msgs[m]));
+            msgs[m].msg_hdr.msg_name = (void *) &d_nladdr;
+            msgs[m].msg_hdr.msg_namelen = sizeof (d_nladdr);
+            msgs[m].msg_hdr.msg_iov = iov[m];
+            msgs[m].msg_hdr.msg_iovlen = 3;
+        }
+        int sent = send_batch(msgs, m);
+        published += sent;
+        if (sent < (int) m) {
+            break;
+        }
+    }
+    return published;
+}
+
+int Blackadder::send_batch(batch_msghdr *msgs, unsigned int count) {
+    unsigned int sent = 0;
+    int ret;
+    while (sent < count) {
+#ifdef __linux__
+        ret = sendmmsg(sock_fd, msgs + sent, count - sent, 0);
+#else
+        ret = sendmsg(sock_fd, &msgs[sent].msg_hdr, 0);
+        if (ret >= 0) {
+            ret = 1;
+        }
+#endif
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("Blackadder Library: Failed to publish data ");
+            break;
+        }
+        sent += ret;
+    }
+    return sent;
+}
+
 bool Blackadder::publish_data(const string&id,
                               unsigned char strategy,
                               void *str_opt,
@@ -600,7 +752,7 @@ void Blackadder::getEventIntoBuf(Event &ev, void *data, unsigned int data_len) {
 #endif
     if (total_buf_size > 0) {
         if (data == NULL) {
-            iov.iov_base = malloc(total_buf_size);
+            iov.iov_base = event_pool->acquire(total_buf_size);
             if (!iov.iov_base) {
                 ev.type = UNDEF_EVENT;
                 return;
@@ -613,17 +765,26 @@ void Blackadder::getEventIntoBuf(Event &ev, void *data, unsigned int data_len) {
         bytes_read = recvmsg(sock_fd, &msg, 0);
         if (bytes_read < 0) {
             //perror("recvmsg for data");
-            free(iov.iov_base);
+            if (data == NULL) {
+                EventBufferPool::release(iov.iov_base);
+            } else {
+                free(iov.iov_base);
+            }
             ev.type = UNDEF_EVENT;
             return;
         }
         if (bytes_read < sizeof(struct nlmsghdr)) {
             cout << "read " << bytes_read << " bytes, not enough" << endl;
-            free(iov.iov_base);
+            if (data == NULL) {
+                EventBufferPool::release(iov.iov_base);
+            } else {
+                free(iov.iov_base);
+            }
             ev.type = UNDEF_EVENT;
             return;
         }
         ev.buffer = iov.iov_base;
+        ev.pool = (data == NULL) ? event_pool : NULL;
         ptr = (unsigned char *)ev.buffer + sizeof(struct nlmsghdr);
         ev.type = *ptr; ptr += sizeof(ev.type);
         id_len  = *ptr; ptr += sizeof(id_len);
@@ -656,26 +817,148 @@ void Blackadder::getEventIntoBuf(Event &ev, void *data, unsigned int data_len) {
 }
 
 Event::Event()
-: type(0), id(), nodeId(), isubID(), data(NULL), data_len(0), buffer(NULL) {
+: type(0), id(), nodeId(), isubID(), data(NULL), data_len(0), buffer(NULL), pool(NULL) {
 }
 
 Event::Event(Event &ev) {
+    unsigned int buffer_len = sizeof (struct nlmsghdr) + sizeof (type) + sizeof (unsigned char) + ev.id.length() + sizeof (nodeId) + sizeof (unsigned char) + ev.isubID.length() + ev.data_len;
     type = ev.type;
     id = ev.id;
     data_len = ev.data_len;
     nodeId = ev.nodeId;
     isubID = ev.isubID;
-    buffer = malloc(sizeof (struct nlmsghdr) + sizeof (type) + sizeof (unsigned char) + id.length() + sizeof (nodeId) + sizeof (unsigned char) + isubID.length() + data_len);
-    memcpy(buffer, ev.buffer, sizeof (struct nlmsghdr) + sizeof (type) + sizeof (unsigned char) + id.length() + sizeof (nodeId) + sizeof (unsigned char) + isubID.length() + data_len);
+    /*the copy takes its buffer from the same pool*/
+    pool = ev.pool;
+    if (pool != NULL) {
+        buffer = pool->acquire(buffer_len);
+    } else {
+        buffer = malloc(buffer_len);
+    }
+    if (buffer == NULL) {
+        /*no memory for the copy: it is left empty, as getEvent leaves an Event it fails to read*/
+        type = UNDEF_EVENT;
+        data = NULL;
+        data_len = 0;
+        pool = NULL;
+        return;
+    }
+    memcpy(buffer, ev.buffer, buffer_len);
     data = (char *) buffer + sizeof (struct nlmsghdr) + sizeof (type) + sizeof (unsigned char) + id.length() + sizeof (nodeId) + sizeof(unsigned char) + isubID.length();
 }
 
 Event::~Event() {
     if (buffer != NULL) {
-        free(buffer);
+        if (pool != NULL) {
+            EventBufferPool::release(buffer);
+        } else {
+            free(buffer);
+        }
+    }
+}
+
+/*the sizes of the classes of an EventBufferPool*/
+static const unsigned int event_pool_class_sizes[EVENT_POOL_SIZE_CLASSES] = {256, 2048, 16384, 65536};
+
+EventBufferPool::EventBufferPool() {
+    for (int i = 0; i < EVENT_POOL_SIZE_CLASSES; i++) {
+        pthread_mutex_init(&classes[i].mutex, NULL);
+        classes[i].free_list = NULL;
+    }
+    references = 1;
+    in_use = 0;
+}
+
+EventBufferPool::~EventBufferPool() {
+    for (int i = 0; i < EVENT_POOL_SIZE_CLASSES; i++) {
+        for (size_t j = 0; j < classes[i].slabs.size(); j++) {
+            free(classes[i].slabs[j]);
+        }
+        pthread_mutex_destroy(&classes[i].mutex);
+    }
+}
+
+void *EventBufferPool::acquire(unsigned int size) {
+    BufferHeader *header;
+    unsigned int size_class = 0;
+    while ((size_class < EVENT_POOL_SIZE_CLASSES) && (size > event_pool_class_sizes[size_class])) {
+        size_class++;
+    }
+    if (size_class == EVENT_POOL_SIZE_CLASSES) {
+        /*too large for the slabs*/
+        header = (BufferHeader *) malloc(sizeof (BufferHeader) + size);
+        if (header == NULL) {
+            return NULL;
+        }
+    } else {
+        SizeClass &sc = classes[size_class];
+        pthread_mutex_lock(&sc.mutex);
+        if (sc.free_list == NULL) {
+            /*carve a new slab into buffers of this class*/
+            unsigned int buffer_size = sizeof (BufferHeader) + event_pool_class_sizes[size_class];
+            char *slab = (char *) malloc(EVENT_POOL_SLAB_SIZE);
+            if (slab == NULL) {
+                pthread_mutex_unlock(&sc.mutex);
+                return NULL;
+            }
+            sc.slabs.push_back(slab);
+            for (unsigned int offset = 0; offset + buffer_size <= EVENT_POOL_SLAB_SIZE; offset += buffer_size) {
+                BufferHeader *free_header = (BufferHeader *) (slab + offset);
+                free_header->next = sc.free_list;
+                sc.free_list = free_header;
+            }
+        }
+        header = sc.free_list;
+        sc.free_list = header->next;
+        pthread_mutex_unlock(&sc.mutex);
+    }
+    header->pool = this;
+    header->next = NULL;
+    header->size_class = size_class;
+    __sync_fetch_and_add(&in_use, 1);
+    ref();
+    return header + 1;
+}
+
+void EventBufferPool::release(void *buffer) {
+    BufferHeader *header = (BufferHeader *) buffer - 1;
+    EventBufferPool *pool = header->pool;
+    if (header->size_class == EVENT_POOL_SIZE_CLASSES) {
+        free(header);
+    } else {
+        SizeClass &sc = pool->classes[header->size_class];
+        pthread_mutex_lock(&sc.mutex);
+        header->next = sc.free_list;
+        sc.free_list = header;
+        pthread_mutex_unlock(&sc.mutex);
+    }
+    __sync_fetch_and_sub(&pool->in_use, 1);
+    pool->unref();
+}
+
+void EventBufferPool::ref() {
+    __sync_fetch_and_add(&references, 1);
+}
+
+void EventBufferPool::unref() {
+    if (__sync_sub_and_fetch(&references, 1) == 0) {
+        delete this;
     }
 }
 
+unsigned int EventBufferPool::buffers_in_use() {
+    return __sync_fetch_and_add(&in_use, 0);
+}
+
+size_t EventBufferPool::slab_bytes() {
+    size_t bytes = 0;
+    for (int i = 0; i < EVENT_POOL_SIZE_CLASSES; i++) {
+        pthread_mutex_lock(&classes[i].mutex);
+        bytes += classes[i].slabs.size() * EVENT_POOL_SLAB_SIZE;
+        pthread_mutex_unlock(&classes[i].mutex);
+    }
+    return bytes;
+}
+
 string get_chararray_sid(const string &icnid, unsigned int &depth) {
     string sid;
     int id_len = icnid.length() / PURSUIT_ID_LEN;
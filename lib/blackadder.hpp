@@ -46,6 +46,7 @@
 #endif
 #include <errno.h>
 #include <unistd.h>
+#include <pthread.h>
 #include <vector>
 #include <sstream>
 #include <iostream>
@@ -87,6 +88,69 @@ vector<int> split_int_string(string &input_str, char delim_char);
 string get_chararray_sid(const string &icnid, unsigned int &depth);
 
 class Event;
+class EventBufferPool;
+
+/**@relates Blackadder
+ * @brief the maximum number of publications sent by a single system call in Blackadder::publish_data_batch.
+ */
+#define PUBLISH_BATCH_SIZE 64
+
+/**@relates Blackadder
+ * @brief a message of a batch: the struct mmsghdr of sendmmsg on Linux, the same fields elsewhere (where the messages are sent one by one).
+ */
+#ifdef __linux__
+typedef struct mmsghdr batch_msghdr;
+#else
+struct batch_msghdr {
+    struct msghdr msg_hdr;
+    unsigned int msg_len;
+};
+#endif
+
+/**@relates Blackadder
+ * @brief a publication of a Blackadder::publish_data_batch request. The fields are the arguments of Blackadder::publish_data.
+ *
+ * Nothing is copied: the identifier, the strategy options and the data must stay valid until publish_data_batch returns.
+ */
+struct PublishRequest {
+    /**@brief the full identifier of the information item for which data is published.
+     */
+    const string *id;
+    /**@brief the dissemination strategy assigned to the request.
+     */
+    unsigned char strategy;
+    /**@brief a bucket of bytes that are strategy specific (e.g. a LIPSIN identifier for IMPLICIT_RENDEZVOUS), or NULL.
+     */
+    void *str_opt;
+    /**@brief the size of str_opt.
+     */
+    unsigned int str_opt_len;
+    /**@brief a bucket of data that is published.
+     */
+    void *data;
+    /**@brief the size of the published data.
+     */
+    unsigned int data_len;
+};
+
+/**@brief (User Library) the service model header of a PUBLISH_DATA request (type, identifier, strategy and strategy options), built once for repeated publications of the same identifier.
+ *
+ * Blackadder::publish_data and Blackadder::publish_data_batch send it as a single iovec in front of the data of each publication.
+ */
+class PublishHeader {
+public:
+    /**@brief builds the header. The arguments are the ones of Blackadder::publish_data.
+     *
+     * If the identifier size is wrong the header is not valid and nothing is published with it.
+     */
+    PublishHeader(const string &id, unsigned char strategy, void *str_opt, unsigned int str_opt_len);
+    /**@brief is the header valid?
+     */
+    bool valid() const { return !buffer.empty(); }
+    /**@brief the header bytes, as they follow the netlink header of a PUBLISH_DATA request.
+     */
+    string buffer;
+};
 
 /**@brief (User Library) This is the wrapper class that makes the service model available to all applications.
  *
@@ -259,6 +323,33 @@ public:
      * @return: boolean indicating whether the message has been passed to core Blackadder succesffuly or not
      */
     bool publish_data(const string&id, unsigned char strategy, void *str_opt, unsigned int str_opt_len, std::list<string> &nodeIds, void * data, unsigned int data_len);
+    /**@brief this is an overloaded method of publish_data, it sends a PUBLISH_DATA request with a precomputed header, for repeated publications of the same identifier.
+     *
+     * @param header the header of the request (identifier, strategy and strategy options).
+     * @param data a bucket of data that is published.
+     * @param data_len the size of the published data.
+     */
+    void publish_data(const PublishHeader &header, void *data, unsigned int data_len);
+    /**@brief this method sends multiple PUBLISH_DATA requests to Blackadder, up to PUBLISH_BATCH_SIZE of them with a single system call (sendmmsg when available).
+     *
+     * The requests are sent in order. A request with a wrong identifier size is not sent: it is skipped and counted in skipped, the requests after it are still sent.
+     * If a system call fails, the requests from the one it failed on are not sent.
+     *
+     * @param requests an array of publications.
+     * @param count the number of publications in the array.
+     * @param skipped if not NULL, set to the number of requests skipped for a wrong identifier size.
+     * @return the number of requests sent to Blackadder. The returned value and skipped add up to count unless a system call failed.
+     */
+    int publish_data_batch(PublishRequest *requests, unsigned int count, unsigned int *skipped = NULL);
+    /**@brief this is an overloaded method of publish_data_batch, for multiple publications with the same precomputed header (e.g. the fragments of a large object sent on the same identifier).
+     *
+     * @param header the header of the requests (identifier, strategy and strategy options).
+     * @param data an array of buckets of data that are published.
+     * @param data_len an array with the size of each bucket of data.
+     * @param count the number of publications.
+     * @return the number of requests sent to Blackadder, which is less than count if a system call failed.
+     */
+    int publish_data_batch(const PublishHeader &header, void **data, unsigned int *data_len, unsigned int count);
     /**@brief this method will send a PUBLISH_DATA_iSUB request to Blackadder.
      * overloaded function to introduce the informationID associated with PUBLISH_DATA_iSUB
      *
@@ -313,6 +404,13 @@ private:
      * @param str_opt_len as passed by a request method.
      */
     int create_and_send_buffers(unsigned char type, const string &id, const string &prefix_id, char strategy, void *str_opt, unsigned int str_opt_len);
+    /**@brief send_batch sends the messages prepared by publish_data_batch, with as few system calls as possible.
+     *
+     * @param msgs the messages (struct mmsghdr on Linux).
+     * @param count the number of messages.
+     * @return the number of messages sent.
+     */
+    int send_batch(batch_msghdr *msgs, unsigned int count);
     /** @brief The netlink socket file descriptor.
      */
     int sock_fd;
@@ -326,11 +424,83 @@ private:
     /**@brief a dummy buffer for peeking the actual expected buffer so that we can learn its size.
      */
     char fake_buf[1];
+    /**@brief the pool the buffers of the received Events are taken from.
+     */
+    EventBufferPool *event_pool;
     /**@brief the single static Blackadder object an application can access.
      */
     static Blackadder* m_pInstance;
 };
 
+/**@relates EventBufferPool
+ * @brief the number of size classes of an EventBufferPool. Larger buffers are allocated with malloc.
+ */
+#define EVENT_POOL_SIZE_CLASSES 4
+
+/**@relates EventBufferPool
+ * @brief the size of the slabs an EventBufferPool carves its buffers from.
+ */
+#define EVENT_POOL_SLAB_SIZE (256 * 1024)
+
+/**@brief (User Library) A pool of Event buffers, in size classes (256, 2048, 16384 and 65536 bytes) carved from slabs of EVENT_POOL_SLAB_SIZE bytes.
+ *
+ * Blackadder and NB_Blackadder read each Event in a buffer of the pool instead of a malloc'ed one. The Event keeps a handle to the pool and its destructor releases the buffer back to it.
+ * Each size class has its own free list and mutex, so buffers can be released by any thread.
+ * The pool is reference counted: every buffer in use holds a reference, as does the library instance that owns it, so Events may outlive the instance.
+ * The slabs are only freed when the last reference is dropped.
+ */
+class EventBufferPool {
+public:
+    /**@brief Constructor: the pool is empty and has a single reference, that of its creator.
+     */
+    EventBufferPool();
+    /**@brief returns a buffer of at least size bytes and takes a reference to the pool.
+     *
+     * @param size the size of the buffer.
+     * @return the buffer or NULL if no memory is available.
+     */
+    void *acquire(unsigned int size);
+    /**@brief gives a buffer returned by acquire back to its pool and drops the reference it held.
+     *
+     * @param buffer the buffer.
+     */
+    static void release(void *buffer);
+    /**@brief takes a reference to the pool.
+     */
+    void ref();
+    /**@brief drops a reference to the pool. The pool is deleted when the last one is dropped.
+     */
+    void unref();
+    /**@brief the number of buffers acquired and not released yet.
+     */
+    unsigned int buffers_in_use();
+    /**@brief the number of bytes of all slabs allocated by the pool.
+     */
+    size_t slab_bytes();
+private:
+    /**@brief Destructor: it frees the slabs. It is only called by unref.
+     */
+    ~EventBufferPool();
+    /**@brief the header in front of each buffer: the pool and size class the buffer belongs to, and the next free buffer when it is in a free list.
+     */
+    struct BufferHeader {
+        EventBufferPool *pool;
+        BufferHeader *next;
+        unsigned int size_class;
+        unsigned int padding[3];
+    };
+    /**@brief a size class: the free buffers and the slabs they were carved from.
+     */
+    struct SizeClass {
+        pthread_mutex_t mutex;
+        BufferHeader *free_list;
+        vector<void *> slabs;
+    };
+    SizeClass classes[EVENT_POOL_SIZE_CLASSES];
+    unsigned int references;
+    unsigned int in_use;
+};
+
 /**@brief (User Library) An event is what can be always expected by Blackaddder. Events are sent to applications asynchronously in respect with their initial pub/sub requests.
  *
  * An Event contains the type of the Event, the full identifier of the Scope or Information Item (depending on the Event) and potentially the data (when the Event is PUBLISHED_DATA).
@@ -342,10 +512,12 @@ public:
      */
     Event();
     /**
-     * @brief Destructor: The destructor should delete the buffer. The buffer is not accessed by applications. data is somewhere in this buffer so a free(data) is NOT ALLOWED.
+     * @brief Destructor: The destructor should delete the buffer (or release it to its EventBufferPool). The buffer is not accessed by applications. data is somewhere in this buffer so a free(data) is NOT ALLOWED.
      */
     ~Event();
     /**@brief Copy Constructor: The buffer must be copied so that it can be then freed safely.
+     *
+     * When no memory is available for the buffer the copy is an UNDEF_EVENT without data.
      *
      * @param ev
      */
@@ -391,6 +563,9 @@ public:
     /**@brief a buffer containing all the above.
      */
     void *buffer; /*do not use that...only the destructor uses it to delete the whole buffer once*/
+    /**@brief the EventBufferPool the buffer belongs to, or NULL if the buffer was malloc'ed.
+     */
+    EventBufferPool *pool; /*the destructor releases the buffer to the pool instead of freeing it*/
 };
 
 #ifndef __LINUX_NETLINK_H
@@ -137,6 +137,7 @@ enum ClickMessageTypes {
 	UPDATE_DELIVERY,
 	DISCOVER_FAILURE,
 	UPDATE_UNICAST_DELIVERY,
+	DISCOVER_RECOVERY,
 	START_PUBLISH = 100,
 	STOP_PUBLISH,
 	SCOPE_PUBLISHED,
@@ -16,20 +16,24 @@ NB_Blackadder* NB_Blackadder::m_pInstance = NULL;
 
 fd_set NB_Blackadder::read_set;
 fd_set NB_Blackadder::write_set;
-int NB_Blackadder::pipe_fds[2] = {-1, -1};
+int NB_Blackadder::wakeup_fds[2] = {-1, -1};
 int NB_Blackadder::sock_fd = -1;
+#ifdef __linux__
+int NB_Blackadder::epoll_fd = -1;
+#endif
 
 queue <struct msghdr> NB_Blackadder::output_queue;
 pthread_t NB_Blackadder::selector_thread;
+bool NB_Blackadder::joining = false;
+bool NB_Blackadder::threads_joined = false;
 pthread_mutex_t NB_Blackadder::selector_mutex;
 pthread_cond_t NB_Blackadder::queue_overflow_cond;
 
-queue <Event *> NB_Blackadder::event_queue;
-pthread_t NB_Blackadder::worker_thread;
-pthread_mutex_t NB_Blackadder::worker_mutex;
-pthread_cond_t NB_Blackadder::worker_cond;
+EventWorker *NB_Blackadder::workers = NULL;
+unsigned int NB_Blackadder::number_of_workers = 0;
+
+EventBufferPool *NB_Blackadder::event_pool = NULL;
 
-char NB_Blackadder::pipe_buf[1];
 char NB_Blackadder::fake_buf[1];
 
 #if HAVE_USE_NETLINK
@@ -51,42 +55,288 @@ void defaultCallback(Event *ev) {
     cout << "NB_Blackadder Library: ATTENTION - user did not specify a callback function for handling events...I am falling back to default and just deleting the Event" << endl;
 }
 
+/*the wakeup file descriptors: an eventfd on Linux (both ends are the same descriptor), a pipe elsewhere*/
+static int wakeup_open(int fds[2]) {
+#ifdef __linux__
+    fds[0] = fds[1] = eventfd(0, 0);
+    return (fds[0] < 0) ? -1 : 0;
+#else
+    if (pipe(fds) != 0) {
+        return -1;
+    }
+    /*a signal is never worth blocking for: a full pipe wakes the reader anyway*/
+    return fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL, 0) | O_NONBLOCK);
+#endif
+}
+
+static int wakeup_signal(int fd) {
+#ifdef __linux__
+    uint64_t value = 1;
+#else
+    char value = 0;
+#endif
+    return write(fd, &value, sizeof (value));
+}
+
+static int wakeup_wait(int fd) {
+#ifdef __linux__
+    uint64_t value;
+#else
+    char value;
+#endif
+    return read(fd, &value, sizeof (value));
+}
+
+static void wakeup_close(int fds[2]) {
+    if (fds[0] != -1) {
+        close(fds[0]);
+    }
+    if ((fds[1] != -1) && (fds[1] != fds[0])) {
+        close(fds[1]);
+    }
+    fds[0] = fds[1] = -1;
+}
+
+EventRing::EventRing() {
+    head = 0;
+    tail = 0;
+}
+
+bool EventRing::push(Event *ev) {
+    unsigned int t = tail;
+    if (t - __atomic_load_n(&head, __ATOMIC_ACQUIRE) == EVENT_RING_SIZE) {
+        return false;
+    }
+    events[t & (EVENT_RING_SIZE - 1)] = ev;
+    __atomic_store_n(&tail, t + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+Event *EventRing::pop() {
+    Event *ev;
+    unsigned int h = head;
+    if (h == __atomic_load_n(&tail, __ATOMIC_ACQUIRE)) {
+        return NULL;
+    }
+    ev = events[h & (EVENT_RING_SIZE - 1)];
+    __atomic_store_n(&head, h + 1, __ATOMIC_RELEASE);
+    return ev;
+}
+
+bool EventRing::empty() {
+    return __atomic_load_n(&head, __ATOMIC_ACQUIRE) == __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+}
+
+EventWorker::EventWorker() {
+    wakeup_fds[0] = wakeup_fds[1] = -1;
+    sleeping = 0;
+}
+
 void NB_Blackadder::signal_handler(int sig) {
     (void) signal(SIGINT, SIG_DFL);
     pthread_cancel(selector_thread);
-    pthread_cancel(worker_thread);
+    for (unsigned int i = 0; i < number_of_workers; i++) {
+        pthread_cancel(workers[i].thread);
+    }
 }
 
 void *NB_Blackadder::worker(void *arg) {
+    EventWorker *w = (EventWorker *) arg;
     Event *ev;
     while (true) {
-        pthread_mutex_lock(&worker_mutex);
-        pthread_cond_wait(&worker_cond, &worker_mutex);
-        while (event_queue.size() > 0) {
-            ev = event_queue.front();
-            event_queue.pop();
-            pthread_mutex_unlock(&worker_mutex);
+        while ((ev = w->ring.pop()) != NULL) {
             cf(ev);
-            pthread_mutex_lock(&worker_mutex);
         }
-        pthread_mutex_unlock(&worker_mutex);
+        /*tell the selector thread that this worker will block, then look at the ring again so that an Event pushed in between is not left there*/
+        __atomic_store_n(&w->sleeping, 1, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (w->ring.empty()) {
+            wakeup_wait(w->wakeup_fds[0]);
+        }
+        __atomic_store_n(&w->sleeping, 0, __ATOMIC_RELAXED);
     }
 
     return NULL; /* Not reached unless the while-loop is terminated. */
 }
 
-void *NB_Blackadder::selector(void *arg) {
+Event *NB_Blackadder::receive() {
     struct msghdr msg;
     struct iovec iov;
     int total_buf_size;
     int bytes_read;
     unsigned char id_len;
     unsigned char isubID_len;
+    unsigned char *ptr = NULL;
+    memset(&msg, 0, sizeof (msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    iov.iov_base = fake_buf;
+    iov.iov_len = 1;
+#ifdef __linux__
+    total_buf_size = recvmsg(sock_fd, &msg, MSG_PEEK | MSG_TRUNC);
+#else
+# ifdef __APPLE__
+    socklen_t _option_len = sizeof(total_buf_size);
+    if (recvmsg(sock_fd, &msg, MSG_PEEK) < 0 || getsockopt(sock_fd,
+                                                           SOL_SOCKET, SO_NREAD, &total_buf_size, &_option_len) < 0)
+# else
+    if (recvmsg(sock_fd, &msg, MSG_PEEK) < 0 ||
+        ioctl(sock_fd,FIONREAD, &total_buf_size) < 0)
+# endif
+    {
+        cout << "recvmsg/ioctl: " << errno << endl;
+        total_buf_size = -1;
+    }
+#endif
+    if (total_buf_size <= 0) {
+        //perror("NB_Blackadder Library: did not read ");
+        /*DO NOT call the callback function*/
+        return NULL;
+    }
+    iov.iov_base = event_pool->acquire(total_buf_size);
+    if (iov.iov_base == NULL) {
+        return NULL;
+    }
+    iov.iov_len = total_buf_size;
+    bytes_read = recvmsg(sock_fd, &msg, 0);
+    if (bytes_read < (int) sizeof (struct nlmsghdr)) {
+        EventBufferPool::release(iov.iov_base);
+        return NULL;
+    }
+    Event *ev = new Event();
+    ev->buffer = (char *) iov.iov_base;
+    ev->pool = event_pool;
+    ptr = (unsigned char *)ev->buffer + sizeof(struct nlmsghdr);
+    ev->type = *ptr; ptr += sizeof(ev->type);
+    id_len = *ptr; ptr += sizeof(id_len);
+    ev->id = string((char *)ptr, ((int) id_len) * PURSUIT_ID_LEN);
+    ptr += ((int) id_len) * PURSUIT_ID_LEN;
+    if (ev->type == PUBLISHED_DATA) {
+        ev->data = (void *)ptr;
+        ev->data_len = bytes_read - (ptr - (unsigned char *)ev->buffer);
+    } else if (ev->type == PUBLISHED_DATA_iSUB) {
+        ev->nodeId = string((char *) ptr, NODEID_LEN);
+        ptr += NODEID_LEN;
+        isubID_len = *ptr;
+        ptr += sizeof(isubID_len);
+        ev->isubID = string((char *)ptr, ((int) isubID_len) * PURSUIT_ID_LEN);
+        ptr += ((int) isubID_len) * PURSUIT_ID_LEN;
+        ev->data = (void *)ptr;
+        ev->data_len = bytes_read - (ptr - (unsigned char *)ev->buffer);
+    } else {
+        ev->data = NULL;
+        ev->data_len = 0;
+    }
+    return ev;
+}
+
+void NB_Blackadder::dispatch(Event *ev) {
+    EventWorker *w = &workers[fnv1a_64((const unsigned char *) ev->id.data(), ev->id.length()) % number_of_workers];
+    while (!w->ring.push(ev)) {
+        /*the worker is behind: make sure it runs and let it make room*/
+        wakeup_signal(w->wakeup_fds[1]);
+        sched_yield();
+    }
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&w->sleeping, __ATOMIC_SEQ_CST)) {
+        wakeup_signal(w->wakeup_fds[1]);
+    }
+}
+
+bool NB_Blackadder::send() {
+    struct msghdr msg;
     int ret;
+    bool pending;
+    pthread_mutex_lock(&selector_mutex);
+    while (output_queue.size() > 0) {
+        msg = output_queue.front();
+        ret = sendmsg(sock_fd, &msg, MSG_WAITALL);
+        if (ret <= 0) {
+            //perror("NB_Blackadder Library: could not write!!");
+            break;
+        }
+        output_queue.pop();
+        if (msg.msg_iovlen == 2) {
+            free(msg.msg_iov[0].iov_base);
+            msg.msg_iov[0].iov_base = NULL;
+            free(msg.msg_iov[1].iov_base);
+            msg.msg_iov[1].iov_base = NULL;
+        } else {
+            free(msg.msg_iov->iov_base);
+            msg.msg_iov->iov_base = NULL;
+        }
+        free(msg.msg_iov);
+        msg.msg_iov = NULL;
+    }
+    pending = (output_queue.size() > 0);
+    if (!pending) {
+        /*the destructor and the producers that reached the limit of pending requests wait for this*/
+        pthread_cond_broadcast(&queue_overflow_cond);
+    }
+    pthread_mutex_unlock(&selector_mutex);
+    return pending;
+}
+
+#ifdef __linux__
+
+void *NB_Blackadder::selector(void *arg) {
+    struct epoll_event events[2];
+    struct epoll_event sock_event;
+    Event *ev;
+    int ready;
+    bool writing = false;
+    memset(&sock_event, 0, sizeof (sock_event));
+    sock_event.data.fd = sock_fd;
+    while (true) {
+        ready = epoll_wait(epoll_fd, events, 2, -1);
+        if (ready == -1) {
+            if (errno != EINTR) {
+                perror("NB_Blackadder Library: epoll_wait() error..retrying!");
+            }
+            continue;
+        }
+        for (int i = 0; i < ready; i++) {
+            if (events[i].data.fd == wakeup_fds[0]) {
+                /*that's a control internal message sent in the eventfd: there are requests to send*/
+                wakeup_wait(wakeup_fds[0]);
+                if (!writing) {
+                    writing = true;
+                    sock_event.events = EPOLLIN | EPOLLOUT;
+                    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, sock_fd, &sock_event);
+                }
+                continue;
+            }
+            if (events[i].events & (EPOLLIN | EPOLLERR)) {
+                /*the netlink socket is readable: read a batch of Events, then see if it is writable too*/
+                for (int j = 0; j < EVENT_BATCH_SIZE; j++) {
+                    ev = receive();
+                    if (ev == NULL) {
+                        break;
+                    }
+                    dispatch(ev);
+                }
+            }
+            if (events[i].events & EPOLLOUT) {
+                /*the netlink socket is writable*/
+                if (!send()) {
+                    writing = false;
+                    sock_event.events = EPOLLIN;
+                    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, sock_fd, &sock_event);
+                }
+            }
+        }
+    }
+
+    return NULL; /* Not reached unless the while-loop is terminated. */
+}
+
+#else
+
+void *NB_Blackadder::selector(void *arg) {
     int high_sock;
-    unsigned char *ptr = NULL;
-    if (pipe_fds[0] > sock_fd) {
-        high_sock = pipe_fds[0];
+    Event *ev;
+    if (wakeup_fds[0] > sock_fd) {
+        high_sock = wakeup_fds[0];
     } else {
         high_sock = sock_fd;
     }
@@ -94,124 +344,41 @@ void *NB_Blackadder::selector(void *arg) {
         if (select(high_sock + 1, &read_set, &write_set, NULL, NULL) == -1) {
             perror("NB_Blackadder Library: select() error..retrying!");
         } else {
-            if (FD_ISSET(pipe_fds[0], &read_set)) {
+            if (FD_ISSET(wakeup_fds[0], &read_set)) {
                 /*that's a control internal message sent in the pipe*/
-                ret = read(pipe_fds[0], pipe_buf, 1);
+                wakeup_wait(wakeup_fds[0]);
                 FD_ZERO(&write_set);
                 FD_SET(sock_fd, &write_set);
             }
             if (FD_ISSET(sock_fd, &read_set)) {
                 /*the netlink socket is readable*/
-                memset(&msg, 0, sizeof (msg));
-                msg.msg_iov = &iov;
-                msg.msg_iovlen = 1;
-                iov.iov_base = fake_buf;
-                iov.iov_len = 1;
-#ifdef __linux__
-                total_buf_size = recvmsg(sock_fd, &msg, MSG_PEEK | MSG_TRUNC);
-#else
-# ifdef __APPLE__
-                socklen_t _option_len = sizeof(total_buf_size);
-                if (recvmsg(sock_fd, &msg, MSG_PEEK) < 0 || getsockopt(sock_fd,
-                                                                       SOL_SOCKET, SO_NREAD, &total_buf_size, &_option_len) < 0)
-# else
-                if (recvmsg(sock_fd, &msg, MSG_PEEK) < 0 ||
-                    ioctl(sock_fd,FIONREAD, &total_buf_size) < 0)
-# endif
-                {
-                    cout << "recvmsg/ioctl: " << errno << endl;
-                    total_buf_size = -1;
-                }
-#endif
-                
-                if (total_buf_size > 0) {
-                    iov.iov_base = malloc(total_buf_size);
-                    iov.iov_len = total_buf_size;
-                    bytes_read = recvmsg(sock_fd, &msg, 0);
-                    Event *ev = new Event();
-                    ev->buffer = (char *) iov.iov_base;
-                    ptr = (unsigned char *)ev->buffer + sizeof(struct nlmsghdr);
-                    ev->type = *ptr; ptr += sizeof(ev->type);
-					id_len = *ptr; ptr += sizeof(id_len);
-					ev->id = string((char *)ptr, ((int) id_len) * PURSUIT_ID_LEN);
-					ptr += ((int) id_len) * PURSUIT_ID_LEN;
-					if (ev->type == PUBLISHED_DATA)
-						{
-						ev->data = (void *)ptr;
-						ev->data_len = bytes_read -
-						(ptr - (unsigned char *)ev->buffer);
-						}
-					else if (ev->type == PUBLISHED_DATA_iSUB)
-						{
-						ev->nodeId = string((char *) ptr, NODEID_LEN);
-						ptr += NODEID_LEN;
-						isubID_len = *ptr;
-						ptr += sizeof(isubID_len);
-						ev->isubID = string((char *)ptr, ((int) isubID_len) * PURSUIT_ID_LEN);
-						ptr += ((int) isubID_len) * PURSUIT_ID_LEN;
-						ev->data = (void *)ptr;
-						ev->data_len = bytes_read -
-						(ptr - (unsigned char *)ev->buffer);
-						}
-					else
-						{
-						ev->data = NULL;
-						ev->data_len = 0;
-						}
-					pthread_mutex_lock(&worker_mutex);
-					event_queue.push(ev);
-					pthread_cond_signal(&worker_cond);
-					pthread_mutex_unlock(&worker_mutex);
-
-                } else {
-                    //perror("NB_Blackadder Library: did not read ");
-                    /*DO NOT call the callback function*/
+                ev = receive();
+                if (ev != NULL) {
+                    dispatch(ev);
                 }
             }
             if (FD_ISSET(sock_fd, &write_set)) {
                 /*the netlink socket is writable*/
-                pthread_mutex_lock(&selector_mutex);
-                msg = output_queue.front();
-                ret = sendmsg(sock_fd, &msg, MSG_WAITALL);
-                if (ret > 0) {
-                    output_queue.pop();
-                    if (msg.msg_iovlen == 2) {
-                        free(msg.msg_iov[0].iov_base);
-                        msg.msg_iov[0].iov_base = NULL;
-                        free(msg.msg_iov[1].iov_base);
-                        msg.msg_iov[1].iov_base = NULL;
-                    } else {
-                        free(msg.msg_iov->iov_base);
-                        msg.msg_iov->iov_base = NULL;
-                    }
-                    free(msg.msg_iov);
-                    msg.msg_iov = NULL;
-                }
-                //                else {
-                //                    perror("NB_Blackadder Library: could not write!!");
-                //                }
                 FD_ZERO(&write_set);
-                if (output_queue.size() > 0) {
-                    FD_ZERO(&write_set);
+                if (send()) {
                     FD_SET(sock_fd, &write_set);
-                } else {
-                    FD_ZERO(&write_set);
-                    pthread_cond_signal(&queue_overflow_cond);
                 }
-                pthread_mutex_unlock(&selector_mutex);
             }
-            FD_ZERO(&read_set);
-            FD_SET(sock_fd, &read_set);
-            FD_SET(pipe_fds[0], &read_set);
         }
+        FD_ZERO(&read_set);
+        FD_SET(sock_fd, &read_set);
+        FD_SET(wakeup_fds[0], &read_set);
     }
     
     return NULL; /* Not reached unless the while-loop is terminated. */
 }
 
-NB_Blackadder::NB_Blackadder(bool user_space) {
+#endif
+
+NB_Blackadder::NB_Blackadder(bool user_space, unsigned int worker_count) {
     int ret;
     (void) signal(SIGINT, signal_handler);
+    event_pool = new EventBufferPool();
     if (user_space) {
         //cout << "NB_Blackadder Library: Initializing blackadder client for user space" << endl;
 #if HAVE_USE_NETLINK
@@ -296,22 +463,42 @@ NB_Blackadder::NB_Blackadder(bool user_space) {
         ba_id2path(d_nladdr.sun_path, (user_space) ? PID_BLACKADDER : 0);
     }
 #endif
-    /*initialize pipes*/
-    if (pipe(pipe_fds) != 0) {
-        perror("pipe");
+    /*initialize the wakeup file descriptors*/
+    if (wakeup_open(wakeup_fds) != 0) {
+        perror("NB_Blackadder Library: wakeup");
         /* XXX: Should we raise an exception or something? */
     }
+#ifdef __linux__
+    struct epoll_event event;
+    epoll_fd = epoll_create1(0);
+    if (epoll_fd < 0) {
+        perror("NB_Blackadder Library: epoll_create1");
+    }
+    memset(&event, 0, sizeof (event));
+    event.events = EPOLLIN;
+    event.data.fd = sock_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sock_fd, &event);
+    event.data.fd = wakeup_fds[0];
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup_fds[0], &event);
+#else
     FD_ZERO(&read_set);
     FD_SET(sock_fd, &read_set);
-    FD_SET(pipe_fds[0], &read_set);
+    FD_SET(wakeup_fds[0], &read_set);
+    FD_ZERO(&write_set);
+#endif
     /*register default callback method*/
     cf = &defaultCallback;
     pthread_mutex_init(&selector_mutex, NULL);
-    pthread_mutex_init(&worker_mutex, NULL);
     pthread_cond_init(&queue_overflow_cond, NULL);
-    pthread_cond_init(&worker_cond, NULL);
+    number_of_workers = (worker_count > 0) ? worker_count : 1;
+    workers = new EventWorker[number_of_workers];
+    for (unsigned int i = 0; i < number_of_workers; i++) {
+        if (wakeup_open(workers[i].wakeup_fds) != 0) {
+            perror("NB_Blackadder Library: worker wakeup");
+        }
+        pthread_create(&workers[i].thread, NULL, worker, &workers[i]);
+    }
     pthread_create(&selector_thread, NULL, selector, NULL);
-    pthread_create(&worker_thread, NULL, worker, NULL);
 }
 
 NB_Blackadder::~NB_Blackadder() {
@@ -321,8 +508,27 @@ NB_Blackadder::~NB_Blackadder() {
         pthread_cond_wait(&queue_overflow_cond, &selector_mutex);
     }
     pthread_mutex_unlock(&selector_mutex);
-    pthread_cancel(worker_thread);
+    for (unsigned int i = 0; i < number_of_workers; i++) {
+        pthread_cancel(workers[i].thread);
+    }
     pthread_cancel(selector_thread);
+    /*the threads must be gone before the descriptors they block on and the rings they read are freed.
+     *When the application deletes the instance while it waits in join (e.g. from a signal handler), they are left to the exit*/
+    if (!joining) {
+        join();
+    }
+    if (threads_joined) {
+        for (unsigned int i = 0; i < number_of_workers; i++) {
+            Event *ev;
+            while ((ev = workers[i].ring.pop()) != NULL) {
+                delete ev;
+            }
+            wakeup_close(workers[i].wakeup_fds);
+        }
+        delete [] workers;
+        workers = NULL;
+        number_of_workers = 0;
+    }
     if (sock_fd != -1) {
         close(sock_fd);
         cout << "NB_Blackadder Library: Closed netlink socket" << endl;
@@ -330,22 +536,36 @@ NB_Blackadder::~NB_Blackadder() {
         unlink(s_nladdr.sun_path);
 #endif
     }
-    for (int i = 0; i < (sizeof(pipe_fds)/sizeof(pipe_fds[0])); ++i) {
-        if (pipe_fds[i] != -1)
-            close(pipe_fds[i]);
+    wakeup_close(wakeup_fds);
+#ifdef __linux__
+    if (epoll_fd != -1) {
+        close(epoll_fd);
+        epoll_fd = -1;
     }
+#endif
+    /*Events still alive keep the pool until they are deleted*/
+    event_pool->unref();
+    event_pool = NULL;
 }
 
 NB_Blackadder* NB_Blackadder::Instance(bool user_space) {
+    return Instance(user_space, 1);
+}
+
+NB_Blackadder* NB_Blackadder::Instance(bool user_space, unsigned int worker_count) {
     if (!m_pInstance) {
-        m_pInstance = new NB_Blackadder(user_space);
+        m_pInstance = new NB_Blackadder(user_space, worker_count);
     }
     return m_pInstance;
 }
 
 void NB_Blackadder::join() {
+    joining = true;
     pthread_join(selector_thread, NULL);
-    pthread_join(worker_thread, NULL);
+    for (unsigned int i = 0; i < number_of_workers; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+    threads_joined = true;
 }
 
 void NB_Blackadder::setCallback(callbacktype function) {
@@ -509,7 +729,7 @@ void NB_Blackadder::push(unsigned char type, const string &id, const string &pre
     pthread_mutex_lock(&selector_mutex);
     output_queue.push(msg);
     if (output_queue.size() == 1) {
-        ret = write(pipe_fds[1], pipe_buf, 1);
+        ret = wakeup_signal(wakeup_fds[1]);
     }
     if (output_queue.size() == 1000) {
         pthread_cond_wait(&queue_overflow_cond, &selector_mutex);
@@ -565,7 +785,7 @@ void NB_Blackadder::publish_data(const string &id, unsigned char strategy, void
     pthread_mutex_lock(&selector_mutex);
     output_queue.push(msg);
     if (output_queue.size() == 1) {
-        ret = write(pipe_fds[1], pipe_buf, 1);
+        ret = wakeup_signal(wakeup_fds[1]);
     }
     if (output_queue.size() == 1000) {
         pthread_cond_wait(&queue_overflow_cond, &selector_mutex);
@@ -665,7 +885,7 @@ bool NB_Blackadder::publish_data(const string &id,
     pthread_mutex_lock(&selector_mutex);
     output_queue.push(msg);
     if (output_queue.size() == 1) {
-        ret = write(pipe_fds[1], pipe_buf, 1);
+        ret = wakeup_signal(wakeup_fds[1]);
         if (ret < 0)
         {
             return false;
@@ -766,7 +986,7 @@ bool NB_Blackadder::publish_data_isub(const string &id,
     pthread_mutex_lock(&selector_mutex);
     output_queue.push(msg);
     if (output_queue.size() == 1) {
-        ret = write(pipe_fds[1], pipe_buf, 1);
+        ret = wakeup_signal(wakeup_fds[1]);
         if (ret < 0)
         {
             return false;
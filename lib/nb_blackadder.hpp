@@ -23,23 +23,96 @@
 #include <signal.h>
 #include <queue>
 #include <fcntl.h>
+#include <sched.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
 
 class Event;
 
+/**@relates NB_Blackadder
+ * @brief the number of Events a ring between the selector thread and a worker thread can hold. It must be a power of 2.
+ */
+#define EVENT_RING_SIZE 4096
+
+/**@relates NB_Blackadder
+ * @brief the maximum number of Events the selector thread reads from the socket before it checks for pending requests again.
+ */
+#define EVENT_BATCH_SIZE 64
+
 /**@relates NB_Blackadder
  * @brief a type definition for the pointer to the callback method.
  */
 typedef void (*callbacktype)(Event *);
 
+/**@brief (User Library) A lock-free single-producer/single-consumer ring of Events, from the selector thread of NB_Blackadder to one of its worker threads.
+ *
+ * Only the selector thread calls push() and only the worker thread calls pop(), so head and tail are just published with atomic stores (they are kept on different cache lines).
+ */
+class EventRing {
+public:
+    /**@brief Constructor: the ring is empty.
+     */
+    EventRing();
+    /**@brief (selector thread) appends an Event to the ring.
+     *
+     * @param ev the Event.
+     * @return false if the ring is full.
+     */
+    bool push(Event *ev);
+    /**@brief (worker thread) removes the oldest Event from the ring.
+     *
+     * @return the Event or NULL if the ring is empty.
+     */
+    Event *pop();
+    /**@brief returns true if the ring is empty.
+     */
+    bool empty();
+private:
+    Event *events[EVENT_RING_SIZE];
+    /**@brief the number of Events popped so far (written by the worker thread).
+     */
+    unsigned int head;
+    char head_pad[64 - sizeof (unsigned int)];
+    /**@brief the number of Events pushed so far (written by the selector thread).
+     */
+    unsigned int tail;
+    char tail_pad[64 - sizeof (unsigned int)];
+};
+
+/**@brief (User Library) A worker thread of NB_Blackadder: the thread, the ring it takes the Events from and the file descriptors the selector thread uses to wake it up.
+ */
+class EventWorker {
+public:
+    /**@brief Constructor: it does not start the thread.
+     */
+    EventWorker();
+    /**@brief the worker thread.
+     */
+    pthread_t thread;
+    /**@brief the Events the selector thread assigned to this worker.
+     */
+    EventRing ring;
+    /**@brief the eventfd (Linux) or the pipe the worker blocks on when its ring is empty.
+     */
+    int wakeup_fds[2];
+    /**@brief 1 when the worker found its ring empty and is about to block, so that the selector thread wakes it up.
+     */
+    int sleeping;
+};
+
 /**@brief (User Library) This is the wrapper class that makes the service model available to all applications in a Non-Blocking manner. 
  * 
  * Blackadder expects requests to be sent in its netlink socket. Therefore the wrapper class just exports some human-friendly methods for creating service model compliant buffers that are asynchronously sent to Blackadder.
  * NB_Blackadder implements the Singleton Pattern. A single NB_Blackadder object can be created by a single process using the <b>public</b> Instance method. The Constructor is <b>protected</b>.
  * 
- * NB_Blackadder uses two threads. A selector thread reads events when the netlink socket is readable and passes them to the worker thread. 
- * In the context of the worker thread, the callback method that <b>must be provided by the applications</b> is called with a reference to the received Event.
+ * NB_Blackadder uses a selector thread and one or more worker threads. The selector thread reads events when the netlink socket is readable and passes them to the worker threads. 
+ * In the context of a worker thread, the callback method that <b>must be provided by the applications</b> is called with a reference to the received Event.
+ * Each worker thread has its own lock-free EventRing. Events are assigned to a worker by the hash of their identifier, so the Events of an identifier are processed in order, by the same worker.
+ * With more than one worker (see Instance) the callback method is called concurrently for different identifiers and must be thread-safe.
  * 
- * The selector thread is also notified (using a pipe) to register the netlink socket for write when requests are to be forwarded to Blackadder.
+ * The selector thread waits in epoll (select() on systems other than Linux). It is also notified (using an eventfd, or a pipe) to register the netlink socket for write when requests are to be forwarded to Blackadder.
  * 
  * @note All service request related methods enforce some rules regarding the size of the identifiers so that Blackadder is not confused.
  */
@@ -57,6 +130,14 @@ public:
      * @return 
      */
     static NB_Blackadder* Instance(bool user_space);
+    /**@brief as Instance(bool), but the NB_Blackadder object calls the callback method from the given number of worker threads.
+     *
+     * The Events of an identifier are always passed to the same worker thread. The number of workers is only used the first time Instance is called.
+     * @param user_space as in Instance(bool).
+     * @param worker_count the number of worker threads (at least 1).
+     * @return
+     */
+    static NB_Blackadder* Instance(bool user_space, unsigned int worker_count);
     /**@brief this method will send a PUBLISH_SCOPE request to Blackadder. <b>It won't block. Instead the request buffer will be put in a queue and the selector thread will be notified to send the request to Blackadder.</b>
      * 
      * If prefix_id is an empty string, the request is about a root scope.
@@ -272,7 +353,7 @@ public:
     static void *selector(void *arg);
     /**@brief The worker thread execution method.
      * 
-     * @param arg
+     * @param arg the EventWorker of the thread.
      */
     static void *worker(void *arg);
     /**@brief the signal handler.
@@ -283,69 +364,91 @@ public:
     static void signal_handler(int sig);
     /**@brief This method MUST be called by the application so that the main function will not end before the NB_Blackadder threads end.
      * 
-     * it calls pthread_join for the worker and selector threads.
+     * it calls pthread_join for the worker threads and the selector thread.
      */
     void join();
     /**@brief The selector Thread (see details).
      * 
-     * The selector thread always blocks to the select() method. If the netlink socket is only registered for reading, select() unblocks only when an Event is sent by Blackadder.
-     * When a request is ready to be sent to Blackadder, a dummy message is sent to the pipe in which the selector thread always includes it in the reading fd_set. AT that point the netlink socket is also registered for writing.
-     * When the socket will unblock again it will send the message to Blackadder.
+     * The selector thread always blocks in epoll_wait() (select() on systems other than Linux). If the netlink socket is only registered for reading, it unblocks only when an Event is sent by Blackadder.
+     * When a request is ready to be sent to Blackadder, the eventfd (or pipe) wakeup_fds, which is always registered for reading, is signaled. AT that point the netlink socket is also registered for writing.
+     * When the socket will unblock again it will send the queued messages to Blackadder.
      */
     static pthread_t selector_thread;
+    /**@brief true once join has been called, so that the destructor does not join the threads a second time.
+     */
+    static bool joining;
+    /**@brief true once join has joined the selector and worker threads, only then the destructor frees the workers.
+     */
+    static bool threads_joined;
     /**@brief a mutex used to synchronize NB_Blackadder threads.
      */
     static pthread_mutex_t selector_mutex;
     /**@brief this condition is used for putting a limit to the pending requests.
      */
     static pthread_cond_t queue_overflow_cond;
-    /**@brief the worker thread (see details).
+    /**@brief the worker threads (see details).
      * 
-     * The worker thread always blocks in the worker_cond. The selector thread signals that condition whenever a new event from Blackadder was read.
-     * The worker thread unblocks, reads the event from the event_queue and calls the application-defined callback method.
+     * A worker thread blocks in its wakeup_fds when its EventRing is empty. The selector thread signals them when it pushes an Event to the ring of a sleeping worker.
+     * The worker thread unblocks, pops the Events from its ring and calls the application-defined callback method for each one.
      */
-    static pthread_t worker_thread;
-    /**@brief a mutex used to synchronize NB_Blackadder threads.
+    static EventWorker *workers;
+    /**@brief the number of worker threads.
      */
-    static pthread_mutex_t worker_mutex;
-    /**@brief the condition for which the worker thread constantly waits. It is only signaled by the selector thread.
+    static unsigned int number_of_workers;
+#ifdef __linux__
+    /**@brief the epoll instance of the selector thread. Only the netlink socket sock_fd and the eventfd wakeup_fds are registered.
      */
-    static pthread_cond_t worker_cond;
-    /**@brief the set of file descriptions that are registered for reading. Only the netlink socket sock_fd and the pipefds are used.
+    static int epoll_fd;
+#endif
+    /**@brief the set of file descriptions that are registered for reading (not on Linux). Only the netlink socket sock_fd and the pipe wakeup_fds are used.
      */
     static fd_set read_set;
-    /**@brief the set of file descriptions that are registered for writing. Only the netlink socket sock_fd and the pipefds are used.
+    /**@brief the set of file descriptions that are registered for writing (not on Linux). Only the netlink socket sock_fd and the pipe wakeup_fds are used.
      */
     static fd_set write_set;
-    /**@brief the file descriptors of the bidirectional pipe.
+    /**@brief the file descriptors that wake up the selector thread: an eventfd (both are the same) on Linux, a pipe elsewhere.
      */
-    static int pipe_fds[2];
+    static int wakeup_fds[2];
     /**@brief the netlink socket file descriptor.
      */
     static int sock_fd;
     /**@brief the queue where all service model related methods put their messages that are later sent to Blackadder by the selector thread.
      */
     static queue <struct msghdr> output_queue;
-    /**@brief the queue where the selector thread puts all Events sent by Blackadder that are later processed by the worker thread.
-     */
-    static queue <Event *> event_queue;
-    /**@brief a dummy buffer for getting a dummy message from the pipe and interrupting the select() call.
-     */
-    static char pipe_buf[1];
     /**@brief a dummy buffer for peeking to the actual netlink buffers.
      */
     static char fake_buf[1];
+    /**@brief the pool the buffers of the received Events are taken from.
+     */
+    static EventBufferPool *event_pool;
     /**@brief the Callback function registered with NB_Blackadder. The user must override the default by calling the setCallback() method.
      */
     static callbacktype cf;
 
 protected:
-    /**@brief Constructor: It initiates the netlink socket appropriately. It initiates all mutexes and condition variables and starts the worker and selector threads.
+    /**@brief Constructor: It initiates the netlink socket appropriately. It initiates all mutexes and condition variables and starts the worker threads and the selector thread.
      * 
      * @param user_space
+     * @param worker_count the number of worker threads.
      */
-    NB_Blackadder(bool user_space);
+    NB_Blackadder(bool user_space, unsigned int worker_count);
 private:
+    /**@brief (selector thread) reads an Event from the netlink socket.
+     *
+     * @return the Event or NULL if nothing could be read.
+     */
+    static Event *receive();
+    /**@brief (selector thread) passes an Event to the worker thread its identifier is hashed to, and wakes that worker up if it sleeps.
+     *
+     * If the ring of the worker is full, the selector thread yields until the worker makes room.
+     * @param ev the Event.
+     */
+    static void dispatch(Event *ev);
+    /**@brief (selector thread) sends the queued requests to Blackadder until the socket would block.
+     *
+     * @return true if requests are still queued.
+     */
+    static bool send();
     /**brief push a message in the queue and notify selector thread to send it to Blackadder.
      * 
      * @param type as passed by a request method.
@@ -21,6 +21,178 @@ ActivePublication::ActivePublication(String _fullID, unsigned char _strategy, bo
 ActivePublication::~ActivePublication() {
 }
 
+void *ActivePublication::operator new(size_t size) {
+    if (size != sizeof (ActivePublication)) {
+        return ::operator new(size);
+    }
+    return ActivePublicationSlab::allocate();
+}
+
+void ActivePublication::operator delete(void *p, size_t size) {
+    if (p == NULL) {
+        return;
+    }
+    if (size != sizeof (ActivePublication)) {
+        ::operator delete(p);
+        return;
+    }
+    ActivePublicationSlab::release(p);
+}
+
+ActivePublicationSlab::FreeBlock *ActivePublicationSlab::_free = NULL;
+
+void *ActivePublicationSlab::allocate() {
+    FreeBlock *block;
+    if (_free == NULL) {
+        /*carve a new chunk into blocks, a block is at least as large as a FreeBlock*/
+        size_t blockSize = sizeof (ActivePublication) > sizeof (FreeBlock) ? sizeof (ActivePublication) : sizeof (FreeBlock);
+        char *chunk = new char[ACTIVE_PUBLICATION_SLAB_SIZE * blockSize];
+        for (int i = ACTIVE_PUBLICATION_SLAB_SIZE - 1; i >= 0; i--) {
+            release(chunk + i * blockSize);
+        }
+    }
+    block = _free;
+    _free = block->next;
+    return block;
+}
+
+void ActivePublicationSlab::release(void *block) {
+    FreeBlock *freeBlock = (FreeBlock *) block;
+    freeBlock->next = _free;
+    _free = freeBlock;
+}
+
+ActivePublicationIndex::ActivePublicationIndex() {
+    _capacity = 64;
+    _size = 0;
+    _slots = new Slot[_capacity];
+    for (uint32_t i = 0; i < _capacity; i++) {
+        _slots[i].hash = 0;
+        _slots[i].second = NULL;
+    }
+}
+
+ActivePublicationIndex::~ActivePublicationIndex() {
+    delete [] _slots;
+}
+
+uint32_t ActivePublicationIndex::hashID(const String &ID) {
+    const char *data = ID.data();
+    int length = ID.length();
+    int i = 0;
+    uint64_t word;
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ (uint64_t) length;
+    /*identifiers are made of fragments of PURSUIT_ID_LEN (8) bytes, mix one fragment at a time*/
+    for (; i + (int) sizeof (word) <= length; i += sizeof (word)) {
+        memcpy(&word, data + i, sizeof (word));
+        h = (h ^ word) * 0xff51afd7ed558ccdULL;
+        h ^= h >> 32;
+    }
+    for (; i < length; i++) {
+        h = (h ^ (unsigned char) data[i]) * 0x100000001b3ULL;
+    }
+    h ^= h >> 29;
+    uint32_t hash = (uint32_t) (h ^ (h >> 32));
+    /*a zero hash marks an empty slot*/
+    return (hash == 0) ? 1 : hash;
+}
+
+void ActivePublicationIndex::set(const String &ID, ActivePublication *ap) {
+    uint32_t hash = hashID(ID);
+    int slot = find(ID, hash);
+    if (slot >= 0) {
+        _slots[slot].second = ap;
+        return;
+    }
+    if ((uint32_t) (_size + 1) * 8 > _capacity * 7) {
+        grow();
+    }
+    insert(hash, ID, ap);
+}
+
+void ActivePublicationIndex::insert(uint32_t hash, const String &ID, ActivePublication *ap) {
+    uint32_t mask = _capacity - 1;
+    uint32_t pos = hash & mask;
+    uint32_t dist = 0;
+    String key = ID;
+    while (true) {
+        Slot &slot = _slots[pos];
+        if (slot.hash == 0) {
+            slot.hash = hash;
+            slot.first = key;
+            slot.second = ap;
+            _size++;
+            return;
+        }
+        /*Robin Hood: the entry that is further from its home slot takes the slot, the other one moves on*/
+        uint32_t slotDist = (pos - slot.hash) & mask;
+        if (slotDist < dist) {
+            uint32_t tempHash = slot.hash;
+            String tempKey = slot.first;
+            ActivePublication *tempAP = slot.second;
+            slot.hash = hash;
+            slot.first = key;
+            slot.second = ap;
+            hash = tempHash;
+            key = tempKey;
+            ap = tempAP;
+            dist = slotDist;
+        }
+        pos = (pos + 1) & mask;
+        dist++;
+    }
+}
+
+bool ActivePublicationIndex::erase(const String &ID) {
+    int slot = find(ID, hashID(ID));
+    if (slot < 0) {
+        return false;
+    }
+    uint32_t mask = _capacity - 1;
+    uint32_t pos = slot;
+    uint32_t next = (pos + 1) & mask;
+    /*backward shift: the following entries that are not in their home slot move one slot back*/
+    while ((_slots[next].hash != 0) && (((next - _slots[next].hash) & mask) != 0)) {
+        _slots[pos].hash = _slots[next].hash;
+        _slots[pos].first = _slots[next].first;
+        _slots[pos].second = _slots[next].second;
+        pos = next;
+        next = (next + 1) & mask;
+    }
+    _slots[pos].hash = 0;
+    _slots[pos].first = String();
+    _slots[pos].second = NULL;
+    _size--;
+    return true;
+}
+
+void ActivePublicationIndex::clear() {
+    for (uint32_t i = 0; i < _capacity; i++) {
+        _slots[i].hash = 0;
+        _slots[i].first = String();
+        _slots[i].second = NULL;
+    }
+    _size = 0;
+}
+
+void ActivePublicationIndex::grow() {
+    Slot *oldSlots = _slots;
+    uint32_t oldCapacity = _capacity;
+    _capacity = 2 * oldCapacity;
+    _size = 0;
+    _slots = new Slot[_capacity];
+    for (uint32_t i = 0; i < _capacity; i++) {
+        _slots[i].hash = 0;
+        _slots[i].second = NULL;
+    }
+    for (uint32_t i = 0; i < oldCapacity; i++) {
+        if (oldSlots[i].hash != 0) {
+            insert(oldSlots[i].hash, oldSlots[i].first, oldSlots[i].second);
+        }
+    }
+    delete [] oldSlots;
+}
+
 ActiveSubscription::ActiveSubscription(String _fullID, unsigned char _strategy, bool _isScope) {
     fullID = _fullID;
     strategy = _strategy;
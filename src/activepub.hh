@@ -15,6 +15,9 @@
 #include "common.hh"
 #include <click/vector.hh>
 
+/*the number of ActivePublication objects in each chunk of the slab*/
+#define ACTIVE_PUBLICATION_SLAB_SIZE 256
+
 CLICK_DECLS
 
 class LocalHost;
@@ -40,6 +43,12 @@ public:
      * @brief Destructor: there is nothing dynamically allocated so it is the default destructor
      */
     ~ActivePublication();
+    /**@brief ActivePublication objects are allocated from a slab (see ActivePublicationSlab) rather than one by one from the heap.
+     */
+    static void *operator new(size_t size);
+    /**@brief returns the object to the slab.
+     */
+    static void operator delete(void *p, size_t size);
     /** @brief The identifier of the scope or information item starting from the root of the information graph
      */
     String fullID;
@@ -72,6 +81,142 @@ public:
     bool isScope;
 };
 
+/**
+ * @brief (Blackadder Core) ActivePublicationSlab hands out ActivePublication-sized blocks carved from chunks of ACTIVE_PUBLICATION_SLAB_SIZE objects.
+ *
+ * Freed blocks are kept in a free list and reused, so that publishing and unpublishing items does not go through the heap and the objects stay close to each other in memory.
+ * The chunks are only released when Blackadder exits.
+ */
+class ActivePublicationSlab {
+public:
+    /**@brief a free block, the free list is stored in the blocks themselves.
+     */
+    struct FreeBlock {
+        FreeBlock *next;
+    };
+    /**@brief returns a block of sizeof(ActivePublication) bytes, from the free list or from a new chunk.
+     */
+    static void *allocate();
+    /**@brief puts a block back in the free list.
+     */
+    static void release(void *block);
+private:
+    static FreeBlock *_free;
+};
+
+/**
+ * @brief (Blackadder Core) ActivePublicationIndex maps full identifiers to ActivePublication objects. It replaces a Click's HashTable in the LocalProxy, which looks it up for every user publication.
+ *
+ * It is an open-addressing table with Robin Hood probing and backward shift deletion, whose slots are stored in a single array.
+ * Each slot caches the hash of its identifier, so that a lookup compares identifiers only when their hashes match and never follows a chain of allocated nodes.
+ * The hash reads the identifier a fragment (PURSUIT_ID_LEN bytes) at a time.
+ * The table grows when it is 7/8 full.
+ *
+ * Its interface is the part of the HashTable one used by the LocalProxy: get(), set(), erase(), size() and an iterator over (first, second) pairs.
+ * Erasing an entry moves other entries, so an index must not be modified while iterating over it.
+ */
+class ActivePublicationIndex {
+public:
+    /**@brief a slot of the table. An empty slot has a zero hash.
+     */
+    struct Slot {
+        uint32_t hash;
+        String first;
+        ActivePublication *second;
+    };
+    /**@brief an iterator over the occupied slots.
+     */
+    class iterator {
+    public:
+        iterator(Slot *slot, Slot *end) : _slot(slot), _end(end) {
+            skip();
+        }
+        Slot &operator*() const {return *_slot;}
+        Slot *operator->() const {return _slot;}
+        iterator &operator++() {
+            _slot++;
+            skip();
+            return *this;
+        }
+        void operator++(int) {++(*this);}
+        bool operator==(const iterator &other) const {return _slot == other._slot;}
+        bool operator!=(const iterator &other) const {return _slot != other._slot;}
+    private:
+        void skip() {
+            while ((_slot != _end) && (_slot->hash == 0)) {
+                _slot++;
+            }
+        }
+        Slot *_slot;
+        Slot *_end;
+    };
+    ActivePublicationIndex();
+    ~ActivePublicationIndex();
+    /**@brief the ActivePublication known with this identifier, or default_value() (NULL).
+     */
+    ActivePublication *get(const String &ID) const {
+        int slot = find(ID, hashID(ID));
+        return (slot < 0) ? NULL : _slots[slot].second;
+    }
+    /**@brief the value returned by get() for an unknown identifier.
+     */
+    ActivePublication *default_value() const {return NULL;}
+    /**@brief maps an identifier to an ActivePublication, replacing any previous mapping.
+     */
+    void set(const String &ID, ActivePublication *ap);
+    /**@brief removes an identifier.
+     * @return true if the identifier was in the index
+     */
+    bool erase(const String &ID);
+    /**@brief removes all identifiers (the ActivePublication objects are not deleted).
+     */
+    void clear();
+    /**@brief the number of identifiers in the index.
+     */
+    int size() const {return _size;}
+    iterator begin() {return iterator(_slots, _slots + _capacity);}
+    iterator end() {return iterator(_slots + _capacity, _slots + _capacity);}
+    /**@brief the hash of an identifier, never zero.
+     */
+    static uint32_t hashID(const String &ID);
+private:
+    /**@brief the slot of an identifier, or -1.
+     */
+    int find(const String &ID, uint32_t hash) const {
+        uint32_t mask = _capacity - 1;
+        uint32_t pos = hash & mask;
+        for (uint32_t dist = 0; ; dist++) {
+            const Slot &slot = _slots[pos];
+            /*an empty slot, or an entry closer to its home than the identifier would be: the identifier is not in the table*/
+            if ((slot.hash == 0) || (((pos - slot.hash) & mask) < dist)) {
+                return -1;
+            }
+            if ((slot.hash == hash) && (slot.first == ID)) {
+                return pos;
+            }
+            pos = (pos + 1) & mask;
+        }
+    }
+    /**@brief inserts an identifier known not to be in the table.
+     */
+    void insert(uint32_t hash, const String &ID, ActivePublication *ap);
+    /**@brief doubles the number of slots.
+     */
+    void grow();
+    Slot *_slots;
+    /**@brief the number of slots, a power of 2.
+     */
+    uint32_t _capacity;
+    int _size;
+};
+
+/** @brief The index of ActivePublication objects used by the LocalProxy.
+ */
+typedef ActivePublicationIndex ActivePub;
+/** @brief An iterator over the index of ActivePublication objects.
+ */
+typedef ActivePublicationIndex::iterator ActivePubIter;
+
 /**
  * @brief (Blackadder Core) ActiveSubscription represents an active subscription of an application or click element or another Linux module.
  * 
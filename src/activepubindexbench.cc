@@ -0,0 +1,136 @@
+/*
+ * This file is part of Blackadder.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+#include "activepubindexbench.hh"
+
+#include <click/timestamp.hh>
+
+CLICK_DECLS
+
+ActivePublicationIndexBench::ActivePublicationIndexBench() {
+	number_of_ids = 1000000;
+	for (int i = 0; i < 6; i++) {
+		mops[i] = 0;
+	}
+}
+
+ActivePublicationIndexBench::~ActivePublicationIndexBench() {
+	click_chatter("ActivePublicationIndexBench: destroyed!");
+}
+
+int ActivePublicationIndexBench::configure(Vector<String> &conf, ErrorHandler *errh) {
+	if (conf.size() > 0) {
+		cp_integer(conf[0], &number_of_ids);
+	}
+	if (number_of_ids < 1) {
+		return errh->error("ActivePublicationIndexBench: the number of identifiers must be positive");
+	}
+	return 0;
+}
+
+static double
+mops_since(Timestamp &start, int operations)
+{
+	double elapsed = (Timestamp::now() - start).doubleval();
+	return (elapsed > 0) ? operations / elapsed / 1000000 : 0;
+}
+
+int ActivePublicationIndexBench::initialize(ErrorHandler */*errh*/) {
+	Vector<String> IDs;
+	char ID[2 * PURSUIT_ID_LEN];
+	unsigned int found = 0;
+	Timestamp start;
+	HashTable<String, ActivePublication *> hashTable;
+	ActivePublicationIndex index;
+	/*the identifiers are /SCOPE/ITEM, the item being the index (big endian)*/
+	memset(ID, 0xAB, PURSUIT_ID_LEN);
+	memset(ID + PURSUIT_ID_LEN, 0, PURSUIT_ID_LEN);
+	for (int i = 0; i < number_of_ids; i++) {
+		ID[2 * PURSUIT_ID_LEN - 4] = (char) (i >> 24);
+		ID[2 * PURSUIT_ID_LEN - 3] = (char) (i >> 16);
+		ID[2 * PURSUIT_ID_LEN - 2] = (char) (i >> 8);
+		ID[2 * PURSUIT_ID_LEN - 1] = (char) i;
+		IDs.push_back(String(ID, 2 * PURSUIT_ID_LEN));
+	}
+	/*the Click's HashTable, with ActivePublication objects from the heap*/
+	start = Timestamp::now();
+	for (int i = 0; i < number_of_ids; i++) {
+		hashTable.set(IDs[i], ::new ActivePublication(IDs[i], DOMAIN_LOCAL, false));
+	}
+	mops[0] = mops_since(start, number_of_ids);
+	start = Timestamp::now();
+	for (int i = 0; i < number_of_ids; i++) {
+		if (hashTable.get(IDs[i]) != hashTable.default_value()) {
+			found++;
+		}
+	}
+	mops[1] = mops_since(start, number_of_ids);
+	start = Timestamp::now();
+	for (int i = 0; i < number_of_ids; i++) {
+		ActivePublication *ap = hashTable.get(IDs[i]);
+		hashTable.erase(IDs[i]);
+		ap->~ActivePublication();
+		::operator delete(ap);
+	}
+	mops[2] = mops_since(start, number_of_ids);
+	/*the ActivePublicationIndex, with ActivePublication objects from the slab*/
+	start = Timestamp::now();
+	for (int i = 0; i < number_of_ids; i++) {
+		index.set(IDs[i], new ActivePublication(IDs[i], DOMAIN_LOCAL, false));
+	}
+	mops[3] = mops_since(start, number_of_ids);
+	start = Timestamp::now();
+	for (int i = 0; i < number_of_ids; i++) {
+		if (index.get(IDs[i]) != index.default_value()) {
+			found++;
+		}
+	}
+	mops[4] = mops_since(start, number_of_ids);
+	start = Timestamp::now();
+	for (int i = 0; i < number_of_ids; i++) {
+		ActivePublication *ap = index.get(IDs[i]);
+		index.erase(IDs[i]);
+		delete ap;
+	}
+	mops[5] = mops_since(start, number_of_ids);
+	if (found != 2 * (unsigned int) number_of_ids) {
+		click_chatter("ActivePublicationIndexBench: %u of %d identifiers found", found, 2 * number_of_ids);
+	}
+	click_chatter("ActivePublicationIndexBench: %d identifiers, Mops/s insert/lookup/erase: HashTable %.2f/%.2f/%.2f, ActivePublicationIndex %.2f/%.2f/%.2f",
+			number_of_ids, mops[0], mops[1], mops[2], mops[3], mops[4], mops[5]);
+	return 0;
+}
+
+enum { H_HASHTABLE_INSERT, H_HASHTABLE_LOOKUP, H_HASHTABLE_ERASE, H_INDEX_INSERT, H_INDEX_LOOKUP, H_INDEX_ERASE };
+
+static String
+ActivePublicationIndexBench_read_handler(Element *e, void *thunk)
+{
+	ActivePublicationIndexBench *bench = (ActivePublicationIndexBench *)e;
+	return String(bench->mops[(intptr_t) thunk]);
+}
+
+void ActivePublicationIndexBench::add_handlers() {
+	add_read_handler("hashtable_insert", ActivePublicationIndexBench_read_handler, H_HASHTABLE_INSERT);
+	add_read_handler("hashtable_lookup", ActivePublicationIndexBench_read_handler, H_HASHTABLE_LOOKUP);
+	add_read_handler("hashtable_erase", ActivePublicationIndexBench_read_handler, H_HASHTABLE_ERASE);
+	add_read_handler("index_insert", ActivePublicationIndexBench_read_handler, H_INDEX_INSERT);
+	add_read_handler("index_lookup", ActivePublicationIndexBench_read_handler, H_INDEX_LOOKUP);
+	add_read_handler("index_erase", ActivePublicationIndexBench_read_handler, H_INDEX_ERASE);
+}
+
+CLICK_ENDDECLS
+ELEMENT_REQUIRES(ActivePublication)
+EXPORT_ELEMENT(ActivePublicationIndexBench)
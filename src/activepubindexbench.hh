@@ -0,0 +1,75 @@
+/*
+ * This file is part of Blackadder.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+#ifndef CLICK_ACTIVEPUBINDEXBENCH_HH
+#define CLICK_ACTIVEPUBINDEXBENCH_HH
+
+#include "activepub.hh"
+
+#include <click/element.hh>
+
+CLICK_DECLS
+
+/**@brief (Blackadder Benchmark) ActivePublicationIndexBench compares the ActivePublicationIndex with the Click's HashTable it replaced in the LocalProxy.
+ *
+ * Upon initialization it inserts, looks up and erases the given number of identifiers (two fragments each, as /SCOPE/ITEM) in both tables, and times each step.
+ * The ActivePublication objects are allocated from the slab for the ActivePublicationIndex and from the heap for the HashTable.
+ * The handlers give the millions of operations per second, see activepubindex_bench.conf.
+ */
+class ActivePublicationIndexBench : public Element {
+public:
+	/**
+	 * @brief Constructor: it does nothing - as Click suggests
+	 * @return
+	 */
+	ActivePublicationIndexBench();
+	/**
+	 * @brief Destructor: it does nothing - as Click suggests
+	 * @return
+	 */
+	~ActivePublicationIndexBench();
+	/**
+	 * @brief the class name - required by Click
+	 * @return
+	 */
+	const char *class_name() const {return "ActivePublicationIndexBench";}
+	/**
+	 * @brief the port count - required by Click - no ports.
+	 * @return
+	 */
+	const char *port_count() const {return "0/0";}
+	/**
+	 * @brief Element configuration: the number of identifiers.
+	 */
+	int configure(Vector<String>&, ErrorHandler*);
+	/**@brief Click: Install the element's handlers (hashtable_insert, hashtable_lookup, hashtable_erase, index_insert, index_lookup and index_erase).
+	 */
+	void add_handlers();
+	/**
+	 * @brief runs the benchmark.
+	 * @param errh
+	 * @return
+	 */
+	int initialize(ErrorHandler *errh);
+	/**@brief The number of identifiers.
+	 */
+	int number_of_ids;
+	/**@brief The millions of operations per second for each step: insert, lookup and erase in the HashTable, then in the ActivePublicationIndex.
+	 */
+	double mops[6];
+};
+
+CLICK_ENDDECLS
+#endif
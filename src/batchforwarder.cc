@@ -0,0 +1,276 @@
+/*
+ * This file is part of Blackadder.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+#include "batchforwarder.hh"
+
+#if HAVE_BATCH
+
+CLICK_DECLS
+
+BatchForwarder::BatchForwarder() {
+    number_of_links = 0;
+    _threads = NULL;
+    _threads_memory = NULL;
+    _nthreads = 0;
+}
+
+BatchForwarder::~BatchForwarder() {
+    click_chatter("BatchForwarder: destroyed!");
+}
+
+int BatchForwarder::configure(Vector<String> &conf, ErrorHandler *errh) {
+    gc = (GlobalConf *) cp_element(conf[0], this);
+    if (!gc->use_mac) {
+        return errh->error("BatchForwarder: only the MAC mode is supported, use the Forwarder in IP mode");
+    }
+    click_chatter("*****************************************************FORWARDER CONFIGURATION*****************************************************");
+    click_chatter("BatchForwarder: internal LID: %s", gc->iLID.to_string().c_str());
+    number_of_links = Forwarder::configureLinks(this, gc, conf, fwTable);
+    click_chatter("*********************************************************************************************************************************");
+    return 0;
+}
+
+int BatchForwarder::initialize(ErrorHandler */*errh*/) {
+    _nthreads = click_max_cpu_ids();
+    _threads = new_cache_aligned<ThreadState>(_nthreads, _threads_memory);
+    for (int i = 0; i < _nthreads; i++) {
+        ThreadState &state = _threads[i];
+        state.no_groups = 0;
+        state.outputs.resize(noutputs());
+        state.packets = 0;
+        state.batches = 0;
+        state.copies = 0;
+        state.copied_bytes = 0;
+    }
+    return 0;
+}
+
+void BatchForwarder::cleanup(CleanupStage stage) {
+    if (stage >= CLEANUP_CONFIGURED) {
+        for (int i = 0; i < fwTable.size(); i++) {
+            ForwardingEntry *fe = fwTable.at(i);
+            delete fe;
+        }
+        delete_cache_aligned(_threads, _nthreads, _threads_memory);
+    }
+    click_chatter("BatchForwarder: Cleaned Up!");
+}
+
+WritablePacket *BatchForwarder::copyPacket(Packet *p, ThreadState &state) {
+    WritablePacket *q = Packet::make(p->headroom(), p->data(), p->length(), 0);
+    if (q != NULL) {
+        q->copy_annotations(p);
+        state.copies++;
+        state.copied_bytes += p->length();
+    }
+    return q;
+}
+
+BatchForwarder::FIDGroup *BatchForwarder::classify(int in_port, Packet *p, ThreadState &state) {
+    const unsigned char *FID_data;
+    uint64_t p_src_mac64 = 0;
+    uint64_t p_dst_mac64 = 0;
+    int p_proto_type = 0;
+    if (in_port == 0) {
+        FID_data = p->data();
+    } else {
+        p_dst_mac64 = mac_to_uint64(p->data());
+        p_src_mac64 = mac_to_uint64(p->data() + MAC_LEN);
+        uint16_t ether_type;
+        memcpy(&ether_type, p->data() + 12, 2);
+        p_proto_type = ntohs(ether_type);
+        /*the FID follows the MAC header, and the 8 bytes completing the IPv6 header in SDN frames*/
+        if (p_proto_type == 34525) {
+            FID_data = p->data() + 14 + 8;
+        } else {
+            FID_data = p->data() + 14;
+        }
+    }
+    /*consecutive packets of a burst usually belong to the same flow, so start from the last group*/
+    for (int g = state.no_groups - 1; g >= 0; g--) {
+        FIDGroup &group = state.groups[g];
+        if ((group.src_mac64 == p_src_mac64) && (group.dst_mac64 == p_dst_mac64) && (group.proto_type == p_proto_type) && (memcmp(group.FID, FID_data, FID_LEN) == 0)) {
+            return &group;
+        }
+    }
+    if (state.no_groups == state.groups.size()) {
+        state.groups.resize(state.no_groups + 1);
+    }
+    FIDGroup &group = state.groups[state.no_groups++];
+    BABitvector FID(FID_LEN * 8);
+    BABitvector andVector(FID_LEN * 8);
+    memcpy(group.FID, FID_data, FID_LEN);
+    memcpy(FID._data, FID_data, FID_LEN);
+    group.src_mac64 = p_src_mac64;
+    group.dst_mac64 = p_dst_mac64;
+    group.proto_type = p_proto_type;
+    group.links.clear();
+    group.pushLocally = false;
+    group.packets.clear();
+    if (in_port == 0) {
+        for (int i = 0; i < fwTable.size(); i++) {
+            andVector = FID & (*fwTable[i]->LID);
+            if (andVector == (*fwTable[i]->LID)) {
+                group.links.push_back(i);
+            }
+        }
+        return &group;
+    }
+    BABitvector testFID(FID);
+    testFID.negate();
+    if (!testFID.zero()) {
+        for (int i = 0; i < fwTable.size(); i++) {
+            ForwardingEntry *fe = fwTable[i];
+            andVector = FID & (*fe->LID);
+            if (andVector == (*fe->LID)) {
+                if ((p_src_mac64 == fe->dst_mac64) && (p_dst_mac64 == fe->src_mac64)) {
+                    click_chatter("MAC: a loop in %u from positive..I am not forwarding to the interface I received the packet from", i);
+                    continue;
+                }
+                if ((p_src_mac64 == fe->src_mac64) || (p_dst_mac64 == fe->dst_mac64)) {
+                    click_chatter("MAC: a looped packet in %u from positive, potentialy SDN..I am not forwarding to the interface I received the packet from", i);
+                    continue;
+                }
+                group.links.push_back(i);
+            }
+        }
+    } else {
+        /*all bits were 1 - probably from a link_broadcast strategy--do not forward*/
+    }
+    /*check if the packets must be pushed locally*/
+    andVector = FID & gc->iLID;
+    if (andVector == gc->iLID) {
+        group.pushLocally = true;
+    }
+    return &group;
+}
+
+void BatchForwarder::forward(int in_port, FIDGroup &group, ThreadState &state) {
+    WritablePacket *payload;
+    if ((group.links.size() == 0) && (!group.pushLocally)) {
+        for (int j = 0; j < group.packets.size(); j++) {
+            group.packets[j]->kill();
+        }
+        return;
+    }
+    /*link by link, so that the last link (or the LocalProxy) takes the original packets once all copies are made*/
+    for (int k = 0; k < group.links.size(); k++) {
+        ForwardingEntry *fe = fwTable[group.links[k]];
+        bool last = (k == group.links.size() - 1) && (!group.pushLocally);
+        for (int j = 0; j < group.packets.size(); j++) {
+            Packet *p = group.packets[j];
+            /**length of data for IP header
+            * does not include MAC (14) or BF (32)*/
+            unsigned short payload_len = p->length() - 14 - 32;
+            if (last) {
+                payload = p->uniqueify();
+            } else {
+                payload = copyPacket(p, state);
+            }
+            if (payload == NULL) {
+                continue;
+            }
+            if (in_port == 0) {
+                payload = Forwarder::encapsulateMAC(payload, fe, payload_len);
+            } else {
+                payload = Forwarder::relayMAC(payload, fe, group.proto_type, payload_len);
+            }
+            if (payload != NULL) {
+                state.outputs[fe->port].push_back(payload);
+            }
+        }
+    }
+    if (group.pushLocally) {
+        for (int j = 0; j < group.packets.size(); j++) {
+            Packet *p = group.packets[j];
+            if (group.proto_type == 34525) {
+                /*SDN packet: take out the MAC header + 8 byte SDN + FID*/
+                p->pull(14 + 8 + FID_LEN);
+            } else {
+                /*BA packet (or any other type, see Forwarder::push): take out the MAC header + FID*/
+                p->pull(14 + FID_LEN);
+            }
+            state.outputs[0].push_back(p);
+        }
+    }
+}
+
+void BatchForwarder::push(int in_port, Packet *p) {
+    push_batch(in_port, PacketBatch::make_from_packet(p));
+}
+
+void BatchForwarder::push_batch(int in_port, PacketBatch *batch) {
+    ThreadState &state = _threads[click_current_cpu_id()];
+    state.batches++;
+    state.no_groups = 0;
+    FOR_EACH_PACKET_SAFE(batch, p) {
+        state.packets++;
+        classify(in_port, p, state)->packets.push_back(p);
+    }
+    for (int g = 0; g < state.no_groups; g++) {
+        forward(in_port, state.groups[g], state);
+    }
+    /*a single batch per output port for the whole burst.
+     *A packet pushed out may come back to the BatchForwarder in the same thread (e.g. from the LocalProxy), so the list of a port is emptied before its batch is pushed:
+     *the nested call then starts from empty groups (the groups of this burst are all forwarded by now) and only pushes the packets it adds itself, or the ones of ports this call has not reached yet*/
+    for (int port = 0; port < state.outputs.size(); port++) {
+        Vector<Packet *> &out = state.outputs[port];
+        if (out.size() == 0) {
+            continue;
+        }
+        for (int j = 0; j < out.size() - 1; j++) {
+            out[j]->set_next(out[j + 1]);
+        }
+        out.back()->set_next(NULL);
+        PacketBatch *out_batch = PacketBatch::make_from_simple_list(out[0], out.back(), out.size());
+        out.clear();
+        output_push_batch(port, out_batch);
+    }
+}
+
+enum { H_PACKETS, H_BATCHES, H_COPIES, H_COPIED_BYTES };
+
+String BatchForwarder::read_stats_handler(Element *e, void *thunk) {
+    BatchForwarder *fw = (BatchForwarder *)e;
+    uint64_t value = 0;
+    for (int i = 0; i < fw->_nthreads; i++) {
+        switch ((intptr_t) thunk) {
+            case H_PACKETS:
+                value += fw->_threads[i].packets;
+                break;
+            case H_BATCHES:
+                value += fw->_threads[i].batches;
+                break;
+            case H_COPIES:
+                value += fw->_threads[i].copies;
+                break;
+            default:
+                value += fw->_threads[i].copied_bytes;
+        }
+    }
+    return String(value);
+}
+
+void BatchForwarder::add_handlers() {
+    add_read_handler("packets", read_stats_handler, H_PACKETS);
+    add_read_handler("batches", read_stats_handler, H_BATCHES);
+    add_read_handler("copies", read_stats_handler, H_COPIES);
+    add_read_handler("copied_bytes", read_stats_handler, H_COPIED_BYTES);
+}
+
+CLICK_ENDDECLS
+#endif
+ELEMENT_REQUIRES(batch Forwarder)
+EXPORT_ELEMENT(BatchForwarder)
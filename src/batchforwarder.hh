@@ -0,0 +1,168 @@
+/*
+ * This file is part of Blackadder.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+#ifndef CLICK_BATCHFORWARDER_HH
+#define CLICK_BATCHFORWARDER_HH
+
+#include "forwarder.hh"
+
+#if HAVE_BATCH
+#include <click/batchelement.hh>
+
+CLICK_DECLS
+
+/**@brief (Blackadder Core) The BatchForwarder is the Forwarder for Click builds with packet batching (FastClick, --enable-batch).
+ *
+ * It is configured exactly like the Forwarder and forwards the same way, but it handles a whole burst (PacketBatch) at a time.
+ * The packets of a burst are first grouped by FID (and by MAC addresses, which the loop check depends on), so the LIPSIN identifier is matched against the forwarding table once per group.
+ * Then the packets of all groups are replicated and their headers written link by link, and each output port receives a single batch per burst.
+ * Only the MAC mode is supported, the Forwarder must be used in IP mode.
+ *
+ * Like the Forwarder, the BatchForwarder can be used by several Click threads at the same time: the groups and output lists of a burst and the counters are kept per thread.
+ * A burst pushed out may come back to the BatchForwarder in the same thread: no packets are pushed out before all groups are forwarded, and the list of an output port is emptied before its batch is pushed.
+ */
+class BatchForwarder : public BatchElement {
+public:
+    /**
+     * @brief Constructor: it does nothing - as Click suggests
+     * @return
+     */
+    BatchForwarder();
+    /**
+     * @brief Destructor: it does nothing - as Click suggests
+     * @return
+     */
+    ~BatchForwarder();
+    /**
+     * @brief the class name - required by Click
+     * @return
+     */
+    const char *class_name() const {return "BatchForwarder";}
+    /**
+     * @brief the port count - required by Click - as for the Forwarder.
+     * @return
+     */
+    const char *port_count() const {return "-/-";}
+    /**
+     * @brief a PUSH Element.
+     * @return PUSH
+     */
+    const char *processing() const {return PUSH;}
+    /**
+     * @brief Element configuration: the same as for the Forwarder (see Forwarder::configureLinks).
+     */
+    int configure(Vector<String>&, ErrorHandler*);
+    /**@brief This Element must be configured AFTER the GlobalConf Element
+     * @return the correct number so that it is configured afterwards
+     */
+    int configure_phase() const{return 200;}
+    /**@brief Click: Install the element's handlers (packets, batches, copies and copied_bytes), which sum the counters of all threads.
+     */
+    void add_handlers();
+    /**
+     * @brief prepares the state of each thread, with one packet list per output port used to build the output batches.
+     * @param errh
+     * @return
+     */
+    int initialize(ErrorHandler *errh);
+    /**@brief Cleanups everything.
+     *
+     * If stage >= CLEANUP_CONFIGURED (i.e. the Element was configured), BatchForwarder will delete all stored ForwardingEntry and the thread states.
+     */
+    void cleanup(CleanupStage stage);
+    /**@brief a single packet is forwarded as a burst of one packet.
+     * @param port the port from which the packet was pushed. 0 for LocalProxy, >0 for network elements
+     * @param p a pointer to the packet
+     */
+    void push(int port, Packet *p);
+    /**@brief forwards a burst of packets, see Forwarder::push for the forwarding rules.
+     * @param port the port from which the burst was pushed. 0 for LocalProxy, >0 for network elements
+     * @param batch the burst
+     */
+    void push_batch(int port, PacketBatch *batch);
+    /**@brief A pointer to the GlobalConf Element for reading some global node configuration.
+     */
+    GlobalConf *gc;
+    /**@brief The number of links in the forwarding table.
+     */
+    int number_of_links;
+    /**@brief A vector containing all ForwardingEntry.
+     */
+    Vector<ForwardingEntry *> fwTable;
+private:
+    /**@brief the packets of a burst with the same FID, MAC addresses and Ethernet type, which are therefore forwarded to the same links.
+     */
+    struct FIDGroup {
+        unsigned char FID[FID_LEN];
+        uint64_t src_mac64;
+        uint64_t dst_mac64;
+        int proto_type;
+        /**@brief the indexes of the matching links in fwTable*/
+        Vector<int> links;
+        bool pushLocally;
+        Vector<Packet *> packets;
+    };
+    /**@brief the state of a Click thread: the burst it forwards and its counters. Each thread only writes to its own state, which is aligned to a cache line (see ForwarderThreadState).
+     */
+    struct ThreadState {
+        /**@brief the groups of the current burst, groups[0] to groups[no_groups - 1] (the vector is reused between bursts).
+         */
+        Vector<FIDGroup> groups;
+        int no_groups;
+        /**@brief the packets of the current burst for each output port.
+         */
+        Vector<Vector<Packet *> > outputs;
+        /**@brief the number of packets pushed to the BatchForwarder by this thread.
+         */
+        uint64_t packets;
+        /**@brief the number of bursts pushed to the BatchForwarder by this thread.
+         */
+        uint64_t batches;
+        /**@brief the number of packet copies made for multicast replication by this thread.
+         */
+        uint64_t copies;
+        /**@brief the number of bytes copied for multicast replication by this thread.
+         */
+        uint64_t copied_bytes;
+    } __attribute__((aligned(FORWARDER_CACHE_LINE)));
+    /**@brief makes the private copy of a packet that is sent on one more link (see Forwarder::copyPacket).
+     * @param p the packet
+     * @param state the state of the calling thread, which counts the copy
+     * @return the copy or NULL if no memory is available
+     */
+    WritablePacket *copyPacket(Packet *p, ThreadState &state);
+    /**@brief finds the group of a packet in the current burst of the thread, or starts a new one by matching the FID against the forwarding table.
+     */
+    FIDGroup *classify(int in_port, Packet *p, ThreadState &state);
+    /**@brief replicates the packets of a group and appends them to the packet lists of their output ports.
+     */
+    void forward(int in_port, FIDGroup &group, ThreadState &state);
+    /**@brief sums a counter of all threads for the handlers.
+     */
+    static String read_stats_handler(Element *e, void *thunk);
+    /**@brief The state of each Click thread, indexed by click_current_cpu_id().
+     */
+    ThreadState *_threads;
+    /**@brief The block _threads is allocated in (see new_cache_aligned).
+     */
+    char *_threads_memory;
+    /**@brief The number of entries in _threads.
+     */
+    int _nthreads;
+};
+
+CLICK_ENDDECLS
+#endif
+#endif
@@ -0,0 +1,115 @@
+/*
+ * This file is part of Blackadder.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+#include "checksumadjustcheck.hh"
+
+#include <click/packet.hh>
+
+CLICK_DECLS
+
+ChecksumAdjustCheck::ChecksumAdjustCheck() {
+	number_of_packets = 200000;
+	mismatches = 0;
+}
+
+ChecksumAdjustCheck::~ChecksumAdjustCheck() {
+	click_chatter("ChecksumAdjustCheck: destroyed!");
+}
+
+int ChecksumAdjustCheck::configure(Vector<String> &conf, ErrorHandler *errh) {
+	if (conf.size() > 0) {
+		cp_integer(conf[0], &number_of_packets);
+	}
+	if (number_of_packets < 1) {
+		return errh->error("ChecksumAdjustCheck: the number of packets must be positive");
+	}
+	return 0;
+}
+
+static struct in_addr
+random_address()
+{
+	struct in_addr address;
+	address.s_addr = click_random();
+	return address;
+}
+
+/*the UDP checksum as the Forwarder computes it for packets it sends, 0xffff for a computed zero*/
+static uint16_t
+udp_checksum(click_ip *ip, uint16_t len)
+{
+	click_udp *udp = reinterpret_cast<click_udp *> (ip + 1);
+	uint16_t sum;
+	udp->uh_sum = 0;
+	sum = click_in_cksum_pseudohdr(click_in_cksum((unsigned char *) udp, len), ip, len);
+	return (sum == 0) ? 0xffff : sum;
+}
+
+int ChecksumAdjustCheck::initialize(ErrorHandler *errh) {
+	unsigned char buffer[1500];
+	click_ip *ip = reinterpret_cast<click_ip *> (buffer);
+	click_udp *udp = reinterpret_cast<click_udp *> (ip + 1);
+	mismatches = 0;
+	for (int i = 0; i < number_of_packets; i++) {
+		uint16_t length = click_random(sizeof (click_ip) + sizeof (click_udp), sizeof (buffer));
+		uint16_t len = length - sizeof (click_ip);
+		bool no_udp_sum = (click_random(0, 9) == 0);
+		for (int b = 0; b < length; b++) {
+			buffer[b] = click_random(0, 255);
+		}
+		/*a valid packet as the previous hop sent it*/
+		ip->ip_v = 4;
+		ip->ip_hl = sizeof (click_ip) >> 2;
+		ip->ip_len = htons(length);
+		ip->ip_p = IP_PROTO_UDP;
+		udp->uh_ulen = htons(len);
+		udp->uh_sum = no_udp_sum ? 0 : udp_checksum(ip, len);
+		ip->ip_sum = 0;
+		ip->ip_sum = click_in_cksum((unsigned char *) ip, sizeof (click_ip));
+		/*this hop*/
+		forward_ip_header(ip, random_address(), random_address());
+		uint16_t ip_sum = ip->ip_sum;
+		uint16_t udp_sum = udp->uh_sum;
+		/*the checksums summed over the rewritten packet*/
+		ip->ip_sum = 0;
+		if (ip_sum != click_in_cksum((unsigned char *) ip, sizeof (click_ip))) {
+			mismatches++;
+		} else if (udp_sum != (no_udp_sum ? 0 : udp_checksum(ip, len))) {
+			mismatches++;
+		}
+	}
+	click_chatter("ChecksumAdjustCheck: %d random IP/UDP packets, %d incremental checksums differ from the recomputed ones", number_of_packets, mismatches);
+	if (mismatches > 0) {
+		return errh->error("ChecksumAdjustCheck: %d checksum mismatches", mismatches);
+	}
+	return 0;
+}
+
+enum { H_PACKETS, H_MISMATCHES };
+
+static String
+ChecksumAdjustCheck_read_handler(Element *e, void *thunk)
+{
+	ChecksumAdjustCheck *check = (ChecksumAdjustCheck *)e;
+	return String((intptr_t) thunk == H_PACKETS ? check->number_of_packets : check->mismatches);
+}
+
+void ChecksumAdjustCheck::add_handlers() {
+	add_read_handler("packets", ChecksumAdjustCheck_read_handler, H_PACKETS);
+	add_read_handler("mismatches", ChecksumAdjustCheck_read_handler, H_MISMATCHES);
+}
+
+CLICK_ENDDECLS
+EXPORT_ELEMENT(ChecksumAdjustCheck)
@@ -0,0 +1,75 @@
+/*
+ * This file is part of Blackadder.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+#ifndef CLICK_CHECKSUMADJUSTCHECK_HH
+#define CLICK_CHECKSUMADJUSTCHECK_HH
+
+#include "forwarder.hh"
+
+#include <click/element.hh>
+
+CLICK_DECLS
+
+/**@brief (Blackadder Test) ChecksumAdjustCheck compares the incremental checksum update of the Forwarder in IP mode with a full recomputation.
+ *
+ * Upon initialization it builds the given number of random IP/UDP packets (random sizes up to 1500 bytes and random header fields, one in ten without a UDP checksum) with valid checksums,
+ * forwards each of them to random addresses with forward_ip_header and compares the resulting IP and UDP checksums with the ones summed over the rewritten packet.
+ * Initialization fails if any of them differs, the handlers give the number of packets and mismatches, see checksumadjust_check.conf.
+ */
+class ChecksumAdjustCheck : public Element {
+public:
+	/**
+	 * @brief Constructor: it does nothing - as Click suggests
+	 * @return
+	 */
+	ChecksumAdjustCheck();
+	/**
+	 * @brief Destructor: it does nothing - as Click suggests
+	 * @return
+	 */
+	~ChecksumAdjustCheck();
+	/**
+	 * @brief the class name - required by Click
+	 * @return
+	 */
+	const char *class_name() const {return "ChecksumAdjustCheck";}
+	/**
+	 * @brief the port count - required by Click - no ports.
+	 * @return
+	 */
+	const char *port_count() const {return "0/0";}
+	/**
+	 * @brief Element configuration: the number of packets.
+	 */
+	int configure(Vector<String>&, ErrorHandler*);
+	/**@brief Click: Install the element's handlers (packets and mismatches).
+	 */
+	void add_handlers();
+	/**
+	 * @brief runs the check.
+	 * @param errh
+	 * @return
+	 */
+	int initialize(ErrorHandler *errh);
+	/**@brief The number of packets.
+	 */
+	int number_of_packets;
+	/**@brief The number of packets whose incrementally updated IP or UDP checksum differs from the recomputed one.
+	 */
+	int mismatches;
+};
+
+CLICK_ENDDECLS
+#endif
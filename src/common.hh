@@ -15,6 +15,7 @@
 #include "ba_bitvector.hh"
 #include <click/string.hh>
 #include <click/hashtable.hh>
+#include <../lib/blackadder_enums.hpp>
 
 CLICK_DECLS
 
@@ -232,12 +233,7 @@ typedef HashTable<int, LocalHost *> PubSubIdx;
 /** @brief An iterator to a Click's HashTable of integers mapped to pointers of LocalHost.
  */
 typedef PubSubIdx::iterator PubSubIdxIter;
-/** @brief A Click's HashTable of Click's Strings mapped to an ActivePublication.
- */
-typedef HashTable<String, ActivePublication *> ActivePub;
-/** @brief An iterator to a Click's HashTable of Click's Strings mapped to an ActivePublication.
- */
-typedef ActivePub::iterator ActivePubIter;
+/* ActivePub (the index of ActivePublication objects) is defined in activepub.hh*/
 /** @brief A Click's HashTable of Click's Strings mapped to an ActiveSubscription.
  */
 typedef HashTable<String, ActiveSubscription *> ActiveSub;
@@ -252,6 +248,79 @@ typedef HashTable<String, ActiveNode *> ActiveNodeMap;
  */
 typedef ActiveNodeMap::iterator ActiveNodMapIter;
 
+/**@brief (Blackadder Core) a non-owning view of an identifier inside a packet: the address of its first fragment and its number of fragments (PURSUIT_ID_LEN each).
+ *
+ * A view allocates nothing, so that identifiers can be looked up in the indexes without copying them out of the packet. It is valid as long as the packet bytes it points to.
+ */
+class IDView {
+public:
+    IDView() : data(NULL), fragments(0) {}
+    IDView(const unsigned char *_data, unsigned char _fragments) : data(_data), fragments(_fragments) {}
+    /**@brief the length of the identifier in bytes.
+     */
+    int length() const {return (int) fragments * PURSUIT_ID_LEN;}
+    /**@brief a Click's String that refers to the bytes of the view without copying them (String::make_stable), for index lookups. It must never be stored in an index.
+     */
+    String stable() const {return String::make_stable((const char *) data, length());}
+    /**@brief a Click's String with its own copy of the identifier, for new index entries.
+     */
+    String string() const {return String((const char *) data, length());}
+    /**@brief the address of the first fragment.
+     */
+    const unsigned char *data;
+    /**@brief the number of fragments.
+     */
+    unsigned char fragments;
+};
+
+/**@brief (Blackadder Core) a non-owning view of the identifiers in the header of a network publication: numberOfIDs followed by numberOfIDs (IDLength, ID) pairs.
+ */
+class IDListView {
+public:
+    /**@brief an iterator over the identifiers of the list, it dereferences to an IDView.
+     */
+    class iterator {
+    public:
+        iterator(const unsigned char *position, int index) : _position(position), _index(index) {}
+        IDView operator*() const {return IDView(_position + 1, *_position);}
+        iterator &operator++() {
+            _position += 1 + (int) *_position * PURSUIT_ID_LEN;
+            _index++;
+            return *this;
+        }
+        bool operator==(const iterator &other) const {return _index == other._index;}
+        bool operator!=(const iterator &other) const {return _index != other._index;}
+    private:
+        const unsigned char *_position;
+        int _index;
+    };
+    /**@brief the view of the header that starts at data (with numberOfIDs).
+     */
+    IDListView(const unsigned char *data) : _data(data) {
+        _length = 1;
+        for (int i = 0; i < (int) *_data; i++) {
+            _length += 1 + (int) *(_data + _length) * PURSUIT_ID_LEN;
+        }
+    }
+    /**@brief the number of identifiers.
+     */
+    int size() const {return (int) *_data;}
+    /**@brief the length of the header in bytes.
+     */
+    int length() const {return _length;}
+    /**@brief the address of the header (numberOfIDs).
+     */
+    const unsigned char *data() const {return _data;}
+    iterator begin() const {return iterator(_data + 1, 0);}
+    iterator end() const {return iterator(NULL, size());}
+    /**@brief the first identifier (the list must not be empty).
+     */
+    IDView front() const {return *begin();}
+private:
+    const unsigned char *_data;
+    int _length;
+};
+
 
 CLICK_ENDDECLS
 #endif
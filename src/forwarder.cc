@@ -26,6 +26,8 @@ ForwardingEntry::ForwardingEntry() {
     dst_ip = NULL;
     LID = NULL;
     proto_type = 0;
+    src_mac64 = 0;
+    dst_mac64 = 0;
 }
 
 ForwardingEntry::~ForwardingEntry() {
@@ -47,7 +49,10 @@ ForwardingEntry::~ForwardingEntry() {
 }
 
 Forwarder::Forwarder() {
-
+    fwTable = NULL;
+    _threads = NULL;
+    _threads_memory = NULL;
+    _nthreads = 0;
 }
 
 Forwarder::~Forwarder() {
@@ -55,11 +60,25 @@ Forwarder::~Forwarder() {
 }
 
 int Forwarder::configure(Vector<String> &conf, ErrorHandler */*errh*/) {
-    int port;
     gc = (GlobalConf *) cp_element(conf[0], this);
-    _id = 0;
+    _nthreads = click_max_cpu_ids();
+    _threads = new_cache_aligned<ForwarderThreadState>(_nthreads, _threads_memory);
+    memset(_threads, 0, _nthreads * sizeof(ForwarderThreadState));
+    for (int i = 0; i < _nthreads; i++) {
+        _threads[i].ip_id = i;
+    }
     click_chatter("*****************************************************FORWARDER CONFIGURATION*****************************************************");
     click_chatter("Forwarder: internal LID: %s", gc->iLID.to_string().c_str());
+    fwTable = new Vector<ForwardingEntry *>();
+    number_of_links = configureLinks(this, gc, conf, *fwTable);
+    click_chatter("*********************************************************************************************************************************");
+    //click_chatter("Forwarder: Configured!");
+    return 0;
+}
+
+int Forwarder::configureLinks(Element *e, GlobalConf *gc, Vector<String> &conf, Vector<ForwardingEntry *> &fwTable) {
+    int port;
+    int number_of_links;
     if (gc->use_mac == true) {
         cp_integer(conf[1], &number_of_links);
         click_chatter("Forwarder: Number of Links: %d", number_of_links);
@@ -68,8 +87,8 @@ int Forwarder::configure(Vector<String> &conf, ErrorHandler */*errh*/) {
             cp_integer(conf[2 + 5 * i], &port);
             EtherAddress * src = new EtherAddress();
             EtherAddress * dst = new EtherAddress();
-            cp_ethernet_address(conf[3 + 5 * i], src, this);
-            cp_ethernet_address(conf[4 + 5 * i], dst, this);
+            cp_ethernet_address(conf[3 + 5 * i], src, e);
+            cp_ethernet_address(conf[4 + 5 * i], dst, e);
             cp_integer(conf[5 + 5 * i], 16, &reverse_proto);
             ForwardingEntry *fe = new ForwardingEntry();
             fe->src = src;
@@ -77,6 +96,8 @@ int Forwarder::configure(Vector<String> &conf, ErrorHandler */*errh*/) {
             fe->port = port;
             fe->LID = new BABitvector(FID_LEN * 8);
             fe->proto_type = htons(reverse_proto);
+            fe->src_mac64 = mac_to_uint64(src->data());
+            fe->dst_mac64 = mac_to_uint64(dst->data());
             for (int j = 0; j < conf[6 + 5 * i].length(); j++) {
                 if (conf[6 + 5 * i].at(j) == '1') {
                     (*fe->LID)[conf[6 + 5 * i].length() - j - 1] = true;
@@ -98,8 +119,8 @@ int Forwarder::configure(Vector<String> &conf, ErrorHandler */*errh*/) {
             cp_integer(conf[2 + 4 * i], &port);
             IPAddress * src_ip = new IPAddress();
             IPAddress * dst_ip = new IPAddress();
-            cp_ip_address(conf[3 + 4 * i], src_ip, this);
-            cp_ip_address(conf[4 + 4 * i], dst_ip, this);
+            cp_ip_address(conf[3 + 4 * i], src_ip, e);
+            cp_ip_address(conf[4 + 4 * i], dst_ip, e);
             ForwardingEntry *fe = new ForwardingEntry();
             fe->src_ip = src_ip;
             fe->dst_ip = dst_ip;
@@ -116,11 +137,36 @@ int Forwarder::configure(Vector<String> &conf, ErrorHandler */*errh*/) {
             click_chatter("Forwarder: Added forwarding entry: port %d - source IP: %s - destination IP: %s - LID: %s", fe->port, fe->src_ip->unparse().c_str(), fe->dst_ip->unparse().c_str(), fe->LID->to_string().c_str());
         }
     }
-    click_chatter("*********************************************************************************************************************************");
-    //click_chatter("Forwarder: Configured!");
+    return number_of_links;
+}
+
+int Forwarder::live_reconfigure(Vector<String> &conf, ErrorHandler */*errh*/) {
+    Vector<ForwardingEntry *> *table = new Vector<ForwardingEntry *>();
+    Vector<ForwardingEntry *> *old_table = fwTable;
+    click_chatter("Forwarder: reconfiguring the forwarding table");
+    number_of_links = configureLinks(this, gc, conf, *table);
+    /*publish the new table, threads entering readLock from now on use it*/
+    __atomic_store_n(&fwTable, table, __ATOMIC_SEQ_CST);
+    synchronize();
+    for (int i = 0; i < old_table->size(); i++) {
+        delete (*old_table)[i];
+    }
+    delete old_table;
     return 0;
 }
 
+void Forwarder::synchronize() {
+    for (int i = 0; i < _nthreads; i++) {
+        uint32_t epoch = __atomic_load_n(&_threads[i].epoch, __ATOMIC_SEQ_CST);
+        /*an odd epoch means that the thread may still be using the old table, wait until it leaves the section*/
+        if (epoch & 1) {
+            while (__atomic_load_n(&_threads[i].epoch, __ATOMIC_ACQUIRE) == epoch) {
+                click_relax_fence();
+            }
+        }
+    }
+}
+
 int Forwarder::initialize(ErrorHandler */*errh*/) {
     //click_chatter("Forwarder: Initialized!");
     return 0;
@@ -128,14 +174,138 @@ int Forwarder::initialize(ErrorHandler */*errh*/) {
 
 void Forwarder::cleanup(CleanupStage stage) {
     if (stage >= CLEANUP_CONFIGURED) {
-        for (int i = 0; i < number_of_links; i++) {
-            ForwardingEntry *fe = fwTable.at(i);
+        for (int i = 0; i < fwTable->size(); i++) {
+            ForwardingEntry *fe = fwTable->at(i);
             delete fe;
         }
+        delete fwTable;
+        delete_cache_aligned(_threads, _nthreads, _threads_memory);
     }
     click_chatter("Forwarder: Cleaned Up!");
 }
 
+WritablePacket *Forwarder::copyPacket(Packet *p, ForwarderThreadState &state) {
+    WritablePacket *q = Packet::make(p->headroom(), p->data(), p->length(), 0);
+    if (q != NULL) {
+        q->copy_annotations(p);
+        state.copies++;
+        state.copied_bytes += p->length();
+    }
+    return q;
+}
+
+WritablePacket *Forwarder::encapsulateMAC(WritablePacket *payload, ForwardingEntry *fe, unsigned short payload_len) {
+    WritablePacket *newPacket = NULL;
+    int reverse_proto = ntohs(fe->proto_type);
+    /*0x080a == 2058*/
+    if (reverse_proto == 2058) {
+        newPacket = payload->push_mac_header(14);
+        if (newPacket == NULL) {
+            return NULL;
+        }
+        /*prepare the mac header*/
+        /*destination MAC*/
+        memcpy(newPacket->data(), fe->dst->data(), MAC_LEN);
+        /*source MAC*/
+        memcpy(newPacket->data() + MAC_LEN, fe->src->data(), MAC_LEN);
+        /*protocol type*/
+        memcpy(newPacket->data() + MAC_LEN + MAC_LEN, &fe->proto_type, 2);
+    } else if (reverse_proto == 34525) {
+        /*0x86dd == 34525, this is the protocol type used for IPv6 in the SDN implementation*/
+        newPacket = payload->push_mac_header(14 + 8);
+        if (newPacket == NULL) {
+            return NULL;
+        }
+        /*prepare the mac header*/
+        /*destination MAC*/
+        memcpy(newPacket->data(), fe->dst->data(), MAC_LEN);
+        /*source MAC*/
+        memcpy(newPacket->data() + MAC_LEN, fe->src->data(), MAC_LEN);
+        /*protocol type 0x080a*/
+        memcpy(newPacket->data() + MAC_LEN + MAC_LEN, &fe->proto_type, 2);
+        /*add 8 byte to complete IPv6 header for SDN switching, including:*/
+        /*version number */
+        memset(newPacket->data() + MAC_LEN + MAC_LEN + 2, 0x60, 1);
+        /*zero for not used IP feilds*/
+        memset(newPacket->data() + MAC_LEN + MAC_LEN + 3, 0x00, 3);
+        /*actualy payload length*/
+        memcpy(newPacket->data() + MAC_LEN + MAC_LEN + 6,(void*)&payload_len, 2);
+        /*IPv6 value for 'no next header'*/
+        memset(newPacket->data() + MAC_LEN + MAC_LEN + 8, 59, 1);
+        /*hop limit =255*/
+        memset(newPacket->data() + MAC_LEN + MAC_LEN + 9, 0xff, 1);
+    } else {
+        payload->kill();
+    }
+    return newPacket;
+}
+
+WritablePacket *Forwarder::relayMAC(WritablePacket *payload, ForwardingEntry *fe, int p_proto_type, unsigned short payload_len) {
+    /*BA->BA or SDN->SDN, only write the src/dst MAC addrs - no need to write the protocol type or tamper with the packet*/
+    if (p_proto_type == ntohs(fe->proto_type)){
+        /*prepare the mac header*/
+        /*destination MAC*/
+        memcpy(payload->data(), fe->dst->data(), MAC_LEN);
+        /*source MAC*/
+        memcpy(payload->data() + MAC_LEN, fe->src->data(), MAC_LEN);
+    }else{
+        /*BA -> SDN*/
+        if (p_proto_type == 2058 && ntohs(fe->proto_type) == 34525){
+            /*add 8 bytes between the FID and MAC header to complete the IPv6 header for ICN-SDN FW*/
+            payload = payload->push_mac_header(8);
+            if (payload == NULL) {
+                return NULL;
+            }
+            /*destination MAC*/
+            memcpy(payload->data(), fe->dst->data(), MAC_LEN);
+            /*source MAC*/
+            memcpy(payload->data() + MAC_LEN, fe->src->data(), MAC_LEN);
+            /*protocol type*/
+            memcpy(payload->data() + MAC_LEN + MAC_LEN, &fe->proto_type, 2);
+            /*add 8 byte to complete IPv6 header for SDN switching, including:*/
+            /*version number */
+            memset(payload->data() + MAC_LEN + MAC_LEN + 2, 0x60, 1);
+            /*zero for not used IP feilds*/
+            memset(payload->data() + MAC_LEN + MAC_LEN + 3, 0x00, 3);
+            /*actualy payload length*/
+            memcpy(payload->data() + MAC_LEN + MAC_LEN + 6,(void*)&payload_len, 2);
+            /*IPv6 value for 'no next header'*/
+            memset(payload->data() + MAC_LEN + MAC_LEN + 8, 59, 1);
+            /*hop limit =255*/
+            memset(payload->data() + MAC_LEN + MAC_LEN + 9, 0xff, 1);
+        }
+        /*SDN -> BA*/
+        else if (p_proto_type == 34525 && ntohs(fe->proto_type) == 2058){
+            /*take out the 8 bytes between the FID and MAC header to restore the BA packet, requires also to take the 14 byte current MAC header*/
+            payload->pull(14 + 8);
+            /*reinstate the MAC header*/
+            payload = payload->push_mac_header(14);
+            if (payload == NULL) {
+                return NULL;
+            }
+            /*destination MAC*/
+            memcpy(payload->data(), fe->dst->data(), MAC_LEN);
+            /*source MAC*/
+            memcpy(payload->data() + MAC_LEN, fe->src->data(), MAC_LEN);
+            /*protocol type*/
+            memcpy(payload->data() + MAC_LEN + MAC_LEN, &fe->proto_type, 2);
+        }
+        /**Carefull, I will assume every packet not matching the above to be a blackadder packet
+         *This is particularlry to solve NS3 issue of using IPv4 for Blackadder packets.
+         *When NS3 issue is resolved, this should be corrected
+         */
+        else {
+            /*prepare the mac header*/
+            /*destination MAC*/
+            memcpy(payload->data(), fe->dst->data(), MAC_LEN);
+            /*source MAC*/
+            memcpy(payload->data() + MAC_LEN, fe->src->data(), MAC_LEN);
+            click_chatter ("Forwarder: unknown ethernet packet type: %x !", p_proto_type);
+        }
+    }
+    return payload;
+}
+
 void Forwarder::push(int in_port, Packet *p) {
 //  click_chatter("Forwarder::push");
     WritablePacket *newPacket;
@@ -149,15 +319,20 @@ void Forwarder::push(int in_port, Packet *p) {
     bool pushLocally = false;
     click_ip *ip;
     click_udp *udp;
-    int reverse_proto;
+    /*the UDP checksum of the header and data, the same for every copy sent from here*/
+    unsigned udp_csum = 0;
+    bool udp_csum_ready = false;
     /**length of data for IP header
     * does not include MAC (14) or BF (32)*/
     unsigned short payload_len=p->length()-14-32;
+    ForwarderThreadState &state = threadState();
+    Vector<ForwardingEntry *> &table = *readLock(state);
+    state.packets++;
     if (in_port == 0) {
         memcpy(FID._data, p->data(), FID_LEN);
         /*Check all entries in my forwarding table and forward appropriately*/
-        for (int i = 0; i < fwTable.size(); i++) {
-            fe = fwTable[i];
+        for (int i = 0; i < table.size(); i++) {
+            fe = table[i];
             andVector = (FID)&(*fe->LID);
             if (andVector == (*fe->LID)) {
                 out_links.push_back(fe);
@@ -173,45 +348,16 @@ void Forwarder::push(int in_port, Packet *p) {
             if (counter == out_links.size()) {
                 payload = p->uniqueify();
             } else {
-                payload = p->clone()->uniqueify();
+                payload = copyPacket(p, state);
+            }
+            if (payload == NULL) {
+                counter++;
+                continue;
             }
             fe = *out_links_it;
             if (gc->use_mac) {
-                reverse_proto = ntohs(fe->proto_type);
-                /*0x080a == 2058*/
-                if(reverse_proto == 2058){
-                    newPacket = payload->push_mac_header(14);
-                    /*prepare the mac header*/
-                    /*destination MAC*/
-                    memcpy(newPacket->data(), fe->dst->data(), MAC_LEN);
-                    /*source MAC*/
-                    memcpy(newPacket->data() + MAC_LEN, fe->src->data(), MAC_LEN);
-                    /*protocol type*/
-                    memcpy(newPacket->data() + MAC_LEN + MAC_LEN, &fe->proto_type, 2);
-                    /*push the packet to the appropriate ToDevice Element*/
-                    output(fe->port).push(newPacket);
-                }
-                /*0x86dd == 34525, this is the protocol type used for IPv6 in the SDN implementation*/
-                if (reverse_proto == 34525){
-                    newPacket = payload->push_mac_header(14 + 8);
-                    /*prepare the mac header*/
-                    /*destination MAC*/
-                    memcpy(newPacket->data(), fe->dst->data(), MAC_LEN);
-                    /*source MAC*/
-                    memcpy(newPacket->data() + MAC_LEN, fe->src->data(), MAC_LEN);
-                    /*protocol type 0x080a*/
-                    memcpy(newPacket->data() + MAC_LEN + MAC_LEN, &fe->proto_type, 2);
-                    /*add 8 byte to complete IPv6 header for SDN switching, including:*/
-                    /*version number */
-                    memset(newPacket->data() + MAC_LEN + MAC_LEN + 2, 0x60, 1);
-                    /*zero for not used IP feilds*/
-                    memset(newPacket->data() + MAC_LEN + MAC_LEN + 3, 0x00, 3);
-                    /*actualy payload length*/
-                    memcpy(newPacket->data() + MAC_LEN + MAC_LEN + 6,(void*)&payload_len, 2);
-                    /*IPv6 value for 'no next header'*/
-                    memset(newPacket->data() + MAC_LEN + MAC_LEN + 8, 59, 1);
-                    /*hop limit =255*/
-                    memset(newPacket->data() + MAC_LEN + MAC_LEN + 9, 0xff, 1);
+                newPacket = encapsulateMAC(payload, fe, payload_len);
+                if (newPacket != NULL) {
                     /*push the packet to the appropriate ToDevice Element*/
                     output(fe->port).push(newPacket);
                 }
@@ -223,7 +369,8 @@ void Forwarder::push(int in_port, Packet *p) {
                 ip->ip_v = 4;
                 ip->ip_hl = sizeof (click_ip) >> 2;
                 ip->ip_len = htons(newPacket->length());
-                ip->ip_id = htons(_id.fetch_and_add(1));
+                ip->ip_id = htons(state.ip_id);
+                state.ip_id += _nthreads;
                 ip->ip_p = IP_PROTO_UDP;
                 ip->ip_src = fe->src_ip->in_addr();
                 ip->ip_dst = fe->dst_ip->in_addr();
@@ -239,8 +386,12 @@ void Forwarder::push(int in_port, Packet *p) {
                 uint16_t len = newPacket->length() - sizeof (click_ip);
                 udp->uh_ulen = htons(len);
                 udp->uh_sum = 0;
-                unsigned csum = click_in_cksum((unsigned char *) udp, len);
-                udp->uh_sum = click_in_cksum_pseudohdr(csum, ip, len);
+                /*only the pseudo header differs between copies, sum the data once*/
+                if (!udp_csum_ready) {
+                    udp_csum = click_in_cksum((unsigned char *) udp, len);
+                    udp_csum_ready = true;
+                }
+                udp->uh_sum = click_in_cksum_pseudohdr(udp_csum, ip, len);
                 output(fe->port).push(newPacket);
             }
             counter++;
@@ -249,7 +400,12 @@ void Forwarder::push(int in_port, Packet *p) {
         /**a packet has been pushed by the underlying network.**/
         /*check if it needs to be forwarded*/
         int p_proto_type;
+        uint64_t p_src_mac64 = 0;
+        uint64_t p_dst_mac64 = 0;
         if (gc->use_mac) {
+            /*the MAC addresses of the packet, for the loop check against every matching link*/
+            p_dst_mac64 = mac_to_uint64(p->data());
+            p_src_mac64 = mac_to_uint64(p->data() + MAC_LEN);
             /*check if the packet is coming from a SDN switch or a BA forwarder*/
             memcpy(&p_proto_type, p->data() + 12, 2);
             p_proto_type = ntohs(p_proto_type);
@@ -269,19 +425,17 @@ void Forwarder::push(int in_port, Packet *p) {
         testFID.negate();
         if (!testFID.zero()) {
             /*Check all entries in my forwarding table and forward appropriately*/
-            for (int i = 0; i < fwTable.size(); i++) {
-                fe = fwTable[i];
+            for (int i = 0; i < table.size(); i++) {
+                fe = table[i];
                 andVector = (FID)&(*fe->LID);
                 if (andVector == (*fe->LID)) {
                     if (gc->use_mac) {
-                        EtherAddress src(p->data() + MAC_LEN);
-                        EtherAddress dst(p->data());
-                        /*click_chatter("Forwarder: network packet, src MAC: %s, dst MAC: %s", (src.unparse()).c_str(), (dst.unparse()).c_str());*/
-                        if ((src.unparse().compare(fe->dst->unparse()) == 0) && (dst.unparse().compare(fe->src->unparse()) == 0)) {
+                        /*click_chatter("Forwarder: network packet, src MAC: %s, dst MAC: %s", EtherAddress(p->data() + MAC_LEN).unparse().c_str(), EtherAddress(p->data()).unparse().c_str());*/
+                        if ((p_src_mac64 == fe->dst_mac64) && (p_dst_mac64 == fe->src_mac64)) {
                             click_chatter("MAC: a loop in %u from positive..I am not forwarding to the interface I received the packet from", i);
                             continue;
                         }
-                        if ((src.unparse().compare(fe->src->unparse()) == 0) || (dst.unparse().compare(fe->dst->unparse()) == 0)) {
+                        if ((p_src_mac64 == fe->src_mac64) || (p_dst_mac64 == fe->dst_mac64)) {
                             click_chatter("MAC: a looped packet in %u from positive, potentialy SDN..I am not forwarding to the interface I received the packet from", i);
                             continue;
                         }
@@ -308,88 +462,23 @@ void Forwarder::push(int in_port, Packet *p) {
                 if ((counter == out_links.size()) && (pushLocally == false)) {
                     payload = p->uniqueify();
                 } else {
-                    payload = p->clone()->uniqueify();
+                    payload = copyPacket(p, state);
+                }
+                if (payload == NULL) {
+                    counter++;
+                    continue;
                 }
                 fe = *out_links_it;
                 if (gc->use_mac) {
-                    /*BA->BA or SDN->SDN, only write the src/dst MAC addrs - no need to write the protocol type or tamper with the packet*/
-                    if (p_proto_type == ntohs(fe->proto_type)){
-                        /*prepare the mac header*/
-                        /*destination MAC*/
-                        memcpy(payload->data(), fe->dst->data(), MAC_LEN);
-                        /*source MAC*/
-                        memcpy(payload->data() + MAC_LEN, fe->src->data(), MAC_LEN);
+                    payload = relayMAC(payload, fe, p_proto_type, payload_len);
+                    if (payload != NULL) {
                         /*push the packet to the appropriate ToDevice Element*/
                         output(fe->port).push(payload);
-                    }else{
-                        /*BA -> SDN*/
-                        if (p_proto_type == 2058 && ntohs(fe->proto_type) == 34525){
-                            /*add 8 bytes between the FID and MAC header to complete the IPv6 header for ICN-SDN FW*/
-                            payload->push_mac_header(8);
-                            /*destination MAC*/
-                            memcpy(payload->data(), fe->dst->data(), MAC_LEN);
-                            /*source MAC*/
-                            memcpy(payload->data() + MAC_LEN, fe->src->data(), MAC_LEN);
-                            /*protocol type*/
-                            memcpy(payload->data() + MAC_LEN + MAC_LEN, &fe->proto_type, 2);
-                            /*add 8 byte to complete IPv6 header for SDN switching, including:*/
-                            /*version number */
-                            memset(payload->data() + MAC_LEN + MAC_LEN + 2, 0x60, 1);
-                            /*zero for not used IP feilds*/
-                            memset(payload->data() + MAC_LEN + MAC_LEN + 3, 0x00, 3);
-                            /*actualy payload length*/
-                            memcpy(payload->data() + MAC_LEN + MAC_LEN + 6,(void*)&payload_len, 2);
-                            /*IPv6 value for 'no next header'*/
-                            memset(payload->data() + MAC_LEN + MAC_LEN + 8, 59, 1);
-                            /*hop limit =255*/
-                            memset(payload->data() + MAC_LEN + MAC_LEN + 9, 0xff, 1);
-                            output(fe->port).push(payload);
-                        }
-                        /*SDN -> BA*/
-                        else if (p_proto_type == 34525 && ntohs(fe->proto_type) == 2058){
-                            /*take out the 8 bytes between the FID and MAC header to restore the BA packet, requires also to take the 14 byte current MAC header*/
-                            payload->pull(14 + 8);
-                            /*reinstate the MAC header*/
-                            payload->push_mac_header(14);
-                            /*destination MAC*/
-                            memcpy(payload->data(), fe->dst->data(), MAC_LEN);
-                            /*source MAC*/
-                            memcpy(payload->data() + MAC_LEN, fe->src->data(), MAC_LEN);
-                            /*protocol type*/
-                            memcpy(payload->data() + MAC_LEN + MAC_LEN, &fe->proto_type, 2);
-                            output(fe->port).push(payload);
-                        }
-                        /**Carefull, I will assume every packet not matching the above to be a blackadder packet
-                         *This is particularlry to solve NS3 issue of using IPv4 for Blackadder packets.
-                         *When NS3 issue is resolved, this should be corrected
-                         */
-                        else {
-                            /*prepare the mac header*/
-                            /*destination MAC*/
-                            memcpy(payload->data(), fe->dst->data(), MAC_LEN);
-                            /*source MAC*/
-                            memcpy(payload->data() + MAC_LEN, fe->src->data(), MAC_LEN);
-                            /*push the packet to the appropriate ToDevice Element*/
-                            output(fe->port).push(payload);
-                          click_chatter ("Forwarder: unknown ethernet packet type: %x !", p_proto_type);
-                          /*payload->kill();*/
-                        }
                     }
                 } else {
                     click_ip *ip = reinterpret_cast<click_ip *> (payload->data());
-                    ip->ip_src = fe->src_ip->in_addr();
-                    ip->ip_dst = fe->dst_ip->in_addr();
-                    ip->ip_tos = 0;
-                    ip->ip_off = 0;
-                    ip->ip_ttl = 250;
-                    ip->ip_sum = 0;
-                    ip->ip_sum = click_in_cksum((unsigned char *) ip, sizeof (click_ip));
-                    click_udp *udp = reinterpret_cast<click_udp *> (ip + 1);
-                    //uint16_t len = udp->uh_ulen;
-                    uint16_t len = payload->length() - sizeof (click_ip);
-                    udp->uh_sum = 0;
-                    unsigned csum = click_in_cksum((unsigned char *) udp, len);
-                    udp->uh_sum = click_in_cksum_pseudohdr(csum, ip, len);
+                    /*update the IP and UDP (pseudo header) checksums incrementally (RFC 1624) instead of summing the packet again*/
+                    forward_ip_header(ip, fe->src_ip->in_addr(), fe->dst_ip->in_addr());
                     output(fe->port).push(payload);
                 }
                 counter++;
@@ -425,6 +514,35 @@ void Forwarder::push(int in_port, Packet *p) {
             p->kill();
         }
     }
+    readUnlock(state);
+}
+
+enum { H_PACKETS, H_COPIES, H_COPIED_BYTES };
+
+static String
+Forwarder_read_stats_handler(Element *e, void *thunk)
+{
+    Forwarder *fw = (Forwarder *)e;
+    uint64_t value = 0;
+    for (int i = 0; i < fw->_nthreads; i++) {
+        switch ((intptr_t) thunk) {
+            case H_PACKETS:
+                value += fw->_threads[i].packets;
+                break;
+            case H_COPIES:
+                value += fw->_threads[i].copies;
+                break;
+            default:
+                value += fw->_threads[i].copied_bytes;
+        }
+    }
+    return String(value);
+}
+
+void Forwarder::add_handlers() {
+    add_read_handler("packets", Forwarder_read_stats_handler, H_PACKETS);
+    add_read_handler("copies", Forwarder_read_stats_handler, H_COPIES);
+    add_read_handler("copied_bytes", Forwarder_read_stats_handler, H_COPIED_BYTES);
 }
 
 CLICK_ENDDECLS
@@ -23,6 +23,7 @@
 //#include "statistics.hh"
 
 #include <click/etheraddress.hh>
+#include <clicknet/ip.h>
 #include <clicknet/udp.h>
 
 CLICK_DECLS
@@ -56,13 +57,128 @@ public:
     /**@brief The Ethernet protocol type (hardcoded to be either: 0x080a for BA, or 0x86dd for SDN)
     */
     int proto_type;
+    /**@brief the source MAC address as an integer (see mac_to_uint64), used by the loop check.
+     */
+    uint64_t src_mac64;
+    /**@brief the destination MAC address as an integer (see mac_to_uint64), used by the loop check.
+     */
+    uint64_t dst_mac64;
 };
 
 
+/**@brief the 6 bytes of a MAC address packed in an integer, so that MAC addresses are compared without formatting them.
+ */
+static inline uint64_t mac_to_uint64(const unsigned char *mac) {
+    uint64_t value = 0;
+    memcpy(&value, mac, MAC_LEN);
+    return value;
+}
+
+/**@brief RFC 1624 (eqn. 3) incremental update of an Internet checksum: HC' = ~(~HC + ~m + m') for a 16-bit word changing from m to m'.
+ * The words may be in network byte order, as long as the checksum is too.
+ */
+static inline uint16_t cksum_adjust(uint16_t sum, uint16_t old_word, uint16_t new_word) {
+    uint32_t s = (uint16_t) ~sum + (uint16_t) ~old_word + new_word;
+    s = (s & 0xffff) + (s >> 16);
+    s = (s & 0xffff) + (s >> 16);
+    return (uint16_t) ~s;
+}
+
+/**@brief rewrites the IP header of a packet forwarded in IP mode (addresses, tos, offset and ttl) and updates the IP and UDP checksums incrementally (cksum_adjust) instead of summing the packet again.
+ * Only the 16-bit words 0, 3, 4 and 6-9 of the header change, the UDP checksum covers the addresses (6-9) through its pseudo header.
+ * A zero UDP checksum (none) stays zero, a computed zero is sent as 0xffff.
+ */
+static inline void forward_ip_header(click_ip *ip, struct in_addr src, struct in_addr dst) {
+    static const int changed_words[] = {0, 3, 4, 6, 7, 8, 9};
+    click_udp *udp = reinterpret_cast<click_udp *> (ip + 1);
+    uint16_t *words = reinterpret_cast<uint16_t *> (ip);
+    uint16_t old_words[10];
+    memcpy(old_words, words, sizeof (old_words));
+    ip->ip_src = src;
+    ip->ip_dst = dst;
+    ip->ip_tos = 0;
+    ip->ip_off = 0;
+    ip->ip_ttl = 250;
+    uint16_t ip_sum = ip->ip_sum;
+    uint16_t udp_sum = udp->uh_sum;
+    for (unsigned int w = 0; w < sizeof (changed_words) / sizeof (changed_words[0]); w++) {
+        int k = changed_words[w];
+        ip_sum = cksum_adjust(ip_sum, old_words[k], words[k]);
+        if (k >= 6) {
+            udp_sum = cksum_adjust(udp_sum, old_words[k], words[k]);
+        }
+    }
+    ip->ip_sum = ip_sum;
+    if (udp->uh_sum != 0) {
+        udp->uh_sum = (udp_sum == 0) ? 0xffff : udp_sum;
+    }
+}
+
+/**@brief the cache line size the per-thread states of the forwarders are aligned to.
+ */
+#define FORWARDER_CACHE_LINE 64
+
+/**@brief allocates n default constructed objects of T, the first one starting on a cache line.
+ *
+ * new[] only guarantees the alignment of the fundamental types, not the one of a cache aligned T.
+ * @param n the number of objects
+ * @param memory set to the allocated block, which delete_cache_aligned frees
+ * @return the first object
+ */
+template <typename T>
+static inline T *new_cache_aligned(int n, char *&memory) {
+    memory = new char[n * sizeof(T) + FORWARDER_CACHE_LINE - 1];
+    T *objects = reinterpret_cast<T *> (((uintptr_t) memory + FORWARDER_CACHE_LINE - 1) & ~(uintptr_t) (FORWARDER_CACHE_LINE - 1));
+    for (int i = 0; i < n; i++) {
+        new ((void *) &objects[i]) T();
+    }
+    return objects;
+}
+
+/**@brief destroys and frees the objects allocated by new_cache_aligned.
+ */
+template <typename T>
+static inline void delete_cache_aligned(T *objects, int n, char *memory) {
+    for (int i = 0; i < n; i++) {
+        objects[i].~T();
+    }
+    delete [] memory;
+}
+
+/**@brief (Blackadder Core) the state of a Click thread in the Forwarder.
+ *
+ * Each thread only writes to its own state, so forwarding does not share counters between threads.
+ * The state is aligned and padded to a cache line (and allocated with new_cache_aligned) so that two threads never write to the same line.
+ */
+struct ForwarderThreadState {
+    /**@brief the number of packets pushed to the Forwarder by this thread.
+     */
+    uint64_t packets;
+    /**@brief the number of packet copies made by this thread.
+     */
+    uint64_t copies;
+    /**@brief the number of bytes copied by this thread.
+     */
+    uint64_t copied_bytes;
+    /**@brief the next ip_id of the thread. Thread i uses i, i + n, i + 2n... (n threads), so threads never pick the same ip_id.
+     */
+    uint32_t ip_id;
+    /**@brief odd while the thread forwards with a forwarding table (see Forwarder::readLock).
+     */
+    uint32_t epoch;
+    /**@brief the number of nested readLock calls, a packet pushed by the Forwarder may come back to it in the same thread.
+     */
+    uint32_t nesting;
+} __attribute__((aligned(FORWARDER_CACHE_LINE)));
+
 /**@brief (Blackadder Core) The Forwarder Element implements the forwarding function. Currently it supports the basic LIPSIN mechanism.
  * 
  * It can work in two modes. In a MAC mode it expects ethernet frames from the network devices. It checks the LIPSIN identifiers and pushes packets to another Ethernet interface or to the LocalProxy.
  * In IP mode, the Forwarder expects raw IP sockets as the underlying network. Note that a mixed mode is currently not supported. Some lines must be written.
+ *
+ * The Forwarder can be used by several Click threads at the same time (e.g. one thread per NIC queue, see multiqueue_sample.conf).
+ * The forwarding table is never modified in place: a live reconfiguration (writing the config handler) publishes a new table and
+ * deletes the old one after all threads that were forwarding with it are done (a read-copy-update scheme).
  */
 class Forwarder : public Element {
 public:
@@ -98,10 +214,31 @@ public:
      * For each such link the Forwarder reads the outgoing port (to a "network" Element), the source and destination Ethernet or IP addresses (depending on the network mode) as well as the Link identifier (FID_LEN size see blackadder_enums.hpp).
      */
     int configure(Vector<String>&, ErrorHandler*);
+    /**@brief reads the (LIPSIN) links of a Forwarder configuration (conf[1] is the number of links) into a forwarding table.
+     *
+     * It is shared with the BatchForwarder, which is configured in the same way.
+     * @param e the Element being configured
+     * @param gc the GlobalConf Element, which tells whether the links are Ethernet or IP links
+     * @param conf the configuration arguments
+     * @param fwTable the forwarding table to fill
+     * @return the number of links
+     */
+    static int configureLinks(Element *e, GlobalConf *gc, Vector<String> &conf, Vector<ForwardingEntry *> &fwTable);
     /**@brief This Element must be configured AFTER the GlobalConf Element
      * @return the correct number so that it is configured afterwards
      */
     int configure_phase() const{return 200;}
+    /**@brief The links can be changed at runtime by writing the config handler.
+     */
+    bool can_live_reconfigure() const {return true;}
+    /**@brief replaces the forwarding table with the links of the new configuration, without stopping the threads that forward packets.
+     *
+     * The new table is published first, then the old table is deleted once every thread has left the readLock section in which it may still use it.
+     */
+    int live_reconfigure(Vector<String>&, ErrorHandler*);
+    /**@brief Click: Install the element's handlers (packets, copies and copied_bytes).
+     */
+    void add_handlers();
     /**
      * @brief This method is called by Click when the Element is about to be initialized. There is nothing that needs initialization though.
      * @param errh
@@ -126,21 +263,75 @@ public:
      * @param p a pointer to the packet
      */
     void push(int port, Packet *p);
+    /**@brief makes the private copy of a packet that is sent on one more link.
+     *
+     * Unlike clone()->uniqueify(), which copies the whole buffer of the packet (headroom and tailroom included), only the packet data is copied.
+     * The copy keeps the headroom of the packet, so that the link headers can be pushed in front of it, and its annotations.
+     * @param p the packet
+     * @param state the state of the calling thread, which counts the copy
+     * @return the copy or NULL if no memory is available
+     */
+    WritablePacket *copyPacket(Packet *p, ForwarderThreadState &state);
+    /**@brief the state of the calling thread.
+     */
+    ForwarderThreadState &threadState() {return _threads[click_current_cpu_id()];}
+    /**@brief starts using the forwarding table in the calling thread; the table is not deleted before the matching readUnlock.
+     * @param state the state of the calling thread
+     * @return the current forwarding table
+     */
+    Vector<ForwardingEntry *> *readLock(ForwarderThreadState &state) {
+        if (state.nesting++ == 0) {
+            __atomic_add_fetch(&state.epoch, 1, __ATOMIC_SEQ_CST);
+        }
+        return __atomic_load_n(&fwTable, __ATOMIC_SEQ_CST);
+    }
+    /**@brief stops using the forwarding table returned by readLock.
+     * @param state the state of the calling thread
+     */
+    void readUnlock(ForwarderThreadState &state) {
+        if (--state.nesting == 0) {
+            __atomic_add_fetch(&state.epoch, 1, __ATOMIC_RELEASE);
+        }
+    }
+    /**@brief waits until every thread that may use a replaced forwarding table has called readUnlock.
+     */
+    void synchronize();
+    /**@brief pushes the Ethernet header of a link (and the 8 bytes completing the IPv6 header for an SDN link) in front of a packet sent by the LocalProxy.
+     * @param payload the packet, starting with its FID
+     * @param fe the ForwardingEntry of the link
+     * @param payload_len the IPv6 payload length written for an SDN link
+     * @return the frame or NULL if it cannot be sent on the link (the packet is then killed)
+     */
+    static WritablePacket *encapsulateMAC(WritablePacket *payload, ForwardingEntry *fe, unsigned short payload_len);
+    /**@brief rewrites the Ethernet header of a frame received from the network for the link it is forwarded to, converting it between Blackadder and SDN frames when needed.
+     * @param payload the frame
+     * @param fe the ForwardingEntry of the link
+     * @param p_proto_type the Ethernet type of the received frame
+     * @param payload_len the IPv6 payload length written when converting to an SDN frame
+     * @return the frame or NULL if no memory is available
+     */
+    static WritablePacket *relayMAC(WritablePacket *payload, ForwardingEntry *fe, int p_proto_type, unsigned short payload_len);
     /**@brief A pointer to the GlobalConf Element for reading some global node configuration.
      */
     GlobalConf *gc;
     /**@brief A pointer to the Statistics Element for collecting packet/byte statis in the node.
      */
 //    Statistics *st;
-    /**@brief It is used for filling the ip_id field in the IP packet when sending over raw sockets. It is increased for every sent packet.
-     */
-    atomic_uint32_t _id;
     /**@brief The number of links in the forwarding table.
      */
     int number_of_links;
-    /**@brief A vector containing all ForwardingEntry.
+    /**@brief A vector containing all ForwardingEntry. It is replaced as a whole and must be read between readLock and readUnlock.
+     */
+    Vector<ForwardingEntry *> *fwTable;
+    /**@brief The state of each Click thread, indexed by click_current_cpu_id(). The packets, copies and copied_bytes handlers sum the counters of all threads.
+     */
+    ForwarderThreadState *_threads;
+    /**@brief The block _threads is allocated in (see new_cache_aligned).
+     */
+    char *_threads_memory;
+    /**@brief The number of entries in _threads.
      */
-    Vector<ForwardingEntry *> fwTable;
+    int _nthreads;
 };
 
 CLICK_ENDDECLS
@@ -0,0 +1,87 @@
+#!/bin/bash
+#
+# This file is part of Blackadder.
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License version
+# 3 as published by the Free Software Foundation.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# See LICENSE and COPYING for more details.
+#
+# Forwarder scaling test over veth pairs: for 1, 2, 4... MAX_THREADS
+# threads, a generator Click process sends Blackadder frames on one veth
+# pair per thread, and a forwarding Click process reads the other end of
+# each pair in its own thread and forwards the frames through a single
+# Forwarder. It prints the frames per second forwarded with each number of
+# threads. It must be run as root, with the blackadder package installed
+# and, for meaningful figures, at least 2 * MAX_THREADS cores.
+#
+# Usage: forwarder_mt_bench.sh [MAX_THREADS] [SECONDS]
+
+MAX_THREADS=${1:-4}
+SECONDS_PER_RUN=${2:-10}
+CLICK=${CLICK:-click}
+TMP=$(mktemp -d)
+
+cleanup() {
+	for ((i = 0; i < MAX_THREADS; i++)); do
+		ip link del bagen$i 2>/dev/null
+	done
+	rm -rf $TMP
+}
+trap cleanup EXIT
+
+for ((i = 0; i < MAX_THREADS; i++)); do
+	ip link add bagen$i type veth peer name bafw$i || exit 1
+	ip link set bagen$i up
+	ip link set bafw$i up
+done
+
+for ((n = 1; n <= MAX_THREADS; n *= 2)); do
+	# the generator: one InfiniteSource per veth pair, each in its own thread
+	{
+		for ((i = 0; i < n; i++)); do
+			echo "src$i::InfiniteSource(DATA \<00 00 00 00 00 01  00 00 00 00 00 02  08 0a  00 ff ff ff ff ff ff ff ff ff ff ff ff ff ff ff ff ff ff ff ff ff ff ff ff ff ff ff ff ff ff 7f  00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00 00>, BURST 32) -> Queue(1000) -> tx$i::ToDevice(bagen$i, METHOD LINUX);"
+			echo "StaticThreadSched(src$i $i, tx$i $i);"
+		done
+	} > $TMP/gen.click
+	# the forwarding node: one FromDevice per veth pair, each in its own thread, a counter per thread
+	{
+		echo "require(blackadder);"
+		cat <<'END'
+globalconf::GlobalConf(
+MODE mac,
+NODEID 00000001,
+DEFAULTRV 1000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000,
+iLID      1000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000,
+TMFID     1000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000);
+
+fw::Forwarder(globalconf,1,
+1,00:00:00:00:01:01,00:00:00:00:02:01,080a,0000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000100000000);
+
+fw[0] -> Discard;
+fw[1] -> Discard;
+END
+		for ((i = 0; i < n; i++)); do
+			echo "rx$i::FromDevice(bafw$i, METHOD LINUX, BURST 32) -> c$i::AverageCounter -> [1]fw;"
+			echo "StaticThreadSched(rx$i $i);"
+		done
+		echo -n "DriverManager(wait ${SECONDS_PER_RUN}s"
+		for ((i = 0; i < n; i++)); do
+			echo -n ", print c$i.rate"
+		done
+		echo ", stop);"
+	} > $TMP/fw.click
+	$CLICK -j $n $TMP/gen.click &
+	GEN=$!
+	sleep 1
+	RATE=$($CLICK -j $n $TMP/fw.click 2>/dev/null | awk '{ sum += $1 } END { printf "%.0f", sum }')
+	kill $GEN
+	wait $GEN 2>/dev/null
+	echo "$n threads: $RATE frames/s"
+done
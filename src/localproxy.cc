@@ -22,6 +22,10 @@
 CLICK_DECLS
 
 LocalProxy::LocalProxy() {
+	subscriptionGeneration = 1;
+	subscriber_cache_hits = 0;
+	subscriber_cache_misses = 0;
+	subscriber_cache_invalidations = 0;
 }
 
 LocalProxy::~LocalProxy() {
@@ -48,18 +52,17 @@ void LocalProxy::cleanup(CleanupStage stage) {
 			delete (*it1).second;
 			it1 = local_pub_sub_Index.erase(it1);
 		}
-		size = activePublicationIndex.size();
-		ActivePubIter it2 = activePublicationIndex.begin();
-		for (int i = 0; i < size; i++) {
+		for (ActivePubIter it2 = activePublicationIndex.begin(); it2 != activePublicationIndex.end(); it2++) {
 			delete (*it2).second;
-			it2 = activePublicationIndex.erase(it2);
 		}
+		activePublicationIndex.clear();
 		size = activeSubscriptionIndex.size();
 		ActiveSubIter it3 = activeSubscriptionIndex.begin();
 		for (int i = 0; i < size; i++) {
 			delete (*it3).second;
 			it3 = activeSubscriptionIndex.erase(it3);
 		}
+		flushSubscriberCache();
 	}
 	click_chatter("LocalProxy: Cleaned Up!");
 }
@@ -69,7 +72,6 @@ void LocalProxy::push(int in_port, Packet * p) {
 	int type_of_publisher;
 	bool forward;
 	unsigned char type, APItype, numberOfIDs, IDLength /*in fragments of PURSUIT_ID_LEN each*/, prefixIDLength /*in fragments of PURSUIT_ID_LEN each*/, strategy, numberofNodeIDs, Apptype /*notification sent by application to blackadder */;
-	Vector<String> IDs;
 	LocalHost *_localhost;
 	BABitvector RVFID;
 	BABitvector FID_to_subscribers;
@@ -78,28 +80,27 @@ void LocalProxy::push(int in_port, Packet * p) {
 	index = 0;
 	if (in_port == 2) {
 		/*from port 2 I receive publications from the network*/
-		index = 0;
-		/*read the "header"*/
-		numberOfIDs = *(p->data());
-		/*Read all the identifiers*/
-		for (int i = 0; i < (int) numberOfIDs; i++) {
-			IDLength = *(p->data() + sizeof (numberOfIDs) + index);
-			IDs.push_back(String((const char *) (p->data() + sizeof (numberOfIDs) + sizeof (IDLength) + index), (int) IDLength * PURSUIT_ID_LEN));
-			index = index + sizeof (IDLength) + IDLength * PURSUIT_ID_LEN;
+		/*the identifiers are not copied out of the packet: IDs refers to the header, which stays in the headroom after the pull (see pushDataToLocalSubscriber)*/
+		/*so the packet must not be shared, otherwise pushing a new header in front of the data could reallocate it*/
+		p = p->uniqueify();
+		if (!p) {
+			return;
 		}
-		p->pull(sizeof (numberOfIDs) + index);
+		/*read the "header"*/
+		IDListView IDs(p->data());
+		p->pull(IDs.length());
 		type = *(p->data());
 		if (type == PUBLISH_DATA) {
 			APItype = PUBLISHED_DATA;
 			/*pull the type out as the application does not need it*/
 			p->pull(sizeof (type));
-			if ((IDs.size() == 1) && (IDs[0].compare(gc->notificationIID) == 0)) {
+			if ((IDs.size() == 1) && (IDs.front().stable().compare(gc->notificationIID) == 0)) {
 				/*a special case here: Got back an RV/TM event...it was published using the ID /FFFFFFFFFFFFFFFD/MYNODEID*/
 				/*remove the header, plus the outer type of PUBLISHED_DATA */
 				handleRVNotification(p);
 				p->kill();
-			} else if ((IDs.size() == 1) && (IDs[0].compare(gc->pathMgmtIID) == 0)){
-				//click_chatter("LocalProxy, Link change : ID: %s", IDs[0].quoted_hex().c_str());
+			} else if ((IDs.size() == 1) && (IDs.front().stable().compare(gc->pathMgmtIID) == 0)){
+				//click_chatter("LocalProxy, Link change : ID: %s", IDs.front().stable().quoted_hex().c_str());
 				processTMNotification(p);
 			}
 			else {
@@ -364,6 +365,8 @@ void LocalProxy::disconnect(LocalHost *_localhost) {
 	/*there is a bug here...I have to rethink how to correctly delete all entries in the right sequence*/
 	if (_localhost != NULL) {
 		click_chatter("LocalProxy: Entity %s disconnected...cleaning...", _localhost->localHostID.c_str());
+		/*the cached subscribers may include _localhost*/
+		subscriptionGeneration++;
 		/*I know whether we talk about a scope or an information item from the isScope boolean value*/
 		deleteAllActiveInformationItemPublications(_localhost);
 		deleteAllActiveInformationItemSubscriptions(_localhost);
@@ -508,6 +511,7 @@ bool LocalProxy::removeActivePublication(LocalHost *_publisher, String &fullID,
  If not, the RV point already knows about this node's subscription...Note that RV points know only about network nodes - NOT about processes or click modules*/
 bool LocalProxy::storeActiveSubscription(LocalHost *_subscriber, String &fullID, unsigned char strategy, BABitvector &RVFID, bool isScope) {
 	ActiveSubscription *as;
+	subscriptionGeneration++;
 	as = activeSubscriptionIndex.get(fullID);
 	if (as == activeSubscriptionIndex.default_value()) {
 		as = new ActiveSubscription(fullID, strategy, isScope);
@@ -542,6 +546,7 @@ bool LocalProxy::storeActiveSubscription(LocalHost *_subscriber, String &fullID,
 /*delete the remote scope for the _subscriber..forward the message to the RV point only if there aren't any other publishers or subscribers for this scope*/
 bool LocalProxy::removeActiveSubscription(LocalHost *_subscriber, String &fullID, unsigned char strategy) {
 	ActiveSubscription *as;
+	subscriptionGeneration++;
 	as = activeSubscriptionIndex.get(fullID);
 	if (as != activeSubscriptionIndex.default_value()) {
 		if (as->strategy == strategy) {
@@ -568,10 +573,10 @@ bool LocalProxy::removeActiveSubscription(LocalHost *_subscriber, String &fullID
 }
 
 /*store the nodeIDs of implicit subscribers*/
-bool LocalProxy::storeActiveNode(String &_isubscriberID, Vector<String> &IDs) {
+bool LocalProxy::storeActiveNode(String &_isubscriberID, IDListView &IDs) {
 	ActiveNode *an;
 	LocalHostStringHashMap localSubscribers;
-	//	click_chatter("received data for ID: %s", IDs[0].quoted_hex().c_str());
+	//	click_chatter("received data for ID: %s", IDs.front().stable().quoted_hex().c_str());
 	bool foundLocalSubscribers = findLocalSubscribers(IDs, localSubscribers);
 	an = activeNodeIndex.get(_isubscriberID);
 	if (an == activeNodeIndex.default_value()) {
@@ -799,9 +804,10 @@ void LocalProxy::pushDataToLocalSubscriber(LocalHost *_localhost, String &ID, Pa
 #if !CLICK_NS
 	/*no need to push the size of type as type is reintroduced in the publish_data packet*/
 	newPacket = p->push(sizeof (unsigned char) + sizeof (unsigned char) +ID.length());
+	/*the ID may refer to the header of a network publication in the headroom of p (see IDListView), so it is moved before anything else is written*/
+	memmove(newPacket->data() + sizeof (unsigned char) + sizeof (unsigned char), ID.data(), ID.length());
 	memcpy(newPacket->data(), &type, sizeof (unsigned char));
 	memcpy(newPacket->data() + sizeof (unsigned char), &IDLength, sizeof (unsigned char));
-	memcpy(newPacket->data() + sizeof (unsigned char) + sizeof (unsigned char), ID.c_str(), ID.length());
 	if (_localhost->type == CLICK_ELEMENT) {
 		output(_localhost->id).push(newPacket);
 	} else {
@@ -811,16 +817,16 @@ void LocalProxy::pushDataToLocalSubscriber(LocalHost *_localhost, String &ID, Pa
 #else
 	if (_localhost->type == CLICK_ELEMENT) {
 		newPacket = p->push(sizeof (unsigned char) + sizeof (unsigned char) +ID.length());
+		memmove(newPacket->data() + sizeof (unsigned char) + sizeof (unsigned char), ID.data(), ID.length());
 		memcpy(newPacket->data(), &type, sizeof (unsigned char));
 		memcpy(newPacket->data() + sizeof (unsigned char), &IDLength, sizeof (unsigned char));
-		memcpy(newPacket->data() + sizeof (unsigned char) + sizeof (unsigned char), ID.c_str(), ID.length());
 		output(_localhost->id).push(newPacket);
 	} else {
 		newPacket = p->push(sizeof (_localhost->id) + sizeof (unsigned char) + sizeof (unsigned char) +ID.length());
+		memmove(newPacket->data() + sizeof (_localhost->id) + sizeof (unsigned char) + sizeof (unsigned char), ID.data(), ID.length());
 		memcpy(newPacket->data(), &_localhost->id, sizeof (_localhost->id));
 		memcpy(newPacket->data() + sizeof (_localhost->id), &type, sizeof (unsigned char));
 		memcpy(newPacket->data() + sizeof (_localhost->id) + sizeof (unsigned char), &IDLength, sizeof (unsigned char));
-		memcpy(newPacket->data() + sizeof (_localhost->id) + sizeof (unsigned char) + sizeof (unsigned char), ID.c_str(), ID.length());
 		output(0).push(newPacket);
         click_chatter("LocalProxy: Pushed packet to Subscriber");
 	}
@@ -919,22 +925,25 @@ void LocalProxy::pushDataToRemoteSubscribers(Vector<String> &IDs, unsigned char
 	/*push the new packet to the network*/
 	output(2).push(newPacket);
 }
-void LocalProxy::handleNetworkPublication(Vector<String> &IDs, Packet *p /*the packet has some headroom and only the data which hasn't been copied yet*/, unsigned char &APItype) {
-	LocalHostStringHashMap localSubscribers;
-	int counter = 1;
-//	click_chatter("received data for ID: %s", IDs[0].quoted_hex().c_str());
-	bool foundLocalSubscribers = findLocalSubscribers(IDs, localSubscribers);
-	int localSubscribersSize = localSubscribers.size();
-	if (foundLocalSubscribers) {
+void LocalProxy::handleNetworkPublication(IDListView &IDs, Packet *p /*the packet has some headroom and only the data which hasn't been copied yet*/, unsigned char &APItype) {
+	int offset;
+//	click_chatter("received data for ID: %s", IDs.front().stable().quoted_hex().c_str());
+	SubscriberCacheEntry *entry = resolveLocalSubscribers(IDs);
+	/*a local subscriber is pushed the publication synchronously and may (un)subscribe meanwhile, which clears or deletes the cache entry: deliver from copies*/
+	Vector<LocalHost *> subscribers(entry->subscribers);
+	Vector<int> IDOffsets(entry->IDOffsets);
+	int localSubscribersSize = subscribers.size();
+	if (localSubscribersSize > 0) {
 //        click_chatter("LocalProxy: found Subscribers");
-		for (LocalHostStringHashMapIter localSubscribers_it = localSubscribers.begin(); localSubscribers_it != localSubscribers.end(); localSubscribers_it++) {
-			if (counter == localSubscribersSize) {
+		for (int i = 0; i < localSubscribersSize; i++) {
+			offset = IDOffsets[i];
+			String ID = IDView(IDs.data() + offset + 1, *(IDs.data() + offset)).stable();
+			if (i == localSubscribersSize - 1) {
 				/*don't clone the packet since this is the last subscriber*/
-				pushDataToLocalSubscriber((*localSubscribers_it).first, (*localSubscribers_it).second, p, APItype);
+				pushDataToLocalSubscriber(subscribers[i], ID, p, APItype);
 			} else {
-				pushDataToLocalSubscriber((*localSubscribers_it).first, (*localSubscribers_it).second, p->clone()->uniqueify(), APItype);
+				pushDataToLocalSubscriber(subscribers[i], ID, p->clone()->uniqueify(), APItype);
 			}
-			counter++;
 		}
 	} else {
 		p->kill();
@@ -1575,6 +1584,72 @@ bool LocalProxy::findLocalSubscribers(Vector<String> &IDs, LocalHostStringHashMa
 	return foundSubscribers;
 }
 
+bool LocalProxy::findLocalSubscribers(IDListView &IDs, LocalHostStringHashMap & _localSubscribers) {
+	bool foundSubscribers;
+	String knownID;
+	LocalHostSetIter set_it;
+	ActiveSubscription *as;
+	foundSubscribers = false;
+	/*the same lookups as above, but the identifiers stay in the packet (stable Strings are never copied)*/
+	for (IDListView::iterator id_it = IDs.begin(); id_it != IDs.end(); ++id_it) {
+		knownID = (*id_it).stable();
+		/*check for local subscription for the specific information item*/
+		as = activeSubscriptionIndex.get(knownID);
+		if (as != activeSubscriptionIndex.default_value()) {
+			for (set_it = as->subscribers.begin(); set_it != as->subscribers.end(); set_it++) {
+				_localSubscribers.set((*set_it)._lhpointer, knownID);
+				foundSubscribers = true;
+			}
+		}
+		as = activeSubscriptionIndex.get(knownID.substring(0, knownID.length() - PURSUIT_ID_LEN));
+		if (as != activeSubscriptionIndex.default_value()) {
+			for (set_it = as->subscribers.begin(); set_it != as->subscribers.end(); set_it++) {
+				_localSubscribers.set((*set_it)._lhpointer, knownID);
+				foundSubscribers = true;
+			}
+		}
+	}
+	return foundSubscribers;
+}
+
+SubscriberCacheEntry *LocalProxy::resolveLocalSubscribers(IDListView &IDs) {
+	LocalHostStringHashMap localSubscribers;
+	String key = String::make_stable((const char *) IDs.data(), IDs.length());
+	SubscriberCacheEntry *entry = subscriberCache.get(key);
+	if (entry != subscriberCache.default_value()) {
+		if (entry->generation == subscriptionGeneration) {
+			subscriber_cache_hits++;
+			return entry;
+		}
+		subscriber_cache_invalidations++;
+		entry->subscribers.clear();
+		entry->IDOffsets.clear();
+	} else {
+		subscriber_cache_misses++;
+		if (subscriberCache.size() >= SUBSCRIBER_CACHE_SIZE) {
+			flushSubscriberCache();
+		}
+		entry = new SubscriberCacheEntry();
+		/*the key is copied, the packet will not outlive this publication*/
+		subscriberCache.set(String(key.data(), key.length()), entry);
+	}
+	findLocalSubscribers(IDs, localSubscribers);
+	for (LocalHostStringHashMapIter localSubscribers_it = localSubscribers.begin(); localSubscribers_it != localSubscribers.end(); localSubscribers_it++) {
+		/*the identifiers found are stable Strings referring to the header*/
+		entry->subscribers.push_back((*localSubscribers_it).first);
+		entry->IDOffsets.push_back((const unsigned char *) (*localSubscribers_it).second.data() - 1 - IDs.data());
+	}
+	entry->generation = subscriptionGeneration;
+	return entry;
+}
+
+void LocalProxy::flushSubscriberCache() {
+	for (SubscriberCacheIter it = subscriberCache.begin(); it != subscriberCache.end(); it++) {
+		delete (*it).second;
+	}
+	subscriberCache.clear();
+}
+
 void LocalProxy::sendNotificationLocally(unsigned char type, LocalHost *_localhost, String ID) {
 	WritablePacket *p;
 	unsigned char IDLength;
@@ -1844,5 +1919,27 @@ void LocalProxy::deleteAllActiveScopeSubscriptions(LocalHost * _subscriber) {
 	}
 }
 
+enum { H_CACHE_HITS, H_CACHE_MISSES, H_CACHE_INVALIDATIONS };
+
+static String
+LocalProxy_read_cache_handler(Element *e, void *thunk)
+{
+	LocalProxy *lp = (LocalProxy *)e;
+	switch ((intptr_t) thunk) {
+		case H_CACHE_HITS:
+			return String(lp->subscriber_cache_hits);
+		case H_CACHE_MISSES:
+			return String(lp->subscriber_cache_misses);
+		default:
+			return String(lp->subscriber_cache_invalidations);
+	}
+}
+
+void LocalProxy::add_handlers() {
+	add_read_handler("subscriber_cache_hits", LocalProxy_read_cache_handler, H_CACHE_HITS);
+	add_read_handler("subscriber_cache_misses", LocalProxy_read_cache_handler, H_CACHE_MISSES);
+	add_read_handler("subscriber_cache_invalidations", LocalProxy_read_cache_handler, H_CACHE_INVALIDATIONS);
+}
+
 CLICK_ENDDECLS
 EXPORT_ELEMENT(LocalProxy)
@@ -24,10 +24,36 @@
 #include "activenode.hh"
 #include <click/router.hh>
 
+/*the maximum number of entries in the subscriber cache of the LocalProxy*/
+#define SUBSCRIBER_CACHE_SIZE 4096
+
 CLICK_DECLS
 
 class LocalHost;
 
+/**@brief (Blackadder Core) the local subscribers of the identifiers of a network publication, as resolved by LocalProxy::findLocalSubscribers() for a given subscription generation.
+ *
+ * The entry is valid as long as its generation is the generation of the LocalProxy, which is bumped whenever a subscription is stored or removed.
+ */
+class SubscriberCacheEntry {
+public:
+	SubscriberCacheEntry() : generation(0) {}
+	/**@brief the subscription generation the entry was resolved for.
+	 */
+	unsigned int generation;
+	/**@brief the local subscribers, in the order they are pushed the publication.
+	 */
+	Vector<LocalHost *> subscribers;
+	/**@brief for each subscriber, the offset in the publication header (see IDListView) of the IDLength of the identifier it is subscribed to.
+	 */
+	Vector<int> IDOffsets;
+};
+
+/**@brief A HashTable that maps the identifiers of a network publication (its whole header, see IDListView) to their cached local subscribers.
+ */
+typedef HashTable<String, SubscriberCacheEntry *> SubscriberCache;
+typedef SubscriberCache::iterator SubscriberCacheIter;
+
 /**@brief (Blackadder Core) The LocalProxy Element is the core element in a Blackadder Node.
  *
  * All Click packets received by the Core component are annotated with an application identifier by the FromNetlink Element.
@@ -82,6 +108,9 @@ public:
 	 * If stage >= CLEANUP_ROUTER_INITIALIZED (i.e. the Element was initialized) LocalProxy will delete all stored ActivePublication, ActiveSubscription and LocalHost.
 	 */
 	void cleanup(CleanupStage stage);
+	/**@brief Click: Install the element's handlers (subscriber_cache_hits, subscriber_cache_misses and subscriber_cache_invalidations).
+	 */
+	void add_handlers();
 	/**@brief This method is called by Click whenever a packet is pushed to the LocalProxy by some other Element.
 	 *
 	 * We distinct the following cases:
@@ -102,6 +131,7 @@ public:
 	 *
 	 * 3) A Packet is pushed by the Forwarder Element. This is a network publication.
 	 * Network publications may have multiple information identifiers. LocalProxy reads them all and pulls everything from the packet except from the payload. Then, it calls the handleNetworkPublication() method.
+	 * The identifiers are not copied: an IDListView refers to the header, which stays in the headroom of the packet after the pull.
 	 * A special case is when the publication identifier is the /FFFFFFFFFFFFFFFD/NODEID.
 	 * This publications are RV/TM notifications, therefore the processRVNotification() method is called (after pulling everything from the packet except from the payload, which in this case is the notification).
 	 * Then the Packet is deleted (p->kill()).
@@ -162,9 +192,10 @@ public:
     /** @brief: store the identifiers of nodes that make implicit subscription
      *
      * @param _isubscriberID a reference to the node identifier of the isubscriber
+     * @param IDs the identifiers of the network publication that carried the implicit subscription
      * @retrun True if the storage is successful, false if not
      */
-    bool storeActiveNode(String &_isubscriberID, Vector<String> &IDs);
+    bool storeActiveNode(String &_isubscriberID, IDListView &IDs);
 	/** @brief The behaviour of this method is strategy specific. It should remove by the LocalProxy some state about the fact that an ActivePublication is no more assigned to a publisher (LocalHost).
 	 *
 	 * The ActivePublication is potentially deleted and the publisher is removed from it. Depending on the strategy, the request may be forwarded to a rendezvous node (even locally) or not.
@@ -287,11 +318,11 @@ public:
 	 *
 	 * It looks if any local subscribers exist and pushes the data to each one of them
 	 *
-	 * @param IDs A network publication may have multiple identifiers. IDs is a vector containing all the identifiers.
+	 * @param IDs A network publication may have multiple identifiers. IDs is a view of all the identifiers in the (pulled) header of p.
 	 * @param p A Click packet containing ONLY some headroom and the published DATA.
      * @param APItype the API type of the message, used when the message is passed to local subscribers
 	 */
-    void handleNetworkPublication(Vector<String> &IDs, Packet *p, unsigned char &APItype);
+    void handleNetworkPublication(IDListView &IDs, Packet *p, unsigned char &APItype);
 	/** This method is called whenever a pub/sub request must be published to the rendezvous point.
 	 *
 	 * If the rendezvous node is running locally (e.g. node-local strategy or domain-local when the application runs locally), a packet is created according to the exported API (PUBLISHED_DATA event) and sent to the LocalRV Element.
@@ -316,7 +347,7 @@ public:
 	 * If LocalHost is a Click Element the packet is pushed to the respective Element output.
 	 *
 	 * @param _localhost The LocalHost to send the event (along with the data).
-	 * @param ID The information identifier included in the PUBLISHED_DATA event.
+	 * @param ID The information identifier included in the PUBLISHED_DATA event. It may refer to the headroom of p (a stable String, see IDView).
 	 * @param p A Click packet containing ONLY some headroom and the DATA to be published.
      * @param APItype the API type of the message, used when the message is passed to local subscribers
 	 */
@@ -392,6 +423,28 @@ public:
 	 * @return true if at least a subscriber was found.
 	 */
 	bool findLocalSubscribers(Vector<String> &IDs, LocalHostStringHashMap & _localSubscribers);
+	/**@brief The same as above for the identifiers of a network publication, which are looked up without being copied out of the packet.
+	 *
+	 * The identifiers stored in _localSubscribers are stable Strings, valid as long as the packet.
+	 *
+	 * @param IDs a view of the identifiers of the network publication.
+	 * @param _localSubscribers a reference to a HashTable that maps pointers to LocalHost to information identifiers for which the LocalHost is subscribed.
+	 * @return true if at least a subscriber was found.
+	 */
+	bool findLocalSubscribers(IDListView &IDs, LocalHostStringHashMap & _localSubscribers);
+	/**@brief It returns the local subscribers of the identifiers of a network publication from the subscriber cache.
+	 *
+	 * A streaming publisher sends many publications with the same identifiers to the same subscribers, so findLocalSubscribers() is only called
+	 * when the identifiers are not in the cache or when a subscription was stored or removed since they were resolved (the cache entry is then invalidated).
+	 * The cache is flushed when it holds SUBSCRIBER_CACHE_SIZE entries.
+	 *
+	 * @param IDs a view of the identifiers of the network publication.
+	 * @return the cache entry, valid until the next call or until a subscription is stored or removed or the cache is flushed (e.g. while a publication is pushed to a local subscriber).
+	 */
+	SubscriberCacheEntry *resolveLocalSubscribers(IDListView &IDs);
+	/**@brief deletes all entries of the subscriber cache.
+	 */
+	void flushSubscriberCache();
 	/**@brief It looks for local subscribers to father item of the one identified by the ID.
 	 *
 	 * @todo It should be renamed or something
@@ -415,7 +468,7 @@ public:
 	 * A publisher or subscriber can be an application or a Click element. Check LocalHost documentation.
 	 */
 	PubSubIdx local_pub_sub_Index;
-	/**@brief A HashTable that maps an ActivePublication identifier (full ID from a root of a graph) to a pointer of ActivePublication.
+	/**@brief An ActivePublicationIndex that maps an ActivePublication identifier (full ID from a root of a graph) to a pointer of ActivePublication.
 	 */
 	ActivePub activePublicationIndex;
 	/**@brief A HashTable that maps an ActiveSubscription identifier (full ID from a root of a graph) to a pointer of ActiveSubscription.
@@ -424,7 +477,21 @@ public:
     /**@brief A HashTable that maps an ActiveNode identifier (NODEID of NODEID_LEN) to a pointer of ActiveNode.
      */
     ActiveNodeMap activeNodeIndex;
-
+	/**@brief The local subscribers of recent network publications (see resolveLocalSubscribers()).
+	 */
+	SubscriberCache subscriberCache;
+	/**@brief The subscription generation, bumped whenever an ActiveSubscription is stored or removed.
+	 */
+	unsigned int subscriptionGeneration;
+	/**@brief The number of network publications whose local subscribers were found in the subscriber cache.
+	 */
+	uint64_t subscriber_cache_hits;
+	/**@brief The number of network publications whose identifiers were not in the subscriber cache.
+	 */
+	uint64_t subscriber_cache_misses;
+	/**@brief The number of cache entries resolved again because a subscription changed.
+	 */
+	uint64_t subscriber_cache_invalidations;
 };
 
 CLICK_ENDDECLS
@@ -86,13 +86,16 @@ void PLA::push(int in_port, Packet *p) {
 	unsigned csum;
 	uint8_t ret = 0;
 	uint16_t len;
+	/*the forwarding table of the Forwarder, it is not deleted before readUnlock*/
+	ForwarderThreadState &state = forwarder_element->threadState();
+	Vector<ForwardingEntry *> &fwTable = *forwarder_element->readLock(state);
 
 	if (in_port == 0) {
 		start_eval();
 		memcpy(FID._data, p->data() + HD_LEN, FID_LEN);
 		/*Check all entries in my forwarding table and forward appropriately*/
-		for (i = 0; i < forwarder_element->fwTable.size(); i++) {
-			fe = forwarder_element->fwTable[i];
+		for (i = 0; i < fwTable.size(); i++) {
+			fe = fwTable[i];
 			andVector = (FID)&(*fe->LID);
 			if (andVector == (*fe->LID)) {
 				if (SIGN_PLA) {
@@ -145,6 +148,7 @@ void PLA::push(int in_port, Packet *p) {
 						p->kill();
 						stop_eval();
 						print_eval(2);
+						forwarder_element->readUnlock(state);
 						return;
 					} else {
 						pla_len = PLA_LEN;
@@ -156,6 +160,7 @@ void PLA::push(int in_port, Packet *p) {
 						p->kill();
 						stop_eval();
 						print_eval(5);
+						forwarder_element->readUnlock(state);
 						return;
 					} else {
 						pla_len = PLA_LEN;
@@ -174,8 +179,8 @@ void PLA::push(int in_port, Packet *p) {
 		testFID.negate();
 		if (!testFID.zero()) {
 			/*Check all entries in my forwarding table and forward appropriately*/
-			for (i = 0; i < forwarder_element->fwTable.size(); i++) {
-				fe = forwarder_element->fwTable[i];
+			for (i = 0; i < fwTable.size(); i++) {
+				fe = fwTable[i];
 				andVector = (FID)&(*fe->LID);
 				if (andVector == (*fe->LID)) {
 					out_links.push_back(fe);
@@ -244,6 +249,7 @@ void PLA::push(int in_port, Packet *p) {
 		}
 
 	}
+	forwarder_element->readUnlock(state);
 }
 
 void PLA::start_eval() {
@@ -0,0 +1,148 @@
+/*
+ * This file is part of Blackadder.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+#include "publicationreplay.hh"
+
+#include <click/standard/scheduleinfo.hh>
+
+CLICK_DECLS
+
+/*the scope of all publications, each identifier adds an item (its index) to it*/
+#define REPLAY_SCOPE_BYTE 0xAB
+#define REPLAY_BURST 32
+
+PublicationReplay::PublicationReplay() : _task(this) {
+	number_of_ids = 1;
+	count = 0;
+	data_length = 0;
+	sent = 0;
+	received = 0;
+}
+
+PublicationReplay::~PublicationReplay() {
+	click_chatter("PublicationReplay: destroyed!");
+}
+
+int PublicationReplay::configure(Vector<String> &conf, ErrorHandler *errh) {
+	if (conf.size() != 3) {
+		return errh->error("PublicationReplay: NUMBER_OF_IDS, COUNT and LENGTH are expected");
+	}
+	cp_integer(conf[0], &number_of_ids);
+	cp_integer(conf[1], &count);
+	cp_integer(conf[2], &data_length);
+	if ((number_of_ids < 1) || (number_of_ids > 255)) {
+		return errh->error("PublicationReplay: the number of identifiers must be between 1 and 255");
+	}
+	return 0;
+}
+
+int PublicationReplay::initialize(ErrorHandler *errh) {
+	unsigned char type = SUBSCRIBE_INFO;
+	unsigned char IDLength = 1;
+	unsigned char strategy = LINK_LOCAL;
+	/*subscribe to /SCOPE/0: [type][IDLength][ID][prefixIDLength][prefixID][strategy]*/
+	WritablePacket *p = Packet::make(50, NULL, sizeof (type) + sizeof (IDLength) + PURSUIT_ID_LEN + sizeof (IDLength) + PURSUIT_ID_LEN + sizeof (strategy), 0);
+	memcpy(p->data(), &type, sizeof (type));
+	memcpy(p->data() + sizeof (type), &IDLength, sizeof (IDLength));
+	memset(p->data() + sizeof (type) + sizeof (IDLength), 0, PURSUIT_ID_LEN);
+	memcpy(p->data() + sizeof (type) + sizeof (IDLength) + PURSUIT_ID_LEN, &IDLength, sizeof (IDLength));
+	memset(p->data() + sizeof (type) + 2 * sizeof (IDLength) + PURSUIT_ID_LEN, REPLAY_SCOPE_BYTE, PURSUIT_ID_LEN);
+	memcpy(p->data() + sizeof (type) + 2 * sizeof (IDLength) + 2 * PURSUIT_ID_LEN, &strategy, sizeof (strategy));
+	output(0).push(p);
+	ScheduleInfo::initialize_task(this, &_task, errh);
+	return 0;
+}
+
+WritablePacket *PublicationReplay::makePublication() {
+	unsigned char numberOfIDs = number_of_ids;
+	unsigned char IDLength = 2;
+	unsigned char type = PUBLISH_DATA;
+	int index = sizeof (numberOfIDs);
+	/*the headroom the Forwarder leaves in front of a publication (MAC header and FID)*/
+	WritablePacket *p = Packet::make(14 + FID_LEN, NULL, sizeof (numberOfIDs) + number_of_ids * (sizeof (IDLength) + 2 * PURSUIT_ID_LEN) + sizeof (type) + data_length, 0);
+	if (!p) {
+		return p;
+	}
+	memcpy(p->data(), &numberOfIDs, sizeof (numberOfIDs));
+	for (int i = 0; i < number_of_ids; i++) {
+		memcpy(p->data() + index, &IDLength, sizeof (IDLength));
+		memset(p->data() + index + sizeof (IDLength), REPLAY_SCOPE_BYTE, PURSUIT_ID_LEN);
+		memset(p->data() + index + sizeof (IDLength) + PURSUIT_ID_LEN, 0, PURSUIT_ID_LEN);
+		*(p->data() + index + sizeof (IDLength) + 2 * PURSUIT_ID_LEN - 1) = (unsigned char) i;
+		index = index + sizeof (IDLength) + 2 * PURSUIT_ID_LEN;
+	}
+	memcpy(p->data() + index, &type, sizeof (type));
+	memset(p->data() + index + sizeof (type), 0, data_length);
+	return p;
+}
+
+bool PublicationReplay::run_task(Task *) {
+	if (sent == 0) {
+		first = Timestamp::now();
+	}
+	for (int i = 0; (i < REPLAY_BURST) && (sent < count); i++) {
+		WritablePacket *p = makePublication();
+		if (!p) {
+			break;
+		}
+		sent++;
+		output(1).push(p);
+	}
+	if (sent < count) {
+		_task.fast_reschedule();
+	} else {
+		last = Timestamp::now();
+		click_chatter("PublicationReplay: %llu publications sent, %llu delivered", (unsigned long long) sent, (unsigned long long) received);
+		router()->please_stop_driver();
+	}
+	return true;
+}
+
+void PublicationReplay::push(int /*port*/, Packet *p) {
+	received++;
+	p->kill();
+}
+
+enum { H_SENT, H_RECEIVED, H_RATE };
+
+static String
+PublicationReplay_read_stats_handler(Element *e, void *thunk)
+{
+	PublicationReplay *pr = (PublicationReplay *)e;
+	switch ((intptr_t) thunk) {
+		case H_SENT:
+			return String(pr->sent);
+		case H_RECEIVED:
+			return String(pr->received);
+		default:
+		{
+			/*publications per second between the first and the last burst*/
+			double elapsed = (pr->last - pr->first).doubleval();
+			if (elapsed <= 0) {
+				return String(0);
+			}
+			return String(pr->sent / elapsed);
+		}
+	}
+}
+
+void PublicationReplay::add_handlers() {
+	add_read_handler("sent", PublicationReplay_read_stats_handler, H_SENT);
+	add_read_handler("received", PublicationReplay_read_stats_handler, H_RECEIVED);
+	add_read_handler("rate", PublicationReplay_read_stats_handler, H_RATE);
+}
+
+CLICK_ENDDECLS
+EXPORT_ELEMENT(PublicationReplay)
@@ -0,0 +1,111 @@
+/*
+ * This file is part of Blackadder.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version
+ * 3 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * See LICENSE and COPYING for more details.
+ */
+
+#ifndef CLICK_PUBLICATIONREPLAY_HH
+#define CLICK_PUBLICATIONREPLAY_HH
+
+#include "globalconf.hh"
+
+#include <click/task.hh>
+#include <click/timestamp.hh>
+
+CLICK_DECLS
+
+/**@brief (Blackadder Benchmark) PublicationReplay replays network publications into the LocalProxy, as if the Forwarder pushed them, and counts the ones delivered back to it.
+ *
+ * It is connected to a LocalProxy like any other Click Element (output 0 to a LocalProxy port >= 4 and that LocalProxy output back to input 0),
+ * and its output 1 to the port 2 of the LocalProxy. Upon initialization it subscribes (LINK_LOCAL) to the first identifier of the publications.
+ * Then a task pushes the publications in bursts of 32. Each publication has NUMBER_OF_IDS identifiers /SCOPE/ITEMi, so that the LocalProxy looks up all of them.
+ * See localproxy_bench.conf.
+ */
+class PublicationReplay : public Element {
+public:
+	/**
+	 * @brief Constructor: it does nothing - as Click suggests
+	 * @return
+	 */
+	PublicationReplay();
+	/**
+	 * @brief Destructor: it does nothing - as Click suggests
+	 * @return
+	 */
+	~PublicationReplay();
+	/**
+	 * @brief the class name - required by Click
+	 * @return
+	 */
+	const char *class_name() const {return "PublicationReplay";}
+	/**
+	 * @brief the port count - required by Click - deliveries from the LocalProxy in, subscription requests (0) and network publications (1) out.
+	 * @return
+	 */
+	const char *port_count() const {return "1/2";}
+	/**
+	 * @brief a PUSH Element.
+	 * @return PUSH
+	 */
+	const char *processing() const {return PUSH;}
+	/**
+	 * @brief Element configuration: the number of identifiers of each publication, the number of publications and the length of their data.
+	 */
+	int configure(Vector<String>&, ErrorHandler*);
+	/**@brief This Element must be configured (and initialized) AFTER the LocalProxy, which receives its subscription request in initialize().
+	 * @return the correct number so that it is configured afterwards
+	 */
+	int configure_phase() const {return 300;}
+	/**@brief Click: Install the element's handlers (sent, received and rate).
+	 */
+	void add_handlers();
+	/**
+	 * @brief sends the subscription request and schedules the task.
+	 * @param errh
+	 * @return
+	 */
+	int initialize(ErrorHandler *errh);
+	/**@brief counts a publication delivered by the LocalProxy and kills it.
+	 * @param port
+	 * @param p
+	 */
+	void push(int port, Packet *p);
+	/**@brief pushes a burst of publications, and stops the driver after the last one.
+	 */
+	bool run_task(Task *);
+	/**@brief The number of identifiers of each publication.
+	 */
+	int number_of_ids;
+	/**@brief The number of publications to send.
+	 */
+	uint64_t count;
+	/**@brief The length of the data of each publication.
+	 */
+	int data_length;
+	/**@brief The number of publications sent.
+	 */
+	uint64_t sent;
+	/**@brief The number of publications delivered by the LocalProxy.
+	 */
+	uint64_t received;
+	/**@brief When the first and the last publications were sent.
+	 */
+	Timestamp first, last;
+private:
+	/**@brief builds a network publication as the Forwarder pushes it to the LocalProxy: [numberOfIDs][IDLength][ID]...[PUBLISH_DATA][data].
+	 */
+	WritablePacket *makePublication();
+	Task _task;
+};
+
+CLICK_ENDDECLS
+#endif
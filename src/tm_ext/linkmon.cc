@@ -63,7 +63,7 @@ int LinkMon::configure(Vector<String>& conf, ErrorHandler*){
 int LinkMon::initialize(ErrorHandler *){
   
   // Initialize Links
-  FwTable fwt = &fw->fwTable;
+  FwTable fwt = fw->fwTable;
   
   // Count sub-interfaces per interface
   map<string, int> ifcount;